@@ -413,21 +413,43 @@ public:
   typedef _ConfiguratorType ConfiguratorType;
 
   explicit FELinOpInterface ( const typename ConfiguratorType::InitType &Grid, OperatorType OpType = ONTHEFLY )
-      : FEOpInterface<ConfiguratorType, aol::Vector<RealType> > ( Grid ), _mat ( NULL ), _opType ( OpType ) {}
+      : FEOpInterface<ConfiguratorType, aol::Vector<RealType> > ( Grid ), _mat ( NULL ), _frozenMat ( NULL ), _opType ( OpType ) {}
 
   explicit FELinOpInterface ( const ConfiguratorType &Config, OperatorType OpType = ONTHEFLY )
-      : FEOpInterface<ConfiguratorType, aol::Vector<RealType> > ( Config ), _mat ( NULL ), _opType ( OpType ) {}
+      : FEOpInterface<ConfiguratorType, aol::Vector<RealType> > ( Config ), _mat ( NULL ), _frozenMat ( NULL ), _opType ( OpType ) {}
 
   virtual ~FELinOpInterface( ) {
     delete _mat;
+    delete _frozenMat;
   }
 
-  //! clears the assembled matrix
+  //! clears the assembled and the frozen matrix
   void reset( ) {
     if ( _mat ) {
       delete _mat;
     }
     _mat = NULL;
+    discardFrozenMatrix( );
+  }
+
+  /** Assembles the matrix (if not done yet) and, if it is stored row by row (aol::SparseMatrix and the other
+   *  aol::GenSparseMatrix subclasses), (re)creates a contiguous CSRMatrix copy of it, which multiplies considerably
+   *  faster. ASSEMBLED operators do this automatically after assembling their matrix and then use the copy in the
+   *  unmasked applyAdd. The assembled matrix is kept for getMatrix and the masked applyAdd, so call freeze again
+   *  after changing the matrix returned by getMatrix. Other matrix types (e.g. qc::FastUniformGridMatrix) are used as
+   *  they are.
+   *  \attention Not thread safe, freeze before applying the operator in parallel.
+   */
+  void freeze( ) {
+    if ( !_mat ) {
+      assembleMatrix( );
+    }
+    discardFrozenMatrix( );
+    _frozenMat = freezeMatrix ( _mat );
+  }
+
+  bool isFrozen( ) const {
+    return ( _frozenMat != NULL );
   }
 
   OperatorType getOpType() const {
@@ -471,13 +493,17 @@ public:
       if ( !_mat ) {
         assembleMatrix( );
       }
-      _mat->applyAdd ( Arg, Dest );
+      if ( _frozenMat )
+        _frozenMat->applyAdd ( Arg, Dest );
+      else
+        _mat->applyAdd ( Arg, Dest );
       break;
     default:
       throw aol::UnimplementedCodeException ( "FELinOpInterface::applyAdd: unsupported opType", __FILE__, __LINE__ );
     }
   }
 
+  //! \attention ASSEMBLED operators apply a frozen copy of the matrix, call freeze after changing the returned matrix.
   typename ConfiguratorType::MatrixType& getMatrix( ) const {
     if ( !_mat ) {
       assembleMatrix( );
@@ -486,6 +512,12 @@ public:
     return *_mat;
   }
 
+  const CSRMatrix<RealType>& getFrozenMatrix( ) const {
+    if ( !_frozenMat )
+      throw aol::Exception ( "FELinOpInterface::getFrozenMatrix: the matrix has not been frozen", __FILE__, __LINE__ );
+    return *_frozenMat;
+  }
+
   void makeDiagonal ( DiagonalMatrix<RealType> &Mat ) {
     typedef typename ConfiguratorType::ElementIteratorType IteratorType;
     Mat.setZero();
@@ -595,8 +627,26 @@ protected:
 
   void assembleMatrix( ) const {
     if ( _mat ) delete _mat;
+    discardFrozenMatrix( );
     _mat = this->getConfigurator().createNewMatrix( );
     assembleAddMatrix ( *_mat );
+    if ( _opType == ASSEMBLED )
+      _frozenMat = freezeMatrix ( _mat );
+  }
+
+  //! Matrices stored row by row (aol::SparseMatrix and the other aol::GenSparseMatrix subclasses) are copied to a contiguous CSRMatrix by freeze.
+  static CSRMatrix<RealType>* freezeMatrix ( const GenSparseMatrix<RealType> *Mat ) {
+    return new CSRMatrix<RealType> ( *Mat );
+  }
+
+  //! Other matrix types (e.g. qc::FastUniformGridMatrix) are used as they are.
+  static CSRMatrix<RealType>* freezeMatrix ( const void * ) {
+    return NULL;
+  }
+
+  void discardFrozenMatrix( ) const {
+    delete _frozenMat;
+    _frozenMat = NULL;
   }
 
 public:
@@ -704,6 +754,7 @@ protected:
   inline const Imp& asImp() const { return static_cast<const Imp&> ( *this ); }
 
   mutable typename ConfiguratorType::MatrixType *_mat;
+  mutable CSRMatrix<RealType> *_frozenMat;
   OperatorType _opType;
 
   template <typename FEOpType, typename MatrixType, GridGlobalIndexMode indexMode> friend struct LocalAssemblyHelper;
@@ -1590,6 +1641,48 @@ protected:
 };
 
 
+/**
+ * \brief Partition of the elements of a configurator into slabs, used to traverse the elements in parallel in the
+ *        element loops of the nonlinear FE operator interfaces (FENonlinOpInterface and friends).
+ *
+ * A slab is traversed by a single thread in the order of the element iterator. Two slabs whose indices have the
+ * same parity may not share any degrees of freedom, so the operators scatter all even slabs in parallel and
+ * afterwards all odd ones without any synchronization. Since the partition only depends on the configurator,
+ * the results don't depend on the number of threads.
+ *
+ * \attention With a partition into more than one slab, getNonlinearity and evaluateIntegrand are called by several
+ *            threads at the same time. Thus, they have to be thread safe in every class derived from one of these
+ *            interfaces, in particular they may not modify mutable members (e.g. caches) without synchronization.
+ *
+ * This default puts all elements into one slab, i.e. the elements are traversed serially. qc::QuocElementLayerSlabs
+ * provides a partition for the regular quoc grids.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+class FEElementSlabs {
+public:
+  typedef typename ConfiguratorType::ElementIteratorType IteratorType;
+  typedef typename IteratorType::EndType EndType;
+protected:
+  const ConfiguratorType &_config;
+public:
+  explicit FEElementSlabs ( const ConfiguratorType &Config ) : _config ( Config ) {}
+
+  int getNumSlabs ( ) const {
+    return 1;
+  }
+
+  IteratorType begin ( const int /*Slab*/ ) const {
+    return _config.begin();
+  }
+
+  EndType end ( const int /*Slab*/ ) const {
+    return _config.end();
+  }
+};
+
+
 //! General Interface for nonlinear FE-operators depending on x, which are locally assembled.
 //! only getNonlinearity has to be provided. not for operators depending on derivatives of
 //! the function, use FENonlinDiffOpInterface instead.
@@ -1614,23 +1707,46 @@ public:
   virtual ~FENonlinOpInterface( ) {}
 
   void applyAdd ( const Vector<RealType> &Arg, Vector<RealType> &Dest ) const {
-    typedef typename ConfiguratorType::ElementIteratorType IteratorType;
     const aol::DiscreteFunctionDefault<ConfiguratorType> discrFunc ( this->getConfigurator(), Arg );
+    const FEElementSlabs<ConfiguratorType> slabs ( this->getConfigurator() );
+    const int numSlabs = slabs.getNumSlabs();
 
+    // Slabs with indices of the same parity don't share any dofs, see FEElementSlabs.
+    for ( int parity = 0; parity < 2; ++parity ) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for ( int slab = parity; slab < numSlabs; slab += 2 )
+        applyAddOnSlab ( discrFunc, slabs.begin ( slab ), slabs.end ( slab ), Dest );
+    }
+  }
+
+  //! interface function, has to be provided in derived classes. Is called by several threads at the same time, so it has to be thread safe (see FEElementSlabs).
+  void getNonlinearity ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFunc,
+                         const typename ConfiguratorType::ElementType &El,
+                         int QuadPoint, const typename ConfiguratorType::DomVecType &RefCoord,
+                         typename ConfiguratorType::RealType &NL ) const {
+    throw aol::Exception ( "called the interface function", __FILE__, __LINE__ );
+    this->asImp().getNonlinearity ( DiscFunc, El, QuadPoint, RefCoord, NL );
+  }
+
+protected:
+  void applyAddOnSlab ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscrFunc,
+                        typename ConfiguratorType::ElementIteratorType it,
+                        const typename ConfiguratorType::ElementIteratorType::EndType &end_it,
+                        Vector<RealType> &Dest ) const {
     typedef RealType NLTYPE;
 
     NLTYPE *nl_cache = new NLTYPE[ this->getConfigurator().maxNumQuadPoints() ];
 
-    const typename IteratorType::EndType end_it = this->getConfigurator().end();
-
-    for ( IteratorType it = this->getConfigurator().begin(); it != end_it; ++it ) {
+    for ( ; it != end_it; ++it ) {
       const int numLocalDofs = this->getConfigurator().getNumLocalDofs ( *it );
 
       const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
       const int numQuadPoints = bfs.numQuadPoints( );
 
       for ( int q = 0; q < numQuadPoints; ++q ) {
-        this->asImp().getNonlinearity ( discrFunc, *it, q, bfs.getRefCoord ( q ), nl_cache[q] );
+        this->asImp().getNonlinearity ( DiscrFunc, *it, q, bfs.getRefCoord ( q ), nl_cache[q] );
       }
 
       for ( int dof = 0; dof < numLocalDofs; dof++ ) {
@@ -1648,16 +1764,6 @@ public:
     delete[] nl_cache;
   }
 
-  //! interface function, has to be provided in derived classes.
-  void getNonlinearity ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFunc,
-                         const typename ConfiguratorType::ElementType &El,
-                         int QuadPoint, const typename ConfiguratorType::DomVecType &RefCoord,
-                         typename ConfiguratorType::RealType &NL ) const {
-    throw aol::Exception ( "called the interface function", __FILE__, __LINE__ );
-    this->asImp().getNonlinearity ( DiscFunc, El, QuadPoint, RefCoord, NL );
-  }
-
-protected:
   // barton-nackman
   inline Imp& asImp() { return static_cast<Imp&> ( *this ); }
   inline const Imp& asImp() const { return static_cast<const Imp&> ( *this ); }
@@ -1789,20 +1895,43 @@ public:
       throw aol::Exception ( "Mismatching number of vectors.", __FILE__, __LINE__ );
     }
 
-    typedef typename ConfiguratorType::ElementIteratorType IteratorType;
-
     auto_container<NumCompArg, aol::DiscreteFunctionDefault<ConfiguratorType> > discrFuncsArg;
     for ( int c = 0; c < NumCompArg; c++ ) {
       discrFuncsArg.set_copy ( c, aol::DiscreteFunctionDefault<ConfiguratorType> ( this->getConfigurator(), Arg[c] ) );
     }
 
+    const FEElementSlabs<ConfiguratorType> slabs ( this->getConfigurator() );
+    const int numSlabs = slabs.getNumSlabs();
+
+    // Slabs with indices of the same parity don't share any dofs, see FEElementSlabs.
+    for ( int parity = 0; parity < 2; ++parity ) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for ( int slab = parity; slab < numSlabs; slab += 2 )
+        applyAddOnSlab ( discrFuncsArg, slabs.begin ( slab ), slabs.end ( slab ), Dest );
+    }
+  }
+
+  //! interface function, has to be provided in derived classes. Is called by several threads at the same time, so it has to be thread safe (see FEElementSlabs).
+  void getNonlinearity ( auto_container<NumCompArg, aol::DiscreteFunctionDefault<ConfiguratorType> > &DiscFuncs,
+                         const typename ConfiguratorType::ElementType &El,
+                         int QuadPoint, const typename ConfiguratorType::DomVecType &/*RefCoord*/,
+                         aol::Vec<NumCompDest, RealType> &NL ) const {
+    throw aol::Exception ( "called the interface function", __FILE__, __LINE__ );
+    this->asImp().getNonlinearity ( DiscFuncs, El, QuadPoint, NL );
+  }
+
+protected:
+  void applyAddOnSlab ( auto_container<NumCompArg, aol::DiscreteFunctionDefault<ConfiguratorType> > &DiscrFuncsArg,
+                        typename ConfiguratorType::ElementIteratorType it,
+                        const typename ConfiguratorType::ElementIteratorType::EndType &end_it,
+                        MultiVector<RealType> &Dest ) const {
     typedef typename aol::Vec<NumCompDest, RealType> NLTYPE;
 
     NLTYPE *nl_cache = new NLTYPE[ this->getConfigurator().maxNumQuadPoints() ];
 
-    const typename IteratorType::EndType end_it = this->getConfigurator().end();
-
-    for ( IteratorType it = this->getConfigurator().begin(); it != end_it; ++it ) {
+    for ( ; it != end_it; ++it ) {
       const int numLocalDofs = this->getConfigurator().getNumLocalDofs ( *it );
 
       const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
@@ -1810,7 +1939,7 @@ public:
       const RealType vol = this->getConfigurator().vol ( *it );
 
       for ( int q = 0; q < numQuadPoints; ++q ) {
-        this->asImp().getNonlinearity ( discrFuncsArg, *it, q, bfs.getRefCoord ( q ), nl_cache[q] );
+        this->asImp().getNonlinearity ( DiscrFuncsArg, *it, q, bfs.getRefCoord ( q ), nl_cache[q] );
       }
 
       aol::Vec<NumCompDest, RealType> a;
@@ -1829,16 +1958,6 @@ public:
     delete[] nl_cache;
   }
 
-  //! interface function, has to be provided in derived classes.
-  void getNonlinearity ( auto_container<NumCompArg, aol::DiscreteFunctionDefault<ConfiguratorType> > &DiscFuncs,
-                         const typename ConfiguratorType::ElementType &El,
-                         int QuadPoint, const typename ConfiguratorType::DomVecType &/*RefCoord*/,
-                         aol::Vec<NumCompDest, RealType> &NL ) const {
-    throw aol::Exception ( "called the interface function", __FILE__, __LINE__ );
-    this->asImp().getNonlinearity ( DiscFuncs, El, QuadPoint, NL );
-  }
-
-protected:
   // barton-nackman
   inline Imp& asImp() { return static_cast<Imp&> ( *this ); }
   inline const Imp& asImp() const { return static_cast<const Imp&> ( *this ); }
@@ -1869,36 +1988,18 @@ public:
   virtual ~FENonlinDiffOpInterface( ) {}
 
   void applyAdd ( const Vector<RealType> &Arg, Vector<RealType> &Dest ) const {
-
-    typedef typename ConfiguratorType::ElementIteratorType IteratorType;
     const aol::DiscreteFunctionDefault<ConfiguratorType> discrFunc ( this->getConfigurator(), Arg );
+    const FEElementSlabs<ConfiguratorType> slabs ( this->getConfigurator() );
+    const int numSlabs = slabs.getNumSlabs();
 
-    typedef typename ConfiguratorType::VecType NLTYPE;
-
-    NLTYPE *nl_cache = new NLTYPE[ this->getConfigurator().maxNumQuadPoints() ];
-
-    const typename IteratorType::EndType end_it = this->getConfigurator().end();
-
-    for ( IteratorType it = this->getConfigurator().begin(); it != end_it; ++it ) {
-      const int numLocalDofs = this->getConfigurator().getNumLocalDofs ( *it );
-
-      const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
-      const int numQuadPoints = bfs.numQuadPoints( );
-
-      for ( int q = 0; q < numQuadPoints; ++q ) {
-        this->asImp().getNonlinearity ( discrFunc, *it, q, bfs.getRefCoord ( q ), nl_cache[q] );
-      }
-
-      for ( int dof = 0; dof < numLocalDofs; dof++ ) {
-        RealType a = 0.;
-        for ( int q = 0; q < numQuadPoints; ++q ) {
-          a += ( nl_cache[q] * bfs.evaluateGradient ( dof, q ) ) * bfs.getWeight ( q );
-        }
-        a *= this->getConfigurator().vol ( *it ) ;
-        Dest[ this->getConfigurator().localToGlobal ( *it, dof ) ] += a;
-      }
+    // Slabs with indices of the same parity don't share any dofs, see FEElementSlabs.
+    for ( int parity = 0; parity < 2; ++parity ) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for ( int slab = parity; slab < numSlabs; slab += 2 )
+        applyAddOnSlab ( discrFunc, slabs.begin ( slab ), slabs.end ( slab ), Dest );
     }
-    delete[] nl_cache;
   }
 
 
@@ -1978,7 +2079,7 @@ public:
   }
 
 
-
+  //! interface function, has to be provided in derived classes. Is called by several threads at the same time, so it has to be thread safe (see FEElementSlabs).
   void getNonlinearity ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFunc,
                          const typename ConfiguratorType::ElementType &El,
                          int QuadPoint, const typename ConfiguratorType::DomVecType &RefCoord,
@@ -1988,6 +2089,36 @@ public:
   }
 
 protected:
+  void applyAddOnSlab ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscrFunc,
+                        typename ConfiguratorType::ElementIteratorType it,
+                        const typename ConfiguratorType::ElementIteratorType::EndType &end_it,
+                        Vector<RealType> &Dest ) const {
+    typedef typename ConfiguratorType::VecType NLTYPE;
+
+    NLTYPE *nl_cache = new NLTYPE[ this->getConfigurator().maxNumQuadPoints() ];
+
+    for ( ; it != end_it; ++it ) {
+      const int numLocalDofs = this->getConfigurator().getNumLocalDofs ( *it );
+
+      const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
+      const int numQuadPoints = bfs.numQuadPoints( );
+
+      for ( int q = 0; q < numQuadPoints; ++q ) {
+        this->asImp().getNonlinearity ( DiscrFunc, *it, q, bfs.getRefCoord ( q ), nl_cache[q] );
+      }
+
+      for ( int dof = 0; dof < numLocalDofs; dof++ ) {
+        RealType a = 0.;
+        for ( int q = 0; q < numQuadPoints; ++q ) {
+          a += ( nl_cache[q] * bfs.evaluateGradient ( dof, q ) ) * bfs.getWeight ( q );
+        }
+        a *= this->getConfigurator().vol ( *it ) ;
+        Dest[ this->getConfigurator().localToGlobal ( *it, dof ) ] += a;
+      }
+    }
+    delete[] nl_cache;
+  }
+
   // barton-nackman
   inline Imp& asImp() { return static_cast<Imp&> ( *this ); }
   inline const Imp& asImp() const { return static_cast<const Imp&> ( *this ); }
@@ -2039,15 +2170,38 @@ public:
   }
 
   void applyAdd ( const CompType &Arg, MultiVector<RealType> &Dest ) const {
+    const FEElementSlabs<ConfiguratorType> slabs ( this->getConfigurator() );
+    const int numSlabs = slabs.getNumSlabs();
+
+    // Slabs with indices of the same parity don't share any dofs, see FEElementSlabs.
+    for ( int parity = 0; parity < 2; ++parity ) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for ( int slab = parity; slab < numSlabs; slab += 2 )
+        applyAddOnSlab ( Arg, slabs.begin ( slab ), slabs.end ( slab ), Dest );
+    }
+  }
+
+  //! interface function, has to be provided in derived classes. Is called by several threads at the same time, so it has to be thread safe (see FEElementSlabs).
+  void getNonlinearity ( const CompType &DiscFuncs,
+                         const typename ConfiguratorType::ElementType &El,
+                         int QuadPoint, const typename ConfiguratorType::DomVecType &/*RefCoord*/,
+                         aol::Mat<NumCompDest, ConfiguratorType::Dim, typename ConfiguratorType::RealType> &NL ) const {
+    throw aol::Exception ( "called the interface function", __FILE__, __LINE__ );
+    this->asImp().getNonlinearity ( DiscFuncs, El, QuadPoint, NL );
+  }
 
+protected:
+  void applyAddOnSlab ( const CompType &Arg,
+                        typename ConfiguratorType::ElementIteratorType it,
+                        const typename ConfiguratorType::ElementIteratorType::EndType &end_it,
+                        MultiVector<RealType> &Dest ) const {
     typedef aol::Mat<NumCompDest, ConfiguratorType::Dim, RealType> NLTYPE;
-    typedef typename ConfiguratorType::ElementIteratorType IteratorType;
 
     NLTYPE *nl_cache = new NLTYPE[ this->getConfigurator().maxNumQuadPoints() ];
 
-    const typename IteratorType::EndType end_it = this->getConfigurator().end();
-
-    for ( IteratorType it = this->getConfigurator().begin(); it != end_it; ++it ) {
+    for ( ; it != end_it; ++it ) {
       const int numLocalDofs = this->getConfigurator().getNumLocalDofs ( *it );
 
       const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
@@ -2085,16 +2239,6 @@ public:
     delete[] nl_cache;
   }
 
-  //! interface function, has to be provided in derived classes.
-  void getNonlinearity ( const CompType &DiscFuncs,
-                         const typename ConfiguratorType::ElementType &El,
-                         int QuadPoint, const typename ConfiguratorType::DomVecType &/*RefCoord*/,
-                         aol::Mat<NumCompDest, ConfiguratorType::Dim, typename ConfiguratorType::RealType> &NL ) const {
-    throw aol::Exception ( "called the interface function", __FILE__, __LINE__ );
-    this->asImp().getNonlinearity ( DiscFuncs, El, QuadPoint, NL );
-  }
-
-protected:
   // barton-nackman
   inline Imp& asImp() { return static_cast<Imp&> ( *this ); }
   inline const Imp& asImp() const { return static_cast<const Imp&> ( *this ); }
@@ -2536,32 +2680,24 @@ public:
   virtual ~FENonlinIntegrationVectorInterface() {}
 
   void applyAdd ( const aol::MultiVector<RealType> &Arg, aol::Scalar<RealType> &Dest ) const {
-
-    typedef typename ConfiguratorType::ElementIteratorType IteratorType;
-
     // initialize discrete functions from argument MultiVector
     auto_container<NumComponents, aol::DiscreteFunctionDefault<ConfiguratorType> > discrFuncsArg;
     for ( int c = 0; c < NumComponents; c++ ) {
       discrFuncsArg.set_copy ( c, aol::DiscreteFunctionDefault<ConfiguratorType> ( this->getConfigurator(), Arg[c] ) );
     }
 
-    RealType res = 0.;
+    const FEElementSlabs<ConfiguratorType> slabs ( this->getConfigurator() );
+    const int numSlabs = slabs.getNumSlabs();
 
-    for ( IteratorType it = this->getConfigurator().begin(); it != this->getConfigurator().end(); ++it ) {
-      // Necessary because the number of quadpoints may vary
-      // getBaseFunctionSet() implicitly calls initializeFromElement
-      const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
-      const int numQuadPoints = bfs.numQuadPoints( );
-
-      RealType a = 0.;
-      for ( int q = 0; q < numQuadPoints; ++q )
-        a += this->asImp().evaluateIntegrand ( discrFuncsArg, *it, q, bfs.getRefCoord ( q ) )
-             * bfs.getWeight ( q );
+    // The integrals over the slabs are summed up in a fixed order, so the result doesn't depend on the number of threads.
+    aol::Vector<RealType> slabIntegrals ( numSlabs );
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for ( int slab = 0; slab < numSlabs; ++slab )
+      slabIntegrals[slab] = integrateOnSlab ( discrFuncsArg, slabs.begin ( slab ), slabs.end ( slab ) );
 
-      a *= this->getConfigurator().vol ( *it );
-      res += a;
-    }
-    Dest += res;
+    Dest += slabIntegrals.sum();
   }
 
   void applyAddIntegrand ( const aol::MultiVector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
@@ -2607,7 +2743,7 @@ public:
     Dest += dest;
   }
 
-  //! interface function, has to be provided in derived classes.
+  //! interface function, has to be provided in derived classes. Is called by several threads at the same time, so it has to be thread safe (see FEElementSlabs).
   RealType evaluateIntegrand ( const auto_container<NumComponents, aol::DiscreteFunctionDefault<ConfiguratorType> > &DiscFuncs,
                                const typename ConfiguratorType::ElementType &El,
                                int QuadPoint, const typename ConfiguratorType::DomVecType &RefCoord ) const {
@@ -2616,6 +2752,28 @@ public:
   }
 
 protected:
+  RealType integrateOnSlab ( const auto_container<NumComponents, aol::DiscreteFunctionDefault<ConfiguratorType> > &DiscrFuncsArg,
+                             typename ConfiguratorType::ElementIteratorType it,
+                             const typename ConfiguratorType::ElementIteratorType::EndType &end_it ) const {
+    RealType res = 0.;
+
+    for ( ; it != end_it; ++it ) {
+      // Necessary because the number of quadpoints may vary
+      // getBaseFunctionSet() implicitly calls initializeFromElement
+      const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
+      const int numQuadPoints = bfs.numQuadPoints( );
+
+      RealType a = 0.;
+      for ( int q = 0; q < numQuadPoints; ++q )
+        a += this->asImp().evaluateIntegrand ( DiscrFuncsArg, *it, q, bfs.getRefCoord ( q ) )
+             * bfs.getWeight ( q );
+
+      a *= this->getConfigurator().vol ( *it );
+      res += a;
+    }
+    return res;
+  }
+
   // barton-nackman
   inline Imp& asImp() {
     return static_cast<Imp&> ( *this );
@@ -2808,27 +2966,19 @@ public:
   virtual ~FENonlinIntegrationScalarInterface( ) {}
 
   void applyAdd ( const aol::Vector<RealType> &Arg, aol::Scalar<RealType> &Dest ) const {
-
-    typedef typename ConfiguratorType::ElementIteratorType IteratorType;
-
     const aol::DiscreteFunctionDefault<ConfiguratorType> discFunc ( this->getConfigurator(), Arg );
+    const FEElementSlabs<ConfiguratorType> slabs ( this->getConfigurator() );
+    const int numSlabs = slabs.getNumSlabs();
 
-    RealType res = 0.;
-
-    const typename IteratorType::EndType end = this->getConfigurator().end();
-    for ( IteratorType it = this->getConfigurator().begin(); it != end; ++it ) {
-      const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
-      const int numQuadPoints = bfs.numQuadPoints( );
-
-      RealType a = 0.;
-      for ( int q = 0; q < numQuadPoints; ++q ) {
-        a += this->asImp().evaluateIntegrand ( discFunc, *it, q, bfs.getRefCoord ( q ) ) * bfs.getWeight ( q );
-      }
+    // The integrals over the slabs are summed up in a fixed order, so the result doesn't depend on the number of threads.
+    aol::Vector<RealType> slabIntegrals ( numSlabs );
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for ( int slab = 0; slab < numSlabs; ++slab )
+      slabIntegrals[slab] = integrateOnSlab ( discFunc, slabs.begin ( slab ), slabs.end ( slab ) );
 
-      a *= this->getConfigurator().vol ( *it );
-      res += a;
-    }
-    Dest += res;
+    Dest += slabIntegrals.sum();
   }
 
   void applyAddIntegrand ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
@@ -2872,7 +3022,7 @@ public:
     Dest += dest;
   }
 
-  //! interface function, has to be provided in derived classes.
+  //! interface function, has to be provided in derived classes. Is called by several threads at the same time, so it has to be thread safe (see FEElementSlabs).
   RealType evaluateIntegrand ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFuncs,
                                const typename ConfiguratorType::ElementType &El,
                                int QuadPoint, const typename ConfiguratorType::DomVecType &RefCoord ) const {
@@ -2881,6 +3031,26 @@ public:
   }
 
 protected:
+  RealType integrateOnSlab ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFunc,
+                             typename ConfiguratorType::ElementIteratorType it,
+                             const typename ConfiguratorType::ElementIteratorType::EndType &end_it ) const {
+    RealType res = 0.;
+
+    for ( ; it != end_it; ++it ) {
+      const typename ConfiguratorType::BaseFuncSetType &bfs = this->getConfigurator().getBaseFunctionSet ( *it );
+      const int numQuadPoints = bfs.numQuadPoints( );
+
+      RealType a = 0.;
+      for ( int q = 0; q < numQuadPoints; ++q ) {
+        a += this->asImp().evaluateIntegrand ( DiscFunc, *it, q, bfs.getRefCoord ( q ) ) * bfs.getWeight ( q );
+      }
+
+      a *= this->getConfigurator().vol ( *it );
+      res += a;
+    }
+    return res;
+  }
+
   // barton-nackman
   inline Imp& asImp() { return static_cast<Imp&> ( *this ); }
   inline const Imp& asImp() const { return static_cast<const Imp&> ( *this ); }
@@ -645,7 +645,13 @@ void writebinary ( ostream& os, const DataType& data ) {
   os.write ( reinterpret_cast<const char*> ( &data ), sizeof ( data ) );
 }
 
+//! Number of values converted at once by readBinaryData and writeBinaryData.
+const int BinaryDataConversionChunkSize = 1 << 16;
+
 /**
+ * Reads Length values of type InDataType from In and stores them in Dest. If the types differ,
+ * the data is read and converted chunk by chunk, i.e. there is no temporary copy of all values.
+ *
  * \author Berkels
  */
 template <typename InDataType, typename OutDataType>
@@ -653,9 +659,13 @@ void readBinaryData ( istream &In, OutDataType* Dest, const int Length ) {
   if ( typeid ( InDataType ) == typeid ( OutDataType ) ) {
     In.read ( reinterpret_cast< char* > ( Dest ), Length * sizeof ( InDataType ) );
   } else {
-    InDataType *dummy = new InDataType[ Length];
-    In.read ( reinterpret_cast< char* > ( dummy ),  Length * sizeof ( InDataType ) );
-    for ( int i = 0; i < Length; ++i ) Dest[i] = static_cast< OutDataType > ( dummy[i] );
+    const int chunkSize = aol::Min ( Length, BinaryDataConversionChunkSize );
+    InDataType *dummy = new InDataType[ chunkSize ];
+    for ( int offset = 0; offset < Length; offset += chunkSize ) {
+      const int numValues = aol::Min ( chunkSize, Length - offset );
+      In.read ( reinterpret_cast< char* > ( dummy ),  numValues * sizeof ( InDataType ) );
+      for ( int i = 0; i < numValues; ++i ) Dest[offset + i] = static_cast< OutDataType > ( dummy[i] );
+    }
     delete[] dummy;
   }
 }
@@ -671,6 +681,9 @@ OutDataType readBinaryData ( istream &In ) {
 }
 
 /**
+ * Writes Length values from InputData to Out as OutDataType. If the types differ, the data is
+ * converted and written chunk by chunk, i.e. there is no temporary copy of all values.
+ *
  * \author Berkels
  */
 template <typename InDataType, typename OutDataType>
@@ -678,9 +691,13 @@ void writeBinaryData ( const InDataType* InputData, const int Length, ostream &O
   if ( typeid ( OutDataType ) == typeid ( InDataType ) ) {
     Out.write ( reinterpret_cast<const char *> ( InputData ), Length * sizeof ( OutDataType ) );
   } else {
-    OutDataType * buffer = new OutDataType[Length];
-    for ( int i = 0; i < Length; ++i ) buffer[i] =  static_cast<OutDataType> ( InputData[i] );
-    Out.write ( reinterpret_cast<const char *> ( buffer ), Length * sizeof ( OutDataType ) );
+    const int chunkSize = aol::Min ( Length, BinaryDataConversionChunkSize );
+    OutDataType * buffer = new OutDataType[chunkSize];
+    for ( int offset = 0; offset < Length; offset += chunkSize ) {
+      const int numValues = aol::Min ( chunkSize, Length - offset );
+      for ( int i = 0; i < numValues; ++i ) buffer[i] =  static_cast<OutDataType> ( InputData[offset + i] );
+      Out.write ( reinterpret_cast<const char *> ( buffer ), numValues * sizeof ( OutDataType ) );
+    }
     delete[] buffer;
   }
 }
@@ -698,6 +715,12 @@ DataType swapByteOrder ( const DataType Input ) {
   return dest;
 }
 
+//! Returns whether the machine this is running on stores multi-byte values little endian.
+inline bool isLittleEndianMachine ( ) {
+  const int one = 1;
+  return ( *reinterpret_cast<const unsigned char*> ( &one ) == 1 );
+}
+
 //! STL vector output
 template <class DataType>
 ostream& operator << ( ostream& os, const std::vector<DataType> vec ) {
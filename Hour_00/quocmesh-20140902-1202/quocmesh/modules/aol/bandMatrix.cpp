@@ -21,7 +21,7 @@ template < typename _DataType >
 GenBandMatrix<_DataType>::GenBandMatrix ( const int Rows, const int Cols )
   : aol::Matrix<_DataType> ( Rows, Cols ),
     _startApply ( 0 ), _endApply ( 0 ),  _globalToLocal ( 0 ), _localToGlobal ( 0 ),
-    _pData ( NULL ), _nDiags ( 0 ) {
+    _pData ( NULL ), _nDiags ( 0 ), _sizeReserved ( 0 ) {
 
   aol::Vector<int> dummy;
   this->reallocate ( this->getNumRows(), this->getNumCols(), dummy );
@@ -32,7 +32,7 @@ template < typename _DataType >
 GenBandMatrix<_DataType>::GenBandMatrix ( const qc::GridStructure & Grid )
   : aol::Matrix<_DataType> ( Grid.getNumberOfNodes(), Grid.getNumberOfNodes() ),
     _startApply ( 0 ), _endApply ( 0 ),  _globalToLocal ( 0 ), _localToGlobal ( 0 ),
-    _pData ( NULL ), _nDiags ( 0 ) {
+    _pData ( NULL ), _nDiags ( 0 ), _sizeReserved ( 0 ) {
 
   aol::Vector<int> dummy;
   this->reallocate ( this->getNumRows(), this->getNumCols(), dummy );
@@ -43,7 +43,7 @@ template < typename _DataType >
 GenBandMatrix<_DataType>::GenBandMatrix ( )
   : Matrix<_DataType> ( ),
     _startApply ( 0 ), _endApply ( 0 ),  _globalToLocal ( 0 ), _localToGlobal ( 0 ),
-    _pData ( NULL ), _nDiags ( 0 ) {
+    _pData ( NULL ), _nDiags ( 0 ), _sizeReserved ( 0 ) {
 
   aol::Vector<int> dummy;
   this->reallocate ( this->getNumRows(), this->getNumCols(), dummy );
@@ -54,10 +54,14 @@ template < typename _DataType >
 GenBandMatrix<_DataType>::GenBandMatrix ( const GenBandMatrix<_DataType> &Other )
   : Matrix<_DataType> ( Other ),
     _startApply ( Other._startApply ), _endApply ( Other._endApply ),  _globalToLocal ( Other._globalToLocal ), _localToGlobal ( Other._localToGlobal ),
-    _pData ( NULL ), _nDiags ( Other._nDiags ) {
+    _pData ( NULL ), _nDiags ( Other._nDiags ), _sizeReserved ( 0 ) {
 
-  _pData = new DataType[ this->getNumRows() * _nDiags ];
-  memcpy ( _pData, Other._pData, this->getNumRows() * _nDiags * sizeof ( DataType ) );
+  // Allocate like reallocate does, the destructor returns _pData to the MemoryManager.
+  if ( _nDiags != 0 ) {
+    _sizeReserved = this->getNumRows() * _nDiags; // possible change in allocateAtLeast
+    _pData = static_cast<DataType*> ( aol::MemoryManager::allocateAtLeast ( _sizeReserved, sizeof ( DataType ) ) );
+    memcpy ( _pData, Other._pData, this->getNumRows() * _nDiags * sizeof ( DataType ) );
+  }
 }
 
 
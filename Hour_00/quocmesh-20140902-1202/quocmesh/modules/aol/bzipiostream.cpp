@@ -0,0 +1,565 @@
+#include <bzipiostream.h>
+
+namespace aol {
+
+namespace {
+
+#ifdef USE_LIB_BZ2
+// Upper bound for the compressed size of a bzip2 stream created from a single block of input.
+const size_t MaxCompressedStreamSize = 1 << 21;
+
+//! Returns whether Data starts with a bzip2 stream header followed by a block or an end of stream header.
+bool isBzip2StreamStart ( const char *Data ) {
+  static const unsigned char blockMagic[6] = { 0x31, 0x41, 0x59, 0x26, 0x53, 0x59 };
+  static const unsigned char endOfStreamMagic[6] = { 0x17, 0x72, 0x45, 0x38, 0x50, 0x90 };
+  return ( Data[0] == 'B' ) && ( Data[1] == 'Z' ) && ( Data[2] == 'h' ) && ( Data[3] >= '1' ) && ( Data[3] <= '9' )
+         && ( ( memcmp ( Data + 4, blockMagic, 6 ) == 0 ) || ( memcmp ( Data + 4, endOfStreamMagic, 6 ) == 0 ) );
+}
+
+//! Returns the position of the first bzip2 stream header in [Begin,End), End if there is none.
+size_t findBzip2StreamStart ( const std::vector<char> &Data, const size_t Begin, const size_t End ) {
+  for ( size_t i = Begin; i + 10 <= End; ++i ) {
+    if ( isBzip2StreamStart ( &Data[i] ) )
+      return i;
+  }
+  return End;
+}
+
+//! Decompresses the single bzip2 stream stored in Source to Dest. Trailing data after the end of the stream is ignored.
+bool decompressBzip2Stream ( const char *Source, const size_t Size, std::vector<char> &Dest ) {
+  bz_stream bzStream;
+  memset ( &bzStream, 0, sizeof ( bzStream ) );
+  if ( BZ2_bzDecompressInit ( &bzStream, 0, 0 ) != BZ_OK )
+    return false;
+
+  Dest.resize ( 4 * Size + 1024 );
+  bzStream.next_in = const_cast<char*> ( Source );
+  bzStream.avail_in = static_cast<unsigned int> ( Size );
+  size_t numDecompressed = 0;
+  int ret = BZ_OK;
+  while ( ret == BZ_OK ) {
+    if ( numDecompressed == Dest.size() )
+      Dest.resize ( 2 * Dest.size() );
+    bzStream.next_out = &Dest[numDecompressed];
+    bzStream.avail_out = static_cast<unsigned int> ( Dest.size() - numDecompressed );
+    ret = BZ2_bzDecompress ( &bzStream );
+    numDecompressed = Dest.size() - bzStream.avail_out;
+    if ( ( ret == BZ_OK ) && ( bzStream.avail_in == 0 ) && ( numDecompressed < Dest.size() ) )
+      ret = BZ_UNEXPECTED_EOF;
+  }
+  BZ2_bzDecompressEnd ( &bzStream );
+  Dest.resize ( numDecompressed );
+  return ( ret == BZ_STREAM_END );
+}
+#endif // USE_LIB_BZ2
+
+}
+
+Bzipifstreambuf::Bzipifstreambuf ( FILE *File, const bool Decompress, const int BufferSize, const int NumThreads )
+  : _file ( File ),
+    _decompress ( Decompress ),
+    _numThreads ( getNumThreadsToUse ( NumThreads ) ),
+    _buffer ( PutBackSize + BufferSize ),
+    _compressedBuffer ( Decompress ? BufferSize : 0 ),
+    _endOfData ( false ),
+#ifdef USE_LIB_BZ2
+    _bzStreamInitialized ( false ),
+#endif
+    _decompressSequentially ( _numThreads <= 1 ),
+    _windowBegin ( 0 ),
+    _windowEnd ( 0 ),
+    _currentStream ( 0 ),
+    _currentStreamPos ( 0 ) {
+  if ( BufferSize <= 0 )
+    throw Exception ( "Bzipifstreambuf: BufferSize has to be positive.\n", __FILE__, __LINE__ );
+
+  char *bufferEnd = &_buffer[0] + PutBackSize;
+  setg ( bufferEnd, bufferEnd, bufferEnd );
+
+  if ( _decompress ) {
+#ifdef USE_LIB_BZ2
+    memset ( &_bzStream, 0, sizeof ( _bzStream ) );
+    if ( BZ2_bzDecompressInit ( &_bzStream, 0, 0 ) != BZ_OK )
+      throw Exception ( "Bzipifstreambuf: BZ2_bzDecompressInit failed.\n", __FILE__, __LINE__ );
+    _bzStreamInitialized = true;
+#else
+    throw Exception ( "Reading bz2 compressed files with Bzipifstream without using bzlib is impossible.\nDefine USE_LIB_BZ2 and link bzlib, e.g by using CFLAG += -DUSE_LIB_BZ2 and LFLAGS += -lbz2, to remedy this.\n", __FILE__, __LINE__ );
+#endif
+  }
+}
+
+Bzipifstreambuf::~Bzipifstreambuf () {
+#ifdef USE_LIB_BZ2
+  if ( _bzStreamInitialized )
+    BZ2_bzDecompressEnd ( &_bzStream );
+#endif
+  if ( _file )
+    fclose ( _file );
+}
+
+Bzipifstreambuf::int_type Bzipifstreambuf::underflow () {
+  if ( gptr() < egptr() )
+    return traits_type::to_int_type ( *gptr() );
+
+  // Keep the last few characters to allow putting them back.
+  const std::streamsize numPutBack = std::min<std::streamsize> ( gptr() - eback(), PutBackSize );
+  char *bufferStart = &_buffer[0] + PutBackSize;
+  memmove ( bufferStart - numPutBack, gptr() - numPutBack, static_cast<size_t> ( numPutBack ) );
+
+  const std::streamsize numRead = readData ( bufferStart, static_cast<std::streamsize> ( _buffer.size() ) - PutBackSize );
+  if ( numRead <= 0 ) {
+    setg ( bufferStart - numPutBack, bufferStart, bufferStart );
+    return traits_type::eof();
+  }
+
+  setg ( bufferStart - numPutBack, bufferStart, bufferStart + numRead );
+  return traits_type::to_int_type ( *gptr() );
+}
+
+std::streamsize Bzipifstreambuf::xsgetn ( char *Dest, std::streamsize Size ) {
+  // First hand out what is still in the buffer.
+  std::streamsize numCopied = std::min<std::streamsize> ( egptr() - gptr(), Size );
+  memcpy ( Dest, gptr(), static_cast<size_t> ( numCopied ) );
+  gbump ( static_cast<int> ( numCopied ) );
+
+  // Large requests are read directly to Dest, the buffer would only cause an additional copy.
+  const std::streamsize bufferSize = static_cast<std::streamsize> ( _buffer.size() ) - PutBackSize;
+  if ( Size - numCopied >= bufferSize ) {
+    while ( numCopied < Size ) {
+      const std::streamsize numRead = readData ( Dest + numCopied, Size - numCopied );
+      if ( numRead <= 0 )
+        break;
+      numCopied += numRead;
+    }
+    preparePutBackArea ( Dest, numCopied );
+    return numCopied;
+  }
+
+  while ( numCopied < Size ) {
+    if ( traits_type::eq_int_type ( underflow(), traits_type::eof() ) )
+      break;
+    const std::streamsize num = std::min<std::streamsize> ( egptr() - gptr(), Size - numCopied );
+    memcpy ( Dest + numCopied, gptr(), static_cast<size_t> ( num ) );
+    gbump ( static_cast<int> ( num ) );
+    numCopied += num;
+  }
+  return numCopied;
+}
+
+void Bzipifstreambuf::preparePutBackArea ( const char *LastRead, const std::streamsize NumLastRead ) {
+  const std::streamsize numPutBack = std::min<std::streamsize> ( NumLastRead, PutBackSize );
+  char *bufferStart = &_buffer[0] + PutBackSize;
+  memcpy ( bufferStart - numPutBack, LastRead + NumLastRead - numPutBack, static_cast<size_t> ( numPutBack ) );
+  setg ( bufferStart - numPutBack, bufferStart, bufferStart );
+}
+
+std::streamsize Bzipifstreambuf::readData ( char *Dest, const std::streamsize Size ) {
+  if ( _decompress && ( _decompressSequentially == false ) )
+    return readDecompressedInParallel ( Dest, Size );
+
+  if ( _endOfData || ( _file == NULL ) )
+    return 0;
+
+  if ( !_decompress ) {
+    const size_t numRead = fread ( Dest, 1, static_cast<size_t> ( Size ), _file );
+    if ( numRead == 0 ) {
+      _endOfData = true;
+      return ferror ( _file ) ? -1 : 0;
+    }
+    return static_cast<std::streamsize> ( numRead );
+  }
+
+  return readDecompressedSequentially ( Dest, Size );
+}
+
+std::streamsize Bzipifstreambuf::readDecompressedSequentially ( char *Dest, const std::streamsize Size ) {
+#ifdef USE_LIB_BZ2
+  // bz_stream only handles unsigned int sized chunks.
+  const unsigned int size = static_cast<unsigned int> ( std::min<std::streamsize> ( Size, std::numeric_limits<int>::max() ) );
+  _bzStream.next_out = Dest;
+  _bzStream.avail_out = size;
+
+  while ( _bzStream.avail_out == size ) {
+    if ( _bzStream.avail_in == 0 ) {
+      const size_t numRead = fread ( &_compressedBuffer[0], 1, _compressedBuffer.size(), _file );
+      if ( numRead == 0 ) {
+        // A truncated file is treated like the old BZ2_bzRead based implementation did, i.e. the data read so far is kept.
+        _endOfData = true;
+        break;
+      }
+      _bzStream.next_in = &_compressedBuffer[0];
+      _bzStream.avail_in = static_cast<unsigned int> ( numRead );
+    }
+
+    const int ret = BZ2_bzDecompress ( &_bzStream );
+    if ( ret == BZ_STREAM_END ) {
+      // The file may consist of several concatenated bzip2 streams (e.g. created by pbzip2), continue with the next one.
+      char *nextIn = _bzStream.next_in;
+      const unsigned int availIn = _bzStream.avail_in;
+      char *nextOut = _bzStream.next_out;
+      const unsigned int availOut = _bzStream.avail_out;
+      BZ2_bzDecompressEnd ( &_bzStream );
+      _bzStreamInitialized = false;
+
+      if ( ( availIn == 0 ) && feof ( _file ) ) {
+        _endOfData = true;
+        break;
+      }
+      memset ( &_bzStream, 0, sizeof ( _bzStream ) );
+      if ( BZ2_bzDecompressInit ( &_bzStream, 0, 0 ) != BZ_OK )
+        return -1;
+      _bzStreamInitialized = true;
+      _bzStream.next_in = nextIn;
+      _bzStream.avail_in = availIn;
+      _bzStream.next_out = nextOut;
+      _bzStream.avail_out = availOut;
+    }
+    else if ( ret == BZ_DATA_ERROR_MAGIC ) {
+      // Trailing garbage after a complete bzip2 stream is ignored, like bzip2 does.
+      _endOfData = true;
+      break;
+    }
+    else if ( ret != BZ_OK )
+      return -1;
+  }
+  return static_cast<std::streamsize> ( size - _bzStream.avail_out );
+#else
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Dest );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Size );
+  return -1;
+#endif
+}
+
+std::streamsize Bzipifstreambuf::readDecompressedInParallel ( char *Dest, const std::streamsize Size ) {
+  while ( _currentStream >= _decompressedStreams.size() ) {
+    if ( _decompressSequentially )
+      return readDecompressedSequentially ( Dest, Size );
+    if ( _endOfData )
+      return 0;
+    if ( !decompressNextStreams() )
+      return -1;
+  }
+
+  const std::vector<char> &stream = _decompressedStreams[_currentStream];
+  const std::streamsize num = std::min<std::streamsize> ( Size, stream.size() - _currentStreamPos );
+  if ( num > 0 )
+    memcpy ( Dest, &stream[_currentStreamPos], static_cast<size_t> ( num ) );
+  _currentStreamPos += static_cast<size_t> ( num );
+  if ( _currentStreamPos == stream.size() ) {
+    ++_currentStream;
+    _currentStreamPos = 0;
+  }
+  return num;
+}
+
+bool Bzipifstreambuf::decompressNextStreams () {
+#ifdef USE_LIB_BZ2
+  // Move the unprocessed data to the front of the window and fill the rest of it.
+  if ( _window.size() == 0 )
+    _window.resize ( ( _numThreads + 1 ) * MaxCompressedStreamSize );
+  memmove ( &_window[0], &_window[0] + _windowBegin, _windowEnd - _windowBegin );
+  _windowEnd -= _windowBegin;
+  _windowBegin = 0;
+  _windowEnd += fread ( &_window[0] + _windowEnd, 1, _window.size() - _windowEnd, _file );
+  const bool endOfFile = ( _windowEnd < _window.size() );
+  if ( ferror ( _file ) )
+    return false;
+
+  // Collect up to _numThreads complete streams in the window, the remaining ones are left for the next call. Otherwise
+  // the decompressed batch could get arbitrarily large for highly compressible data. The last stream in the window is
+  // only known to be complete at the end of the file.
+  std::vector<size_t> streamStarts;
+  if ( ( _windowEnd >= 10 ) && isBzip2StreamStart ( &_window[0] ) ) {
+    size_t pos = 0;
+    while ( ( pos < _windowEnd ) && ( streamStarts.size() < static_cast<size_t> ( _numThreads ) ) ) {
+      streamStarts.push_back ( pos );
+      pos = findBzip2StreamStart ( _window, pos + 1, _windowEnd );
+    }
+    if ( pos < _windowEnd )
+      streamStarts.push_back ( pos );
+    else if ( endOfFile )
+      streamStarts.push_back ( _windowEnd );
+  }
+  const int numStreams = static_cast<int> ( streamStarts.size() ) - 1;
+
+  // Parallel decompression only pays off if there are several streams (e.g. not for files written by bzip2).
+  // Everything else, including empty files, is handled by the sequential code.
+  if ( numStreams < 2 ) {
+    _decompressSequentially = true;
+    _bzStream.next_in = &_window[0];
+    _bzStream.avail_in = static_cast<unsigned int> ( _windowEnd );
+    return true;
+  }
+
+  _decompressedStreams.resize ( numStreams );
+  _currentStream = 0;
+  _currentStreamPos = 0;
+  int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( _numThreads ) reduction ( + : numFailed )
+#endif
+  for ( int i = 0; i < numStreams; ++i ) {
+    if ( !decompressBzip2Stream ( &_window[streamStarts[i]], streamStarts[i + 1] - streamStarts[i], _decompressedStreams[i] ) )
+      ++numFailed;
+  }
+  _windowBegin = streamStarts[numStreams];
+  _endOfData = endOfFile && ( _windowBegin == _windowEnd );
+  return ( numFailed == 0 );
+#else
+  return false;
+#endif
+}
+
+Bzipofstreambuf::Bzipofstreambuf ( FILE *File, const bool Compress, const int CompressionLevel, const int BufferSize, const int NumThreads )
+  : _file ( File ),
+    _compress ( Compress ),
+    _compressionLevel ( CompressionLevel ),
+    _numThreads ( getNumThreadsToUse ( NumThreads ) ),
+    _failed ( false ),
+#ifdef USE_LIB_BZ2
+    _bzStreamInitialized ( false ),
+#endif
+    _wroteBlock ( false ) {
+  if ( BufferSize <= 0 )
+    throw Exception ( "Bzipofstreambuf: BufferSize has to be positive.\n", __FILE__, __LINE__ );
+  if ( ( CompressionLevel < 1 ) || ( CompressionLevel > 9 ) )
+    throw Exception ( strprintf ( "Bzipofstreambuf: Invalid compression level %d, has to be in [1,9].\n", CompressionLevel ).c_str(), __FILE__, __LINE__ );
+
+  // For parallel compression the buffer holds one block per thread, the blocks are compressed whenever it is full.
+  if ( compressInParallel() ) {
+    _buffer.resize ( static_cast<size_t> ( _numThreads ) * CompressionLevel * 100000 );
+    _compressedBlocks.resize ( _numThreads );
+  }
+  else {
+    _buffer.resize ( BufferSize );
+    if ( _compress )
+      _compressedBuffer.resize ( BufferSize );
+  }
+  setp ( &_buffer[0], &_buffer[0] + _buffer.size() );
+
+  if ( _compress ) {
+#ifdef USE_LIB_BZ2
+    if ( compressInParallel() == false ) {
+      memset ( &_bzStream, 0, sizeof ( _bzStream ) );
+      if ( BZ2_bzCompressInit ( &_bzStream, CompressionLevel, 0, 0 ) != BZ_OK )
+        throw Exception ( "Bzipofstreambuf: BZ2_bzCompressInit failed.\n", __FILE__, __LINE__ );
+      _bzStreamInitialized = true;
+    }
+#else
+    throw Exception ( "Writing bz2 compressed files with Bzipofstream without using bzlib is impossible.\nDefine USE_LIB_BZ2 and link bzlib, e.g by using CFLAG += -DUSE_LIB_BZ2 and LFLAGS += -lbz2, to remedy this.\n", __FILE__, __LINE__ );
+#endif
+  }
+}
+
+Bzipofstreambuf::~Bzipofstreambuf () {
+  close();
+}
+
+bool Bzipofstreambuf::close () {
+  // We can't do anything when there is no file (probably close was already called).
+  if ( _file == NULL )
+    return !_failed;
+
+  flushBuffer();
+
+  // Like bzip2, write an empty stream if there was no data at all.
+  if ( compressInParallel() && ( _wroteBlock == false ) )
+    writeBlocks ( &_buffer[0], 0 );
+
+#ifdef USE_LIB_BZ2
+  if ( _bzStreamInitialized ) {
+    _bzStream.next_in = NULL;
+    _bzStream.avail_in = 0;
+    int ret = BZ_FINISH_OK;
+    while ( !_failed && ( ret == BZ_FINISH_OK ) ) {
+      _bzStream.next_out = &_compressedBuffer[0];
+      _bzStream.avail_out = static_cast<unsigned int> ( _compressedBuffer.size() );
+      ret = BZ2_bzCompress ( &_bzStream, BZ_FINISH );
+      if ( ( ret != BZ_FINISH_OK ) && ( ret != BZ_STREAM_END ) )
+        _failed = true;
+      const size_t numCompressed = _compressedBuffer.size() - _bzStream.avail_out;
+      if ( fwrite ( &_compressedBuffer[0], 1, numCompressed, _file ) != numCompressed )
+        _failed = true;
+    }
+    BZ2_bzCompressEnd ( &_bzStream );
+    _bzStreamInitialized = false;
+  }
+#endif
+
+  if ( fclose ( _file ) != 0 )
+    _failed = true;
+  _file = NULL;
+  return !_failed;
+}
+
+Bzipofstreambuf::int_type Bzipofstreambuf::overflow ( int_type C ) {
+  if ( !flushBuffer() )
+    return traits_type::eof();
+  if ( !traits_type::eq_int_type ( C, traits_type::eof() ) ) {
+    *pptr() = traits_type::to_char_type ( C );
+    pbump ( 1 );
+  }
+  return traits_type::not_eof ( C );
+}
+
+std::streamsize Bzipofstreambuf::xsputn ( const char *Source, std::streamsize Size ) {
+  // Large writes bypass the buffer to avoid an additional copy. When compressing in parallel,
+  // the data always has to go through the buffer to get blocks of the same size.
+  if ( ( compressInParallel() == false ) && ( Size >= static_cast<std::streamsize> ( _buffer.size() ) ) ) {
+    if ( !flushBuffer() || !writeData ( Source, Size ) )
+      return 0;
+    return Size;
+  }
+  return std::streambuf::xsputn ( Source, Size );
+}
+
+int Bzipofstreambuf::sync () {
+  // Flushing a partially filled buffer when compressing in parallel would create small blocks
+  // (e.g. on every endl), so the data is kept until the buffer is full or the stream is closed.
+  if ( compressInParallel() )
+    return _failed ? -1 : 0;
+  return flushBuffer() ? 0 : -1;
+}
+
+bool Bzipofstreambuf::flushBuffer () {
+  const std::streamsize num = pptr() - pbase();
+  setp ( &_buffer[0], &_buffer[0] + _buffer.size() );
+  if ( num > 0 )
+    return compressInParallel() ? writeBlocks ( &_buffer[0], num ) : writeData ( &_buffer[0], num );
+  return !_failed;
+}
+
+bool Bzipofstreambuf::writeBlocks ( const char *Source, const std::streamsize Size ) {
+  if ( _failed || ( _file == NULL ) )
+    return false;
+
+#ifdef USE_LIB_BZ2
+  const std::streamsize blockSize = static_cast<std::streamsize> ( _compressionLevel ) * 100000;
+  const int numBlocks = std::max ( 1, static_cast<int> ( ( Size + blockSize - 1 ) / blockSize ) );
+  int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( _numThreads ) reduction ( + : numFailed )
+#endif
+  for ( int i = 0; i < numBlocks; ++i ) {
+    const std::streamsize offset = i * blockSize;
+    const unsigned int size = static_cast<unsigned int> ( std::min ( blockSize, Size - offset ) );
+    // Worst case size of the compressed data according to the bzip2 documentation.
+    unsigned int compressedSize = size + size / 100 + 600;
+    _compressedBlocks[i].resize ( compressedSize );
+    if ( BZ2_bzBuffToBuffCompress ( &_compressedBlocks[i][0], &compressedSize, const_cast<char*> ( Source + offset ), size, _compressionLevel, 0, 0 ) == BZ_OK )
+      _compressedBlocks[i].resize ( compressedSize );
+    else
+      ++numFailed;
+  }
+
+  for ( int i = 0; ( i < numBlocks ) && ( numFailed == 0 ); ++i ) {
+    if ( fwrite ( &_compressedBlocks[i][0], 1, _compressedBlocks[i].size(), _file ) != _compressedBlocks[i].size() )
+      ++numFailed;
+  }
+  _wroteBlock = true;
+  _failed = ( numFailed > 0 );
+  return !_failed;
+#else
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Source );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Size );
+  _failed = true;
+  return false;
+#endif
+}
+
+bool Bzipofstreambuf::writeData ( const char *Source, const std::streamsize Size ) {
+  if ( _failed || ( _file == NULL ) )
+    return false;
+
+  if ( !_compress ) {
+    if ( fwrite ( Source, 1, static_cast<size_t> ( Size ), _file ) != static_cast<size_t> ( Size ) )
+      _failed = true;
+    return !_failed;
+  }
+
+#ifdef USE_LIB_BZ2
+  std::streamsize numProcessed = 0;
+  while ( numProcessed < Size ) {
+    // bz_stream only handles unsigned int sized chunks.
+    const unsigned int chunkSize = static_cast<unsigned int> ( std::min<std::streamsize> ( Size - numProcessed, std::numeric_limits<int>::max() ) );
+    _bzStream.next_in = const_cast<char*> ( Source + numProcessed );
+    _bzStream.avail_in = chunkSize;
+    while ( _bzStream.avail_in > 0 ) {
+      _bzStream.next_out = &_compressedBuffer[0];
+      _bzStream.avail_out = static_cast<unsigned int> ( _compressedBuffer.size() );
+      if ( BZ2_bzCompress ( &_bzStream, BZ_RUN ) != BZ_RUN_OK ) {
+        _failed = true;
+        return false;
+      }
+      const size_t numCompressed = _compressedBuffer.size() - _bzStream.avail_out;
+      if ( fwrite ( &_compressedBuffer[0], 1, numCompressed, _file ) != numCompressed ) {
+        _failed = true;
+        return false;
+      }
+    }
+    numProcessed += chunkSize;
+  }
+  return true;
+#else
+  _failed = true;
+  return false;
+#endif
+}
+
+Bzipifstream::Bzipifstream ( const char *FileName, const int NumThreads, const int BufferSize )
+  : std::istream ( NULL ),
+    _streambuf ( NULL ) {
+  FILE *file = fopen ( FileName, "rb" );
+  if ( !file ) {
+    string errorMessage = "Could not open \"";
+    errorMessage += FileName;
+    errorMessage += "\" for reading.\n";
+    throw Exception ( errorMessage.c_str(), __FILE__, __LINE__ );
+  }
+
+  try {
+    _streambuf = new Bzipifstreambuf ( file, hasBzipSuffx ( FileName ), BufferSize, NumThreads );
+  } catch ( ... ) {
+    fclose ( file );
+    throw;
+  }
+  rdbuf ( _streambuf );
+}
+
+Bzipifstream::~Bzipifstream () {
+  rdbuf ( NULL );
+  delete _streambuf;
+}
+
+Bzipofstream::Bzipofstream ( const char *FileName, const int CompressionLevel, const int NumThreads, const int BufferSize )
+  : std::ostream ( NULL ),
+    _streambuf ( NULL ) {
+  FILE *file = fopen ( FileName, "wb" );
+  if ( !file ) {
+    string errorMessage = "Could not open \"";
+    errorMessage += FileName;
+    errorMessage += "\" for output.\n";
+    throw Exception ( errorMessage.c_str(), __FILE__, __LINE__ );
+  }
+
+  try {
+    _streambuf = new Bzipofstreambuf ( file, hasBzipSuffx ( FileName ), CompressionLevel, BufferSize, NumThreads );
+  } catch ( ... ) {
+    fclose ( file );
+    throw;
+  }
+  rdbuf ( _streambuf );
+}
+
+Bzipofstream::~Bzipofstream () {
+  close();
+  rdbuf ( NULL );
+  delete _streambuf;
+}
+
+void Bzipofstream::close () {
+  if ( ( _streambuf != NULL ) && !_streambuf->close() )
+    setstate ( std::ios_base::badbit );
+}
+
+}// end namespace aol
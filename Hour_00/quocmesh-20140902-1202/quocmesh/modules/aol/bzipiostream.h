@@ -35,115 +35,169 @@ namespace aol {
 #pragma warning ( disable : 4250 )
 #endif
 
+/**
+ * \brief Stream buffer that reads a file in fixed-size chunks and, if requested, decompresses
+ *        it with libbz2 on the fly. Concatenated bzip2 streams are read one after another.
+ *
+ * If NumThreads is larger than one, files consisting of several concatenated bzip2 streams
+ * (as written by Bzipofstreambuf with more than one thread or by pbzip2) are decompressed in
+ * parallel, NumThreads streams at a time. Files consisting of a single stream are decompressed
+ * sequentially.
+ *
+ * The memory needed is independent of the file size, but grows linearly with NumThreads. A few
+ * characters can always be put back. Takes ownership of File and closes it when destroyed.
+ */
+class Bzipifstreambuf : public std::streambuf {
+  static const int PutBackSize = 4;
+
+  FILE *_file;
+  const bool _decompress;
+  const int _numThreads;
+  std::vector<char> _buffer;
+  std::vector<char> _compressedBuffer;
+  bool _endOfData;
+#ifdef USE_LIB_BZ2
+  bz_stream _bzStream;
+  bool _bzStreamInitialized;
+#endif
+  // Only used for parallel decompression.
+  bool _decompressSequentially;
+  std::vector<char> _window;
+  size_t _windowBegin, _windowEnd;
+  std::vector<std::vector<char> > _decompressedStreams;
+  size_t _currentStream, _currentStreamPos;
+public:
+  //! NumThreads <= 0 uses as many threads as OpenMP provides (one thread inside a parallel region).
+  Bzipifstreambuf ( FILE *File, const bool Decompress, const int BufferSize, const int NumThreads = 1 );
+  ~Bzipifstreambuf ();
+
+protected:
+  virtual int_type underflow ();
+  virtual std::streamsize xsgetn ( char *Dest, std::streamsize Size );
+
+private:
+  //! Reads (and possibly decompresses) up to Size bytes to Dest, returns the number of bytes read, -1 on errors.
+  std::streamsize readData ( char *Dest, const std::streamsize Size );
+  std::streamsize readDecompressedSequentially ( char *Dest, const std::streamsize Size );
+  std::streamsize readDecompressedInParallel ( char *Dest, const std::streamsize Size );
+  //! Decompresses the next batch of complete bzip2 streams in parallel, returns false on errors.
+  bool decompressNextStreams ();
+  //! Moves the last read characters into the put back area and makes the get area empty.
+  void preparePutBackArea ( const char *LastRead, const std::streamsize NumLastRead );
+
+  Bzipifstreambuf ( const Bzipifstreambuf& ); // do not implement
+  Bzipifstreambuf& operator= ( const Bzipifstreambuf& ); // do not implement
+};
+
+/**
+ * \brief Stream buffer that collects written data in a fixed-size chunk and, whenever the chunk
+ *        is full, writes it to a file, compressing it with libbz2 on the fly if requested.
+ *
+ * If NumThreads is larger than one, the data is compressed like pbzip2 does it: It is split into
+ * blocks of CompressionLevel * 100k bytes that are compressed independently, NumThreads blocks
+ * at a time, and written as concatenated bzip2 streams. bzip2 and Python's bz2 module read these
+ * files like files with a single stream.
+ *
+ * The memory needed is independent of the file size, but grows linearly with NumThreads. Takes
+ * ownership of File and closes it in close().
+ */
+class Bzipofstreambuf : public std::streambuf {
+  FILE *_file;
+  const bool _compress;
+  const int _compressionLevel;
+  const int _numThreads;
+  std::vector<char> _buffer;
+  std::vector<char> _compressedBuffer;
+  bool _failed;
+#ifdef USE_LIB_BZ2
+  bz_stream _bzStream;
+  bool _bzStreamInitialized;
+#endif
+  // Only used for parallel compression.
+  std::vector<std::vector<char> > _compressedBlocks;
+  bool _wroteBlock;
+public:
+  //! CompressionLevel is the bzip2 block size in units of 100k (1 to 9). NumThreads <= 0 uses as many threads as OpenMP provides (one thread inside a parallel region).
+  Bzipofstreambuf ( FILE *File, const bool Compress, const int CompressionLevel, const int BufferSize, const int NumThreads = 1 );
+  ~Bzipofstreambuf ();
+
+  //! Writes all pending data, finishes the bzip2 stream and closes the file. Returns false on errors.
+  bool close ();
+
+protected:
+  virtual int_type overflow ( int_type C );
+  virtual std::streamsize xsputn ( const char *Source, std::streamsize Size );
+  virtual int sync ();
+
+private:
+  bool compressInParallel () const {
+    return _compress && ( _numThreads > 1 );
+  }
+  //! Writes (and possibly compresses) Size bytes from Source, returns false on errors.
+  bool writeData ( const char *Source, const std::streamsize Size );
+  //! Compresses Size bytes from Source as independent bzip2 streams in parallel and writes them, returns false on errors.
+  bool writeBlocks ( const char *Source, const std::streamsize Size );
+  bool flushBuffer ();
+
+  Bzipofstreambuf ( const Bzipofstreambuf& ); // do not implement
+  Bzipofstreambuf& operator= ( const Bzipofstreambuf& ); // do not implement
+};
+
 /**
  * \brief Can be used like an ifstream, but supports on the fly bzip2 decompression using libbz2.
  *
  * Automatically decides whether to decompress the input file or not based on the suffix of
- * the constructor argument FileName.
+ * the constructor argument FileName. The file is read and decompressed in chunks of BufferSize
+ * bytes while the stream is being read, not all at once. Files consisting of several bzip2
+ * streams are decompressed using NumThreads threads (<= 0 means as many as OpenMP provides, but
+ * only one thread inside a parallel region). Use more than one thread only for large files.
  *
  * \author Berkels
  */
-class Bzipifstream : public stringstream{
+class Bzipifstream : public std::istream {
+  Bzipifstreambuf *_streambuf;
 public:
-  Bzipifstream ( const char *FileName ){
-    FILE *tempf;
-    char buf[200000];
-    tempf = fopen ( FileName, "rb" );
-    if ( !tempf ){
-      string errorMessage = "Could not open \"";
-      errorMessage += FileName;
-      errorMessage += "\" for reading.\n";
-      throw Exception ( errorMessage.c_str(), __FILE__, __LINE__ );
-    }
-
-    if ( hasBzipSuffx ( FileName ) ) {
-#ifdef USE_LIB_BZ2
-      BZFILE *tempb;
-      int bzerror;
-
-      tempb = BZ2_bzReadOpen ( &bzerror, tempf, 0, 0, NULL, 0 );
-      while ( bzerror == BZ_OK ) {
-        const int bytesRead = BZ2_bzRead ( &bzerror, tempb, buf, sizeof ( buf ) );
-        (*this).write ( buf, bytesRead );
-      }
-      BZ2_bzReadClose ( &bzerror, tempb );
-#else
-      throw Exception ( "Reading bz2 compressed files with Bzipifstream without using bzlib is impossible.\nDefine USE_LIB_BZ2 and link bzlib, e.g by using CFLAG += -DUSE_LIB_BZ2 and LFLAGS += -lbz2, to remedy this.\n", __FILE__, __LINE__ );
-#endif // USE_LIB_BZ2
-    } else {
-      while ( !feof(tempf) ) {
-        const int bytesRead = static_cast<int>(fread ( buf, 1, sizeof ( buf ), tempf ));
-        (*this).write ( buf, bytesRead );
-      }
-    }
-    fclose ( tempf );
-  }
+  static const int DefaultBufferSize = 1 << 18;
+
+  Bzipifstream ( const char *FileName, const int NumThreads = 1, const int BufferSize = DefaultBufferSize );
+  ~Bzipifstream ();
 
 private:
   template< typename AnyThing >
   Bzipifstream& operator<< ( const AnyThing& ); // do not implement
+  Bzipifstream ( const Bzipifstream& ); // do not implement
+  Bzipifstream& operator= ( const Bzipifstream& ); // do not implement
 };
 
 /**
  * \brief Can be used like an ofstream, but supports on the fly bzip2 compression using libbz2.
  *
+ * Automatically decides whether to compress the output or not based on the suffix of FileName.
+ * The data is compressed and written in chunks of BufferSize bytes while the stream is being
+ * written, so the whole output never has to be held in memory. CompressionLevel is the bzip2
+ * block size in units of 100k (1 to 9), smaller values compress faster but less. If more than
+ * one thread is used (NumThreads <= 0 means as many as OpenMP provides, but only one thread inside
+ * a parallel region), the blocks are compressed in parallel and written as concatenated bzip2
+ * streams, see Bzipofstreambuf. Use more than one thread only for large files.
+ *
  * \author Berkels
  */
-class Bzipofstream : public stringstream{
-  FILE *outFile;
-  const bool compressOutput;
+class Bzipofstream : public std::ostream {
+  Bzipofstreambuf *_streambuf;
 public:
-  Bzipofstream ( const char *FileName )
-    : outFile ( NULL ),
-      compressOutput ( hasBzipSuffx ( FileName ) )
-  {
-    outFile = fopen ( FileName, "wb" );
-    if ( !outFile ){
-      string errorMessage = "Could not open \"";
-      errorMessage += FileName;
-      errorMessage += "\" for output.\n";
-      throw Exception ( errorMessage.c_str(), __FILE__, __LINE__ );
-    }
-  }
-  ~Bzipofstream(){
-    close();
-  }
-  void close() {
-    char buf[200000];
-    // We can't do anything when there is no outfile (probably close was already called).
-    if ( outFile == NULL )
-      return;
+  static const int DefaultCompressionLevel = 9;
+  static const int DefaultBufferSize = 1 << 18;
 
-    if ( compressOutput ){
-#ifdef USE_LIB_BZ2
-      BZFILE *b;
-      int bzerror;
-      b = BZ2_bzWriteOpen ( &bzerror, outFile, 9, 0, 0 );
-      while ( !this->eof() ) {
-        (*this).read ( buf, sizeof ( buf ) );
-        const int bytesRead = static_cast<int>(this->gcount());
-        BZ2_bzWrite ( &bzerror, b, buf, bytesRead );
-      }
-      unsigned int temp;
-      BZ2_bzWriteClose ( &bzerror, b, 0, &temp, &temp );
-#else
-      throw Exception ( "Writing bz2 compressed files with Bzipofstream without using bzlib is impossible.\nDefine USE_LIB_BZ2 and link bzlib, e.g by using CFLAG += -DUSE_LIB_BZ2 and LFLAGS += -lbz2, to remedy this.\n", __FILE__, __LINE__ );
-#endif
-    }
-    else{
-      while ( !this->eof() ) {
-        (*this).read ( buf, sizeof ( buf ) );
-        const int bytesRead = static_cast<int>(this->gcount());
-        fwrite( buf, 1, bytesRead, outFile );
-      }
-    }
-    fclose( outFile );
-    outFile = NULL;
-  }
+  Bzipofstream ( const char *FileName, const int CompressionLevel = DefaultCompressionLevel, const int NumThreads = 1, const int BufferSize = DefaultBufferSize );
+  ~Bzipofstream ();
+
+  void close ();
 
 private:
   template< typename AnyThing >
   Bzipofstream& operator>> ( const AnyThing& ); // do not implement
+  Bzipofstream ( const Bzipofstream& ); // do not implement
+  Bzipofstream& operator= ( const Bzipofstream& ); // do not implement
 };
 
 // Turn on the warning C4250 again.
@@ -154,4 +208,3 @@ private:
 }// end namespace aol
 
 #endif //__BZIPIOSTREAM_H
-
@@ -613,6 +613,9 @@ public:
   void setSmoothFirstNComponents ( const int SmoothFirstNComponents ) {
     _smoothFirstNComponents = SmoothFirstNComponents;
   }
+  InverseH1MetricType &getSmoothOpReference ( ) const {
+    return _smoothOp;
+  }
 };
 
 template <typename ConfiguratorType, typename VectorType, typename GradientDescentType = GradientDescent<ConfiguratorType, VectorType> >
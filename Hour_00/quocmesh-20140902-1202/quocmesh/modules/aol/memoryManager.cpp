@@ -1,5 +1,234 @@
 #include <memoryManager.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+typedef aol::MemoryManager::MMStore MMStore;
+
+/** Deallocated blocks sorted into bins by size class. Within a bin, the
+ *  blocks are ordered by the time of deallocation, the newest one last.
+ */
+class BlockBins {
+  static const int NumBins = 8 * sizeof ( size_t );
+
+  std::vector<MMStore> _bins[NumBins];
+  uint64_t _nextStamp;
+  size_t _memusage;
+  int _numStored;
+
+public:
+  int64_t numHits, numMisses, numDeallocations, numReleased;
+
+  BlockBins ( ) : _nextStamp ( 0 ), _memusage ( 0 ), _numStored ( 0 ) {
+    resetStatistics();
+  }
+
+  size_t memusage ( ) const {
+    return _memusage;
+  }
+
+  int numStored ( ) const {
+    return _numStored;
+  }
+
+  bool exceeds ( const int MaxRetain, const size_t MemusageLimit ) const {
+    return ( ( _numStored > MaxRetain ) || ( _memusage > MemusageLimit ) );
+  }
+
+  void resetStatistics ( ) {
+    numHits = numMisses = numDeallocations = numReleased = 0;
+  }
+
+  //! Remove and return the newest block with at least Bytes and less than 2 * Bytes bytes that is a multiple of PointeeSize, NULL if there is none.
+  void* take ( const size_t Bytes, const size_t PointeeSize, size_t &Size ) {
+    // Blocks in bin b have between 2^b and 2^(b+1)-1 bytes, so only two bins can contain suitable blocks.
+    const int bin = getBin ( Bytes );
+    for ( int b = bin; ( b <= bin + 1 ) && ( b < NumBins ); ++b ) {
+      std::vector<MMStore> &blocks = _bins[b];
+      for ( int i = static_cast<int> ( blocks.size() ) - 1; i >= 0; --i ) {
+        const size_t size = blocks[i].size;
+        if ( ( size >= Bytes ) && ( size / 2 < Bytes ) && ( size % PointeeSize == 0 )
+             && ( size / PointeeSize <= static_cast<size_t> ( std::numeric_limits<int>::max() ) ) ) {
+          void *ptr = blocks[i].pBlock;
+          Size = size;
+          blocks.erase ( blocks.begin() + i );
+          --_numStored;
+          _memusage -= size;
+          ++numHits;
+          return ptr;
+        }
+      }
+    }
+    return NULL;
+  }
+
+  void put ( const MMStore &Block ) {
+    _bins[getBin ( Block.size )].push_back ( MMStore ( Block.size, Block.pBlock, ++_nextStamp ) );
+    ++_numStored;
+    _memusage += Block.size;
+  }
+
+  //! Remove the oldest block and return it in Block, false if there are no blocks.
+  bool popOldest ( MMStore &Block ) {
+    int oldestBin = -1;
+    for ( int b = 0; b < NumBins; ++b ) {
+      if ( ( _bins[b].size() > 0 ) && ( ( oldestBin < 0 ) || ( _bins[b].front().stamp < _bins[oldestBin].front().stamp ) ) )
+        oldestBin = b;
+    }
+    if ( oldestBin < 0 )
+      return false;
+
+    Block = _bins[oldestBin].front();
+    _bins[oldestBin].erase ( _bins[oldestBin].begin() );
+    --_numStored;
+    _memusage -= Block.size;
+    return true;
+  }
+
+  //! Index of the bin for blocks of Size > 0 bytes, i.e. floor(log2(Size)).
+  static int getBin ( size_t Size ) {
+#ifdef __GNUC__
+    if ( sizeof ( size_t ) == sizeof ( unsigned long ) )
+      return static_cast<int> ( 8 * sizeof ( unsigned long ) ) - 1 - __builtin_clzl ( static_cast<unsigned long> ( Size ) );
+#endif
+    int bin = 0;
+    while ( Size >>= 1 )
+      ++bin;
+    return bin;
+  }
+};
+
+struct ThreadCache {
+  BlockBins bins;
+#ifdef _OPENMP
+  //! Only contended if another thread cleans the caches or collects the statistics.
+  omp_lock_t lock;
+
+  ThreadCache ( ) {
+    omp_init_lock ( &lock );
+  }
+#endif
+};
+
+class ThreadCacheLock {
+  ThreadCache &_cache;
+
+public:
+  explicit ThreadCacheLock ( ThreadCache &Cache ) : _cache ( Cache ) {
+#ifdef _OPENMP
+    omp_set_lock ( &_cache.lock );
+#endif
+  }
+
+  ~ThreadCacheLock ( ) {
+#ifdef _OPENMP
+    omp_unset_lock ( &_cache.lock );
+#endif
+  }
+};
+
+// All of these are created on first use and never destroyed, so that vectors with static
+// storage duration can use the MemoryManager independently of the order of initialization.
+// sharedStore and allThreadCaches may only be accessed inside critical ( aol_MemoryManager ).
+BlockBins *sharedStore = NULL;
+std::vector<ThreadCache*> *allThreadCaches = NULL;
+
+ThreadCache *threadCache = NULL;
+#ifdef _OPENMP
+#pragma omp threadprivate ( threadCache )
+#endif
+
+BlockBins& getSharedStore ( ) {
+  if ( sharedStore == NULL )
+    sharedStore = new BlockBins;
+  return *sharedStore;
+}
+
+std::vector<ThreadCache*>& getAllThreadCaches ( ) {
+  if ( allThreadCaches == NULL )
+    allThreadCaches = new std::vector<ThreadCache*>;
+  return *allThreadCaches;
+}
+
+// Memory and number of blocks kept in all thread caches together, only accessed inside
+// critical ( aol_MemoryManager_threadCacheTotals ), which never waits for any other lock.
+size_t threadCachesMemusage = 0;
+int threadCachesNumStored = 0;
+
+//! Add (Sign = 1) or remove (Sign = -1) a block of Bytes bytes to or from the totals of the thread caches, returns whether the totals exceed MaxRetain or MemusageLimit afterwards.
+bool changeThreadCacheTotals ( const int Sign, const size_t Bytes, const int MaxRetain, const size_t MemusageLimit ) {
+  bool exceeded;
+#ifdef _OPENMP
+#pragma omp critical ( aol_MemoryManager_threadCacheTotals )
+#endif
+  {
+    threadCachesNumStored += Sign;
+    if ( Sign > 0 )
+      threadCachesMemusage += Bytes;
+    else
+      threadCachesMemusage -= Bytes;
+    exceeded = ( ( threadCachesNumStored > MaxRetain ) || ( threadCachesMemusage > MemusageLimit ) );
+  }
+  return exceeded;
+}
+
+ThreadCache& getThreadCache ( ) {
+  if ( threadCache == NULL ) {
+    ThreadCache *cache = new ThreadCache;
+#ifdef _OPENMP
+#pragma omp critical ( aol_MemoryManager )
+#endif
+    {
+      getAllThreadCaches().push_back ( cache );
+    }
+    threadCache = cache;
+  }
+  return *threadCache;
+}
+
+// If all huge blocks started at a HugePageSize boundary, entries with the same index in different
+// vectors would be mapped to the same cache sets (the pages are physically contiguous), which makes
+// kernels streaming through several vectors at once considerably slower. Hence, the start of huge
+// blocks is moved away from the boundary by one of NumHugeBlockOffsets different offsets.
+const int NumHugeBlockOffsets = 16;
+const size_t HugeBlockOffsetStride = 4096 + aol::MemoryManager::CacheLineSize;
+unsigned int numHugeBlocksAllocated = 0;
+
+// Stored directly in front of each huge block, so that freeBlock can find the address returned by
+// aligned_memory_allocation. Size and magic number detect blocks that were not allocated as huge blocks.
+struct HugeBlockHeader {
+  void *base;
+  size_t size;
+  size_t magic;
+};
+
+const size_t HugeBlockMagic = 0x4d4d4842;
+// The smallest offset leaves room for the header and keeps the block aligned to cache lines.
+const size_t HugeBlockHeaderSpace = ( ( sizeof ( HugeBlockHeader ) + aol::MemoryManager::CacheLineSize - 1 ) / aol::MemoryManager::CacheLineSize ) * aol::MemoryManager::CacheLineSize;
+
+HugeBlockHeader* getHugeBlockHeader ( void *Block ) {
+  return reinterpret_cast<HugeBlockHeader*> ( static_cast<char*> ( Block ) - sizeof ( HugeBlockHeader ) );
+}
+
+size_t nextHugeBlockOffset ( ) {
+  unsigned int n;
+#ifdef _OPENMP
+#pragma omp critical ( aol_MemoryManager_hugeBlockOffset )
+#endif
+  n = numHugeBlocksAllocated++;
+  return HugeBlockHeaderSpace + ( n % NumHugeBlockOffsets ) * HugeBlockOffsetStride;
+}
+
+}
+
+
 void aol::MemoryManager::deleteUnlocked ( int NumToRetain ) {
 #ifdef DO_NOT_USE_MEMORYMANAGER
   aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumToRetain );
@@ -13,33 +242,27 @@ void aol::MemoryManager::deleteUnlocked ( int NumToRetain ) {
 #pragma omp critical ( aol_MemoryManager )
 #endif
   {
-    list< MMStore >::iterator it;
-    const list< MMStore >::iterator end = _storage.end ();
+    BlockBins &shared = getSharedStore();
+    const std::vector<ThreadCache*> &caches = getAllThreadCaches();
+    MMStore block ( 0, NULL );
+
+    for ( unsigned int i = 0; i < caches.size(); ++i ) {
+      ThreadCacheLock lock ( *caches[i] );
+      while ( caches[i]->bins.popOldest ( block ) ) {
+        shared.put ( block );
+        changeThreadCacheTotals ( -1, block.size, 0, 0 );
+      }
+    }
 
 #ifdef VERBOSE
-    cerr << "aol::MemoryManager: deleting from " << _numStored << " unlocked blocks, retaining " << NumToRetain << endl;
+    cerr << "aol::MemoryManager: deleting from " << shared.numStored() << " unlocked blocks, retaining " << NumToRetain << endl;
 #endif
 
-    it = _storage.begin();
-    for ( int retained = 0; ( retained < NumToRetain ) && ( it != end ); ++retained ) {
-      ++it;
-    }
+    while ( ( shared.numStored() > NumToRetain ) && shared.popOldest ( block ) )
+      freeBlock ( block.pBlock, block.size );
 
-    for ( ; it != end; it = _storage.erase ( it ) ) {
-#ifdef USE_SSE
-      aol::aligned_memory_deallocation ( (*it).pBlock );
-#else
-#ifdef USE_DUMA
-      free ( (*it).pBlock );
-#else
-      operator delete ( (*it).pBlock );
-#endif
-#endif
-      --_numStored;
-      _memusage -= ( (*it).size );
-    }
 #ifdef VERBOSE
-    cerr << "aol::MemoryManager: after deleteUnlocked: MemoryManager stores " << _memusage / ( 1024*1024 ) << " MiB in " << _numStored << " blocks." << endl;;
+    cerr << "aol::MemoryManager: after deleteUnlocked: MemoryManager stores " << shared.memusage() / ( 1024*1024 ) << " MiB in " << shared.numStored() << " blocks." << endl;;
 #endif
   }
 
@@ -47,8 +270,10 @@ void aol::MemoryManager::deleteUnlocked ( int NumToRetain ) {
 }
 
 
-int aol::MemoryManager::memoryManagerMemoryUsage () {
-  return _memusage;
+size_t aol::MemoryManager::memoryManagerMemoryUsage () {
+  Statistics stats;
+  getStatistics ( stats );
+  return stats.bytesRetained;
 }
 
 
@@ -69,7 +294,7 @@ void aol::MemoryManager::setMaxRetain ( const int MaxRetain ) {
 }
 
 
-void aol::MemoryManager::setMemusageLimit ( const int MaxMemusage ) {
+void aol::MemoryManager::setMemusageLimit ( const size_t MaxMemusage ) {
 #ifdef DO_NOT_USE_MEMORYMANAGER
   aol::doNothingWithArgumentToPreventUnusedParameterWarning ( MaxMemusage );
 #ifdef VERBOSE
@@ -86,6 +311,101 @@ void aol::MemoryManager::setMemusageLimit ( const int MaxMemusage ) {
 }
 
 
+void aol::MemoryManager::getStatistics ( Statistics &Stats ) {
+  Stats = Statistics();
+#ifndef DO_NOT_USE_MEMORYMANAGER
+#ifdef _OPENMP
+#pragma omp critical ( aol_MemoryManager )
+#endif
+  {
+    const BlockBins &shared = getSharedStore();
+    const std::vector<ThreadCache*> &caches = getAllThreadCaches();
+
+    Stats.numSharedHits = shared.numHits;
+    Stats.numMisses = shared.numMisses;
+    Stats.numReleased = shared.numReleased;
+    Stats.bytesRetained = shared.memusage();
+    Stats.numBlocksRetained = shared.numStored();
+    Stats.numThreadCaches = static_cast<int> ( caches.size() );
+
+    for ( unsigned int i = 0; i < caches.size(); ++i ) {
+      ThreadCacheLock lock ( *caches[i] );
+      const BlockBins &bins = caches[i]->bins;
+      Stats.numThreadCacheHits += bins.numHits;
+      Stats.numDeallocations += bins.numDeallocations;
+      Stats.bytesRetained += bins.memusage();
+      Stats.numBlocksRetained += bins.numStored();
+    }
+  }
+#endif
+}
+
+
+void aol::MemoryManager::resetStatistics ( ) {
+#ifndef DO_NOT_USE_MEMORYMANAGER
+#ifdef _OPENMP
+#pragma omp critical ( aol_MemoryManager )
+#endif
+  {
+    getSharedStore().resetStatistics();
+    const std::vector<ThreadCache*> &caches = getAllThreadCaches();
+    for ( unsigned int i = 0; i < caches.size(); ++i ) {
+      ThreadCacheLock lock ( *caches[i] );
+      caches[i]->bins.resetStatistics();
+    }
+  }
+#endif
+}
+
+
+void* aol::MemoryManager::allocateBlock ( const size_t Size ) {
+#ifdef USE_DUMA
+  void *block = malloc ( Size );
+#else
+  void *block = NULL;
+  if ( Size >= HugePageSize ) {
+    const size_t offset = nextHugeBlockOffset();
+    char *base = static_cast<char*> ( aol::aligned_memory_allocation ( Size + offset, HugePageSize ) );
+    if ( base ) {
+#if defined ( __linux__ ) && defined ( MADV_HUGEPAGE )
+      // Only a hint, so failure (e.g. if transparent huge pages are disabled) does not matter.
+      madvise ( base, ( Size + offset ) - ( Size + offset ) % HugePageSize, MADV_HUGEPAGE );
+#endif
+      block = base + offset;
+      HugeBlockHeader *header = getHugeBlockHeader ( block );
+      header->base = base;
+      header->size = Size;
+      header->magic = HugeBlockMagic;
+    }
+  }
+  else
+    block = aol::aligned_memory_allocation ( Size, CacheLineSize );
+#endif
+
+  if ( !block )
+    throw aol::OutOfMemoryException ( "aol::MemoryManager: Allocate not successful.", __FILE__, __LINE__ );
+
+  return block;
+}
+
+
+void aol::MemoryManager::freeBlock ( void *Ptr, const size_t Size ) {
+#ifdef USE_DUMA
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Size );
+  free ( Ptr );
+#else
+  if ( ( Size >= HugePageSize ) && Ptr ) {
+    HugeBlockHeader *header = getHugeBlockHeader ( Ptr );
+    if ( ( header->magic != HugeBlockMagic ) || ( header->size != Size ) )
+      throw aol::Exception ( "aol::MemoryManager::freeBlock: Block was not allocated by allocateBlock with this size.", __FILE__, __LINE__ );
+    header->magic = 0;
+    Ptr = header->base;
+  }
+  aol::aligned_memory_deallocation ( Ptr );
+#endif
+}
+
+
 void* aol::MemoryManager::allocateAtLeast ( int& Length, const size_t PointeeSize ) {
   // If the user wants a memory block of length 0, just return a NULL pointer. Such a pointer
   // can't be used for anything anyway and this saves us from doing more checks further below
@@ -98,61 +418,50 @@ void* aol::MemoryManager::allocateAtLeast ( int& Length, const size_t PointeeSiz
     throw aol::Exception ( "aol::MemoryManager: Cannot allocate negative amount of memory", __FILE__, __LINE__ );
 #endif
 
+  const size_t bytes = static_cast<size_t> ( Length ) * PointeeSize;
+
 #ifndef DO_NOT_USE_MEMORYMANAGER
+  size_t size = 0;
   void* ptr = NULL;
-#ifdef _OPENMP
-#pragma omp critical ( aol_MemoryManager )
-#endif
   {
-    int maxlen = ( Length * PointeeSize ) << 1;
-
-    // Find vector of correct length
-    const list<MMStore>::iterator end = _storage.end ();
+    ThreadCache &cache = getThreadCache();
+    ThreadCacheLock lock ( cache );
+    ptr = cache.bins.take ( bytes, PointeeSize, size );
+  }
+  if ( ptr != NULL )
+    changeThreadCacheTotals ( -1, size, 0, 0 );
 
-    for ( list<MMStore>::iterator it = _storage.begin (); it != end; ++it ) {
-#ifdef VERBOSE
-      cerr << "aol::MemoryManager: searching, found length " << (*it).size << endl;
+  if ( ptr == NULL ) {
+#ifdef _OPENMP
+#pragma omp critical ( aol_MemoryManager )
 #endif
+    {
+      BlockBins &shared = getSharedStore();
+      ptr = shared.take ( bytes, PointeeSize, size );
+      if ( ptr == NULL )
+        ++shared.numMisses;
+    }
+  }
 
-      if ( ( (*it).size >= static_cast<int> ( Length * PointeeSize ) ) && ( (*it).size < maxlen ) && ( (*it).size % PointeeSize == 0 ) ) {
-        Length = (*it).size / PointeeSize; // integer division on purpose, must be multiple
+  if ( ptr != NULL ) {
+    Length = static_cast<int> ( size / PointeeSize ); // integer division on purpose, must be multiple
 #ifdef VERBOSE
-        cerr << "aol::MemoryManager: recycling memory with " << ( Length * PointeeSize ) << " bytes at address " << (*it).pBlock << " with length " << (*it).size << endl;
+    cerr << "aol::MemoryManager: recycling memory with " << bytes << " bytes at address " << ptr << " with length " << size << endl;
 #endif
-
-        ptr = (*it).pBlock;
-        --_numStored;
-        _memusage -= Length * PointeeSize;
-        _storage.erase ( it );
-        break;
-      }
-    }
-  }
-  if ( ptr != NULL )
     return ptr;
+  }
   // Otherwise allocate new data
 
 #endif //DO_NOT_USE_MEMORYMANAGER
 
-#ifdef USE_SSE
-  void *new_vec = aol::aligned_memory_allocation ( Length * PointeeSize, 16 );
-#else
-#ifdef USE_DUMA
-  void *new_vec = malloc ( Length * PointeeSize );
-#else
-  void *new_vec = operator new ( Length * PointeeSize );
-#endif
-#endif // USE_SSE
+  void *new_vec = allocateBlock ( bytes );
 
 #ifndef DO_NOT_USE_MEMORYMANAGER
 #ifdef VERBOSE
-  cerr << "aol::MemoryManager: allocating new memory at address " << new_vec << " with length " << Length * PointeeSize << endl;
+  cerr << "aol::MemoryManager: allocating new memory at address " << new_vec << " with length " << bytes << endl;
 #endif
 #endif
 
-  if ( !new_vec )
-    throw aol::OutOfMemoryException ( "aol::MemoryManager: Allocate not successful.", __FILE__, __LINE__ );
-
   return new_vec;
 }
 
@@ -160,76 +469,80 @@ void* aol::MemoryManager::allocateAtLeast ( int& Length, const size_t PointeeSiz
 void aol::MemoryManager::deallocate ( void *Ptr, const int Length, const size_t PointeeSize ) {
 #ifdef DO_NOT_USE_MEMORYMANAGER
   // no-vectormanager case:
-  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Length + PointeeSize );
-#ifdef USE_SSE
-  aol::aligned_memory_deallocation ( Ptr );
-#else
-#ifdef USE_DUMA
-  free( Ptr );
-#else
-  operator delete ( Ptr );
-#endif
-#endif
+  freeBlock ( Ptr, static_cast<size_t> ( Length ) * PointeeSize );
 
 #else
 
+  if ( Ptr == NULL )
+    return;
+
 #ifdef USE_SSE
   if ( ( reinterpret_cast<const uintptr_t> ( Ptr ) % 16 ) != 0 ) {
     throw Exception ( "aol::MemoryManager::deallocate: With USE_SSE, the data pointer must be 16 byte aligned.\n", __FILE__, __LINE__ );
   }
 #endif
 
+  const size_t bytes = static_cast<size_t> ( Length ) * PointeeSize;
+
 #ifdef VERBOSE
-  cerr << "aol::MemoryManager: unlocking memory at address " << Ptr << " with length " << Length * PointeeSize << endl;
+  cerr << "aol::MemoryManager: unlocking memory at address " << Ptr << " with length " << bytes << endl;
 #endif
 
+  const int threadCachesMaxRetain = _maxRetain / ThreadCacheShare;
+  const size_t threadCachesMemusageLimit = _memusageLimit / ThreadCacheShare;
+
+  ThreadCache &cache = getThreadCache();
+  MMStore block ( 0, NULL );
+  {
+    ThreadCacheLock lock ( cache );
+    cache.bins.put ( MMStore ( bytes, Ptr ) );
+    ++cache.bins.numDeallocations;
+  }
+  bool overflow = changeThreadCacheTotals ( 1, bytes, threadCachesMaxRetain, threadCachesMemusageLimit );
+
+  // Move the oldest blocks from the thread cache to the shared store until all thread caches
+  // together respect their limits again (or this one is empty, then the totals are at most what
+  // they were before the block was added). The thread cache lock may not be held when entering
+  // the critical section, deleteUnlocked locks in the opposite order.
+  while ( overflow ) {
+    {
+      ThreadCacheLock lock ( cache );
+      if ( !cache.bins.popOldest ( block ) )
+        break;
+    }
+    overflow = changeThreadCacheTotals ( -1, block.size, threadCachesMaxRetain, threadCachesMemusageLimit );
+
 #ifdef _OPENMP
 #pragma omp critical ( aol_MemoryManager )
 #endif
-  {
-    _storage.push_front ( MMStore ( Length * PointeeSize, Ptr ) );
-    ++_numStored;
-    _memusage += Length * PointeeSize;
+    {
+      BlockBins &shared = getSharedStore();
+      shared.put ( block );
 
-    while ( ( _numStored > _maxRetain ) || ( _memusage > _memusageLimit ) ) {
+      while ( shared.exceeds ( _maxRetain - threadCachesMaxRetain, _memusageLimit - threadCachesMemusageLimit ) && shared.popOldest ( block ) ) {
 #ifdef VERBOSE
-      cerr << "aol::MemoryManager: removing memory of length " << ( _storage.back() ).size << " bytes" << endl;
+        cerr << "aol::MemoryManager: removing memory of length " << block.size << " bytes" << endl;
 #endif
-
-#ifdef USE_SSE
-      aol::aligned_memory_deallocation ( (_storage.back()).pBlock );
-#else
-#ifdef USE_DUMA
-      free ( (_storage.back()).pBlock );
-#else
-      operator delete ( (_storage.back()).pBlock );
-#endif
-#endif
-
-      --_numStored;
-      _memusage -= ( (_storage.back()).size );
-      _storage.pop_back ();
+        freeBlock ( block.pBlock, block.size );
+        ++shared.numReleased;
+      }
 
 #ifdef VERBOSE
-      cerr << "aol::MemoryManager: was too large, deleted last entry" << endl;
+      cerr << "aol::MemoryManager: shared store keeps " << shared.memusage() / ( 1024*1024 ) << " MiB in " << shared.numStored() << " blocks." << endl;
 #endif
-
     }
-
-#ifdef VERBOSE
-    cerr << "aol::MemoryManager stores " << _memusage / ( 1024*1024 ) << " MiB in " << _numStored << " blocks." << endl;
-#endif
   }
 
 #endif
 }
 
 
-list< aol::MemoryManager::MMStore > aol::MemoryManager::_storage = std::list< MMStore >();
-int aol::MemoryManager::_numStored = 0;
-int aol::MemoryManager::_memusage = 0;
+const size_t aol::MemoryManager::CacheLineSize;
+const size_t aol::MemoryManager::HugePageSize;
+const int aol::MemoryManager::ThreadCacheShare;
+
 int aol::MemoryManager::_maxRetain = 256;
-int aol::MemoryManager::_memusageLimit = 512 * ( 1 << 20 ); // 512 MiB
+size_t aol::MemoryManager::_memusageLimit = 512 * ( 1 << 20 ); // 512 MiB
 
 
 #ifndef DO_NOT_USE_MEMORYMANAGER
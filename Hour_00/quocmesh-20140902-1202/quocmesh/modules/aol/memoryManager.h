@@ -5,37 +5,69 @@
 
 namespace aol {
 
-/** Class for allocating and deallocating memory (16-byte aligned in
- *  case SSE is used).  A certain amount of memory is kept here rather
- *  than returned to the system to improve performance (unless
- *  explicitly disabled by definig DO_NOT_USE_MEMORYMANAGER).  Newest
- *  blocks of memory deallocated are recycled first, oldest blocks are
- *  dropped first.
+/** Class for allocating and deallocating memory.  A certain amount of
+ *  memory is kept here rather than returned to the system to improve
+ *  performance (unless explicitly disabled by definig
+ *  DO_NOT_USE_MEMORYMANAGER).  Newest blocks of memory deallocated are
+ *  recycled first, oldest blocks are dropped first.
  *
- *  \todo consistent use of size_t and int data types
+ *  Deallocated blocks are sorted into bins by size class (the bin of a
+ *  block of n bytes is floor(log2(n))), so finding a block to recycle only
+ *  needs to look at two bins.  A block is recycled if its size is at least
+ *  the requested size and less than twice the requested size.
+ *
+ *  Each thread has its own cache of deallocated blocks that is searched
+ *  first and needs no global lock.  Blocks dropped from a thread cache go to
+ *  a store shared by all threads.  The limits set by setMaxRetain and
+ *  setMemusageLimit apply to all retained blocks: All thread caches together
+ *  keep at most 1/ThreadCacheShare of them (independently of the number of
+ *  threads), the shared store the rest.  Since a block freed by a
+ *  thread is recycled by the same thread first, memory tends to stay on the
+ *  NUMA node that touched it first.
+ *
+ *  Blocks are aligned to cache lines. Blocks of at least HugePageSize bytes
+ *  are allocated aligned to HugePageSize (and marked as candidates for
+ *  transparent huge pages under Linux), but start a few (varying) pages and
+ *  cache lines after the boundary to avoid cache set conflicts between
+ *  vectors.  A small header in front of such a block stores the allocated
+ *  address and the size, which freeBlock checks.
  *
  *  \author Schwen (MEVIS), based on older code
  */
 class MemoryManager {
 public:
   struct MMStore {
-    int size;
+    size_t size;
     void* pBlock;
-    MMStore ( const int Size, void* PBlock ) : size ( Size ), pBlock ( PBlock ) { };
+    uint64_t stamp;   //!< the larger the stamp, the more recently the block was deallocated
+    MMStore ( const size_t Size, void* PBlock, const uint64_t Stamp = 0 ) : size ( Size ), pBlock ( PBlock ), stamp ( Stamp ) { };
   };
 
-private:
-  static list< MMStore > _storage;
+  //! Counters describing how well the MemoryManager works, summed over all threads.
+  struct Statistics {
+    int64_t numThreadCacheHits;  //!< allocations served from the cache of the allocating thread
+    int64_t numSharedHits;       //!< allocations served from the shared store
+    int64_t numMisses;           //!< allocations that had to request memory from the system
+    int64_t numDeallocations;    //!< blocks handed to the MemoryManager for reuse
+    int64_t numReleased;         //!< blocks returned to the system because a limit was exceeded
+    size_t bytesRetained;        //!< memory currently kept for reuse
+    size_t numBlocksRetained;    //!< number of blocks currently kept for reuse
+    int numThreadCaches;
 
-  static int
-    _numStored,       //!< number of memory blocks being stored
-    _memusage,        //!< memory being used
-    _maxRetain,       //!< Maximum number of memory blocks to retain in manager
-    _memusageLimit;   //!< maximum memory usage
+    Statistics ( ) : numThreadCacheHits ( 0 ), numSharedHits ( 0 ), numMisses ( 0 ), numDeallocations ( 0 ), numReleased ( 0 ), bytesRetained ( 0 ), numBlocksRetained ( 0 ), numThreadCaches ( 0 ) { }
+  };
+
+  static const size_t CacheLineSize = 64;
+  static const size_t HugePageSize = 2 << 20;
+  static const int ThreadCacheShare = 8;
+
+private:
+  static int _maxRetain;         //!< Maximum number of memory blocks to retain in the thread caches and the shared store together
+  static size_t _memusageLimit;  //!< maximum memory usage of the thread caches and the shared store together
 
 public:
   //! Return how much memory is used by the MemoryManager
-  static int memoryManagerMemoryUsage ();
+  static size_t memoryManagerMemoryUsage ();
 
   //! Return a pointer to memory of at least size Length * PointeeSize, write actual length to Length
   //! \warning The user has to store the actual length returned and pass this value to deallocate later, otherwise memory will get lost.
@@ -44,7 +76,7 @@ public:
   //! Vector manager, store for reuse
   static void deallocate ( void *Ptr, const int Length, const size_t PointeeSize );
 
-  //! Clean reuse storage
+  //! Clean reuse storage: Moves the blocks of all thread caches to the shared store and keeps the NumToRetain newest blocks there.
   //! \todo rename method
   static void deleteUnlocked ( const int NumToRetain = 0 );
 
@@ -52,7 +84,19 @@ public:
   static void setMaxRetain ( const int MaxRetain );
 
   //! set maximum amount of memory to be kept, does not affect current size
-  static void setMemusageLimit ( const int MaxMemusage );
+  static void setMemusageLimit ( const size_t MaxMemusage );
+
+  static void getStatistics ( Statistics &Stats );
+
+  //! Set all counters of the statistics to zero (the retained memory is not affected)
+  static void resetStatistics ( );
+
+  //! Allocate a block of Size bytes from the system with the alignment described above
+  static void* allocateBlock ( const size_t Size );
+
+  //! Return a block allocated by allocateBlock ( Size ) to the system. Throws if a block of at least
+  //! HugePageSize bytes was not allocated by allocateBlock with exactly this size.
+  static void freeBlock ( void *Ptr, const size_t Size );
 
   //! to free used memory on exit to prevent memory leak, should not be called directly except by atexit
   static void clearOnExit ( ) {
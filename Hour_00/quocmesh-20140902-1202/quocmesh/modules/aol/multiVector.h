@@ -446,6 +446,39 @@ public:
     return *this;
   }
 
+  MultiVector<DataType> &scaleAndAddMultiple ( const DataType ScaleFactor, const aol::MultiVector<DataType>& Vec, const DataType VecFactor ) {
+    if ( !Vec.compareDim ( *this ) )
+      throw Exception ( "MultiVector<DataType>::scaleAndAddMultiple dimensions don't match.", __FILE__, __LINE__ );
+
+    for ( int i = 0; i < numComponents (); ++i )
+      ( *this ) [i].scaleAndAddMultiple ( ScaleFactor, Vec[i], VecFactor );
+
+    return *this;
+  }
+
+  //! Adds multiple of Vec to this MultiVector and returns the squared norm of the result, see Vector::addMultipleAndNormSqr
+  DataType addMultipleAndNormSqr ( const MultiVector<DataType> &Vec, DataType Factor ) {
+    if ( !Vec.compareDim ( *this ) ) {
+      throw Exception ( "MultiVector<DataType>::addMultipleAndNormSqr dimensions don't match.", __FILE__, __LINE__ );
+    }
+    DataType s = 0;
+    for ( int i = 0; i < numComponents (); ++i )
+      s += ( *this ) [i].addMultipleAndNormSqr ( Vec[i], Factor );
+    return s;
+  }
+
+  //! Adds multiples of Vec to this MultiVector and of OtherVec to Other and returns the squared norm of this MultiVector, see Vector::addMultipleAndNormSqr
+  DataType addMultipleAndNormSqr ( const MultiVector<DataType> &Vec, DataType Factor,
+                                   MultiVector<DataType> &Other, const MultiVector<DataType> &OtherVec, DataType OtherFactor ) {
+    if ( !Vec.compareDim ( *this ) || !Other.compareDim ( *this ) || !OtherVec.compareDim ( *this ) ) {
+      throw Exception ( "MultiVector<DataType>::addMultipleAndNormSqr dimensions don't match.", __FILE__, __LINE__ );
+    }
+    DataType s = 0;
+    for ( int i = 0; i < numComponents (); ++i )
+      s += ( *this ) [i].addMultipleAndNormSqr ( Vec[i], Factor, Other[i], OtherVec[i], OtherFactor );
+    return s;
+  }
+
   void setSum ( const MultiVector<DataType>& Vec1, const MultiVector<DataType>& Vec2, DataType Factor ) {
     if ( !Vec1.compareDim ( *this ) || !Vec2.compareDim ( *this ) ) {
       throw Exception ( "MultiVector<DataType>::setSum dimensions don't match.", __FILE__, __LINE__ );
@@ -36,6 +36,10 @@
 #include <aol.h>
 #include <vec.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #if defined(__MINGW32_VERSION) || defined(__MINGW64__) || defined(__CYGWIN__)
 #include <io.h>
 #include <fcntl.h>
@@ -55,6 +59,11 @@
 
 #include <dirent.h>
 
+#if !defined ( _WIN32 ) && !defined ( _WIN64 )
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+
 namespace aol{
 
 #if !defined ( _WIN32 ) && !defined ( _WIN64 )
@@ -69,9 +78,13 @@ namespace aol{
 
 #ifdef USE_SSE
 #include <xmmintrin.h>
+#endif
+
 void* aligned_memory_allocation ( const size_t MemorySize, const size_t Alignment ) {
 #if defined (__MINGW32_VERSION) || defined(__MINGW64__)
   return __mingw_aligned_malloc ( MemorySize, Alignment );
+#elif defined(_MSC_VER)
+  return _aligned_malloc ( MemorySize, Alignment );
 #else
 #ifdef __CYGWIN__
   return memalign ( Alignment, MemorySize );
@@ -88,11 +101,12 @@ void* aligned_memory_allocation ( const size_t MemorySize, const size_t Alignmen
 void aligned_memory_deallocation ( void* Pointer ) {
 #if defined (__MINGW32_VERSION) || defined(__MINGW64__)
   __mingw_aligned_free ( Pointer );
+#elif defined(_MSC_VER)
+  _aligned_free ( Pointer );
 #else
   free ( Pointer );
 #endif // __MINGW32_VERSION
 }
-#endif
 
 #if defined(_MSC_VER)
 // Visual C++ uses UNICODE and therefore wide chars instead of chars for certain functions.
@@ -282,6 +296,29 @@ void createDirectoryListing ( const char *Dir, std::vector<std::string> &DirList
   }
 }
 
+void createRecursiveFileListing ( const string &Dir, std::vector<std::string> &FileList ) {
+  std::vector<std::string> dirList;
+  createDirectoryListing ( Dir.c_str(), dirList, true );
+  std::sort ( dirList.begin(), dirList.end() );
+
+  for ( unsigned int i = 0; i < dirList.size(); ++i ) {
+    if ( ( dirList[i] == "." ) || ( dirList[i] == ".." ) )
+      continue;
+
+    const string path = ( Dir.size() > 0 ) && ( Dir[Dir.size() - 1] == '/' ) ? ( Dir + dirList[i] ) : ( Dir + "/" + dirList[i] );
+#if defined ( GNU ) || defined ( __clang__ )
+    // Symbolic links to directories are not followed, otherwise a link to a parent directory would recurse forever.
+    struct stat buf;
+    if ( !lstat ( path.c_str (), &buf ) && S_ISLNK ( buf.st_mode ) && directoryExists ( path ) )
+      continue;
+#endif
+    if ( directoryExists ( path ) )
+      createRecursiveFileListing ( path, FileList );
+    else if ( fileExists ( path ) )
+      FileList.push_back ( path );
+  }
+}
+
 bool fileExists ( string filename ) {
 #if defined ( GNU ) || defined ( __clang__ )
   struct stat buf;
@@ -296,6 +333,20 @@ bool fileExists ( string filename ) {
 #endif
 }
 
+bool directoryExists ( const string &DirectoryName ) {
+#if defined ( GNU ) || defined ( __clang__ )
+  struct stat buf;
+  return !stat ( DirectoryName.c_str (), &buf ) && S_ISDIR ( buf.st_mode );
+#else
+#if (defined(_MSC_VER))
+  struct _stat buf;
+  return !_stat( DirectoryName.c_str (), &buf ) && (buf.st_mode & _S_IFDIR);
+#else
+  throw UnimplementedCodeException("directoryExists", __FILE__, __LINE__);
+#endif
+#endif
+}
+
 int getSizeOfFile ( const std::string &Filename ) {
   if ( aol::fileExists ( Filename ) ) {
     struct stat filestatus;
@@ -306,6 +357,58 @@ int getSizeOfFile ( const std::string &Filename ) {
     return -1;
 }
 
+MemoryMappedFile::MemoryMappedFile ( const string &FileName )
+  : _data ( NULL ),
+    _size ( 0 ),
+    _mapped ( false ) {
+#if !defined ( _WIN32 ) && !defined ( _WIN64 )
+  const int fd = ::open ( FileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    throw FileException ( strprintf ( "MemoryMappedFile: Could not open \"%s\" for reading.", FileName.c_str() ).c_str(), __FILE__, __LINE__ );
+  struct stat buf;
+  if ( fstat ( fd, &buf ) != 0 ) {
+    ::close ( fd );
+    throw FileException ( strprintf ( "MemoryMappedFile: Could not determine the size of \"%s\".", FileName.c_str() ).c_str(), __FILE__, __LINE__ );
+  }
+  _size = static_cast<size_t> ( buf.st_size );
+  // mmap doesn't allow empty mappings.
+  if ( _size > 0 ) {
+    void *data = mmap ( NULL, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    if ( data == MAP_FAILED ) {
+      ::close ( fd );
+      throw FileException ( strprintf ( "MemoryMappedFile: Could not map \"%s\" into memory.", FileName.c_str() ).c_str(), __FILE__, __LINE__ );
+    }
+    _data = static_cast<char*> ( data );
+    _mapped = true;
+  }
+  // The mapping stays valid after closing the file.
+  ::close ( fd );
+#else
+  FILE *file = fopen ( FileName.c_str(), "rb" );
+  if ( file == NULL )
+    throw FileException ( strprintf ( "MemoryMappedFile: Could not open \"%s\" for reading.", FileName.c_str() ).c_str(), __FILE__, __LINE__ );
+  fseek ( file, 0, SEEK_END );
+  _size = static_cast<size_t> ( ftell ( file ) );
+  fseek ( file, 0, SEEK_SET );
+  _data = new char[_size + 1];
+  const size_t numRead = fread ( _data, 1, _size, file );
+  fclose ( file );
+  if ( numRead != _size ) {
+    delete[] _data;
+    throw FileException ( strprintf ( "MemoryMappedFile: Could not read \"%s\".", FileName.c_str() ).c_str(), __FILE__, __LINE__ );
+  }
+#endif
+}
+
+MemoryMappedFile::~MemoryMappedFile () {
+#if !defined ( _WIN32 ) && !defined ( _WIN64 )
+  if ( _mapped )
+    munmap ( _data, _size );
+#else
+  delete[] _data;
+#endif
+}
+
 void appendSearchPath ( const char *DirectoryName ) {
   std::string path;
   const char *pathVar = getenv ( "PATH" );
@@ -321,6 +424,16 @@ void appendSearchPath ( const char *DirectoryName ) {
 #endif
 }
 
+int getNumThreadsToUse ( const int NumThreads ) {
+  if ( NumThreads > 0 )
+    return NumThreads;
+#ifdef _OPENMP
+  return omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
 void callSystemPauseIfNecessaryOnPlatform (){
 #if defined(__MINGW32_VERSION) || defined(__MINGW64__) || defined(_MSC_VER)
   const char *var = getenv ( "QUOC_NO_SYSTEM_PAUSE" );
@@ -179,9 +179,16 @@ void setCurrentDirectory ( std::string dir );
 //! \author Berkels
 void createDirectoryListing ( const char *Dir, std::vector<std::string> &DirList, const bool IncludeDirectories = false );
 
+//! Creates a sorted vector with the paths of all files in \arg Dir and, recursively, in all of its subdirectories.
+//! Symbolic links to directories are not followed (under Linux and Mac OS X).
+void createRecursiveFileListing ( const std::string &Dir, std::vector<std::string> &FileList );
+
 //! Test for file existence
 bool fileExists ( std::string filename );
 
+//! Test for directory existence
+bool directoryExists ( const std::string &DirectoryName );
+
 //! Returns the size of the file and -1 if the file does not exist.
 //! \author Berkels
 int getSizeOfFile ( const std::string &Filename );
@@ -193,6 +200,12 @@ void appendSearchPath ( const char *DirectoryName );
 //! Calls system( "PAUSE" ), if called on a platform where the output window is automatically closed on exit (MinGW for example)
 void callSystemPauseIfNecessaryOnPlatform ();
 
+/** Number of threads a routine that takes a NumThreads argument should use: NumThreads if it is positive, otherwise all
+ *  OpenMP threads, but only one if called from inside a parallel region (so that nested calls do not oversubscribe the
+ *  cores) or without OpenMP.
+ */
+int getNumThreadsToUse ( const int NumThreads );
+
 //! Writes the current wall clock time in seconds to Seconds and the miliseconds part to Miliseconds.
 void getWallClockTime( time_t &Seconds, unsigned short &Miliseconds );
 
@@ -224,6 +237,35 @@ int64_t memusage ( const MemoryUsageFlags flags = static_cast<MemoryUsageFlags>
 //! \author Berkels
 int vscprintf(const char *format, va_list ap);
 
+/**
+ * \brief Read-only view of the contents of a file that is mapped into memory.
+ *
+ * The mapping is private, i.e. the data may be modified in memory (copy-on-write), but
+ * modifications are never written back to the file. Pages are only read from disk when they are
+ * accessed, so creating the view is cheap independently of the file size. On platforms without
+ * mmap the file is read into memory instead.
+ */
+class MemoryMappedFile {
+  char *_data;
+  size_t _size;
+  bool _mapped;
+public:
+  explicit MemoryMappedFile ( const std::string &FileName );
+  ~MemoryMappedFile ();
+
+  char* getData () const {
+    return _data;
+  }
+
+  size_t getSize () const {
+    return _size;
+  }
+
+private:
+  MemoryMappedFile ( const MemoryMappedFile& ); // do not implement
+  MemoryMappedFile& operator= ( const MemoryMappedFile& ); // do not implement
+};
+
 //! pfstream is a GNU extension and therefore unknown to the intel compiler
 //! We supply a substitution here
 //! @ingroup Input
@@ -3,6 +3,10 @@
 
 #include <solver.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace aol {
 
 /** Basis class for template specialization */
@@ -605,6 +609,386 @@ public:
   }
 };
 
+//! Order in which ParallelSSORPreconditioner and ParallelILU0Preconditioner process the unknowns in their triangular sweeps.
+enum ParallelSweepOrdering {
+  //! Keep the order of the unknowns and process rows that do not depend on each other in parallel (level scheduling).
+  //! Gives the same preconditioner as the sequential version.
+  LEVEL_SCHEDULED_ORDERING,
+  //! Order the unknowns by a greedy coloring of the matrix graph and process all unknowns of one color in parallel.
+  //! This is a different preconditioner than the sequential one, usually needing some more iterations, but each sweep
+  //! only has as many sequential steps as there are colors. On quoc grids, the greedy coloring is the red-black type
+  //! ordering by the parity of the node coordinates, i.e. 4 colors in 2D and 8 colors in 3D.
+  MULTICOLOR_ORDERING
+};
+
+/** \brief Sparse matrix in CSR format, possibly with permuted unknowns, together with the schedules needed to do
+ *         forward and backward triangular sweeps in parallel.
+ *
+ *  The rows of the lower (upper) triangular sweep are grouped in levels such that each row only depends on rows of
+ *  earlier levels, hence all rows of one level can be processed in parallel. With natural ordering, the levels of
+ *  a 2D grid are too small to gain from parallelization, in this case (and if only one thread is available) the
+ *  rows are swept in their order, which is much more cache friendly than the order of the levels.
+ *  Explicitly stored zeros (e.g. the ones of FastUniformGridMatrix at the boundary) would only create artificial
+ *  dependencies, so they are dropped.
+ *  \author Berkels
+ *  \ingroup solver
+ */
+template <typename RealType>
+class ParallelSweepMatrix {
+public:
+  //! Levels with fewer rows on average are not worth the synchronization after each level.
+  static const int MinRowsPerParallelLevel = 256;
+
+  //! Permutation from the sweep order to the original numbering of the unknowns.
+  std::vector<int> perm;
+  std::vector<int> rowPointer, columnIndex, diagonalPosition;
+  std::vector<RealType> value;
+  std::vector<int> lowerLevelPointer, lowerLevelRows, upperLevelPointer, upperLevelRows;
+
+  template <typename MatrixType>
+  ParallelSweepMatrix ( const MatrixType &Mat, const ParallelSweepOrdering Ordering ) {
+    const int numRows = Mat.getNumRows();
+    if ( Mat.getNumCols() != numRows )
+      throw Exception ( "aol::ParallelSweepMatrix: Matrix must be square", __FILE__, __LINE__ );
+
+    std::vector<std::vector<typename Row<RealType>::RowEntry> > rows ( numRows );
+    std::vector<typename Row<RealType>::RowEntry> vec;
+    for ( int i = 0; i < numRows; ++i ) {
+      Mat.makeRowEntries ( vec, i );
+      for ( typename std::vector<typename Row<RealType>::RowEntry>::const_iterator it = vec.begin(); it != vec.end(); ++it )
+        if ( ( it->value != aol::ZOTrait<RealType>::zero ) || ( it->col == i ) )
+          rows[i].push_back ( *it );
+    }
+
+    perm.resize ( numRows );
+    if ( Ordering == MULTICOLOR_ORDERING ) {
+      // Since the greedy coloring only looks at row i, a_ji != 0 with j > i is taken into account when row j is colored.
+      std::vector<int> color ( numRows, -1 ), colorUsedBy;
+      int numColors = 0;
+      for ( int i = 0; i < numRows; ++i ) {
+        // Colors of the already colored neighbors are marked with i.
+        for ( typename std::vector<typename Row<RealType>::RowEntry>::const_iterator it = rows[i].begin(); it != rows[i].end(); ++it )
+          if ( ( it->col != i ) && ( color[it->col] >= 0 ) )
+            colorUsedBy[color[it->col]] = i;
+        int c = 0;
+        while ( ( c < numColors ) && ( colorUsedBy[c] == i ) )
+          ++c;
+        if ( c == numColors ) {
+          ++numColors;
+          colorUsedBy.push_back ( -1 );
+        }
+        color[i] = c;
+      }
+      groupByKey ( color, numColors, perm );
+    }
+    else {
+      for ( int i = 0; i < numRows; ++i )
+        perm[i] = i;
+    }
+
+    std::vector<int> invPerm ( numRows );
+    for ( int i = 0; i < numRows; ++i )
+      invPerm[perm[i]] = i;
+
+    rowPointer.resize ( numRows + 1 );
+    diagonalPosition.resize ( numRows );
+    rowPointer[0] = 0;
+    std::vector<std::pair<int, RealType> > row;
+    for ( int i = 0; i < numRows; ++i ) {
+      row.clear();
+      const std::vector<typename Row<RealType>::RowEntry> &entries = rows[perm[i]];
+      for ( typename std::vector<typename Row<RealType>::RowEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it )
+        row.push_back ( std::pair<int, RealType> ( invPerm[it->col], it->value ) );
+      std::sort ( row.begin(), row.end() );
+      diagonalPosition[i] = -1;
+      for ( typename std::vector<std::pair<int, RealType> >::const_iterator it = row.begin(); it != row.end(); ++it ) {
+        if ( it->first == i )
+          diagonalPosition[i] = static_cast<int> ( columnIndex.size() );
+        columnIndex.push_back ( it->first );
+        value.push_back ( it->second );
+      }
+      if ( diagonalPosition[i] < 0 )
+        throw Exception ( aol::strprintf ( "aol::ParallelSweepMatrix: No diagonal entry in row %d", perm[i] ), __FILE__, __LINE__ );
+      rowPointer[i + 1] = static_cast<int> ( columnIndex.size() );
+      std::vector<typename Row<RealType>::RowEntry>().swap ( rows[perm[i]] );
+    }
+
+    std::vector<int> level ( numRows );
+    int numLevels = 0;
+    for ( int i = 0; i < numRows; ++i ) {
+      level[i] = 0;
+      for ( int k = rowPointer[i]; k < diagonalPosition[i]; ++k )
+        level[i] = aol::Max ( level[i], level[columnIndex[k]] + 1 );
+      numLevels = aol::Max ( numLevels, level[i] + 1 );
+    }
+    groupByKey ( level, numLevels, lowerLevelRows, &lowerLevelPointer );
+
+    numLevels = 0;
+    for ( int i = numRows - 1; i >= 0; --i ) {
+      level[i] = 0;
+      for ( int k = diagonalPosition[i] + 1; k < rowPointer[i + 1]; ++k )
+        level[i] = aol::Max ( level[i], level[columnIndex[k]] + 1 );
+      numLevels = aol::Max ( numLevels, level[i] + 1 );
+    }
+    groupByKey ( level, numLevels, upperLevelRows, &upperLevelPointer );
+  }
+
+  int getNumRows() const {
+    return static_cast<int> ( perm.size() );
+  }
+
+  int getNumLowerLevels() const {
+    return static_cast<int> ( lowerLevelPointer.size() ) - 1;
+  }
+
+  int getNumUpperLevels() const {
+    return static_cast<int> ( upperLevelPointer.size() ) - 1;
+  }
+
+  /** Calls RowOp ( i ) for all rows i (in the permuted numbering) such that all rows of the lower (Upper = false) or
+   *  upper (Upper = true) triangular part of row i have been processed before. Rows of one level are processed in
+   *  parallel, so RowOp may only write to row i.
+   */
+  template <bool Upper, typename RowOpType>
+  void sweep ( const RowOpType &RowOp ) const {
+    const std::vector<int> &levelPointer = Upper ? upperLevelPointer : lowerLevelPointer;
+    const int numLevels = static_cast<int> ( levelPointer.size() ) - 1;
+    const int numRows = getNumRows();
+    bool useLevels = ( numLevels > 0 ) && ( numRows / numLevels >= MinRowsPerParallelLevel );
+#ifdef _OPENMP
+    useLevels = useLevels && ( omp_get_max_threads() > 1 );
+#else
+    useLevels = false;
+#endif
+    if ( !useLevels ) {
+      for ( int k = 0; k < numRows; ++k )
+        RowOp ( Upper ? numRows - 1 - k : k );
+      return;
+    }
+
+    const int * const levelRows = Upper ? &upperLevelRows[0] : &lowerLevelRows[0];
+    for ( int level = 0; level < numLevels; ++level ) {
+      const int levelBegin = levelPointer[level], levelEnd = levelPointer[level + 1];
+#ifdef _OPENMP
+#pragma omp parallel for if ( levelEnd - levelBegin >= MinRowsPerParallelLevel )
+#endif
+      for ( int l = levelBegin; l < levelEnd; ++l )
+        RowOp ( levelRows[l] );
+    }
+  }
+
+  void permute ( const Vector<RealType> &Arg, std::vector<RealType> &Dest ) const {
+    const int numRows = getNumRows();
+    Dest.resize ( numRows );
+#ifdef _OPENMP
+#pragma omp parallel for if ( numRows >= ( 1 << 14 ) )
+#endif
+    for ( int i = 0; i < numRows; ++i )
+      Dest[i] = Arg[perm[i]];
+  }
+
+  void permuteBack ( const std::vector<RealType> &Arg, Vector<RealType> &Dest ) const {
+    const int numRows = getNumRows();
+#ifdef _OPENMP
+#pragma omp parallel for if ( numRows >= ( 1 << 14 ) )
+#endif
+    for ( int i = 0; i < numRows; ++i )
+      Dest[perm[i]] = Arg[i];
+  }
+
+protected:
+  //! Stable counting sort of the indices 0, ..., Key.size() - 1 by Key, optionally returns where each key starts.
+  static void groupByKey ( const std::vector<int> &Key, const int NumKeys, std::vector<int> &Indices, std::vector<int> *KeyPointer = NULL ) {
+    std::vector<int> start ( NumKeys + 1, 0 );
+    for ( unsigned int i = 0; i < Key.size(); ++i )
+      ++start[Key[i] + 1];
+    for ( int k = 0; k < NumKeys; ++k )
+      start[k + 1] += start[k];
+    if ( KeyPointer )
+      *KeyPointer = start;
+    Indices.resize ( Key.size() );
+    for ( unsigned int i = 0; i < Key.size(); ++i )
+      Indices[start[Key[i]]++] = i;
+  }
+};
+
+
+/** \brief SSOR preconditioner whose triangular sweeps run in parallel (if compiled with OpenMP).
+ *
+ *  With LEVEL_SCHEDULED_ORDERING, this is the same operator as SSORPreconditioner< aol::Vector<RealType>, MatrixType >,
+ *  with MULTICOLOR_ORDERING it is SSOR for the matrix with the unknowns reordered by color. The matrix is copied in
+ *  the constructor, so any matrix that supports makeRowEntries can be used, but the preconditioner has to be
+ *  recreated if the matrix is changed. Can be passed to PCGInverse, PBiCGStabInverse etc. like the sequential
+ *  preconditioners.
+ *  \author Berkels
+ *  \ingroup solver
+ */
+template <typename RealType>
+class ParallelSSORPreconditioner : public Op<aol::Vector<RealType> > {
+protected:
+  const ParallelSweepMatrix<RealType> _mat;
+  const RealType _omega;
+
+  //! Diagonal entries with absolute value below 1e-20 are replaced by 1, like SSORPreconditioner does with CHECK_ZERO_DIAG.
+  static RealType getDiagonal ( const ParallelSweepMatrix<RealType> &Mat, const int I ) {
+    const RealType diag = Mat.value[Mat.diagonalPosition[I]];
+    return ( Abs ( diag ) < 1e-20 ) ? aol::ZOTrait<RealType>::one : diag;
+  }
+
+  //! Solves row i of (D + omega L) y = b, x holds b on entry.
+  struct ForwardRow {
+    const ParallelSweepMatrix<RealType> &mat;
+    const RealType omega;
+    RealType * const x;
+    ForwardRow ( const ParallelSweepMatrix<RealType> &Mat, const RealType Omega, RealType * const X ) : mat ( Mat ), omega ( Omega ), x ( X ) {}
+    void operator() ( const int I ) const {
+      RealType v = 0;
+      for ( int k = mat.rowPointer[I]; k < mat.diagonalPosition[I]; ++k )
+        v += mat.value[k] * x[mat.columnIndex[k]];
+      x[I] = ( x[I] - omega * v ) / getDiagonal ( mat, I );
+    }
+  };
+
+  //! Solves row i of (D + omega U) x = D y, x holds y on entry.
+  struct BackwardRow {
+    const ParallelSweepMatrix<RealType> &mat;
+    const RealType omega;
+    RealType * const x;
+    BackwardRow ( const ParallelSweepMatrix<RealType> &Mat, const RealType Omega, RealType * const X ) : mat ( Mat ), omega ( Omega ), x ( X ) {}
+    void operator() ( const int I ) const {
+      RealType v = 0;
+      for ( int k = mat.diagonalPosition[I] + 1; k < mat.rowPointer[I + 1]; ++k )
+        v += mat.value[k] * x[mat.columnIndex[k]];
+      const RealType diag = getDiagonal ( mat, I );
+      x[I] = ( diag * x[I] - omega * v ) / diag;
+    }
+  };
+
+public:
+  template <typename MatrixType>
+  explicit ParallelSSORPreconditioner ( const MatrixType &Matrix, const RealType Omega = 1.2, const ParallelSweepOrdering Ordering = LEVEL_SCHEDULED_ORDERING )
+    : _mat ( Matrix, Ordering ), _omega ( Omega ) {}
+
+  virtual void applyAdd ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    aol::Vector<RealType> tmp ( Dest.size() );
+    apply ( Arg, tmp );
+    Dest += tmp;
+  }
+
+  virtual void apply ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    if ( _mat.getNumRows() == 0 )
+      return;
+    std::vector<RealType> x;
+    _mat.permute ( Arg, x );
+    _mat.template sweep<false> ( ForwardRow ( _mat, _omega, &x[0] ) );
+    _mat.template sweep<true> ( BackwardRow ( _mat, _omega, &x[0] ) );
+    _mat.permuteBack ( x, Dest );
+  }
+};
+
+
+/** \brief ILU(0) preconditioner whose factorization and triangular solves run in parallel (if compiled with OpenMP).
+ *
+ *  With LEVEL_SCHEDULED_ORDERING, this is the same operator as ILU0Preconditioner (for a matrix without explicitly
+ *  stored zeros, which would allow fill-in at their positions), with MULTICOLOR_ORDERING it is the ILU(0)
+ *  decomposition of the matrix with the unknowns reordered by color. Since ILU(0) does not create fill-in, the
+ *  factorization of a row only depends on the rows of its lower triangular part and uses the same schedule as the
+ *  forward substitution.
+ *  \author Berkels
+ *  \ingroup solver
+ */
+template <typename RealType>
+class ParallelILU0Preconditioner : public Op<aol::Vector<RealType> > {
+protected:
+  ParallelSweepMatrix<RealType> _decomp;
+
+  //! Rowwise elimination of row i, only left from the diagonal. Marks zero pivots instead of throwing, since the rows may be processed in a parallel region.
+  struct FactorizeRow {
+    ParallelSweepMatrix<RealType> &decomp;
+    bool * const zeroPivot;
+    FactorizeRow ( ParallelSweepMatrix<RealType> &Decomp, bool * const ZeroPivot ) : decomp ( Decomp ), zeroPivot ( ZeroPivot ) {}
+    void operator() ( const int I ) const {
+      const std::vector<int> &rowPointer = decomp.rowPointer, &columnIndex = decomp.columnIndex, &diagonalPosition = decomp.diagonalPosition;
+      std::vector<RealType> &value = decomp.value;
+      for ( int ik = rowPointer[I]; ik < diagonalPosition[I]; ++ik ) {
+        const int k = columnIndex[ik];
+        if ( value[diagonalPosition[k]] == aol::ZOTrait<RealType>::zero ) {
+#ifdef _OPENMP
+#pragma omp critical ( aol_ParallelILU0Preconditioner_zeroPivot )
+#endif
+          *zeroPivot = true;
+          return;
+        }
+        // Eliminate index ik, store factor
+        value[ik] /= value[diagonalPosition[k]];
+        // Only right from the current column, entries that are zero in row i are skipped
+        int kj = diagonalPosition[k] + 1;
+        for ( int ij = ik + 1; ij < rowPointer[I + 1]; ++ij ) {
+          while ( ( kj < rowPointer[k + 1] ) && ( columnIndex[kj] < columnIndex[ij] ) )
+            ++kj;
+          if ( kj == rowPointer[k + 1] )
+            break;
+          if ( columnIndex[kj] == columnIndex[ij] )
+            value[ij] -= value[ik] * value[kj];
+        }
+      }
+    }
+  };
+
+  //! Forwards-substitution for row i
+  struct ForwardRow {
+    const ParallelSweepMatrix<RealType> &decomp;
+    RealType * const x;
+    ForwardRow ( const ParallelSweepMatrix<RealType> &Decomp, RealType * const X ) : decomp ( Decomp ), x ( X ) {}
+    void operator() ( const int I ) const {
+      RealType sum = 0;
+      for ( int k = decomp.rowPointer[I]; k < decomp.diagonalPosition[I]; ++k )
+        sum += x[decomp.columnIndex[k]] * decomp.value[k];
+      x[I] -= sum;
+    }
+  };
+
+  //! Backwards-substitution for row i
+  struct BackwardRow {
+    const ParallelSweepMatrix<RealType> &decomp;
+    RealType * const x;
+    BackwardRow ( const ParallelSweepMatrix<RealType> &Decomp, RealType * const X ) : decomp ( Decomp ), x ( X ) {}
+    void operator() ( const int I ) const {
+      RealType sum = 0;
+      for ( int k = decomp.diagonalPosition[I] + 1; k < decomp.rowPointer[I + 1]; ++k )
+        sum += x[decomp.columnIndex[k]] * decomp.value[k];
+      x[I] -= sum;
+      x[I] /= decomp.value[decomp.diagonalPosition[I]];
+    }
+  };
+
+public:
+  template <typename MatrixType>
+  explicit ParallelILU0Preconditioner ( const MatrixType &Matrix, const ParallelSweepOrdering Ordering = LEVEL_SCHEDULED_ORDERING )
+    : _decomp ( Matrix, Ordering ) {
+    bool zeroPivot = false;
+    _decomp.template sweep<false> ( FactorizeRow ( _decomp, &zeroPivot ) );
+    if ( zeroPivot )
+      throw Exception ( "Pivot zero in ILU", __FILE__, __LINE__ );
+  }
+
+  virtual void applyAdd ( const Vector<RealType> &Arg, Vector<RealType> &Dest ) const {
+    Vector<RealType> tmp ( Dest.size() );
+    apply ( Arg, tmp );
+    Dest += tmp;
+  }
+
+  virtual void apply ( const Vector<RealType> &Arg, Vector<RealType> &Dest ) const {
+    if ( _decomp.getNumRows() == 0 )
+      return;
+    std::vector<RealType> x;
+    _decomp.permute ( Arg, x );
+    _decomp.template sweep<false> ( ForwardRow ( _decomp, &x[0] ) );
+    _decomp.template sweep<true> ( BackwardRow ( _decomp, &x[0] ) );
+    _decomp.permuteBack ( x, Dest );
+  }
+};
+
 template <typename RealType, typename BlockMatrixType>
 class ILU0BlockPreconditioner : public Op<aol::MultiVector<RealType> > {
 
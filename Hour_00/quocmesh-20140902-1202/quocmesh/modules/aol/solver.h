@@ -164,14 +164,8 @@ public:
 
     this->_op.apply ( Dest, h );
 
-    //! \todo think about whether it makes sense to write a method for
-    //!       aol::{Multi}Vector to set vector to linear combination
-    //!       of h and arg to avoid double loop
-    r = h;
-    r -= Arg;
-
-    p = Arg;
-    p -= h;
+    r.setSum ( h, Arg, -1 );
+    p.setSum ( Arg, h, -1 );
 
     spn = r * r;
 
@@ -183,8 +177,7 @@ public:
       // case starting with second iteration
       if ( this->_infoPtr->getIterationCount() > 1 ) {
         const DataType e = spn / spa;
-        p *= e;
-        p -= r;
+        p.scaleAndAddMultiple ( e, r, -1 );
       }
 
       // basic iteration step
@@ -193,13 +186,10 @@ public:
       quad = p * h;
       q    = spn / quad;
 
-      Dest.addMultiple ( p, q );
-      r.addMultiple ( h, q );
-
       spa = spn;
 
-      // compute new residuum
-      spn = r * r;
+      // update solution and residuum and compute the new residuum norm in one pass
+      spn = r.addMultipleAndNormSqr ( h, q, Dest, p, q );
 
       this->_infoPtr->finishStep ( spn );
     }
@@ -286,12 +276,15 @@ public:
     this->_infoPtr->getOstream() << "h*h " << h*h << endl;
 #endif
 
+    beta_numer = g * h;
+
     this->_infoPtr->startIterations ( Arg.normSqr(), spn, "p-cg", "l_2 norm ^2" );
 
     while ( ! ( this->_infoPtr->stoppingCriterionIsFulfilled() ) && ! ( this->_infoPtr->maxIterIsReached() ) && ! ( this->_infoPtr->currentResidualIsNaN() ) ) {
       this->_infoPtr->startStep();
 
-      beta_denom = alpha_numer = g * h;
+      // g and h did not change since beta_numer was computed.
+      beta_denom = alpha_numer = beta_numer;
 
 #ifdef VERBOSE
       this->_infoPtr->getOstream() << "beta_denom = " << beta_denom << endl
@@ -307,9 +300,7 @@ public:
       << "alpha_denom = " << alpha_denom << endl;
 #endif
 
-      Dest.addMultiple ( d, alpha_numer / alpha_denom );
-
-      g.addMultiple ( h, alpha_numer / alpha_denom );
+      spn = g.addMultipleAndNormSqr ( h, alpha_numer / alpha_denom, Dest, d, alpha_numer / alpha_denom );
 
 #ifdef VERBOSE
       this->_infoPtr->getOstream() << "g * g = " << g*g << endl;
@@ -324,14 +315,12 @@ public:
       << "beta_numer = " << beta_numer << endl;
 #endif
 
-      d *= ( beta_numer / beta_denom );
-      d -= h;
+      d.scaleAndAddMultiple ( beta_numer / beta_denom, h, -1 );
 
 #ifdef VERBOSE
       this->_infoPtr->getOstream() << "d * d = " << d*d << endl;
 #endif
 
-      spn = g * g;
 #ifdef VERBOSE
       VectorType dummy ( Arg, aol::STRUCT_COPY );
       this->_op.apply ( Dest, dummy );
@@ -419,10 +408,8 @@ public:
       } else {
         beta = rho_new / rho_old;
 
-        p  *= beta;
-        p  += r;
-        pt *= beta;
-        pt += rt;
+        p.scaleAndAdd ( beta, r );
+        pt.scaleAndAdd ( beta, rt );
       }
       this->_op.apply ( p, q );
 
@@ -432,10 +419,7 @@ public:
 
       MDest.addMultiple ( p, alpha );
 
-      r.addMultiple ( q, -alpha );
-      rt.addMultiple ( qt, -alpha );
-
-      DataType resSqr =  r * r;
+      const DataType resSqr = r.addMultipleAndNormSqr ( q, -alpha, rt, qt, -alpha );
 
       rho_old = rho_new;
       this->_infoPtr->finishStep ( resSqr );
@@ -526,10 +510,8 @@ public:
       } else {
         beta = rho_new / rho_old;
 
-        p  *= beta;
-        p  += z;
-        pt *= beta;
-        pt += zt;
+        p.scaleAndAdd ( beta, z );
+        pt.scaleAndAdd ( beta, zt );
       }
 
       this->_op.apply ( p, q );
@@ -540,13 +522,10 @@ public:
 
       MDest.addMultiple ( p, alpha );
 
-      r.addMultiple ( q, -alpha );
-      rt.addMultiple ( qt, -alpha );
+      const DataType resSqr = r.addMultipleAndNormSqr ( q, -alpha, rt, qt, -alpha );
 
       rho_old = rho_new;
 
-      DataType resSqr =  r * r;
-
       this->_infoPtr->finishStep ( resSqr );
     }
 
@@ -625,8 +604,7 @@ public:
         beta = ( rho1 / rho2 ) * ( alpha / omega );
         // p = r + beta * (p - omega * v);
         p.addMultiple ( v, -omega );
-        p *= beta;
-        p += r;
+        p.scaleAndAdd ( beta, r );
       }
 
       _approxInverseOp.apply ( p, phat );
@@ -634,8 +612,7 @@ public:
 
       alpha = rho1 / ( rtilde * v );
       // s = r - alpha(0) * v;
-      s = r;
-      s.addMultiple ( v, -alpha );
+      s.setSum ( r, v, -alpha );
       residSqr = s.normSqr ();
       this->_infoPtr->setCurrentResidual ( residSqr );
       if ( this->_infoPtr->stoppingCriterionIsFulfilled() ) {
@@ -649,8 +626,7 @@ public:
       omega = ( t * s ) / ( t * t );
       MDest.addMultiple ( phat, alpha );
       MDest.addMultiple ( shat, omega );
-      r = s;
-      r.addMultiple ( t, -omega );
+      r.setSum ( s, t, -omega );
 
       rho2 = rho1;
 
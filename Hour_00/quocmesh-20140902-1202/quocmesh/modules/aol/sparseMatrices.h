@@ -1802,6 +1802,30 @@ protected:
     }
   }
 
+  void setFromGenSparseMatrix ( const GenSparseMatrix<DataType> &Mat ) {
+    std::vector<IndexType> index;
+    std::vector<DataType> value;
+    vector<typename Row<DataType>::RowEntry> rowEntries;
+
+    this->_indPointer.resize ( this->getNumRows () + 1 );
+    this->_indPointer[0] = static_cast<IndexType> ( 0 );
+    for ( int row = 0; row < this->getNumRows (); ++row ) {
+      Mat.makeRowEntries ( rowEntries, row );
+      for ( unsigned int j = 0; j < rowEntries.size (); ++j ) {
+        index.push_back ( static_cast<IndexType> ( rowEntries[j].col ) );
+        value.push_back ( rowEntries[j].value );
+      }
+      this->_indPointer[row + 1] = static_cast<IndexType> ( index.size () );
+    }
+
+    this->_index.resize ( static_cast<int> ( index.size () ) );
+    this->_value.resize ( static_cast<int> ( value.size () ) );
+    for ( unsigned int j = 0; j < index.size (); ++j ) {
+      this->_index[j] = index[j];
+      this->_value[j] = value[j];
+    }
+  }
+
 public:
   //! \brief Constructor taking the number of rows and columns.
   CSRMatrix ( IndexType numRows, IndexType numCols )
@@ -1826,6 +1850,16 @@ public:
     setFromTriplet ( tripletMatrix );
   }
 
+  /** \brief Constructor that "freezes" a row-wise stored sparse matrix into the compressed row format.
+   *
+   * The entries of each row are stored in the order given by makeRowEntries, so for aol::SparseMatrix,
+   * apply and applyAdd give exactly the same results as on Mat. Later changes to Mat are not reflected.
+   */
+  explicit CSRMatrix ( const GenSparseMatrix<DataType> &Mat )
+  : CSMatrix<DataType, IndexType> ( Mat.getNumRows (), Mat.getNumCols () ) {
+    setFromGenSparseMatrix ( Mat );
+  }
+
   //! \brief Destructor.
   virtual ~CSRMatrix () {}
 
@@ -1924,24 +1958,12 @@ public:
 
   //! \brief applyAdd method.
   virtual void applyAdd ( const aol::Vector<DataType> &arg, aol::Vector<DataType> &dest ) const {
-    // Traverse the matrix row-wise.
-    for ( int row = 0; row < this->getNumRows (); ++row ) {
-      for ( IndexType j = this->_indPointer[row]; j < this->_indPointer[row + 1]; ++j ) {
-        dest[row] += ( this->_value[j] * arg[this->_index[j]] );
-      }
-    }
+    multiply<true> ( arg, dest );
   }
 
   //! \brief apply method.
   virtual void apply ( const aol::Vector<DataType> &arg, aol::Vector<DataType> &dest ) const {
-    // Traverse the matrix row-wise.
-    for ( int row = 0; row < this->getNumRows (); ++row ) {
-      DataType s = static_cast<DataType> ( 0 );
-      for ( IndexType j = this->_indPointer[row]; j < this->_indPointer[row + 1]; ++j ) {
-        s += ( this->_value[j] * arg[this->_index[j]] );
-      }
-      dest[row] = s;
-    }
+    multiply<false> ( arg, dest );
   }
 
   void applyAdd ( const aol::MultiVector<DataType> &arg, aol::MultiVector<DataType> &dest ) const {
@@ -1974,6 +1996,43 @@ public:
   const aol::Vector<DataType>& getValueReference () const {
     return this->_value;
   }
+
+protected:
+  //! Traverses the matrix row-wise, in parallel if the matrix is large enough to pay off.
+  template <bool Add>
+  void multiply ( const aol::Vector<DataType> &arg, aol::Vector<DataType> &dest ) const {
+    if ( this->getNumRows () != dest.size () || this->getNumCols () != arg.size () ) {
+      string msg = strprintf ( "aol::CSRMatrix::apply: Cannot apply %d by %d matrix from vector of size %d to vector of size %d.", this->getNumRows (), this->getNumCols (), arg.size (), dest.size () );
+      throw ( Exception ( msg, __FILE__, __LINE__ ) );
+    }
+
+    // After setZero, there are no row pointers.
+    if ( this->_indPointer.size () == 0 ) {
+      if ( !Add )
+        dest.setZero ();
+      return;
+    }
+
+    const IndexType *indPointer = this->_indPointer.getData ();
+    const IndexType *index = this->_index.getData ();
+    const DataType *value = this->_value.getData ();
+    const DataType *argData = arg.getData ();
+    DataType *destData = dest.getData ();
+    const int numRows = this->getNumRows ();
+
+#ifdef _OPENMP
+#pragma omp parallel for if ( indPointer[numRows] >= ( 1 << 16 ) )
+#endif
+    for ( int row = 0; row < numRows; ++row ) {
+      DataType s = static_cast<DataType> ( 0 );
+      for ( IndexType j = indPointer[row]; j < indPointer[row + 1]; ++j )
+        s += value[j] * argData[index[j]];
+      if ( Add )
+        destData[row] += s;
+      else
+        destData[row] = s;
+    }
+  }
 };
 
 }
@@ -5,6 +5,10 @@
 #include <multiVector.h>
 #include <bzipiostream.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace aol {
 template <class T> const T aol::OverflowTrait<T>::max = static_cast<T> ( 255 );
 
@@ -26,6 +30,11 @@ template struct aol::OverflowTrait<int64_t>;
 
 namespace {
 
+/* BLAS-1 kernels on raw arrays. The SSE versions accumulate sums in the same order as the SSE version
+ * of ScalarProduct, so the fused kernels give exactly the same results as the corresponding sequence
+ * of unfused operations (e.g. addMultiple followed by normSqr) in all builds.
+ */
+
 template <typename DataType>
 DataType ScalarProduct ( const DataType *a, const DataType *b, const int N ) {
   DataType ret = 0;
@@ -35,64 +44,264 @@ DataType ScalarProduct ( const DataType *a, const DataType *b, const int N ) {
   return ret;
 }
 
+//! Dest += Factor * Src
+template <typename DataType>
+void AddMultiple ( DataType *Dest, const DataType *Src, const DataType Factor, const int N ) {
+  for ( int i = 0; i < N; ++i )
+    Dest[i] += Src[i] * Factor;
+}
+
+//! Dest += Factor * Src, returns the squared norm of the new Dest.
+template <typename DataType>
+DataType AddMultipleAndNormSqr ( DataType *Dest, const DataType *Src, const DataType Factor, const int N ) {
+  DataType ret = 0;
+  for ( int i = 0; i < N; ++i ) {
+    Dest[i] += Src[i] * Factor;
+    ret += Dest[i] * Dest[i];
+  }
+  return ret;
+}
+
+//! Dest += Factor * Src and Dest2 += Factor2 * Src2, returns the squared norm of the new Dest.
+template <typename DataType>
+DataType AddMultiplesAndNormSqr ( DataType *Dest, const DataType *Src, const DataType Factor,
+                                  DataType *Dest2, const DataType *Src2, const DataType Factor2, const int N ) {
+  DataType ret = 0;
+  for ( int i = 0; i < N; ++i ) {
+    Dest[i] += Src[i] * Factor;
+    Dest2[i] += Src2[i] * Factor2;
+    ret += Dest[i] * Dest[i];
+  }
+  return ret;
+}
+
 #ifdef USE_SSE
 template <>
 float ScalarProduct ( const float *a, const float *b, const int N ) {
-  float ret = 0;
-
   const int nLoop = N / 4;
+  __m128 sum = _mm_setzero_ps ();
+  for ( int i = 0; i < nLoop; ++i )
+    sum = _mm_add_ps ( _mm_mul_ps ( _mm_loadu_ps ( a + 4 * i ), _mm_loadu_ps ( b + 4 * i ) ), sum );
 
-  float *temp = static_cast< float* > ( aol::aligned_memory_allocation ( 4 * sizeof ( float ), 16 ) );
-
-  __m128 m1;
-  __m128* m2 = reinterpret_cast< __m128* > ( temp );
-  const __m128* pSrc1 = reinterpret_cast< const __m128* > ( a );
-  const __m128* pSrc2 = reinterpret_cast< const __m128* > ( b );
-  *m2 = _mm_set_ps1 ( 0.0f ); // set all four values of m2 to 0.
-  for ( int i = 0; i < nLoop; ++i ) {
-    // This code is easy to understand:
-    m1 = _mm_mul_ps ( *pSrc1, *pSrc2 );       // *pDest = *pSrc1 * *pSrc2
-    *m2 = _mm_add_ps ( m1, *m2 );
-
-    pSrc1++;
-    pSrc2++;
-  }
-  ret = ( temp[0] + temp[1] + temp[2] + temp[3] );
+  float temp[4];
+  _mm_storeu_ps ( temp, sum );
+  float ret = ( temp[0] + temp[1] + temp[2] + temp[3] );
   for ( int i = 4 * nLoop ; i < N ; ++i ) {
     ret += a[i] * b[i];
   }
-  aol::aligned_memory_deallocation ( temp );
   return ret;
 }
 
 template <>
 double ScalarProduct ( const double *a, const double *b, const int N ) {
-  double ret = 0;
+  const int nLoop = N / 2;
+  __m128d sum = _mm_setzero_pd ();
+  for ( int i = 0; i < nLoop; ++i )
+    sum = _mm_add_pd ( _mm_mul_pd ( _mm_loadu_pd ( a + 2 * i ), _mm_loadu_pd ( b + 2 * i ) ), sum );
 
+  double temp[2];
+  _mm_storeu_pd ( temp, sum );
+  double ret = ( temp[0] + temp[1] );
+  for ( int i = 2 * nLoop ; i < N ; ++i ) {
+    ret += a[i] * b[i];
+  }
+  return ret;
+}
+
+template <>
+void AddMultiple ( float *Dest, const float *Src, const float Factor, const int N ) {
+  const int nLoop = N / 4;
+  const __m128 factor = _mm_set_ps1 ( Factor );
+  for ( int i = 0; i < nLoop; ++i )
+    _mm_storeu_ps ( Dest + 4 * i, _mm_add_ps ( _mm_loadu_ps ( Dest + 4 * i ), _mm_mul_ps ( _mm_loadu_ps ( Src + 4 * i ), factor ) ) );
+  for ( int i = 4 * nLoop; i < N; ++i )
+    Dest[i] += Src[i] * Factor;
+}
+
+template <>
+void AddMultiple ( double *Dest, const double *Src, const double Factor, const int N ) {
   const int nLoop = N / 2;
+  const __m128d factor = _mm_set1_pd ( Factor );
+  for ( int i = 0; i < nLoop; ++i )
+    _mm_storeu_pd ( Dest + 2 * i, _mm_add_pd ( _mm_loadu_pd ( Dest + 2 * i ), _mm_mul_pd ( _mm_loadu_pd ( Src + 2 * i ), factor ) ) );
+  for ( int i = 2 * nLoop; i < N; ++i )
+    Dest[i] += Src[i] * Factor;
+}
 
-  double *temp = static_cast< double* > ( aol::aligned_memory_allocation ( 2 * sizeof ( double ), 16 ) );
-  __m128d m1;
-  __m128d* m2 = reinterpret_cast< __m128d* > ( temp );
-  const __m128d* pSrc1 = reinterpret_cast< const __m128d* > ( a );
-  const __m128d* pSrc2 = reinterpret_cast< const __m128d* > ( b );
-  *m2 = _mm_setzero_pd ();  // set both values of m2 to 0.
+template <>
+float AddMultipleAndNormSqr ( float *Dest, const float *Src, const float Factor, const int N ) {
+  const int nLoop = N / 4;
+  const __m128 factor = _mm_set_ps1 ( Factor );
+  __m128 sum = _mm_setzero_ps ();
   for ( int i = 0; i < nLoop; ++i ) {
-    // This code is easy to understand:
-    m1 = _mm_mul_pd ( *pSrc1, *pSrc2 );       // *pDest = *pSrc1 * *pSrc2
-    *m2 = _mm_add_pd ( m1, *m2 );
+    const __m128 dest = _mm_add_ps ( _mm_loadu_ps ( Dest + 4 * i ), _mm_mul_ps ( _mm_loadu_ps ( Src + 4 * i ), factor ) );
+    _mm_storeu_ps ( Dest + 4 * i, dest );
+    sum = _mm_add_ps ( _mm_mul_ps ( dest, dest ), sum );
+  }
 
-    pSrc1++;
-    pSrc2++;
+  float temp[4];
+  _mm_storeu_ps ( temp, sum );
+  float ret = ( temp[0] + temp[1] + temp[2] + temp[3] );
+  for ( int i = 4 * nLoop; i < N; ++i ) {
+    Dest[i] += Src[i] * Factor;
+    ret += Dest[i] * Dest[i];
   }
-  ret = ( temp[0] + temp[1] );
-  for ( int i = 2 * nLoop ; i < N ; ++i ) {
-    ret += a[i] * b[i];
+  return ret;
+}
+
+template <>
+double AddMultipleAndNormSqr ( double *Dest, const double *Src, const double Factor, const int N ) {
+  const int nLoop = N / 2;
+  const __m128d factor = _mm_set1_pd ( Factor );
+  __m128d sum = _mm_setzero_pd ();
+  for ( int i = 0; i < nLoop; ++i ) {
+    const __m128d dest = _mm_add_pd ( _mm_loadu_pd ( Dest + 2 * i ), _mm_mul_pd ( _mm_loadu_pd ( Src + 2 * i ), factor ) );
+    _mm_storeu_pd ( Dest + 2 * i, dest );
+    sum = _mm_add_pd ( _mm_mul_pd ( dest, dest ), sum );
+  }
+
+  double temp[2];
+  _mm_storeu_pd ( temp, sum );
+  double ret = ( temp[0] + temp[1] );
+  for ( int i = 2 * nLoop; i < N; ++i ) {
+    Dest[i] += Src[i] * Factor;
+    ret += Dest[i] * Dest[i];
+  }
+  return ret;
+}
+
+template <>
+float AddMultiplesAndNormSqr ( float *Dest, const float *Src, const float Factor,
+                               float *Dest2, const float *Src2, const float Factor2, const int N ) {
+  const int nLoop = N / 4;
+  const __m128 factor = _mm_set_ps1 ( Factor ), factor2 = _mm_set_ps1 ( Factor2 );
+  __m128 sum = _mm_setzero_ps ();
+  for ( int i = 0; i < nLoop; ++i ) {
+    const __m128 dest = _mm_add_ps ( _mm_loadu_ps ( Dest + 4 * i ), _mm_mul_ps ( _mm_loadu_ps ( Src + 4 * i ), factor ) );
+    _mm_storeu_ps ( Dest + 4 * i, dest );
+    _mm_storeu_ps ( Dest2 + 4 * i, _mm_add_ps ( _mm_loadu_ps ( Dest2 + 4 * i ), _mm_mul_ps ( _mm_loadu_ps ( Src2 + 4 * i ), factor2 ) ) );
+    sum = _mm_add_ps ( _mm_mul_ps ( dest, dest ), sum );
+  }
+
+  float temp[4];
+  _mm_storeu_ps ( temp, sum );
+  float ret = ( temp[0] + temp[1] + temp[2] + temp[3] );
+  for ( int i = 4 * nLoop; i < N; ++i ) {
+    Dest[i] += Src[i] * Factor;
+    Dest2[i] += Src2[i] * Factor2;
+    ret += Dest[i] * Dest[i];
   }
-  aol::aligned_memory_deallocation ( temp );
   return ret;
 }
+
+template <>
+double AddMultiplesAndNormSqr ( double *Dest, const double *Src, const double Factor,
+                                double *Dest2, const double *Src2, const double Factor2, const int N ) {
+  const int nLoop = N / 2;
+  const __m128d factor = _mm_set1_pd ( Factor ), factor2 = _mm_set1_pd ( Factor2 );
+  __m128d sum = _mm_setzero_pd ();
+  for ( int i = 0; i < nLoop; ++i ) {
+    const __m128d dest = _mm_add_pd ( _mm_loadu_pd ( Dest + 2 * i ), _mm_mul_pd ( _mm_loadu_pd ( Src + 2 * i ), factor ) );
+    _mm_storeu_pd ( Dest + 2 * i, dest );
+    _mm_storeu_pd ( Dest2 + 2 * i, _mm_add_pd ( _mm_loadu_pd ( Dest2 + 2 * i ), _mm_mul_pd ( _mm_loadu_pd ( Src2 + 2 * i ), factor2 ) ) );
+    sum = _mm_add_pd ( _mm_mul_pd ( dest, dest ), sum );
+  }
+
+  double temp[2];
+  _mm_storeu_pd ( temp, sum );
+  double ret = ( temp[0] + temp[1] );
+  for ( int i = 2 * nLoop; i < N; ++i ) {
+    Dest[i] += Src[i] * Factor;
+    Dest2[i] += Src2[i] * Factor2;
+    ret += Dest[i] * Dest[i];
+  }
+  return ret;
+}
+#endif
+
+/* Apply the kernels block by block. With OpenMP, long vectors are processed in parallel (unless we are already
+ * in a parallel region). The partial sums are always formed over the same blocks and added in the same order,
+ * so the results do not depend on the number of threads.
+ */
+const int BLAS1BlockSize = 1 << 13;
+const int BLAS1ParallelThreshold = 1 << 16;
+
+bool useParallelBLAS1 ( const int N ) {
+#ifdef _OPENMP
+  return ( N >= BLAS1ParallelThreshold ) && !omp_in_parallel();
+#else
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( N );
+  return false;
+#endif
+}
+
+//! KernelType needs to provide DataType operator() ( const int Begin, const int End ) const.
+template <typename DataType, typename KernelType>
+DataType reduceBlockwise ( const KernelType &Kernel, const int N ) {
+  if ( useParallelBLAS1 ( N ) == false )
+    return Kernel ( 0, N );
+
+  const int numBlocks = ( N + BLAS1BlockSize - 1 ) / BLAS1BlockSize;
+  std::vector<DataType> partialSums ( numBlocks );
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static )
 #endif
+  for ( int i = 0; i < numBlocks; ++i )
+    partialSums[i] = Kernel ( i * BLAS1BlockSize, aol::Min ( N, ( i + 1 ) * BLAS1BlockSize ) );
+
+  DataType ret = 0;
+  for ( int i = 0; i < numBlocks; ++i )
+    ret += partialSums[i];
+  return ret;
+}
+
+template <typename DataType>
+class ScalarProductKernel {
+  const DataType *_a, *_b;
+public:
+  ScalarProductKernel ( const DataType *A, const DataType *B ) : _a ( A ), _b ( B ) {}
+  DataType operator() ( const int Begin, const int End ) const {
+    return ScalarProduct<DataType> ( _a + Begin, _b + Begin, End - Begin );
+  }
+};
+
+template <typename DataType>
+class AddMultipleKernel {
+  DataType *_dest;
+  const DataType *_src;
+  const DataType _factor;
+public:
+  AddMultipleKernel ( DataType *Dest, const DataType *Src, const DataType Factor ) : _dest ( Dest ), _src ( Src ), _factor ( Factor ) {}
+  DataType operator() ( const int Begin, const int End ) const {
+    AddMultiple<DataType> ( _dest + Begin, _src + Begin, _factor, End - Begin );
+    return 0;
+  }
+};
+
+template <typename DataType>
+class AddMultipleAndNormSqrKernel {
+  DataType *_dest;
+  const DataType *_src;
+  const DataType _factor;
+public:
+  AddMultipleAndNormSqrKernel ( DataType *Dest, const DataType *Src, const DataType Factor ) : _dest ( Dest ), _src ( Src ), _factor ( Factor ) {}
+  DataType operator() ( const int Begin, const int End ) const {
+    return AddMultipleAndNormSqr<DataType> ( _dest + Begin, _src + Begin, _factor, End - Begin );
+  }
+};
+
+template <typename DataType>
+class AddMultiplesAndNormSqrKernel {
+  DataType *_dest, *_dest2;
+  const DataType *_src, *_src2;
+  const DataType _factor, _factor2;
+public:
+  AddMultiplesAndNormSqrKernel ( DataType *Dest, const DataType *Src, const DataType Factor, DataType *Dest2, const DataType *Src2, const DataType Factor2 )
+    : _dest ( Dest ), _dest2 ( Dest2 ), _src ( Src ), _src2 ( Src2 ), _factor ( Factor ), _factor2 ( Factor2 ) {}
+  DataType operator() ( const int Begin, const int End ) const {
+    return AddMultiplesAndNormSqr<DataType> ( _dest + Begin, _src + Begin, _factor, _dest2 + Begin, _src2 + Begin, _factor2, End - Begin );
+  }
+};
 
 } // end namespace
 
@@ -291,7 +500,9 @@ void aol::Vector<_DataType>::saveRaw ( ostream &out, const qc::SaveType type, co
 
   DataType maximum = Maximum;
 
-  if ( ( type == qc::PGM_UNSIGNED_CHAR_BINARY || type == qc::PGM_UNSIGNED_SHORT_BINARY ) && Maximum == 0 ) {
+  const bool scaleToUnsignedShort = ( typeid ( DataType ) != typeid ( unsigned short ) );
+
+  if ( ( type == qc::PGM_UNSIGNED_CHAR_BINARY || ( type == qc::PGM_UNSIGNED_SHORT_BINARY && scaleToUnsignedShort ) ) && Maximum == 0 ) {
     cerr << "Cannot scale image to a maximum of 0, scaling to 1 instead.\n";
     // This is necessary to write complete black images
     maximum = 1;
@@ -325,31 +536,32 @@ void aol::Vector<_DataType>::saveRaw ( ostream &out, const qc::SaveType type, co
     }
     break;
 
-    case qc::PGM_FLOAT_BINARY: {
-      if ( sizeof ( float ) == sizeof ( DataType ) ) {
-        out.write ( reinterpret_cast<char *> ( this->_pData ), this->_size * sizeof ( float ) );
-      } else {
-        float * buffer = new float[this->_size];
-        for ( i = 0; i < this->_size; ++i ) buffer[i] =  static_cast<float> ( this->_pData[i] );
-        out.write ( reinterpret_cast<char *> ( buffer ), this->_size * sizeof ( float ) );
-        delete[] buffer;
-      }
-    }
-    break;
+    case qc::PGM_FLOAT_BINARY:
+      aol::writeBinaryData<DataType, float> ( this->_pData, this->_size, out );
+      break;
 
-    case qc::PGM_DOUBLE_BINARY: {
-      if ( sizeof ( double ) == sizeof ( DataType ) ) {
-        out.write ( reinterpret_cast<char *> ( this->_pData ), this->_size * sizeof ( double ) );
-      } else {
-        double * buffer = new double[this->_size];
-        for ( i = 0; i < this->_size; ++i ) buffer[i] =  static_cast<double> ( this->_pData[i] );
-        out.write ( reinterpret_cast<char *> ( buffer ), this->_size * sizeof ( double ) );
-        delete[] buffer;
-      }
-    }
-    break;
+    case qc::PGM_DOUBLE_BINARY:
+      aol::writeBinaryData<DataType, double> ( this->_pData, this->_size, out );
+      break;
+
+    case qc::PGM_SHORT_BINARY:
+      aol::writeBinaryData<DataType, int16_t> ( this->_pData, this->_size, out );
+      break;
+
+    case qc::PGM_UNSIGNED_INT_BINARY:
+      aol::writeBinaryData<DataType, uint32_t> ( this->_pData, this->_size, out );
+      break;
+
+    case qc::PGM_SIGNED_INT_BINARY:
+      aol::writeBinaryData<DataType, int32_t> ( this->_pData, this->_size, out );
+      break;
 
     case qc::PGM_UNSIGNED_SHORT_BINARY: {
+      // Unsigned short data is saved directly, other data is scaled to [0,65535].
+      if ( !scaleToUnsignedShort ) {
+        out.write ( reinterpret_cast<char*> ( this->_pData ), this->_size * sizeof ( unsigned short ) );
+        break;
+      }
       bool flag = false;
       unsigned short *buffer = new unsigned short[this->_size];
       for ( i = 0; i < this->_size; ++i ) {
@@ -378,7 +590,7 @@ void aol::Vector<_DataType>::saveRaw ( ostream &out, const qc::SaveType type, co
   } else {
     const aol::Bzipofstream* pOut = dynamic_cast<const aol::Bzipofstream*>(&out);
     if( pOut != NULL )
-      throw aol::Exception ( "aol::Vector<DataType>::saveRaw: Writing to aol::Bzipofstream failed. Is there enough free memory to hold the whole file?", __FILE__, __LINE__ );
+      throw aol::Exception ( "aol::Vector<DataType>::saveRaw: Writing to aol::Bzipofstream failed. Is there enough free disk space?", __FILE__, __LINE__ );
     else
       throw aol::Exception ( "aol::Vector<DataType>::saveRaw: Error writing file", __FILE__, __LINE__ );
   }
@@ -403,47 +615,22 @@ void aol::Vector<_DataType>::loadRaw ( istream &in, const int Type ) {
         in >> this->_pData[i];
       }
       break;
-    case qc::PGM_UNSIGNED_CHAR_BINARY: {
-      unsigned char *buffer = new unsigned char[this->_size];
-      in.read ( reinterpret_cast<char*> ( buffer ),  this->_size );
-      for ( int i = 0; i < this->_size; ++i ) this->_pData[i] = static_cast<DataType> ( static_cast<unsigned char> ( buffer[i] ) );
-      delete[] buffer;
-    }
-    break;
+    // The binary data is converted to DataType chunk by chunk while reading, or read directly if no conversion is needed.
+    case qc::PGM_UNSIGNED_CHAR_BINARY:
+      aol::readBinaryData<unsigned char, DataType> ( in, this->_pData, this->_size );
+      break;
     case qc::PGM_FLOAT_BINARY:
-      if ( sizeof ( float ) == sizeof ( DataType ) ) {
-        in.read ( reinterpret_cast<char*> ( this->_pData ), this->_size * sizeof ( float ) );
-      } else {
-        float *buffer = new float[ this->_size];
-        in.read ( reinterpret_cast<char*> ( buffer ),  this->_size * sizeof ( float ) );
-        for ( int i = 0; i < this->_size; ++i ) this->_pData[i] =  static_cast<DataType> ( buffer[i] );
-        delete[] buffer;
-      }
+      aol::readBinaryData<float, DataType> ( in, this->_pData, this->_size );
       break;
     case qc::PGM_DOUBLE_BINARY:
-      if ( sizeof ( double ) == sizeof ( DataType ) ) {
-        in.read ( reinterpret_cast<char*> ( this->_pData ),  this->_size * sizeof ( double ) );
-      } else {
-        double *buffer = new double[ this->_size];
-        in.read ( reinterpret_cast<char*> ( buffer ),  this->_size * sizeof ( double ) );
-        for ( int i = 0; i < this->_size; ++i ) this->_pData[i] =  static_cast<DataType> ( buffer[i] );
-        delete[] buffer;
-      }
+      aol::readBinaryData<double, DataType> ( in, this->_pData, this->_size );
       break;
-    case qc::PGM_UNSIGNED_SHORT_BINARY: {
-      unsigned short *buffer = new unsigned short[ this->_size];
-      in.read ( reinterpret_cast<char*> ( buffer ),  this->_size * sizeof ( unsigned short ) );
-      for ( int i = 0; i < this->_size; ++i ) this->_pData[i] = static_cast<DataType> ( static_cast<unsigned short> ( buffer[i] ) );
-      delete[] buffer;
+    case qc::PGM_UNSIGNED_SHORT_BINARY:
+      aol::readBinaryData<unsigned short, DataType> ( in, this->_pData, this->_size );
       break;
-    }
-    case qc::PGM_SHORT_BINARY: {
-      short *buffer = new short[ this->_size];
-      in.read ( reinterpret_cast<char*> ( buffer ),  this->_size * sizeof ( short ) );
-      for ( int i = 0; i < this->_size; ++i ) this->_pData[i] = static_cast<DataType> ( buffer[i] );
-      delete[] buffer;
+    case qc::PGM_SHORT_BINARY:
+      aol::readBinaryData<int16_t, DataType> ( in, this->_pData, this->_size );
       break;
-    }
     case qc::PGM_UNSIGNED_INT_BINARY: {
       aol::readBinaryData<uint32_t, DataType> ( in, this->_pData, this->_size );
       break;
@@ -613,7 +800,7 @@ _DataType aol::Vector<_DataType>::operator* ( const aol::Vector<_DataType> &c )
   if ( c.size() != _size ) {
     throw aol::Exception ( "Vector::operator*: Vectorlengths not equal...", __FILE__, __LINE__ );
   } else {
-    return ScalarProduct<DataType> ( this->_pData, c.getData(), _size );
+    return reduceBlockwise<DataType> ( ScalarProductKernel<DataType> ( this->_pData, c.getData() ), _size );
   }
   return 0;
 }
@@ -688,8 +875,9 @@ aol::Vector<_DataType> & aol::Vector<_DataType>::copyUnblockedFrom ( const Multi
 template <typename _DataType>
 aol::Vector<_DataType>& aol::Vector<_DataType>::operator+= ( const aol::Vector<_DataType> &Vec ) {
   if ( Vec.size() == _size ) {
+    const DataType *vecData = Vec._pData;
     for ( int i = 0; i < _size; ++i ) {
-      _pData[i] += Vec.get ( i );
+      _pData[i] += vecData[i];
     }
   } else {
     throw aol::Exception ( "aol::Vector::operator+= dimensions don't match", __FILE__, __LINE__ );
@@ -700,8 +888,9 @@ aol::Vector<_DataType>& aol::Vector<_DataType>::operator+= ( const aol::Vector<_
 template <typename _DataType>
 aol::Vector<_DataType>& aol::Vector<_DataType>::operator-= ( const aol::Vector<_DataType> &Vec ) {
   if ( Vec.size() == _size ) {
+    const DataType *vecData = Vec._pData;
     for ( int i = 0; i < _size; ++i ) {
-      _pData[i] -= Vec.get ( i );
+      _pData[i] -= vecData[i];
     }
   } else {
     throw aol::Exception ( "aol::Vector::operator-= dimensions don't match", __FILE__, __LINE__ );
@@ -761,14 +950,27 @@ aol::Vector<_DataType> & aol::Vector<_DataType>::addMultiple ( const aol::Vector
   if ( Vec.size() != _size )
     throw aol::Exception ( "aol::Vector::addMultiple(): dimensions don't match", __FILE__, __LINE__ );
 
-  DataType *ptr = _pData;
-  for ( int i = 0; i < _size; ++i ) {
-    *ptr += Vec.get ( i ) * Factor;
-    ptr++;
-  }
+  reduceBlockwise<DataType> ( AddMultipleKernel<DataType> ( _pData, Vec._pData, Factor ), _size );
   return *this;
 }
 
+template <typename _DataType>
+_DataType aol::Vector<_DataType>::addMultipleAndNormSqr ( const aol::Vector<_DataType>& Vec, _DataType Factor ) {
+  if ( Vec.size() != _size )
+    throw aol::Exception ( "aol::Vector::addMultipleAndNormSqr(): dimensions don't match", __FILE__, __LINE__ );
+
+  return reduceBlockwise<DataType> ( AddMultipleAndNormSqrKernel<DataType> ( _pData, Vec._pData, Factor ), _size );
+}
+
+template <typename _DataType>
+_DataType aol::Vector<_DataType>::addMultipleAndNormSqr ( const aol::Vector<_DataType>& Vec, _DataType Factor,
+                                                          aol::Vector<_DataType>& Other, const aol::Vector<_DataType>& OtherVec, _DataType OtherFactor ) {
+  if ( ( Vec.size() != _size ) || ( Other.size() != _size ) || ( OtherVec.size() != _size ) )
+    throw aol::Exception ( "aol::Vector::addMultipleAndNormSqr(): dimensions don't match", __FILE__, __LINE__ );
+
+  return reduceBlockwise<DataType> ( AddMultiplesAndNormSqrKernel<DataType> ( _pData, Vec._pData, Factor, Other._pData, OtherVec._pData, OtherFactor ), _size );
+}
+
 template <typename _DataType>
 aol::Vector<_DataType> & aol::Vector<_DataType>::addMultipleMasked ( const aol::Vector<_DataType> & Vec, _DataType Factor, const aol::BitVector & mask, bool invertMask ) {
   if ( Vec.size() != _size )
@@ -790,10 +992,9 @@ aol::Vector<_DataType> & aol::Vector<_DataType>::addMultipleMasked ( const aol::
 template <typename _DataType>
 void aol::Vector<_DataType>::setSum ( const aol::Vector<_DataType>& Vec1,
                                       const aol::Vector<_DataType>& Vec2, _DataType Factor ) {
-  if ( Vec1.size() != _size || Vec2.size() != _size ) {
-    cerr << "ERROR in add: incompatible vectorlengths...\n";
-    return;
-  }
+  if ( Vec1.size() != _size || Vec2.size() != _size )
+    throw aol::Exception ( "aol::Vector::setSum(): dimensions don't match", __FILE__, __LINE__ );
+
   DataType *ptr = _pData;
   for ( int i = 0; i < _size; ++i ) {
     *ptr = Vec1.get ( i ) + Vec2.get ( i ) * Factor;
@@ -677,6 +677,15 @@ public:
 
   //! Add Factor*Vec to this vector.
   Vector<DataType> & addMultiple ( const Vector<DataType>& Vec, DataType Factor );
+
+  //! Add Factor*Vec to this vector and return the squared norm of the result, reading this vector only once.
+  DataType addMultipleAndNormSqr ( const Vector<DataType>& Vec, DataType Factor );
+
+  /** Add Factor*Vec to this vector and OtherFactor*OtherVec to Other in the same loop and return the squared
+   *  norm of this vector afterwards, e.g. the update of residual and solution in a CG step.
+   */
+  DataType addMultipleAndNormSqr ( const Vector<DataType>& Vec, DataType Factor,
+                                   Vector<DataType>& Other, const Vector<DataType>& OtherVec, DataType OtherFactor );
   Vector<DataType> & addMultipleMasked ( const Vector<DataType> & Vec, DataType Factor, const BitVector & mask, bool invertMask = false );
 
   Vector<DataType> & scaleAndAdd ( const DataType Factor, const aol::Vector<DataType>& Vec ) {
@@ -699,6 +708,7 @@ public:
     return *this;
   }
 
+  //! Set this vector to Vec1 + Factor*Vec2.
   void setSum ( const Vector<DataType>& Vec1, const Vector<DataType>& Vec2, DataType Factor );
 
   //! Makes this vector the absolute difference of Vec1 and Vec2.
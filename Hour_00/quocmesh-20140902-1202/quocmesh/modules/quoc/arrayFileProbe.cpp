@@ -0,0 +1,178 @@
+#include <arrayFileProbe.h>
+#include <dm3Import.h>
+#include <tiledArrayFile.h>
+#include <bzipiostream.h>
+
+namespace qc {
+
+namespace {
+
+//! Number of (decompressed) bytes read to parse a pgm style header, enough for the comments written by ScalarArray::save.
+const int HeaderProbeSize = 1 << 16;
+
+ArrayFileInfo probePGMStyleFile ( const char *FileName ) {
+  ArrayFileInfo info;
+  info.compressed = aol::hasBzipSuffx ( FileName );
+
+  // Only read the beginning of the file, for compressed files only the first bzip2 block needs to be decompressed.
+  std::vector<char> buffer ( HeaderProbeSize );
+  std::streamsize numRead = 0;
+  {
+    aol::Bzipifstream in ( FileName, 1, HeaderProbeSize );
+    in.read ( &buffer[0], HeaderProbeSize );
+    numRead = in.gcount();
+  }
+
+  std::istringstream in ( string ( &buffer[0], static_cast<size_t> ( numRead ) ) );
+  int type, maxColor;
+  if ( ( numRead > 0 ) && ( buffer[0] == 'Q' ) ) {
+    info.dim = 3;
+    qc::ScalarArray<float, qc::QC_3D>::readHeader ( in, type, info.size[0], info.size[1], info.size[2], maxColor );
+  }
+  else {
+    info.dim = 2;
+    info.size[2] = 1;
+    qc::ScalarArray<float, qc::QC_2D>::readHeader ( in, type, info.size[0], info.size[1], maxColor );
+  }
+  if ( in.fail() )
+    throw aol::FileFormatException ( aol::strprintf ( "qc::probeArrayFile: Error reading the header of \"%s\"", FileName ).c_str(), __FILE__, __LINE__ );
+
+  info.type = static_cast<qc::SaveType> ( type );
+  info.payloadOffset = static_cast<int64_t> ( in.tellg() );
+  info.maxHint = maxColor;
+  return info;
+}
+
+ArrayFileInfo probeTiledArrayFile ( const char *FileName ) {
+  const TiledArrayFile file ( FileName );
+  ArrayFileInfo info;
+  info.dim = file.getDim();
+  info.size = file.getSize();
+  info.type = file.getType();
+  info.compressed = true;
+  return info;
+}
+
+ArrayFileInfo probeDM3File ( const char *FileName ) {
+  DM3Reader dmreader ( FileName );
+  const int num = dmreader.getDataEntry().num;
+  const int numZ = dmreader.getDataEntry().numZ;
+  ArrayFileInfo info;
+  info.dim = ( numZ > 1 ) ? 3 : 2;
+  info.size.set ( dmreader.getDataEntry().numX, dmreader.getDataEntry().numY, ( numZ > 1 ) ? numZ : 1 );
+  info.type = dmreader.getDataEntry().getSaveType();
+  info.payloadOffset = dmreader.getDataEntry().offset;
+
+  // The contrast limits used for display by Digital Micrograph.
+  const string displayInfo = aol::strprintf ( "ImageList.%d.ImageDisplayInfo.", num );
+  if ( dmreader.hasTag ( displayInfo + "LowLimit" ) && dmreader.hasTag ( displayInfo + "HighLimit" ) ) {
+    info.minHint = dmreader.getTagValue<double> ( displayInfo + "LowLimit" );
+    info.maxHint = dmreader.getTagValue<double> ( displayInfo + "HighLimit" );
+  }
+  return info;
+}
+
+template <typename DataType>
+DataType readTIFFValue ( istream &In, const bool SwapByteOrder ) {
+  const DataType value = aol::readBinaryData<DataType, DataType> ( In );
+  return SwapByteOrder ? aol::swapByteOrder<DataType> ( value ) : value;
+}
+
+ArrayFileInfo probeTIFFFile ( const char *FileName ) {
+  std::ifstream in ( FileName, ios::binary );
+  if ( in.good() == false )
+    throw aol::FileException ( aol::strprintf ( "qc::probeArrayFile: Cannot open \"%s\" for reading", FileName ).c_str(), __FILE__, __LINE__ );
+
+  char byteOrder[2] = { 0, 0 };
+  in.read ( byteOrder, 2 );
+  if ( ( byteOrder[0] != byteOrder[1] ) || ( ( byteOrder[0] != 'I' ) && ( byteOrder[0] != 'M' ) ) )
+    throw aol::FileFormatException ( aol::strprintf ( "qc::probeArrayFile: \"%s\" is no TIFF file", FileName ).c_str(), __FILE__, __LINE__ );
+  const uint16_t endianTest = 1;
+  const bool littleEndian = ( *reinterpret_cast<const unsigned char*> ( &endianTest ) == 1 );
+  const bool swap = ( ( byteOrder[0] == 'I' ) != littleEndian );
+
+  if ( readTIFFValue<uint16_t> ( in, swap ) != 42 )
+    throw aol::UnimplementedCodeException ( aol::strprintf ( "qc::probeArrayFile: \"%s\" is no classic TIFF file", FileName ).c_str(), __FILE__, __LINE__ );
+  in.seekg ( readTIFFValue<uint32_t> ( in, swap ) );
+
+  // Only the first image file directory is considered.
+  uint32_t bitsPerSample = 1, compression = 1, samplesPerPixel = 1, sampleFormat = 1;
+  uint32_t stripOffsetsType = 0, stripOffsetsCount = 0, stripOffsets = 0;
+  ArrayFileInfo info;
+  info.dim = 2;
+  info.size[2] = 1;
+  const int numEntries = readTIFFValue<uint16_t> ( in, swap );
+  for ( int i = 0; i < numEntries; ++i ) {
+    const uint16_t tag = readTIFFValue<uint16_t> ( in, swap );
+    const uint16_t type = readTIFFValue<uint16_t> ( in, swap );
+    const uint32_t count = readTIFFValue<uint32_t> ( in, swap );
+    // Values of type SHORT are left-justified in the four byte value field.
+    uint32_t value = 0;
+    if ( type == 3 ) {
+      value = readTIFFValue<uint16_t> ( in, swap );
+      in.ignore ( 2 );
+    }
+    else
+      value = readTIFFValue<uint32_t> ( in, swap );
+
+    switch ( tag ) {
+      case 256: info.size[0] = value; break;            // ImageWidth
+      case 257: info.size[1] = value; break;            // ImageLength
+      case 258: bitsPerSample = value; break;           // BitsPerSample
+      case 259: compression = value; break;             // Compression
+      case 273:                                         // StripOffsets
+        stripOffsetsType = type;
+        stripOffsetsCount = count;
+        stripOffsets = value;
+        break;
+      case 277: samplesPerPixel = value; break;         // SamplesPerPixel
+      case 280: info.minHint = value; break;            // MinSampleValue
+      case 281: info.maxHint = value; break;            // MaxSampleValue
+      case 339: sampleFormat = value; break;            // SampleFormat
+      default: break;
+    }
+  }
+  if ( in.fail() )
+    throw aol::IOException ( aol::strprintf ( "qc::probeArrayFile: Error reading the header of \"%s\"", FileName ).c_str(), __FILE__, __LINE__ );
+  if ( samplesPerPixel != 1 )
+    throw aol::UnimplementedCodeException ( "qc::probeArrayFile: Only grayscale TIFF files are supported", __FILE__, __LINE__ );
+
+  if ( bitsPerSample == 8 )
+    info.type = qc::PGM_UNSIGNED_CHAR_BINARY;
+  else if ( bitsPerSample == 16 )
+    info.type = ( sampleFormat == 2 ) ? qc::PGM_SHORT_BINARY : qc::PGM_UNSIGNED_SHORT_BINARY;
+  else if ( bitsPerSample == 32 )
+    info.type = ( sampleFormat == 3 ) ? qc::PGM_FLOAT_BINARY : ( ( sampleFormat == 2 ) ? qc::PGM_SIGNED_INT_BINARY : qc::PGM_UNSIGNED_INT_BINARY );
+  else if ( ( bitsPerSample == 64 ) && ( sampleFormat == 3 ) )
+    info.type = qc::PGM_DOUBLE_BINARY;
+  else
+    throw aol::UnimplementedCodeException ( aol::strprintf ( "qc::probeArrayFile: %d bits per sample unimplemented.", bitsPerSample ).c_str(), __FILE__, __LINE__ );
+
+  info.compressed = ( compression != 1 );
+  if ( !info.compressed && ( stripOffsetsCount > 0 ) ) {
+    // With more than one strip, the value field contains the offset of the array of strip offsets.
+    if ( stripOffsetsCount > 1 ) {
+      in.seekg ( stripOffsets );
+      stripOffsets = ( stripOffsetsType == 3 ) ? readTIFFValue<uint16_t> ( in, swap ) : readTIFFValue<uint32_t> ( in, swap );
+      if ( in.fail() )
+        throw aol::IOException ( aol::strprintf ( "qc::probeArrayFile: Error reading the strip offsets of \"%s\"", FileName ).c_str(), __FILE__, __LINE__ );
+    }
+    info.payloadOffset = stripOffsets;
+  }
+  return info;
+}
+
+} // end of nameless namespace
+
+ArrayFileInfo probeArrayFile ( const char *FileName ) {
+  if ( aol::fileNameEndsWith ( FileName, ".dm3" ) || aol::fileNameEndsWith ( FileName, ".dm4" ) )
+    return probeDM3File ( FileName );
+  else if ( aol::fileNameEndsWith ( FileName, ".tif" ) || aol::fileNameEndsWith ( FileName, ".tiff" ) )
+    return probeTIFFFile ( FileName );
+  else if ( TiledArrayFile::hasTiledSuffix ( FileName ) )
+    return probeTiledArrayFile ( FileName );
+  else
+    return probePGMStyleFile ( FileName );
+}
+
+}
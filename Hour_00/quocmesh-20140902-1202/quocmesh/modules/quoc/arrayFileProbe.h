@@ -0,0 +1,50 @@
+#ifndef __ARRAYFILEPROBE_H
+#define __ARRAYFILEPROBE_H
+
+#include <quoc.h>
+#include <smallVec.h>
+
+namespace qc {
+
+/**
+ * \brief Information about an array stored in a file that is available without reading the array data, see probeArrayFile.
+ */
+struct ArrayFileInfo {
+  //! Dimension of the array, 2 or 3.
+  int dim;
+  //! Number of elements in each direction, the z component is 1 for 2D arrays.
+  aol::Vec3<int> size;
+  //! Type of the stored data. For TIFF and DM3/DM4 files this is the binary pgm type with the same data type.
+  qc::SaveType type;
+  //! Position of the first byte of the data in the file (in the decompressed data for bzip2 compressed files), -1 if unknown.
+  int64_t payloadOffset;
+  //! Whether the file or the data in it is compressed.
+  bool compressed;
+  //! Range of the values as given by the header, NaN if the header doesn't contain it. Not necessarily the exact minimum and maximum.
+  double minHint, maxHint;
+
+  ArrayFileInfo ( )
+    : dim ( 0 ),
+      size ( 0, 0, 0 ),
+      type ( qc::PGM_UNSIGNED_CHAR_BINARY ),
+      payloadOffset ( -1 ),
+      compressed ( false ),
+      minHint ( aol::NumberTrait<double>::NaN ),
+      maxHint ( aol::NumberTrait<double>::NaN ) { }
+};
+
+/**
+ * Determines the size and type of the array stored in FileName by only reading the header of the file.
+ *
+ * Supports 2D and 3D arrays in pgm style format (bzip2 compressed files like .q2bz and .dat.bz2 are
+ * handled by decompressing only the beginning of the file, i.e. its first bzip2 block), tiled array
+ * files (see qc::TiledArrayFile), uncompressed or compressed grayscale TIFF files and DM3/DM4 files
+ * (only the tag tree is parsed, see qc::DM3Reader).
+ *
+ * \author Berkels
+ */
+ArrayFileInfo probeArrayFile ( const char *FileName );
+
+}
+
+#endif // __ARRAYFILEPROBE_H
@@ -1122,6 +1122,82 @@ protected:
 
 };
 
+/**
+ * \brief Partition of the elements of a regular quoc grid into the layers of elements orthogonal to the last
+ *        coordinate direction, i.e. element rows in 2D and element slices in 3D, see aol::FEElementSlabs.
+ *
+ * Only elements in neighboring layers share nodes, thus all even layers can be traversed in parallel, as can all odd ones.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+class QuocElementLayerSlabs {
+public:
+  typedef typename ConfiguratorType::ElementIteratorType IteratorType;
+  typedef typename IteratorType::EndType EndType;
+protected:
+  const ConfiguratorType &_config;
+  const int _numLayers;
+public:
+  explicit QuocElementLayerSlabs ( const ConfiguratorType &Config )
+    : _config ( Config ),
+      _numLayers ( Config.getInitializer().getSize()[ConfiguratorType::Dim - 1] - 1 ) {}
+
+  int getNumSlabs ( ) const {
+    return _numLayers;
+  }
+
+  //! The element iterators traverse the elements lexicographically, so a layer starts with the first element of the grid shifted to the layer.
+  IteratorType begin ( const int Slab ) const {
+    IteratorType it = _config.begin();
+    it.getCurrentPosition()[ConfiguratorType::Dim - 1] = static_cast<short> ( Slab );
+    return it;
+  }
+
+  EndType end ( const int Slab ) const {
+    if ( Slab + 1 < _numLayers )
+      return begin ( Slab + 1 );
+    else
+      return _config.end();
+  }
+};
+
+}
+
+namespace aol {
+
+template <typename _RealType, typename _QuadType, typename _MatrixType>
+class FEElementSlabs<qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_2D, _QuadType, _MatrixType> >
+  : public qc::QuocElementLayerSlabs<qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_2D, _QuadType, _MatrixType> > {
+public:
+  explicit FEElementSlabs ( const qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_2D, _QuadType, _MatrixType> &Config )
+    : qc::QuocElementLayerSlabs<qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_2D, _QuadType, _MatrixType> > ( Config ) {}
+};
+
+template <typename _RealType, typename _QuadType, typename _MatrixType>
+class FEElementSlabs<qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_3D, _QuadType, _MatrixType> >
+  : public qc::QuocElementLayerSlabs<qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_3D, _QuadType, _MatrixType> > {
+public:
+  explicit FEElementSlabs ( const qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_3D, _QuadType, _MatrixType> &Config )
+    : qc::QuocElementLayerSlabs<qc::QuocConfiguratorTraitMultiLin<_RealType, qc::QC_3D, _QuadType, _MatrixType> > ( Config ) {}
+};
+
+template <typename _RealType, typename _QuadType, typename RectangularGridType>
+class FEElementSlabs<qc::RectangularGridConfigurator<_RealType, qc::QC_2D, _QuadType, RectangularGridType> >
+  : public qc::QuocElementLayerSlabs<qc::RectangularGridConfigurator<_RealType, qc::QC_2D, _QuadType, RectangularGridType> > {
+public:
+  explicit FEElementSlabs ( const qc::RectangularGridConfigurator<_RealType, qc::QC_2D, _QuadType, RectangularGridType> &Config )
+    : qc::QuocElementLayerSlabs<qc::RectangularGridConfigurator<_RealType, qc::QC_2D, _QuadType, RectangularGridType> > ( Config ) {}
+};
+
+template <typename _RealType, typename _QuadType, typename RectangularGridType>
+class FEElementSlabs<qc::RectangularGridConfigurator<_RealType, qc::QC_3D, _QuadType, RectangularGridType> >
+  : public qc::QuocElementLayerSlabs<qc::RectangularGridConfigurator<_RealType, qc::QC_3D, _QuadType, RectangularGridType> > {
+public:
+  explicit FEElementSlabs ( const qc::RectangularGridConfigurator<_RealType, qc::QC_3D, _QuadType, RectangularGridType> &Config )
+    : qc::QuocElementLayerSlabs<qc::RectangularGridConfigurator<_RealType, qc::QC_3D, _QuadType, RectangularGridType> > ( Config ) {}
+};
+
 }
 
 #endif
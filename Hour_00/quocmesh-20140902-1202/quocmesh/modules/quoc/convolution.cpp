@@ -1,5 +1,9 @@
 #include <convolution.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace qc {
 
 #ifdef USE_LIB_FFTW
@@ -20,7 +24,7 @@ void FourierTransform ( const qc::MultiArray<RealType, 2, 2>& function, qc::Mult
     throw aol::Exception ( "Array sizes not equal in FourierTransform", __FILE__, __LINE__ );
   FFTWComplex* f = static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * numX * numY ) );
   FFTWComplex* t = static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * numX * numY ) );
-  typename ConvType::FFTWPlan plan = ConvType::fftwPlan_dft ( aol::Vec2<int> ( numX, numY ), f, t, direction, FFTW_ESTIMATE );
+  typename ConvType::FFTWPlan plan = FFTWPlanCache<qc::QC_2D, RealType>::getInstance().getPlan ( aol::Vec2<int> ( numX, numY ), ( direction == FTForward ) ? FFTW_PLAN_FORWARD : FFTW_PLAN_BACKWARD );
 
   // Copy data, transform and copy back
   for ( int j = 0; j < numY; ++j ) {
@@ -31,7 +35,7 @@ void FourierTransform ( const qc::MultiArray<RealType, 2, 2>& function, qc::Mult
       for ( int k = 0; k < 2; ++k ) f [ind] [k] = val [k];
     }
   }
-  ConvType::fftwExecute ( plan );
+  ConvType::fftwExecute_dft ( plan, f, t );
   for ( int j = 0; j < numY; ++j ) {
     for ( int i = 0; i < numX; ++i ) {
       const int ind = qc::ILexCombine2 ( i, j, numX );
@@ -41,12 +45,101 @@ void FourierTransform ( const qc::MultiArray<RealType, 2, 2>& function, qc::Mult
     }
   }
 
-  // Cleanup
-  ConvType::fftwDestroy_plan ( plan );
+  // Cleanup, the plan is owned by the cache.
+  ConvType::fftwFree ( f );
+  ConvType::fftwFree ( t );
+}
+
+template <typename RealType>
+void computeFourierModulus ( const qc::ScalarArray<RealType, qc::QC_2D> &Function, qc::ScalarArray<RealType, qc::QC_2D> &Modulus ) {
+  typedef ConvolutionTrait<qc::QC_2D,RealType> ConvType;
+  typedef typename ConvType::FFTWComplex FFTWComplex;
+
+  const int numX = Function.getNumX(), numY = Function.getNumY();
+  if ( ( Modulus.getNumX() != numX ) || ( Modulus.getNumY() != numY ) )
+    throw aol::Exception ( "Array sizes not equal in computeFourierModulus", __FILE__, __LINE__ );
+  const int numComplexX = numX / 2 + 1;
+  RealType* f = static_cast<RealType*> ( ConvType::fftwMalloc ( sizeof ( RealType ) * numX * numY ) );
+  FFTWComplex* t = static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * numComplexX * numY ) );
+  Function.copyToBuffer ( f );
+  ConvType::fftwExecute_dft_r2c ( FFTWPlanCache<qc::QC_2D, RealType>::getInstance().getPlan ( aol::Vec2<int> ( numX, numY ), FFTW_PLAN_R2C ), f, t );
+
+  // The r2c transform only computes the coefficients with i <= numX / 2, the others are the complex conjugates
+  // of the coefficients for ( numX - i, numY - j ), since the input is real.
+  for ( int j = 0; j < numY; ++j ) {
+    for ( int i = 0; i < numX; ++i ) {
+      const int ind = ( i < numComplexX ) ? qc::ILexCombine2 ( i, j, numComplexX ) : qc::ILexCombine2 ( numX - i, ( numY - j ) % numY, numComplexX );
+      Modulus.set ( i, j, aol::Vec2<RealType> ( t[ind][0], t[ind][1] ).norm() );
+    }
+  }
+
+  ConvType::fftwFree ( f );
+  ConvType::fftwFree ( t );
+}
+
+template <typename RealType>
+void fourierThreshold ( qc::ScalarArray<RealType, qc::QC_2D> &Image, const RealType AbsoluteThreshold ) {
+  typedef ConvolutionTrait<qc::QC_2D,RealType> ConvType;
+  typedef typename ConvType::FFTWComplex FFTWComplex;
+
+  const int numX = Image.getNumX(), numY = Image.getNumY();
+  const int numComplexPixels = ( numX / 2 + 1 ) * numY;
+  const aol::Vec2<int> size ( numX, numY );
+  RealType* f = static_cast<RealType*> ( ConvType::fftwMalloc ( sizeof ( RealType ) * numX * numY ) );
+  FFTWComplex* t = static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * numComplexPixels ) );
+  Image.copyToBuffer ( f );
+  ConvType::fftwExecute_dft_r2c ( FFTWPlanCache<qc::QC_2D, RealType>::getInstance().getPlan ( size, FFTW_PLAN_R2C ), f, t );
+
+  // Since the norms of conjugate coefficients are equal, thresholding keeps the symmetry of the transform of real
+  // data, so it suffices to threshold the coefficients computed by the r2c transform.
+  for ( int i = 0; i < numComplexPixels; ++i ) {
+    if ( aol::Vec2<RealType> ( t[i][0], t[i][1] ).norm() < AbsoluteThreshold )
+      t[i][0] = t[i][1] = 0;
+  }
+
+  ConvType::fftwExecute_dft_c2r ( FFTWPlanCache<qc::QC_2D, RealType>::getInstance().getPlan ( size, FFTW_PLAN_C2R ), t, f );
+  Image.readFromBuffer ( f );
+  Image /= ( numX * numY );
+
   ConvType::fftwFree ( f );
   ConvType::fftwFree ( t );
 }
 
+namespace {
+int fftwNumThreads = 0;
+}
+
+void setFFTWNumThreads ( const int NumThreads ) {
+  fftwNumThreads = NumThreads;
+}
+
+int getFFTWNumThreads ( ) {
+#ifdef _OPENMP
+  return ( fftwNumThreads > 0 ) ? fftwNumThreads : ( omp_in_parallel() ? 1 : omp_get_max_threads() );
+#else
+  return ( fftwNumThreads > 0 ) ? fftwNumThreads : 1;
+#endif
+}
+
+bool importFFTWWisdom ( const char *FileName ) {
+  int success = 0;
+#ifdef _OPENMP
+#pragma omp critical (qc_FFTWPlanner)
+#endif
+  success = fftw_import_wisdom_from_filename ( FileName );
+  return ( success != 0 );
+}
+
+void exportFFTWWisdom ( const char *FileName ) {
+  int success = 0;
+#ifdef _OPENMP
+#pragma omp critical (qc_FFTWPlanner)
+#endif
+  success = fftw_export_wisdom_to_filename ( FileName );
+  if ( success == 0 )
+    throw aol::Exception ( aol::strprintf ( "Could not write FFTW wisdom to %s", FileName ).c_str(), __FILE__, __LINE__ );
+}
+
 #else
 
 //! 2D Fourier transform (complex-to-complex)
@@ -57,12 +150,40 @@ void FourierTransform ( const qc::MultiArray<RealType, 2, 2>& /*function*/, qc::
   throw aol::Exception ( "FourierTransform needs libfftw! Compile with -DUSE_LIB_FFTW", __FILE__, __LINE__ );
 }
 
+template <typename RealType>
+void computeFourierModulus ( const qc::ScalarArray<RealType, qc::QC_2D> &/*Function*/, qc::ScalarArray<RealType, qc::QC_2D> &/*Modulus*/ ) {
+  throw aol::Exception ( "computeFourierModulus needs libfftw! Compile with -DUSE_LIB_FFTW", __FILE__, __LINE__ );
+}
+
+template <typename RealType>
+void fourierThreshold ( qc::ScalarArray<RealType, qc::QC_2D> &/*Image*/, const RealType /*AbsoluteThreshold*/ ) {
+  throw aol::Exception ( "fourierThreshold needs libfftw! Compile with -DUSE_LIB_FFTW", __FILE__, __LINE__ );
+}
+
+void setFFTWNumThreads ( const int /*NumThreads*/ ) {}
+
+int getFFTWNumThreads ( ) {
+  return 1;
+}
+
+bool importFFTWWisdom ( const char */*FileName*/ ) {
+  throw aol::Exception ( "importFFTWWisdom needs libfftw! Compile with -DUSE_LIB_FFTW", __FILE__, __LINE__ );
+}
+
+void exportFFTWWisdom ( const char */*FileName*/ ) {
+  throw aol::Exception ( "exportFFTWWisdom needs libfftw! Compile with -DUSE_LIB_FFTW", __FILE__, __LINE__ );
+}
+
 #endif
 
 template void FourierTransform<float> ( const qc::MultiArray<float, 2, 2>&, qc::MultiArray<float, 2, 2>&, enum FourierTransformDirection );
 template void FourierTransform<double> ( const qc::MultiArray<double, 2, 2>&, qc::MultiArray<double, 2, 2>&, enum FourierTransformDirection );
 // Since fftw3l seems to be missing on our Linux machines, we can't use the long double version.
 //template void FourierTransform<long double> ( const qc::MultiArray<long double, 2, 2>&, qc::MultiArray<long double, 2, 2>&, enum FourierTransformDirection );
+template void computeFourierModulus<float> ( const qc::ScalarArray<float, qc::QC_2D>&, qc::ScalarArray<float, qc::QC_2D>& );
+template void computeFourierModulus<double> ( const qc::ScalarArray<double, qc::QC_2D>&, qc::ScalarArray<double, qc::QC_2D>& );
+template void fourierThreshold<float> ( qc::ScalarArray<float, qc::QC_2D>&, const float );
+template void fourierThreshold<double> ( qc::ScalarArray<double, qc::QC_2D>&, const double );
 
 void addMotionBlurToArray ( const aol::Vec2<double> &Velocity, const qc::ScalarArray<double, qc::QC_2D> &Arg, qc::ScalarArray<double, qc::QC_2D> &Dest ) {
   qc::Convolution<qc::QC_2D> conv ( aol::Vec2<int>( Arg.getNumX(), Arg.getNumY() ) );
@@ -10,6 +10,22 @@
 
 namespace qc {
 
+/**
+ * Number of threads the FFTW plans of qc::FFTWPlanCache are created for (only has an effect if quocmesh is built with
+ * OpenMP and the threaded FFTW library was found, i.e. USE_LIB_FFTW_OMP is defined). The default is 0, which means
+ * omp_get_max_threads() outside and 1 inside of an active parallel region.
+ */
+void setFFTWNumThreads ( const int NumThreads );
+
+//! The number of threads the FFTW plans are created for, see setFFTWNumThreads.
+int getFFTWNumThreads ( );
+
+//! Imports FFTW wisdom (double precision) from FileName to speed up the creation of plans. Returns false if the file could not be read.
+bool importFFTWWisdom ( const char *FileName );
+
+//! Exports the FFTW wisdom (double precision) accumulated so far to FileName, e.g. to import it in the next run.
+void exportFFTWWisdom ( const char *FileName );
+
 #ifdef USE_LIB_FFTW
 
 template <Dimension = QC_2D, typename RealType = double>
@@ -40,12 +56,41 @@ public:
   static FFTWPlan fftwPlan_dft( aol::Vec2<int> nxy, FFTWComplex *in, FFTWComplex *out, int sign, unsigned flags ){
     return fftw_plan_dft_2d( nxy[1], nxy[0], in, out, sign, flags );
   }
+  // Unnormalized DCT-I (FFTW_REDFT00) in all directions.
+  static FFTWPlan fftwPlan_r2r_dct1( aol::Vec2<int> nxy, double *in, double *out, unsigned flags ){
+    return fftw_plan_r2r_2d( nxy[1], nxy[0], in, out, FFTW_REDFT00, FFTW_REDFT00, flags );
+  }
   static void fftwDestroy_plan( FFTWPlan p ){
     fftw_destroy_plan( p );
   }
   static void fftwExecute( FFTWPlan p ){
     fftw_execute( p );
   }
+  // Execute a plan on other arrays than the ones it was created with, these need to have the same alignment,
+  // i.e. need to be allocated with fftwMalloc, see qc::FFTWPlanCache.
+  static void fftwExecute_dft_r2c( FFTWPlan p, double *in, FFTWComplex *out ){
+    fftw_execute_dft_r2c( p, in, out );
+  }
+  static void fftwExecute_dft_c2r( FFTWPlan p, FFTWComplex *in, double *out ){
+    fftw_execute_dft_c2r( p, in, out );
+  }
+  static void fftwExecute_dft( FFTWPlan p, FFTWComplex *in, FFTWComplex *out ){
+    fftw_execute_dft( p, in, out );
+  }
+  static void fftwExecute_r2r( FFTWPlan p, double *in, double *out ){
+    fftw_execute_r2r( p, in, out );
+  }
+  static void fftwPlanWithThreads( int NumThreads ){
+#ifdef USE_LIB_FFTW_OMP
+    static bool threadsInitialized = false;
+    if ( !threadsInitialized )
+      threadsInitialized = ( fftw_init_threads() != 0 );
+    if ( threadsInitialized )
+      fftw_plan_with_nthreads( NumThreads );
+#else
+    aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+#endif
+  }
 };
 
 template <>
@@ -76,6 +121,38 @@ public:
   static void fftwExecute( FFTWPlan p ){
     fftw_execute( p );
   }
+  static FFTWPlan fftwPlan_dft( aol::Vec3<int> nxyz, FFTWComplex *in, FFTWComplex *out, int sign, unsigned flags ){
+    return fftw_plan_dft_3d( nxyz[2], nxyz[1], nxyz[0], in, out, sign, flags );
+  }
+  // Unnormalized DCT-I (FFTW_REDFT00) in all directions.
+  static FFTWPlan fftwPlan_r2r_dct1( aol::Vec3<int> nxyz, double *in, double *out, unsigned flags ){
+    return fftw_plan_r2r_3d( nxyz[2], nxyz[1], nxyz[0], in, out, FFTW_REDFT00, FFTW_REDFT00, FFTW_REDFT00, flags );
+  }
+  // Execute a plan on other arrays than the ones it was created with, these need to have the same alignment,
+  // i.e. need to be allocated with fftwMalloc, see qc::FFTWPlanCache.
+  static void fftwExecute_dft_r2c( FFTWPlan p, double *in, FFTWComplex *out ){
+    fftw_execute_dft_r2c( p, in, out );
+  }
+  static void fftwExecute_dft_c2r( FFTWPlan p, FFTWComplex *in, double *out ){
+    fftw_execute_dft_c2r( p, in, out );
+  }
+  static void fftwExecute_dft( FFTWPlan p, FFTWComplex *in, FFTWComplex *out ){
+    fftw_execute_dft( p, in, out );
+  }
+  static void fftwExecute_r2r( FFTWPlan p, double *in, double *out ){
+    fftw_execute_r2r( p, in, out );
+  }
+  static void fftwPlanWithThreads( int NumThreads ){
+#ifdef USE_LIB_FFTW_OMP
+    static bool threadsInitialized = false;
+    if ( !threadsInitialized )
+      threadsInitialized = ( fftw_init_threads() != 0 );
+    if ( threadsInitialized )
+      fftw_plan_with_nthreads( NumThreads );
+#else
+    aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+#endif
+  }
 };
 
 template <>
@@ -103,12 +180,41 @@ public:
   static FFTWPlan fftwPlan_dft( aol::Vec2<int> nxy, FFTWComplex *in, FFTWComplex *out, int sign, unsigned flags ){
     return fftwf_plan_dft_2d( nxy[1], nxy[0], in, out, sign, flags );
   }
+  // Unnormalized DCT-I (FFTW_REDFT00) in all directions.
+  static FFTWPlan fftwPlan_r2r_dct1( aol::Vec2<int> nxy, float *in, float *out, unsigned flags ){
+    return fftwf_plan_r2r_2d( nxy[1], nxy[0], in, out, FFTW_REDFT00, FFTW_REDFT00, flags );
+  }
   static void fftwDestroy_plan( FFTWPlan p ){
     fftwf_destroy_plan( p );
   }
   static void fftwExecute( FFTWPlan p ){
     fftwf_execute( p );
   }
+  // Execute a plan on other arrays than the ones it was created with, these need to have the same alignment,
+  // i.e. need to be allocated with fftwMalloc, see qc::FFTWPlanCache.
+  static void fftwExecute_dft_r2c( FFTWPlan p, float *in, FFTWComplex *out ){
+    fftwf_execute_dft_r2c( p, in, out );
+  }
+  static void fftwExecute_dft_c2r( FFTWPlan p, FFTWComplex *in, float *out ){
+    fftwf_execute_dft_c2r( p, in, out );
+  }
+  static void fftwExecute_dft( FFTWPlan p, FFTWComplex *in, FFTWComplex *out ){
+    fftwf_execute_dft( p, in, out );
+  }
+  static void fftwExecute_r2r( FFTWPlan p, float *in, float *out ){
+    fftwf_execute_r2r( p, in, out );
+  }
+  static void fftwPlanWithThreads( int NumThreads ){
+#ifdef USE_LIB_FFTW_OMP
+    static bool threadsInitialized = false;
+    if ( !threadsInitialized )
+      threadsInitialized = ( fftwf_init_threads() != 0 );
+    if ( threadsInitialized )
+      fftwf_plan_with_nthreads( NumThreads );
+#else
+    aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+#endif
+  }
 };
 
 template <>
@@ -139,6 +245,38 @@ public:
   static void fftwExecute( FFTWPlan p ){
     fftwf_execute( p );
   }
+  static FFTWPlan fftwPlan_dft( aol::Vec3<int> nxyz, FFTWComplex *in, FFTWComplex *out, int sign, unsigned flags ){
+    return fftwf_plan_dft_3d( nxyz[2], nxyz[1], nxyz[0], in, out, sign, flags );
+  }
+  // Unnormalized DCT-I (FFTW_REDFT00) in all directions.
+  static FFTWPlan fftwPlan_r2r_dct1( aol::Vec3<int> nxyz, float *in, float *out, unsigned flags ){
+    return fftwf_plan_r2r_3d( nxyz[2], nxyz[1], nxyz[0], in, out, FFTW_REDFT00, FFTW_REDFT00, FFTW_REDFT00, flags );
+  }
+  // Execute a plan on other arrays than the ones it was created with, these need to have the same alignment,
+  // i.e. need to be allocated with fftwMalloc, see qc::FFTWPlanCache.
+  static void fftwExecute_dft_r2c( FFTWPlan p, float *in, FFTWComplex *out ){
+    fftwf_execute_dft_r2c( p, in, out );
+  }
+  static void fftwExecute_dft_c2r( FFTWPlan p, FFTWComplex *in, float *out ){
+    fftwf_execute_dft_c2r( p, in, out );
+  }
+  static void fftwExecute_dft( FFTWPlan p, FFTWComplex *in, FFTWComplex *out ){
+    fftwf_execute_dft( p, in, out );
+  }
+  static void fftwExecute_r2r( FFTWPlan p, float *in, float *out ){
+    fftwf_execute_r2r( p, in, out );
+  }
+  static void fftwPlanWithThreads( int NumThreads ){
+#ifdef USE_LIB_FFTW_OMP
+    static bool threadsInitialized = false;
+    if ( !threadsInitialized )
+      threadsInitialized = ( fftwf_init_threads() != 0 );
+    if ( threadsInitialized )
+      fftwf_plan_with_nthreads( NumThreads );
+#else
+    aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+#endif
+  }
 };
 
 template <>
@@ -166,12 +304,33 @@ public:
   static FFTWPlan fftwPlan_dft( aol::Vec2<int> nxy, FFTWComplex *in, FFTWComplex *out, int sign, unsigned flags ){
     return fftwl_plan_dft_2d( nxy[1], nxy[0], in, out, sign, flags );
   }
+  // Unnormalized DCT-I (FFTW_REDFT00) in all directions.
+  static FFTWPlan fftwPlan_r2r_dct1( aol::Vec2<int> nxy, long double *in, long double *out, unsigned flags ){
+    return fftwl_plan_r2r_2d( nxy[1], nxy[0], in, out, FFTW_REDFT00, FFTW_REDFT00, flags );
+  }
   static void fftwDestroy_plan( FFTWPlan p ){
     fftwl_destroy_plan( p );
   }
   static void fftwExecute( FFTWPlan p ){
     fftwl_execute( p );
   }
+  // Execute a plan on other arrays than the ones it was created with, these need to have the same alignment,
+  // i.e. need to be allocated with fftwMalloc, see qc::FFTWPlanCache.
+  static void fftwExecute_dft_r2c( FFTWPlan p, long double *in, FFTWComplex *out ){
+    fftwl_execute_dft_r2c( p, in, out );
+  }
+  static void fftwExecute_dft_c2r( FFTWPlan p, FFTWComplex *in, long double *out ){
+    fftwl_execute_dft_c2r( p, in, out );
+  }
+  static void fftwExecute_dft( FFTWPlan p, FFTWComplex *in, FFTWComplex *out ){
+    fftwl_execute_dft( p, in, out );
+  }
+  static void fftwExecute_r2r( FFTWPlan p, long double *in, long double *out ){
+    fftwl_execute_r2r( p, in, out );
+  }
+  // There is no threaded fftw3l, so the long double transforms are always single-threaded.
+  static void fftwPlanWithThreads( int /*NumThreads*/ ){
+  }
 };
 
 template <>
@@ -202,6 +361,125 @@ public:
   static void fftwExecute( FFTWPlan p ){
     fftwl_execute( p );
   }
+  static FFTWPlan fftwPlan_dft( aol::Vec3<int> nxyz, FFTWComplex *in, FFTWComplex *out, int sign, unsigned flags ){
+    return fftwl_plan_dft_3d( nxyz[2], nxyz[1], nxyz[0], in, out, sign, flags );
+  }
+  // Unnormalized DCT-I (FFTW_REDFT00) in all directions.
+  static FFTWPlan fftwPlan_r2r_dct1( aol::Vec3<int> nxyz, long double *in, long double *out, unsigned flags ){
+    return fftwl_plan_r2r_3d( nxyz[2], nxyz[1], nxyz[0], in, out, FFTW_REDFT00, FFTW_REDFT00, FFTW_REDFT00, flags );
+  }
+  // Execute a plan on other arrays than the ones it was created with, these need to have the same alignment,
+  // i.e. need to be allocated with fftwMalloc, see qc::FFTWPlanCache.
+  static void fftwExecute_dft_r2c( FFTWPlan p, long double *in, FFTWComplex *out ){
+    fftwl_execute_dft_r2c( p, in, out );
+  }
+  static void fftwExecute_dft_c2r( FFTWPlan p, FFTWComplex *in, long double *out ){
+    fftwl_execute_dft_c2r( p, in, out );
+  }
+  static void fftwExecute_dft( FFTWPlan p, FFTWComplex *in, FFTWComplex *out ){
+    fftwl_execute_dft( p, in, out );
+  }
+  static void fftwExecute_r2r( FFTWPlan p, long double *in, long double *out ){
+    fftwl_execute_r2r( p, in, out );
+  }
+  // There is no threaded fftw3l, so the long double transforms are always single-threaded.
+  static void fftwPlanWithThreads( int /*NumThreads*/ ){
+  }
+};
+
+//! FFTW_PLAN_DCT1 is an in-place DCT-I in all directions, all others are out-of-place.
+enum FFTWPlanType { FFTW_PLAN_R2C, FFTW_PLAN_C2R, FFTW_PLAN_FORWARD, FFTW_PLAN_BACKWARD, FFTW_PLAN_DCT1 };
+
+/**
+ * \brief Process-wide cache of FFTW plans, one per array size, transform type (see FFTWPlanType) and number of threads.
+ *
+ * Creating a plan with FFTW_MEASURE takes much longer than executing it, so each plan is only created once and then
+ * executed on the arrays of the caller with the fftwExecute_* functions of ConvolutionTrait. These arrays need to
+ * be allocated with ConvolutionTrait::fftwMalloc to have the alignment the plans were created for. As usual with
+ * FFTW, the c2r plans overwrite their input. FFTW planning is not thread safe, executing the plans is.
+ *
+ * \author Berkels
+ */
+template <Dimension Dim, typename RealType>
+class FFTWPlanCache {
+  typedef ConvolutionTrait<Dim,RealType> ConvType;
+  typedef typename ConvType::FFTWComplex FFTWComplex;
+  typedef typename ConvType::FFTWPlan FFTWPlan;
+  typedef typename aol::VecDimTrait<int,Dim>::VecType VecType;
+  typedef std::map<std::vector<int>, FFTWPlan> MapType;
+
+  MapType _plans;
+
+  FFTWPlanCache () {}
+  FFTWPlanCache ( const FFTWPlanCache<Dim, RealType> &other );
+  FFTWPlanCache<Dim, RealType>& operator= ( const FFTWPlanCache<Dim, RealType> &other );
+
+public:
+  ~FFTWPlanCache () {
+    for ( typename MapType::iterator it = _plans.begin(); it != _plans.end(); ++it )
+      ConvType::fftwDestroy_plan ( it->second );
+  }
+
+  static FFTWPlanCache<Dim, RealType> &getInstance () {
+    static FFTWPlanCache<Dim, RealType> cache;
+    return cache;
+  }
+
+  //! Returns the plan for arrays of size NumXYZ, the plan is owned by the cache.
+  FFTWPlan getPlan ( const VecType &NumXYZ, const FFTWPlanType Type ) {
+    const int numThreads = getFFTWNumThreads();
+    std::vector<int> key ( Dim + 2 );
+    key[0] = Type;
+    key[1] = numThreads;
+    for ( int i = 0; i < Dim; ++i )
+      key[i + 2] = NumXYZ[i];
+
+    FFTWPlan plan = NULL;
+#ifdef _OPENMP
+#pragma omp critical (qc_FFTWPlanner)
+#endif
+    {
+      typename MapType::const_iterator it = _plans.find ( key );
+      if ( it != _plans.end() )
+        plan = it->second;
+      else {
+        const int numPixels = NumXYZ.prod();
+        const int numComplexPixels = ( Type == FFTW_PLAN_R2C || Type == FFTW_PLAN_C2R ) ? ( numPixels / NumXYZ[0] * ( NumXYZ[0] / 2 + 1 ) ) : numPixels;
+        // FFTW_MEASURE overwrites the arrays used for planning, so plan on scratch arrays.
+        RealType *real = static_cast<RealType*> ( ConvType::fftwMalloc ( sizeof ( RealType ) * numPixels ) );
+        FFTWComplex *complexA = static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * numComplexPixels ) );
+        FFTWComplex *complexB = static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * numComplexPixels ) );
+        ConvType::fftwPlanWithThreads ( numThreads );
+        switch ( Type ) {
+          case FFTW_PLAN_R2C:
+            plan = ConvType::fftwPlan_dft_r2c ( NumXYZ, real, complexA, FFTW_MEASURE );
+            break;
+          case FFTW_PLAN_C2R:
+            plan = ConvType::fftwPlan_dft_c2r ( NumXYZ, complexA, real, FFTW_MEASURE );
+            break;
+          case FFTW_PLAN_FORWARD:
+            plan = ConvType::fftwPlan_dft ( NumXYZ, complexA, complexB, FFTW_FORWARD, FFTW_MEASURE );
+            break;
+          case FFTW_PLAN_BACKWARD:
+            plan = ConvType::fftwPlan_dft ( NumXYZ, complexA, complexB, FFTW_BACKWARD, FFTW_MEASURE );
+            break;
+          case FFTW_PLAN_DCT1:
+            plan = ConvType::fftwPlan_r2r_dct1 ( NumXYZ, real, real, FFTW_MEASURE );
+            break;
+          default:
+            break;
+        }
+        ConvType::fftwFree ( real );
+        ConvType::fftwFree ( complexA );
+        ConvType::fftwFree ( complexB );
+        if ( plan != NULL )
+          _plans[key] = plan;
+      }
+    }
+    if ( plan == NULL )
+      throw aol::Exception ( "qc::FFTWPlanCache::getPlan: FFTW could not create the requested plan", __FILE__, __LINE__ );
+    return plan;
+  }
 };
 
 #endif // USE_LIB_FFTW
@@ -225,27 +503,22 @@ void FourierTransform ( const qc::MultiArray<RealType, 2, 2>& /*function*/, qc::
 /**
  * Transforms an image to the Fourier domain, zeroes all complex Fourier coefficients with a norm
  * smaller then the given threshold and then transforms the thresholded coefficients back to the
- * original domain (discarding the imaginary part).
+ * original domain. Uses real-to-complex transforms.
  *
  * \author Berkels
  */
 template <typename RealType>
-void fourierThreshold ( qc::ScalarArray<RealType, qc::QC_2D> &Image, const RealType AbsoluteThreshold ) {
-  const int nx = Image.getNumX (), ny = Image.getNumY ();
-  qc::MultiArray<RealType, 2, 2> function ( nx, ny ), transform ( nx, ny );
-  function [0] = Image;
-  qc::FourierTransform ( function, transform, qc::FTForward );
-
-  for ( qc::RectangularIterator<qc::QC_2D> it ( Image ); it.notAtEnd(); ++it ) {
-    if ( transform.get ( *it ).norm() < AbsoluteThreshold )
-      transform.set( *it, aol::Vec2<RealType> ( 0, 0 ) );
-  }
+void fourierThreshold ( qc::ScalarArray<RealType, qc::QC_2D> &Image, const RealType AbsoluteThreshold );
 
-  qc::FourierTransform ( transform, function, qc::FTBackward );
-  cerr << function[0].getMaxValue();
-  function[0] /= ( nx * ny );
-  Image = function[0];
-}
+/**
+ * Computes the moduli of the discrete Fourier coefficients of Function, i.e. Modulus.get ( i, j ) is the
+ * modulus of the coefficient of the frequency ( i, j ). Since Function is real, a real-to-complex transform
+ * is used, which only computes half of the coefficients.
+ *
+ * \author Berkels
+ */
+template <typename RealType>
+void computeFourierModulus ( const qc::ScalarArray<RealType, qc::QC_2D> &Function, qc::ScalarArray<RealType, qc::QC_2D> &Modulus );
 
 /**
  * Computes log2 ( 1 + FFT modulus ) pointwise, possible dropping the lowest DropPercentage values.
@@ -257,15 +530,14 @@ void computeLogFFTModulus ( const qc::ScalarArray<RealType, qc::QC_2D> &Image, q
   const int nx = Image.getNumX (), ny = Image.getNumY ();
 
   // Transform
-  qc::MultiArray<RealType, 2, 2> function ( nx, ny ), transform ( nx, ny );
-  function [0] = Image;
-  qc::FourierTransform ( function, transform );
+  qc::ScalarArray<RealType, qc::QC_2D> modulus ( nx, ny );
+  qc::computeFourierModulus ( Image, modulus );
 
   // Compute output, shift zero to center
   for ( int i = 0; i < nx; ++i ) {
     for ( int j = 0; j < ny; ++j ) {
       const aol::Vec2<short> pos ( ( i + nx / 2 ) % nx, ( j + ny / 2 ) % ny );
-      Modulus.set ( pos , aol::Vec2<RealType> ( transform [0].get ( i, j ), transform [1].get ( i, j ) ).norm() );
+      Modulus.set ( pos , modulus.get ( i, j ) );
     }
   }
 
@@ -305,7 +577,7 @@ private:
   RealType* _f;
   FFTWComplex* _g1;
   FFTWComplex* _g2;
-  // FFT procedures for the Fourier transformation and its inverse (will be specified in the constructor)
+  // FFT procedures for the Fourier transformation and its inverse, owned by qc::FFTWPlanCache
   FFTWPlan _forwardPlan;
   FFTWPlan _backwardPlan;
 
@@ -316,22 +588,14 @@ public:
     // allocate sufficient memory for the FFT input and output
     _f ( static_cast<RealType*> ( ConvType::fftwMalloc ( sizeof ( RealType ) * _numPixels ) ) ),
     _g1 ( static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * _numComplexPixels ) ) ),
-    _g2 ( static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * _numComplexPixels ) ) ) {
-
-    // Define the fftw plan "_forwardPlan" to do a discrete Fourier transform (dft) from real to complex (r2c) in 3d
-    // on a _numX by _numY by _numZ grid, taking the array "_f" as (real) input and "_g1" as (complex) output.
-    // Define the fftw plan "_backwardPlan" to do an inverse discrete Fourier transform (dft) from real to complex (r2c) in 3d
-    // on a _numX by _numY by _numZ grid, taking the array "_g1" as (real) input and "_f" as (complex) output.
-    // The flag "FFTW_MEASURE" as opposed to "FFTW_ESTIMATE" makes the routine to try some test calculations to sort out the fastest plan.
-    cerr << "preparing Fourier transformations... ";
-    _forwardPlan  = ConvType::fftwPlan_dft_r2c ( NumXYZ, _f, _g1, FFTW_MEASURE );
-    _backwardPlan = ConvType::fftwPlan_dft_c2r ( NumXYZ, _g1, _f, FFTW_MEASURE );
-    cerr << "done.\n";
-  }
+    _g2 ( static_cast<FFTWComplex*> ( ConvType::fftwMalloc ( sizeof ( FFTWComplex ) * _numComplexPixels ) ) ),
+    // The forward plan does a discrete Fourier transform (dft) from real to complex (r2c), the backward plan the
+    // inverse from complex to real (c2r). They are only created (with FFTW_MEASURE) for the first Convolution of
+    // this size, all others reuse them, see qc::FFTWPlanCache.
+    _forwardPlan ( FFTWPlanCache<Dim, RealType>::getInstance().getPlan ( NumXYZ, FFTW_PLAN_R2C ) ),
+    _backwardPlan ( FFTWPlanCache<Dim, RealType>::getInstance().getPlan ( NumXYZ, FFTW_PLAN_C2R ) ) {}
 
   ~Convolution() {
-    ConvType::fftwDestroy_plan ( _forwardPlan );
-    ConvType::fftwDestroy_plan ( _backwardPlan );
     ConvType::fftwFree ( _f );
     ConvType::fftwFree ( _g1 );
     ConvType::fftwFree ( _g2 );
@@ -341,18 +605,18 @@ private:
   void inputDataFFT ( const qc::ScalarArray<RealType, Dim> &InputA, const qc::ScalarArray<RealType, Dim> &InputB ) const {
     // compute the Fourier transform of InputA (result will be in "_g1")
     InputA.copyToBuffer ( _f );
-    ConvType::fftwExecute ( _forwardPlan );
+    ConvType::fftwExecute_dft_r2c ( _forwardPlan, _f, _g1 );
 
     // copy the result of the FFT on the ImageA in "_g1" to "_g2"
     memcpy ( _g2, _g1, sizeof ( FFTWComplex ) * _numComplexPixels );
 
     // compute the Fourier transform of InputB (result will be in "_g1")
     InputB.copyToBuffer ( _f );
-    ConvType::fftwExecute ( _forwardPlan );
+    ConvType::fftwExecute_dft_r2c ( _forwardPlan, _f, _g1 );
   }
 
   void outputDataIFFT ( qc::ScalarArray<RealType, Dim> &Dest ) const {
-    ConvType::fftwExecute ( _backwardPlan );
+    ConvType::fftwExecute_dft_c2r ( _backwardPlan, _g1, _f );
     Dest.readFromBuffer ( _f );
 
     // normalize the result (the FFT and inverse FFT were only inverse to each other up to a constant factor)
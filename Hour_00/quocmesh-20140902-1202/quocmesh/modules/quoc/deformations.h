@@ -53,6 +53,153 @@ void deformImageWithCoarseDeformation ( const aol::MultiVector<typename Configur
     deformImageWithCoarseDeformation<ConfiguratorType> ( Image[i], Finegrid, Coarsegrid, DeformedImage[i], Phidofs );
 }
 
+/**
+ * \brief Interpolates ilex ordered lattice data of the given size at Pos (in lattice coordinates) with the same
+ *        result as qc::ScalarArray<RealType, Dim>::interpolate, but without the overhead of the array classes.
+ *
+ * \author Berkels
+ */
+template <typename RealType, qc::Dimension Dim>
+struct LatticeInterpolation {};
+
+template <typename RealType>
+struct LatticeInterpolation<RealType, qc::QC_1D> {
+  static RealType interpolate ( const RealType *Data, const aol::Vec3<int> &Size, const RealType *Pos ) {
+    const int p = static_cast<int> ( Pos[0] );
+    if ( p == Size[0] - 1 )
+      return Data[p];
+    const RealType pf = Pos[0] - p;
+    return ( 1 - pf ) * Data[p] + pf * Data[p + 1];
+  }
+};
+
+template <typename RealType>
+struct LatticeInterpolation<RealType, qc::QC_2D> {
+  static RealType interpolate ( const RealType *Data, const aol::Vec3<int> &Size, const RealType *Pos ) {
+    RealType X = Pos[0], Y = Pos[1];
+    int xL = static_cast<int> ( X ), yL = static_cast<int> ( Y );
+
+    if ( X >= static_cast<RealType> ( Size[0] - 1 ) ) xL = Size[0] - 2;
+    if ( Y >= static_cast<RealType> ( Size[1] - 1 ) ) yL = Size[1] - 2;
+    if ( X < 0. ) xL = 0;
+    if ( Y < 0. ) yL = 0;
+
+    X -= xL;
+    Y -= yL;
+
+    const RealType *v = Data + yL * Size[0] + xL;
+    return ( ( 1 - X ) * ( 1 - Y ) * v[0] + X * ( 1 - Y ) * v[1] +
+             ( 1 - X ) *   Y * v[Size[0]] + X *   Y * v[Size[0] + 1] );
+  }
+};
+
+template <typename RealType>
+struct LatticeInterpolation<RealType, qc::QC_3D> {
+  static RealType interpolate ( const RealType *Data, const aol::Vec3<int> &Size, const RealType *Pos ) {
+    RealType X = Pos[0], Y = Pos[1], Z = Pos[2];
+    int xL = static_cast<int> ( X ), yL = static_cast<int> ( Y ), zL = static_cast<int> ( Z );
+
+    if ( X == static_cast<RealType> ( Size[0] - 1 ) ) xL -= 1;
+    if ( Y == static_cast<RealType> ( Size[1] - 1 ) ) yL -= 1;
+    if ( Z == static_cast<RealType> ( Size[2] - 1 ) ) zL -= 1;
+
+    X -= xL;
+    Y -= yL;
+    Z -= zL;
+
+    const int strideY = Size[0], strideZ = Size[0] * Size[1];
+    const RealType *v = Data + zL * strideZ + yL * strideY + xL;
+    const RealType oneMinusY = 1 - Y;
+    const RealType oneMinusZ = 1 - Z;
+    return (  ( 1 - X ) * ( oneMinusY * ( oneMinusZ * v[0] + Z * v[strideZ] )
+                            + Y * ( oneMinusZ * v[strideY] + Z * v[strideY + strideZ] ) )
+              + X * ( oneMinusY * ( oneMinusZ * v[1] + Z * v[strideZ + 1] )
+                      + Y * ( oneMinusZ * v[strideY + 1] + Z * v[strideY + strideZ + 1] ) ) );
+  }
+};
+
+/**
+ * \brief Kernel of the DeformImage variants working on the raw ilex ordered data of the image, the
+ *        deformed image and the components of the displacement Phi.
+ *
+ * The image is processed row by row and the rows are distributed among the OpenMP threads. For each row,
+ * the deformed positions and the mask of positions inside of the domain are computed in branch free loops
+ * the compiler can vectorize, afterwards the image is interpolated at these positions. Outside of the domain,
+ * ExtendImage is used if it is not NULL, ExtensionConstant otherwise. If ExtendOutsideOfDomain is false,
+ * the positions are clamped to the domain instead.
+ *
+ * \author Berkels
+ */
+template <typename RealType, qc::Dimension Dim>
+void deformLatticeData ( const RealType *Image,
+                         const aol::Vec3<int> &Size,
+                         const RealType H,
+                         const RealType * const *Phi,
+                         RealType *DeformedImage,
+                         const bool ExtendOutsideOfDomain,
+                         const RealType ExtensionConstant,
+                         const RealType *ExtendImage,
+                         const bool NearestNeighborInterpolation ) {
+  const int numX = Size[0];
+  const int numY = ( Dim > 1 ) ? Size[1] : 1;
+  const int numRows = numY * ( ( Dim > 2 ) ? Size[2] : 1 );
+
+  // Positions of the current row, one block of numX values per component.
+  std::vector<RealType> positions ( Dim * numX );
+  std::vector<unsigned char> inDomain ( numX );
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate ( positions, inDomain )
+#endif
+  for ( int row = 0; row < numRows; ++row ) {
+    const int offset = row * numX;
+    const RealType rowCoord[2] = { static_cast<RealType> ( row % numY ), static_cast<RealType> ( row / numY ) };
+
+    for ( int i = 0; i < Dim; ++i ) {
+      RealType *pos = &positions[i * numX];
+      const RealType *phi = Phi[i] + offset;
+      if ( i == 0 ) {
+        for ( int x = 0; x < numX; ++x )
+          pos[x] = static_cast<RealType> ( x ) + phi[x] / H;
+      }
+      else {
+        for ( int x = 0; x < numX; ++x )
+          pos[x] = rowCoord[i - 1] + phi[x] / H;
+      }
+    }
+
+    for ( int x = 0; x < numX; ++x )
+      inDomain[x] = 1;
+    for ( int i = 0; i < Dim; ++i ) {
+      RealType *pos = &positions[i * numX];
+      const RealType upper = static_cast<RealType> ( Size[i] - 1 );
+      if ( ExtendOutsideOfDomain ) {
+        // The comparisons are false for NaN, so NaN positions are masked out too.
+        for ( int x = 0; x < numX; ++x )
+          inDomain[x] &= static_cast<unsigned char> ( ( pos[x] >= aol::ZOTrait<RealType>::zero ) & ( pos[x] <= upper ) );
+      }
+      else {
+        for ( int x = 0; x < numX; ++x )
+          pos[x] = aol::Clamp ( pos[x], aol::ZOTrait<RealType>::zero, upper );
+      }
+      if ( NearestNeighborInterpolation ) {
+        for ( int x = 0; x < numX; ++x )
+          pos[x] = static_cast<RealType> ( aol::Rint ( pos[x] ) );
+      }
+    }
+
+    for ( int x = 0; x < numX; ++x ) {
+      if ( inDomain[x] ) {
+        RealType pos[Dim];
+        for ( int i = 0; i < Dim; ++i )
+          pos[i] = positions[i * numX + x];
+        DeformedImage[offset + x] = LatticeInterpolation<RealType, Dim>::interpolate ( Image, Size, pos );
+      }
+      else
+        DeformedImage[offset + x] = ( ExtendImage != NULL ) ? ExtendImage[offset + x] : ExtensionConstant;
+    }
+  }
+}
+
 /**
  * \brief DeformedImage = Image circ Phi
  *
@@ -71,32 +218,12 @@ void DeformImage ( const aol::Vector<typename ConfiguratorType::RealType> &Image
   typename ConfiguratorType::ArrayType deformedImageArray ( DeformedImage, Grid, aol::FLAT_COPY );
   const qc::MultiArray<RealType, ConfiguratorType::Dim> phiMArray ( Grid, Phi, aol::FLAT_COPY );
 
-  const aol::Vec3<int> gridSize = Grid.getSize();
-  const RealType h = static_cast<RealType> ( Grid.H() );
-
-  typename ConfiguratorType::InitType::OldAllNodeIterator fnit;
-  for ( fnit = Grid._nBeginIt; fnit != Grid._nEndIt; ++fnit ) {
-    typename ConfiguratorType::VecType ds;
-
-    bool transformPositionInDomain = true;
-
-    for ( int i = 0; i < ConfiguratorType::Dim; i++ ) {
-      ds[i] = ( *fnit ) [i] + phiMArray[i].get ( *fnit ) / h;
-      if ( ExtendWithConstant == true ) {
-        if ( ds[i] < aol::ZOTrait<RealType>::zero || ds[i] > static_cast<RealType> ( gridSize[i] - 1 ) || aol::isNaN ( ds[i] ) )
-          transformPositionInDomain = false;
-      } else
-        ds[i] = aol::Clamp ( ds[i], aol::ZOTrait<RealType>::zero, static_cast<RealType> ( gridSize[i] - 1 ) );
-
-      if ( NearestNeighborInterpolation )
-        ds[i] = aol::Rint ( ds[i] );
-    }
+  const RealType *phi[ConfiguratorType::Dim];
+  for ( int i = 0; i < ConfiguratorType::Dim; ++i )
+    phi[i] = phiMArray[i].getData();
 
-    RealType value = ExtensionConstant;
-    if ( transformPositionInDomain == true )
-      value = imageArray.interpolate ( ds );
-    deformedImageArray.set ( *fnit, value );
-  }
+  deformLatticeData<RealType, ConfiguratorType::Dim> ( imageArray.getData(), Grid.getSize(), static_cast<RealType> ( Grid.H() ), phi, deformedImageArray.getData(),
+                                                       ExtendWithConstant, ExtensionConstant, NULL, NearestNeighborInterpolation );
 }
 
 /**
@@ -127,30 +254,66 @@ void DeformImage ( const aol::Vector<typename ConfiguratorType::RealType> &Image
                    const aol::MultiVector<typename ConfiguratorType::RealType> &Phi,
                    const aol::Vector<typename ConfiguratorType::RealType> &ExtendImage ) {
   typedef typename ConfiguratorType::RealType RealType;
-  typename ConfiguratorType::ArrayType imageArray ( Image, Grid, aol::FLAT_COPY );
+  const typename ConfiguratorType::ArrayType imageArray ( Image, Grid, aol::FLAT_COPY );
   typename ConfiguratorType::ArrayType deformedImageArray ( DeformedImage, Grid, aol::FLAT_COPY );
-  typename ConfiguratorType::ArrayType extendImageArray ( ExtendImage, Grid, aol::FLAT_COPY );
+  const typename ConfiguratorType::ArrayType extendImageArray ( ExtendImage, Grid, aol::FLAT_COPY );
 
-  const int num = Grid.getNumX();
-  const RealType h = Grid.H();
+  const RealType *phi[ConfiguratorType::Dim];
+  for ( int i = 0; i < ConfiguratorType::Dim; ++i )
+    phi[i] = Phi[i].getData();
 
-  qc::FastILexMapper<ConfiguratorType::Dim> mapper ( Grid );
-  for ( qc::RectangularIterator<ConfiguratorType::Dim> fnit ( Grid ); fnit.notAtEnd(); ++fnit ) {
-    typename ConfiguratorType::VecType ds;
+  deformLatticeData<RealType, ConfiguratorType::Dim> ( imageArray.getData(), Grid.getSize(), static_cast<RealType> ( Grid.H() ), phi, deformedImageArray.getData(),
+                                                       true, aol::ZOTrait<RealType>::zero, extendImageArray.getData(), false );
+}
 
-    bool transformPositionInDomain = true;
+/**
+ * \brief DeformedImage = Image circ Phi, computed node by node with an OldAllNodeIterator.
+ *
+ * This is the implementation of DeformImage before it was based on deformLatticeData. It is much slower and only kept
+ * as reference for tests and benchmarks. If ExtendImage is not NULL, it is used outside of the domain, like the
+ * DeformImage variant with an extension image does.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+void deformImageWithNodeIterator ( const aol::Vector<typename ConfiguratorType::RealType> &Image,
+                                   const typename ConfiguratorType::InitType &Grid,
+                                   aol::Vector<typename ConfiguratorType::RealType> &DeformedImage,
+                                   const aol::MultiVector<typename ConfiguratorType::RealType> &Phi,
+                                   const bool ExtendWithConstant,
+                                   const typename ConfiguratorType::RealType ExtensionConstant,
+                                   const bool NearestNeighborInterpolation,
+                                   const aol::Vector<typename ConfiguratorType::RealType> *ExtendImage = NULL ) {
+  typedef typename ConfiguratorType::RealType RealType;
+  const typename ConfiguratorType::ArrayType imageArray ( Image, Grid, aol::FLAT_COPY );
+  typename ConfiguratorType::ArrayType deformedImageArray ( DeformedImage, Grid, aol::FLAT_COPY );
+  const typename ConfiguratorType::ArrayType extendImageArray ( ( ExtendImage != NULL ) ? *ExtendImage : Image, Grid, aol::FLAT_COPY );
+  const qc::MultiArray<RealType, ConfiguratorType::Dim> phiMArray ( Grid, Phi, aol::FLAT_COPY );
 
+  const aol::Vec3<int> gridSize = Grid.getSize();
+  const RealType h = static_cast<RealType> ( Grid.H() );
+
+  typename ConfiguratorType::InitType::OldAllNodeIterator fnit;
+  for ( fnit = Grid._nBeginIt; fnit != Grid._nEndIt; ++fnit ) {
+    typename ConfiguratorType::VecType ds;
+    bool transformPositionInDomain = true;
     for ( int i = 0; i < ConfiguratorType::Dim; i++ ) {
-      ds[i] = ( *fnit ) [i] + Phi[i].get ( mapper.getGlobalIndex ( *fnit ) ) / h;
-      if ( ds[i] < aol::ZOTrait<RealType>::zero || ds[i] > static_cast<RealType> ( num - 1 ) )
-        transformPositionInDomain = false;
+      ds[i] = ( *fnit ) [i] + phiMArray[i].get ( *fnit ) / h;
+      if ( ExtendWithConstant == true ) {
+        if ( ds[i] < aol::ZOTrait<RealType>::zero || ds[i] > static_cast<RealType> ( gridSize[i] - 1 ) || aol::isNaN ( ds[i] ) )
+          transformPositionInDomain = false;
+      } else
+        ds[i] = aol::Clamp ( ds[i], aol::ZOTrait<RealType>::zero, static_cast<RealType> ( gridSize[i] - 1 ) );
+
+      if ( NearestNeighborInterpolation )
+        ds[i] = aol::Rint ( ds[i] );
     }
+
+    RealType value = ( ExtendImage != NULL ) ? extendImageArray.get ( *fnit ) : ExtensionConstant;
     if ( transformPositionInDomain == true )
-      deformedImageArray.set ( *fnit, imageArray.interpolate ( ds ) );
-    else
-      deformedImageArray.set ( *fnit, extendImageArray.get ( *fnit ) );
+      value = imageArray.interpolate ( ds );
+    deformedImageArray.set ( *fnit, value );
   }
-  return;
 }
 
 template <typename ConfiguratorType>
@@ -2,12 +2,17 @@
 #define __DM3IMPORT_H
 
 #include <scalarArray.h>
+#include <vectorExtensions.h>
 
 namespace qc {
 
 /**
  * Class to parse version 3 and 4 of the Gatan Digital Micrograph file format.
  *
+ * The constructor parses the tag tree in a single pass and builds an index of all tags (see getTags),
+ * their values are only read on demand, e.g. with getTagValue or getPixelSize. Thus, metadata can be
+ * extracted from many files without reading the image data.
+ *
  * \note The DM3/DM4 format parsing should work with most DM3/DM4 files, but the actual data extraction is
  *       rather hackish and only works with a small subset of files compliant with the DM3/DM4 format.
  *
@@ -16,8 +21,8 @@ namespace qc {
 class DM3Reader {
   struct DM3ImageData {
     int num;
-    int offset;
-    int dataSize;
+    int64_t offset;
+    int64_t dataSize;
     int dataType;
     int numX;
     int numY;
@@ -50,45 +55,98 @@ class DM3Reader {
     }
   };
 
-  std::vector<std::string> _currentTag;
+public:
+  /**
+   * Entry of the tag index: Position and DM type of the value of a tag. For arrays (type 20), elementType
+   * is the type of the elements (15 for arrays of groups) and length the number of elements, for groups
+   * (type 15) length is the number of group entries. Tag directories are indexed with type 0 and the
+   * number of tags in the directory as length.
+   */
+  struct DM3Tag {
+    int64_t offset;
+    int type;
+    int elementType;
+    int64_t length;
+    DM3Tag ( )
+      : offset ( -1 ),
+        type ( -1 ),
+        elementType ( -1 ),
+        length ( 0 ) { }
+  };
+
+  typedef std::map<std::string, DM3Tag> TagIndexType;
+
+private:
+  //! Read position in the mapped file while parsing the tag tree.
+  class TagTreeCursor {
+    const char *_begin, *_pos, *_end;
+  public:
+    TagTreeCursor ( const char *Data, const size_t Size )
+      : _begin ( Data ), _pos ( Data ), _end ( Data + Size ) { }
+
+    int64_t tell ( ) const {
+      return _pos - _begin;
+    }
+
+    const char* read ( const int64_t NumBytes ) {
+      if ( ( NumBytes < 0 ) || ( NumBytes > _end - _pos ) )
+        throw aol::IOException ( "qc::DM3Reader: Unexpected end of file", __FILE__, __LINE__ );
+      const char *pos = _pos;
+      _pos += NumBytes;
+      return pos;
+    }
+
+    //! The tag tree structure is stored big endian.
+    template <typename DataType>
+    DataType readBigEndian ( ) {
+      DataType value;
+      memcpy ( &value, read ( sizeof ( DataType ) ), sizeof ( DataType ) );
+      return aol::isLittleEndianMachine() ? aol::swapByteOrder<DataType> ( value ) : value;
+    }
+  };
+
+  TagIndexType _tags;
   std::vector<DM3ImageData> _dataEntries;
+  std::vector<int64_t> _info;
   ifstream _in;
   int _version;
 
-  int64_t readInterger ( ifstream &In ) {
+  int64_t readInteger ( TagTreeCursor &Cursor ) const {
     if ( _version == 3 )
-      return aol::swapByteOrder<int32_t> ( aol::readBinaryData<int32_t, int32_t> ( In ) );
+      return Cursor.readBigEndian<int32_t> ( );
     else
-      return aol::swapByteOrder<int64_t> ( aol::readBinaryData<int64_t, int64_t> ( In ) );
+      return Cursor.readBigEndian<int64_t> ( );
   }
 
 public:
+  /**
+   * Parses the tag tree of InputFileName and builds the tag index. The file is memory mapped while
+   * parsing, so only the pages containing tags are read, the image data is skipped.
+   */
   DM3Reader ( const string &InputFileName )
    : _in ( InputFileName.c_str(), ios::binary ), _version ( 3 ) {
 
     if ( _in.good() == false )
       throw aol::FileException ( aol::strprintf ( "Cannot open file %s for reading", InputFileName.c_str() ).c_str(), __FILE__, __LINE__ );
 
-    _version = aol::swapByteOrder<int32_t> ( aol::readBinaryData<int32_t, int32_t> ( _in ) );
+    const aol::MemoryMappedFile file ( InputFileName );
+    TagTreeCursor cursor ( file.getData(), file.getSize() );
+
+    _version = cursor.readBigEndian<int32_t> ( );
     if ( ( _version != 3 ) && ( _version != 4 ) )
       throw aol::IOException ( aol::strprintf ( "Unexpected version (got %d), expected 3 or 4", _version ).c_str(), __FILE__, __LINE__ );
 
-     /*const int fileLength =*/ readInterger ( _in );
+     /*const int fileLength =*/ readInteger ( cursor );
 
-    const int byteOrder = aol::swapByteOrder<int32_t> ( aol::readBinaryData<int32_t, int32_t> ( _in ) );
+    const int byteOrder = cursor.readBigEndian<int32_t> ( );
     if ( byteOrder != 1 )
       throw aol::UnimplementedCodeException ( "Reading of detected byte order not implemented", __FILE__, __LINE__ );
 
-    readSortedClosed ( _in );
-
-    /*const int numTags =*/ readInterger ( _in );
+    string path;
+    parseTagDirectory ( cursor, path, -1 );
 
-    do {
-      if ( readTagOrTagDir ( _in ) == 0 )
-        break;
-
-      _currentTag.clear();
-    } while ( true );
+    for ( unsigned int i = 0; i < _dataEntries.size(); ++i )
+      initDataEntry ( _dataEntries[i], file.getData() );
   }
 
   const DM3ImageData& getDataEntry ( ) const {
@@ -98,6 +156,97 @@ public:
     throw aol::Exception ( "No data entry found.", __FILE__, __LINE__ );
   }
 
+  //! Index of all tags in the file, the path of a tag consists of the names of its parent directories and its
+  //! own name separated by dots, e.g. "ImageList.1.ImageData.Calibrations.Dimension.0.Scale". Unnamed tags
+  //! are named by their index in the parent directory.
+  const TagIndexType& getTags ( ) const {
+    return _tags;
+  }
+
+  bool hasTag ( const string &Path ) const {
+    return ( _tags.find ( Path ) != _tags.end() );
+  }
+
+  const DM3Tag& getTag ( const string &Path ) const {
+    const TagIndexType::const_iterator it = _tags.find ( Path );
+    if ( it == _tags.end() )
+      throw aol::Exception ( aol::strprintf ( "qc::DM3Reader: Tag \"%s\" not found", Path.c_str() ).c_str(), __FILE__, __LINE__ );
+    return it->second;
+  }
+
+  //! Reads the value of a tag (or element Index of an array tag) and converts it to DataType.
+  template <typename DataType>
+  DataType getTagValue ( const string &Path, const int64_t Index = 0 ) {
+    const DM3Tag &tag = getTag ( Path );
+    const int type = ( tag.type == 20 ) ? tag.elementType : tag.type;
+    if ( ( type == 0 ) || ( type == 15 ) )
+      throw aol::TypeException ( aol::strprintf ( "qc::DM3Reader::getTagValue: Tag \"%s\" is not a number or array of numbers", Path.c_str() ).c_str(), __FILE__, __LINE__ );
+    if ( ( Index < 0 ) || ( Index >= tag.length ) )
+      throw aol::OutOfBoundsException ( aol::strprintf ( "qc::DM3Reader::getTagValue: Index out of bounds for \"%s\"", Path.c_str() ).c_str(), __FILE__, __LINE__ );
+
+    const int size = getSizeOfValue ( type );
+    char value[8];
+    _in.clear();
+    _in.seekg ( tag.offset + Index * size );
+    _in.read ( value, size );
+    if ( _in.fail() )
+      throw aol::IOException ( aol::strprintf ( "qc::DM3Reader::getTagValue: Error reading \"%s\"", Path.c_str() ).c_str(), __FILE__, __LINE__ );
+    return convertValue<DataType> ( value, type );
+  }
+
+  //! Reads a string tag, i.e. an array of UTF-16 characters (type 4) or bytes. Non-ASCII characters are replaced by '?'.
+  string getTagString ( const string &Path ) {
+    const DM3Tag &tag = getTag ( Path );
+    if ( ( tag.type != 20 ) || ( ( tag.elementType != 4 ) && ( tag.elementType != 9 ) && ( tag.elementType != 10 ) ) )
+      throw aol::TypeException ( aol::strprintf ( "qc::DM3Reader::getTagString: Tag \"%s\" is not a string", Path.c_str() ).c_str(), __FILE__, __LINE__ );
+
+    const int size = getSizeOfValue ( tag.elementType );
+    std::vector<char> data ( tag.length * size );
+    _in.clear();
+    _in.seekg ( tag.offset );
+    if ( tag.length > 0 )
+      _in.read ( &data[0], data.size() );
+    if ( _in.fail() )
+      throw aol::IOException ( aol::strprintf ( "qc::DM3Reader::getTagString: Error reading \"%s\"", Path.c_str() ).c_str(), __FILE__, __LINE__ );
+
+    string result ( tag.length, '?' );
+    for ( int64_t i = 0; i < tag.length; ++i ) {
+      const int c = ( size == 2 ) ? convertValue<int> ( &data[2*i], 4 ) : static_cast<unsigned char> ( data[i] );
+      if ( c < 128 )
+        result[i] = static_cast<char> ( c );
+    }
+    return result;
+  }
+
+  //! Path of the tag SubPath of the image returned by getDataEntry, e.g. "ImageList.1.ImageTags.DataBar".
+  string getImageTagPath ( const string &SubPath ) const {
+    return aol::strprintf ( "ImageList.%d.", getDataEntry().num ) + SubPath;
+  }
+
+  //! Calibrated size of a pixel in direction Direction, measured in the unit returned by getPixelSizeUnit.
+  double getPixelSize ( const int Direction = 0 ) {
+    return getTagValue<double> ( getImageTagPath ( aol::strprintf ( "ImageData.Calibrations.Dimension.%d.Scale", Direction ) ) );
+  }
+
+  string getPixelSizeUnit ( const int Direction = 0 ) {
+    return getTagString ( getImageTagPath ( aol::strprintf ( "ImageData.Calibrations.Dimension.%d.Units", Direction ) ) );
+  }
+
+  //! Exposure time in seconds.
+  double getExposureTime ( ) {
+    return getTagValue<double> ( getImageTagPath ( "ImageTags.DataBar.Exposure Time (s)" ) );
+  }
+
+  //! Acquisition date as formatted by Digital Micrograph.
+  string getAcquisitionDate ( ) {
+    return getTagString ( getImageTagPath ( "ImageTags.DataBar.Acquisition Date" ) );
+  }
+
+  //! Acquisition time as formatted by Digital Micrograph.
+  string getAcquisitionTime ( ) {
+    return getTagString ( getImageTagPath ( "ImageTags.DataBar.Acquisition Time" ) );
+  }
+
 
   template <typename DataType>
   void exportDataToScalarArray ( qc::ScalarArray<DataType, qc::QC_2D> &Array ) {
@@ -113,30 +262,140 @@ public:
     Array.loadRaw ( _in, dataEntry.getSaveType(), dataEntry.numX, dataEntry.numY, ( dataEntry.numZ > 1 ) ? dataEntry.numZ : 1 );
   }
 
-  void saveDataAsScalarArray ( const string &OutBaseName, const bool WriteSlices = false ) {
+  /**
+   * Saves the image data in the pgm style format using the data type stored in the DM3/DM4 file,
+   * i.e. the data is neither converted nor widened. Loading the result into a ScalarArray of any
+   * other data type converts the values while reading.
+   */
+  void saveDataAsScalarArray ( const string &OutBaseName, const bool WriteSlices = false, const int NumThreads = 1 ) {
+    switch ( getDataEntry().getSaveType() ) {
+      case qc::PGM_SHORT_BINARY:
+        saveDataAsScalarArray<short> ( OutBaseName, WriteSlices, NumThreads );
+        break;
+      case qc::PGM_UNSIGNED_SHORT_BINARY:
+        saveDataAsScalarArray<unsigned short> ( OutBaseName, WriteSlices, NumThreads );
+        break;
+      case qc::PGM_SIGNED_INT_BINARY:
+        saveDataAsScalarArray<int> ( OutBaseName, WriteSlices, NumThreads );
+        break;
+      case qc::PGM_UNSIGNED_INT_BINARY:
+        saveDataAsScalarArray<unsigned int> ( OutBaseName, WriteSlices, NumThreads );
+        break;
+      default:
+        saveDataAsScalarArray<float> ( OutBaseName, WriteSlices, NumThreads );
+    }
+  }
+
+  //! Converts the image data to DataType and saves it using the SaveType matching DataType.
+  //! Slices are written with saveFramesAsScalarArrays.
+  template <typename DataType>
+  void saveDataAsScalarArray ( const string &OutBaseName, const bool WriteSlices, const int NumThreads ) {
     const DM3ImageData& dataEntry = getDataEntry();
+    const qc::SaveType saveType = static_cast<qc::SaveType> ( aol::FileFormatMagicNumber<DataType>::FFType );
     if ( dataEntry.numZ > 1 ) {
-      qc::ScalarArray<double, qc::QC_3D> a;
-      exportDataToScalarArray ( a );
       if ( WriteSlices )
-        a.saveSlices( ( string ( OutBaseName ) + "_%03d" + qc::getDefaultArraySuffix ( qc::QC_2D ) ).c_str(), qc::QC_Z, qc::PGM_DOUBLE_BINARY );
-      else
-        a.save ( ( string ( OutBaseName ) + qc::getDefaultArraySuffix ( qc::QC_3D ) ).c_str(), qc::PGM_DOUBLE_BINARY );
+        saveFramesAsScalarArrays<DataType> ( ( string ( OutBaseName ) + "_%03d" + qc::getDefaultArraySuffix ( qc::QC_2D ) ).c_str(), saveType, NumThreads );
+      else {
+        qc::ScalarArray<DataType, qc::QC_3D> a;
+        exportDataToScalarArray ( a );
+        a.save ( ( string ( OutBaseName ) + qc::getDefaultArraySuffix ( qc::QC_3D ) ).c_str(), saveType );
+      }
     }
     else {
-      qc::ScalarArray<double, qc::QC_2D> a;
+      qc::ScalarArray<DataType, qc::QC_2D> a;
       exportDataToScalarArray ( a );
-      a.save ( ( string ( OutBaseName ) + qc::getDefaultArraySuffix ( qc::QC_2D ) ).c_str(), qc::PGM_DOUBLE_BINARY );
+      a.save ( ( string ( OutBaseName ) + qc::getDefaultArraySuffix ( qc::QC_2D ) ).c_str(), saveType );
     }
   }
 
+  /**
+   * Saves each frame of the image data as 2D array of type SaveType to the file given by the printf
+   * style FileNameMask, e.g. "frame_%03d.q2bz", converting it to DataType first.
+   *
+   * Unlike exporting the whole stack with exportDataToScalarArray, the frames are read from the file
+   * one after another in a single pass and only NumThreads frames are kept in memory at once, so stacks
+   * that don't fit into memory can be converted. Each batch of NumThreads frames is compressed and
+   * written in parallel (if compiled with OpenMP).
+   */
+  template <typename DataType>
+  void saveFramesAsScalarArrays ( const string &FileNameMask, const qc::SaveType Type, const int NumThreads = 1 ) {
+    if ( NumThreads < 1 )
+      throw aol::Exception ( "qc::DM3Reader::saveFramesAsScalarArrays: NumThreads has to be positive", __FILE__, __LINE__ );
+
+    const DM3ImageData& dataEntry = getDataEntry();
+    const int numFrames = ( dataEntry.numZ > 1 ) ? dataEntry.numZ : 1;
+    const qc::SaveType fileType = dataEntry.getSaveType();
+
+    aol::RandomAccessContainer<qc::ScalarArray<DataType, qc::QC_2D> > frames ( NumThreads, dataEntry.numX, dataEntry.numY );
+    for ( int i = 0; i < NumThreads; ++i )
+      frames[i].setQuietMode ( true );
+
+    _in.clear();
+    _in.seekg ( dataEntry.offset );
+    for ( int batchBegin = 0; batchBegin < numFrames; batchBegin += NumThreads ) {
+      const int batchSize = aol::Min ( NumThreads, numFrames - batchBegin );
+      for ( int i = 0; i < batchSize; ++i )
+        frames[i].loadRaw ( _in, fileType, dataEntry.numX, dataEntry.numY );
+
+      // No exception may leave the parallel region, the first error is thrown after it.
+      int numFailed = 0;
+      string firstError;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( NumThreads ) reduction ( + : numFailed )
+#endif
+      for ( int i = 0; i < batchSize; ++i ) {
+        string error;
+        try {
+          frames[i].save ( aol::strprintf ( FileNameMask.c_str(), batchBegin + i ).c_str(), Type );
+        }
+        catch ( aol::Exception &el ) {
+          el.consume();
+          error = el.getMessage() + " : " + el.getWhere();
+        }
+        catch ( std::exception &ex ) {
+          error = ex.what();
+        }
+        catch ( ... ) {
+          error = "unknown exception";
+        }
+        if ( error.size() > 0 ) {
+          ++numFailed;
+#ifdef _OPENMP
+#pragma omp critical ( DM3Reader_saveFramesAsScalarArrays )
+#endif
+          if ( firstError.size() == 0 )
+            firstError = aol::strprintf ( "frame %d: ", batchBegin + i ) + error;
+        }
+      }
+      if ( numFailed > 0 )
+        throw aol::IOException ( aol::strprintf ( "qc::DM3Reader::saveFramesAsScalarArrays: Failed to save %d frames, first error at %s", numFailed, firstError.c_str() ).c_str(), __FILE__, __LINE__ );
+    }
+  }
+
+  /**
+   * Crops the image data to the rectangle of size CropSize starting at CropStart, averages
+   * each BinSize x BinSize block of it and saves the result as TIFF with 32 bit floating
+   * point precision.
+   */
+  void saveCroppedAndBinnedDataAsTIFF ( const string &OutFileName, const aol::Vec2<int> &CropStart, const aol::Vec2<int> &CropSize, const int BinSize = 1 ) {
+    qc::ScalarArray<float, qc::QC_2D> image;
+    image.setQuietMode ( true );
+    exportDataToScalarArray ( image );
+
+    qc::ScalarArray<float, qc::QC_2D> binnedImage;
+    binnedImage.setQuietMode ( true );
+    binnedImage.cropAndBinFrom ( image, CropStart, CropSize, BinSize );
+    binnedImage.saveTIFF ( OutFileName.c_str() );
+  }
+
   template <typename RealType>
   void saveQuocDataInDM3Container ( const qc::ScalarArray<RealType, qc::QC_2D> &QuocData, const string &OutBaseName ) {
-    const int offset = getDataEntry().offset;
+    const int64_t offset = getDataEntry().offset;
 
     // get length of file:
+    _in.clear();
     _in.seekg ( 0, _in.end );
-    const int length = _in.tellg();
+    const int64_t length = _in.tellg();
     _in.seekg ( 0, _in.beg );
     const string outFileName = ( OutBaseName + ( ( _version == 3 ) ? ".dm3" : ".dm4" ) );
     std::ofstream out ( outFileName.c_str(), ios::binary );
@@ -147,241 +406,227 @@ public:
     if  ( getDataEntry().dataType != 4 )
       throw aol::UnimplementedCodeException ( "DataType not handled", __FILE__, __LINE__ );
 
-    for ( int i = 0; i < offset; ++i )
+    for ( int64_t i = 0; i < offset; ++i )
       out.put ( _in.get() );
 
     qc::ScalarArray<RealType, qc::QC_2D> paddedArray ( getDataEntry().numX, getDataEntry().numY );
     paddedArray.padFrom ( QuocData );
-    for ( int i = 0; i < getDataEntry().dataSize; ++i )
+    for ( int i = 0; i < paddedArray.size(); ++i )
       aol::writebinary<uint16_t> ( out, paddedArray[i] );
 
     _in.seekg ( ( offset + getDataEntry().dataSize * 2 ), _in.beg );
-    for ( int i = ( offset + getDataEntry().dataSize * 2 ); i < length; ++i )
+    for ( int64_t i = ( offset + getDataEntry().dataSize * 2 ); i < length; ++i )
       out.put ( _in.get() );
   }
 protected:
-  void readTagName ( ifstream &in, const int DirNum ) {
-    const int tagNameLength = aol::swapByteOrder<int16_t> ( aol::readBinaryData<int16_t, int16_t> ( in ) );
-    if ( tagNameLength < 0 )
-      throw aol::IOException ( "negative tag name length.", __FILE__, __LINE__ );
-
-    char *tagName = new char[tagNameLength+1];
-    aol::readBinaryData<char, char> ( in, tagName, tagNameLength );
-    tagName[tagNameLength] = 0;
-    string tagNameString = tagName;
-    if ( tagNameLength > 0 )
-      _currentTag.push_back ( tagName );
-    else if ( DirNum > -1 )
-      _currentTag.push_back ( aol::strprintf ( "%d", DirNum ) );
-    else
-      _currentTag.push_back ( "nameless" );
-    delete[] tagName;
-
-    if ( ( _currentTag.size() == 3 )
-      && ( _currentTag[0] == "ImageList" )
-      && ( _currentTag[2] == "ImageData" ) ) {
-      _dataEntries.push_back( DM3ImageData() );
-      _dataEntries.back().num = atoi ( _currentTag[1].c_str() );
-    }
-  }
-
-  string getCurrentTag ( ) const {
-    string tag;
-    for ( unsigned int i = 0; i < _currentTag.size(); ++i ) {
-      tag += _currentTag[i];
-      if ( i < _currentTag.size() - 1 )
-        tag += ".";
+  static int getSizeOfValue ( const int Type ) {
+    switch( Type ) {
+    case 2:
+    case 4:
+      return 2;
+    case 3:
+    case 5:
+    case 6:
+      return 4;
+    case 7:
+    case 11:
+    case 12:
+      return 8;
+    case 8:
+    case 9:
+    case 10:
+      return 1;
+    default:
+      throw aol::UnimplementedCodeException ( aol::strprintf ( "type %d not implemented ", Type ).c_str(), __FILE__, __LINE__ );
     }
-    return tag;
   }
 
-  void readSortedClosed ( ifstream &in ) {
-    /*const int sorted =*/ aol::readBinaryData<unsigned char, int> ( in );
-    /*const int closed =*/ aol::readBinaryData<unsigned char, int> ( in );
+  //! The values of tags are stored little endian.
+  template <typename DataType, typename ValueType>
+  static DataType convertValue ( const char *Value ) {
+    ValueType value;
+    memcpy ( &value, Value, sizeof ( ValueType ) );
+    return static_cast<DataType> ( aol::isLittleEndianMachine() ? value : aol::swapByteOrder<ValueType> ( value ) );
   }
 
+  //! Converts a value of type Type stored in the file (little endian) to DataType.
   template <typename DataType>
-  DataType parseValue ( ifstream &in ) {
-    return aol::readBinaryData<DataType, DataType> ( in );
-  }
-
-  void readValue ( ifstream &in, const int Type ) {
+  static DataType convertValue ( const char *Value, const int Type ) {
     switch( Type ) {
     case 2:
-      parseValue<int16_t> ( in );
-      break;
+      return convertValue<DataType, int16_t> ( Value );
     case 3:
-      parseValue<int32_t> ( in );
-      break;
+      return convertValue<DataType, int32_t> ( Value );
     case 4:
-      parseValue<uint16_t> ( in );
-      break;
+      return convertValue<DataType, uint16_t> ( Value );
     case 5:
-      parseValue<uint32_t> ( in );
-      break;
+      return convertValue<DataType, uint32_t> ( Value );
     case 6:
-      parseValue<float> ( in );
-      break;
+      return convertValue<DataType, float> ( Value );
     case 7:
-      parseValue<double> ( in );
-      break;
+      return convertValue<DataType, double> ( Value );
     case 8:
     case 10:
-      parseValue<signed char> ( in );
-      break;
+      return convertValue<DataType, unsigned char> ( Value );
+    case 9:
+      return convertValue<DataType, signed char> ( Value );
     case 11:
+      return convertValue<DataType, int64_t> ( Value );
     case 12:
-      parseValue<int64_t> ( in );
-      break;
+      return convertValue<DataType, uint64_t> ( Value );
     default:
       throw aol::UnimplementedCodeException ( aol::strprintf ( "type %d not implemented ", Type ).c_str(), __FILE__, __LINE__ );
     }
   }
 
-  void readTag ( ifstream &in ) {
-    // Read "%%%%"
-    for ( int i = 0; i < 4; ++i )
-      if ( aol::readBinaryData<unsigned char, unsigned char> ( in ) != '%' )
-        throw aol::IOException ( "Unexpected character read", __FILE__, __LINE__ );
+  //! Fills the image data entry from the tags ImageList.<num>.ImageData.{Data,DataType,Dimensions.*}.
+  void initDataEntry ( DM3ImageData &Entry, const char *FileData ) const {
+    const string prefix = aol::strprintf ( "ImageList.%d.ImageData.", Entry.num );
+    TagIndexType::const_iterator it = _tags.find ( prefix + "Data" );
+    if ( ( it != _tags.end() ) && ( it->second.type == 20 ) && ( it->second.elementType != 15 ) ) {
+      Entry.offset = it->second.offset;
+      Entry.dataType = it->second.elementType;
+      Entry.dataSize = it->second.length;
+    }
+
+    it = _tags.find ( prefix + "DataType" );
+    if ( ( it != _tags.end() ) && ( it->second.type == 5 ) )
+      Entry.declaredType = convertValue<int> ( FileData + it->second.offset, 5 );
+
+    int *dims[3] = { &Entry.numX, &Entry.numY, &Entry.numZ };
+    for ( int i = 0; i < 3; ++i ) {
+      it = _tags.find ( aol::strprintf ( "%sDimensions.%d", prefix.c_str(), i ) );
+      if ( ( it != _tags.end() ) && ( it->second.type == 5 ) )
+        *dims[i] = convertValue<int> ( FileData + it->second.offset, 5 );
+    }
+  }
 
-    const int64_t infoSize = readInterger( in );
+  //! Returns the number of bytes of the values of a group with the type info starting at Info[First].
+  int64_t getGroupSize ( const int First ) const {
+    if ( _info[First] != 0 )
+      throw aol::IOException ( "length of groupname has to be zero", __FILE__, __LINE__ );
 
-    aol::Vector<int64_t> info ( infoSize );
-    for ( int i = 0; i < infoSize; ++i )
-      info[i] = readInterger ( in );
+    const int64_t numGroupEntries = _info[First+1];
+    if ( ( numGroupEntries < 0 ) || ( static_cast<int64_t> ( _info.size() ) < First + 2 + 2*numGroupEntries ) )
+      throw aol::IOException ( "inconsistent sizes", __FILE__, __LINE__ );
 
+    int64_t size = 0;
+    for ( int64_t i = 0; i < numGroupEntries; ++i ) {
+      if ( _info[First+2+2*i] != 0 )
+        throw aol::IOException ( "length of fieldname has to be zero", __FILE__, __LINE__ );
+      size += getSizeOfValue ( _info[First+3+2*i] );
+    }
+    return size;
+  }
+
+  void parseTag ( TagTreeCursor &Cursor, const string &Path ) {
+    if ( memcmp ( Cursor.read ( 4 ), "%%%%", 4 ) != 0 )
+      throw aol::IOException ( "Unexpected character read", __FILE__, __LINE__ );
+
+    const int64_t infoSize = readInteger ( Cursor );
     if ( infoSize < 1 )
       throw aol::IOException ( "Info size must be positive", __FILE__, __LINE__ );
-    else if ( infoSize == 1 ) {
-      if ( ( _dataEntries.size() > 0 ) && ( _currentTag.size() == 5 )
-        && ( _currentTag[0] == "ImageList" )
-        && ( _dataEntries.back().num == atoi ( _currentTag[1].c_str() ) )
-        && ( _currentTag[2] == "ImageData" )
-        && ( _currentTag[3] == "Dimensions" )
-        && ( info[0] == 5 ) ) {
-        const int dir = atoi ( _currentTag[4].c_str() );
-        const int numXYZ = aol::readBinaryData<uint32_t, int> ( in );
-        if ( dir == 0 )
-          _dataEntries.back().numX = numXYZ;
-        else if ( dir == 1 )
-          _dataEntries.back().numY = numXYZ;
-        else if ( dir == 2 )
-          _dataEntries.back().numZ = numXYZ;
+
+    _info.resize ( infoSize );
+    for ( int64_t i = 0; i < infoSize; ++i )
+      _info[i] = readInteger ( Cursor );
+
+    DM3Tag tag;
+    tag.offset = Cursor.tell();
+    tag.type = _info[0];
+    int64_t size = 0;
+    if ( infoSize == 1 ) {
+      tag.length = 1;
+      size = getSizeOfValue ( tag.type );
+    }
+    // 15 = group of data
+    else if ( ( tag.type == 15 ) && ( infoSize >= 3 ) ) {
+      if ( infoSize != 3 + 2 * _info[2] )
+        throw aol::IOException ( "inconsistent sizes", __FILE__, __LINE__ );
+      tag.length = _info[2];
+      size = getGroupSize ( 1 );
+    }
+    // 20 = array
+    else if ( ( tag.type == 20 ) && ( infoSize >= 3 ) ) {
+      tag.elementType = _info[1];
+      if ( tag.elementType == 15 ) {
+        if ( ( infoSize < 5 ) || ( infoSize != 5 + 2 * _info[3] ) )
+          throw aol::IOException ( "inconsistent sizes", __FILE__, __LINE__ );
+        tag.length = _info[infoSize-1];
+        size = tag.length * getGroupSize ( 2 );
       }
-      else if ( ( _dataEntries.size() > 0 ) && ( _currentTag.size() == 4 )
-        && ( _currentTag[0] == "ImageList" )
-        && ( _dataEntries.back().num == atoi ( _currentTag[1].c_str() ) )
-        && ( _currentTag[2] == "ImageData" )
-        && ( _currentTag[3] == "DataType" )
-        && ( info[0] == 5 ) ) {
-        _dataEntries.back().declaredType = aol::readBinaryData<uint32_t, int> ( in );
+      else {
+        tag.length = _info[2];
+        size = tag.length * getSizeOfValue ( tag.elementType );
       }
-      else
-        readValue ( in, info[0] );
     }
-    else {
-      const int numberType = info[0];
+    else
+      throw aol::UnimplementedCodeException ( aol::strprintf ( "numberType %d not implemented", tag.type ).c_str(), __FILE__, __LINE__ );
 
-      switch( numberType ) {
-      // 15 = group of data
-      case 15:
-        readGroup ( in, info );
-        break;
-      // 20 = array
-      case 20:
-        if ( info[1] == 15 )
-          readArrayOfGroups ( in, info );
-        else {
-          if ( ( _dataEntries.size() > 0 ) && ( _currentTag.size() == 4 )
-            && ( _currentTag[0] == "ImageList" )
-            && ( _dataEntries.back().num == atoi ( _currentTag[1].c_str() ) )
-            && ( _currentTag[2] == "ImageData" )
-            && ( _currentTag[3] == "Data" ) ) {
-              _dataEntries.back().offset = in.tellg();
-              _dataEntries.back().dataType = info[1];
-              _dataEntries.back().dataSize = info[2];
-          }
-
-          for ( int i = 0; i < info[2]; ++i )
-            readValue ( in, info[1] );
-        }
-        break;
-      default:
-        throw aol::UnimplementedCodeException ( aol::strprintf ( "numberType %d not implemented", numberType ).c_str(), __FILE__, __LINE__ );
-      }
-    }
-    _currentTag.pop_back();
+    // Skip the values, they are only read on demand. This way, parsing doesn't need to read the image data.
+    Cursor.read ( size );
+    _tags[Path] = tag;
   }
 
-  void readTagDirectory ( ifstream &in ) {
-    readSortedClosed ( in );
-    const int64_t numTags = readInterger ( in );
+  void parseTagDirectory ( TagTreeCursor &Cursor, string &Path, const int Depth ) {
+    // Skip the sorted and closed flags.
+    Cursor.read ( 2 );
+    const int64_t numTags = readInteger ( Cursor );
+
+    if ( Depth >= 0 ) {
+      DM3Tag &dir = _tags[Path];
+      dir.offset = Cursor.tell();
+      dir.type = 0;
+      dir.length = numTags;
+    }
+
+    // Unnamed tags in the root directory are called "nameless". A tag identifier 0 has no further data and is
+    // skipped, the following tags of the directory are still read.
     for ( int i = 0; i < numTags; ++i )
-      readTagOrTagDir ( in, i );
-    _currentTag.pop_back();
+      parseTagOrTagDir ( Cursor, Path, Depth + 1, ( Depth >= 0 ) ? i : -1 );
   }
 
-  int readTagOrTagDir ( ifstream &in, const int DirNum = -1 ) {
-    const int tagIdentifier = aol::readBinaryData<unsigned char, int> ( in );
+  int parseTagOrTagDir ( TagTreeCursor &Cursor, string &Path, const int Depth, const int DirNum ) {
+    const int tagIdentifier = static_cast<unsigned char> ( *Cursor.read ( 1 ) );
 
     if ( tagIdentifier == 0 )
       return 0;
 
-    readTagName ( in, DirNum );
+    const int tagNameLength = Cursor.readBigEndian<int16_t> ( );
+    if ( tagNameLength < 0 )
+      throw aol::IOException ( "negative tag name length.", __FILE__, __LINE__ );
+
+    const string::size_type parentPathLength = Path.size();
+    if ( Depth > 0 )
+      Path += '.';
+    if ( tagNameLength > 0 )
+      Path.append ( Cursor.read ( tagNameLength ), tagNameLength );
+    else if ( DirNum > -1 )
+      Path += aol::strprintf ( "%d", DirNum );
+    else
+      Path += "nameless";
+
     if ( _version == 4 )
-      aol::swapByteOrder<int64_t> ( aol::readBinaryData<int64_t, int64_t> ( in ) );
+      /*const int64_t tagLength =*/ Cursor.readBigEndian<int64_t> ( );
 
     if ( tagIdentifier == 21 )
-      readTag ( in );
-    else if  ( tagIdentifier == 20 )
-      readTagDirectory ( in );
+      parseTag ( Cursor, Path );
+    else if ( tagIdentifier == 20 ) {
+      // The image data is stored in ImageList.<num>.ImageData.
+      if ( ( Depth == 2 ) && ( Path.compare ( 0, 10, "ImageList." ) == 0 )
+           && ( Path.compare ( Path.size() - 10, 10, ".ImageData" ) == 0 ) ) {
+        _dataEntries.push_back ( DM3ImageData() );
+        _dataEntries.back().num = atoi ( Path.c_str() + 10 );
+      }
+      parseTagDirectory ( Cursor, Path, Depth );
+    }
     else
       throw aol::IOException ( aol::strprintf ( "Invalid tag identifier %d", tagIdentifier ), __FILE__, __LINE__ );
 
+    Path.resize ( parentPathLength );
     return tagIdentifier;
   }
 
-  void readGroup ( ifstream &in, const aol::Vector<int64_t> &info ) {
-    if ( info[1] != 0 )
-      throw aol::IOException ( "length of groupname has to be zero", __FILE__, __LINE__ );
-
-    const int numGroupEntries = info[2];
-
-    if ( ( info.size() - 3 ) != 2*numGroupEntries )
-      throw aol::IOException ( "inconsistent sizes", __FILE__, __LINE__ );
-
-    aol::Vector<int> groupEntryTypes ( numGroupEntries );
-    for ( int i = 0; i < numGroupEntries; ++i ) {
-      if ( info[3+2*i] != 0 )
-        throw aol::IOException ( "length of fieldname has to be zero", __FILE__, __LINE__ );
-      groupEntryTypes[i] = info[4+2*i];
-    }
-
-    for ( int i = 0; i < numGroupEntries; ++i )
-      readValue ( in, groupEntryTypes[i] );
-  }
-
-  void readArrayOfGroups ( ifstream &in, const aol::Vector<int64_t> &info ) {
-    if ( info[2] != 0 )
-      throw aol::IOException ( "length of groupname has to be zero", __FILE__, __LINE__ );
-
-    const int numGroupEntries = info[3];
-
-    if ( ( info.size() - 5 ) != 2*numGroupEntries )
-      throw aol::IOException ( "inconsistent sizes", __FILE__, __LINE__ );
-
-    aol::Vector<int> groupEntryTypes ( numGroupEntries );
-    for ( int i = 0; i < numGroupEntries; ++i ) {
-      if ( info[4+2*i] != 0 )
-        throw aol::IOException ( "length of fieldname has to be zero", __FILE__, __LINE__ );
-      groupEntryTypes[i] = info[5+2*i];
-    }
-
-    for ( int j = 0; j < info[4+2*numGroupEntries]; ++j )
-      for ( int i = 0; i < numGroupEntries; ++i )
-        readValue ( in, groupEntryTypes[i] );
-  }
-
 };
 
 } // namespace qc
@@ -170,7 +170,7 @@ class DisplacementLengthEnergy: public aol::StandardGenEnergyOp<aol::MultiVector
   const aol::DiagonalBlockOp<RealType> _blockStiff;
 public:
 
-  DisplacementLengthEnergy( const aol::StiffOp<ConfiguratorType> &Stiff )
+  DisplacementLengthEnergy( const aol::Op<aol::Vector<RealType> > &Stiff )
     : _blockStiff ( Stiff ) {
   }
   virtual ~DisplacementLengthEnergy() {}
@@ -3,6 +3,7 @@
 #include <gridBase.h>
 #include <multilevelArray.h>
 #include <cellCenteredGrid.h>
+#include <convolution.h>
 
 namespace {
 // nameless namespace only visible in this cpp file
@@ -583,6 +584,82 @@ protected:
 };
 
 
+#ifdef USE_LIB_FFTW
+
+/** Solves the linear system of HeatEquation2DFD / HeatEquation3DFD exactly: The finite difference Laplacian
+ *  with reflecting boundary conditions has the eigenvectors cos ( pi j k / ( Width - 1 ) ) in each direction,
+ *  i.e. it is diagonalized by the DCT-I with the eigenvalues 2 - 2 cos ( pi k / ( Width - 1 ) ) per direction.
+ *  The DCT-I plans are shared with the other FFT based operators, see qc::FFTWPlanCache.
+ *  \author Berkels
+ */
+template <qc::Dimension Dim, typename RealType>
+void solveHeatEquationWithCosineTransform ( const int Width, const RealType Tau, const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) {
+  typedef qc::ConvolutionTrait<Dim, RealType> ConvType;
+
+  // If we are on a 1x1 grid, we can't do anything.
+  if ( Width == 1 ) {
+    Dest = Arg;
+    return;
+  }
+
+  typename aol::VecDimTrait<int, Dim>::VecType size;
+  size.setAll ( Width );
+  const typename ConvType::FFTWPlan plan = qc::FFTWPlanCache<Dim, RealType>::getInstance().getPlan ( size, qc::FFTW_PLAN_DCT1 );
+  const int numNodes = Arg.size();
+  // Makes sure that one can use apply ( a, a ).
+  RealType *data = static_cast<RealType*> ( ConvType::fftwMalloc ( sizeof ( RealType ) * numNodes ) );
+  for ( int i = 0; i < numNodes; ++i )
+    data[i] = Arg[i];
+
+  ConvType::fftwExecute_r2r ( plan, data, data );
+
+  std::vector<RealType> eigenvalues ( Width );
+  for ( int k = 0; k < Width; ++k )
+    eigenvalues[k] = 2 - 2 * cos ( aol::NumberTrait<RealType>::pi * k / ( Width - 1 ) );
+  const RealType hsqrtau = Tau * aol::Sqr ( static_cast<RealType> ( Width - 1 ) );
+  // Applying the unnormalized DCT-I twice multiplies by 2 ( Width - 1 ) in each direction.
+  const RealType normalization = pow ( static_cast<RealType> ( 2 * ( Width - 1 ) ), Dim );
+  const int numZ = ( Dim == qc::QC_3D ) ? Width : 1;
+
+  for ( int z = 0; z < numZ; ++z ) {
+    const RealType eigenvalueZ = ( Dim == qc::QC_3D ) ? eigenvalues[z] : aol::ZTrait<RealType>::zero;
+    for ( int y = 0; y < Width; ++y ) {
+      RealType *row = data + ( z * Width + y ) * Width;
+      const RealType eigenvalueYZ = eigenvalues[y] + eigenvalueZ;
+      for ( int x = 0; x < Width; ++x )
+        row[x] /= normalization * ( 1 + hsqrtau * ( eigenvalues[x] + eigenvalueYZ ) );
+    }
+  }
+
+  ConvType::fftwExecute_r2r ( plan, data, data );
+
+  for ( int i = 0; i < numNodes; ++i )
+    Dest[i] = data[i];
+  ConvType::fftwFree ( data );
+}
+
+template <typename RealType>
+void solveHeatEquationWithCosineTransform ( const int Dim, const int Width, const RealType Tau, const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) {
+  if ( Dim == qc::QC_2D )
+    solveHeatEquationWithCosineTransform<qc::QC_2D, RealType> ( Width, Tau, Arg, Dest );
+  else
+    solveHeatEquationWithCosineTransform<qc::QC_3D, RealType> ( Width, Tau, Arg, Dest );
+}
+
+// Since fftw3l seems to be missing on our Linux machines, there is no long double version.
+void solveHeatEquationWithCosineTransform ( const int, const int, const long double, const aol::Vector<long double> &, aol::Vector<long double> & ) {
+  throw aol::Exception ( "LinearSmoothOp::setUseFFT is not supported for long double", __FILE__, __LINE__ );
+}
+
+#else
+
+template <typename RealType>
+void solveHeatEquationWithCosineTransform ( const int, const int, const RealType, const aol::Vector<RealType> &, aol::Vector<RealType> & ) {
+  throw aol::Exception ( "LinearSmoothOp::setUseFFT needs libfftw! Compile with -DUSE_LIB_FFTW", __FILE__, __LINE__ );
+}
+
+#endif // USE_LIB_FFTW
+
 } // end nameless namespace
 
 
@@ -598,6 +675,11 @@ void LinearSmoothOp<RealType, GridTrait>::apply ( const aol::Vector<RealType> &A
     throw aol::Exception ( "LinearSmoothOp: Size of Arg or Dest incompatible to gridsize.", __FILE__, __LINE__ );
   }
 
+  if ( _useFFT ) {
+    solveHeatEquationWithCosineTransform ( _grid->getDimOfWorld(), _grid->getWidth(), _tau, Arg, Dest );
+    return;
+  }
+
   const qc::Array<RealType> ArgIm ( Arg, *_grid );
   qc::Array<RealType> DestIm ( Dest, *_grid );
 
@@ -5,6 +5,7 @@
 #include <multilevelArray.h>
 #include <solver.h>
 #include <preconditioner.h>
+#include <multigrid.h>
 
 // forward declaration of nb::NarrowGridBase
 namespace nb {
@@ -34,10 +35,10 @@ class LinearSmoothOp : public aol::Op< aol::Vector<RealType> > {
   typedef typename GridTrait::GridType GridType;
   typedef typename GridTrait::MultilevelArrayType MultilevelArrayType;
 public:
-  LinearSmoothOp() : _grid ( NULL, false ), _x ( NULL ), _rhs ( NULL ), _tau ( 1.0 ) {}
+  LinearSmoothOp() : _grid ( NULL, false ), _x ( NULL ), _rhs ( NULL ), _tau ( 1.0 ), _useFFT ( false ) {}
 
   template <typename InputGridType>
-  LinearSmoothOp( const InputGridType &Grid ) : _grid ( NULL, false ), _x ( NULL ), _rhs ( NULL ), _tau ( 1.0 ) {
+  LinearSmoothOp( const InputGridType &Grid ) : _grid ( NULL, false ), _x ( NULL ), _rhs ( NULL ), _tau ( 1.0 ), _useFFT ( false ) {
     setCurrentGrid ( Grid );
   }
 
@@ -54,6 +55,19 @@ public:
     _tau = Tau;
   }
 
+  /**
+   * If UseFFT is true, apply solves the linear system of the heat equation step exactly in the
+   * frequency domain instead of approximately with one multigrid V-cycle: The finite difference
+   * Laplacian with reflecting boundary conditions is diagonalized by the discrete cosine transform
+   * (DCT-I), which is computed with FFTW. The FFTW plans are cached per grid size and shared by all
+   * instances, so they are only created once per level.
+   *
+   * \note Needs libfftw and is only available for float and double.
+   */
+  void setUseFFT ( const bool UseFFT ) {
+    _useFFT = UseFFT;
+  }
+
   void setCurrentGrid ( const GridType &Grid ) {
     _grid.reset ( &Grid, false );
     resetMultilevelArrays ();
@@ -134,11 +148,29 @@ protected:
   aol::DeleteFlagPointer<const GridType> _grid;
   MultilevelArrayType *_x, *_rhs;
   RealType _tau;
+  bool _useFFT;
 };
 
+/**
+ * Calls SmoothOp.setUseFFT ( UseFFT ) if SmoothOp is a qc::LinearSmoothOp, does nothing for other smooth ops.
+ * Allows code that is templatized on the smooth op to select the FFT based solver of qc::LinearSmoothOp.
+ *
+ * \author Berkels
+ */
+template <typename SmoothOpType>
+void setUseFFTIfSupported ( SmoothOpType &/*SmoothOp*/, const bool /*UseFFT*/ ) {}
+
+template <typename RealType, typename GridTrait>
+void setUseFFTIfSupported ( LinearSmoothOp<RealType, GridTrait> &SmoothOp, const bool UseFFT ) {
+  SmoothOp.setUseFFT ( UseFFT );
+}
+
 
 /** Class to compute (approximately) one step of heat conduction \f$ (M + \tau L)^{-1} \f$
- *  using a PCG solver. In contrast to the LinearSmoothOp, it also works for non-cubic grids
+ *  using a PCG solver. In contrast to the LinearSmoothOp, it also works for non-cubic grids.
+ *  By default, PCG uses a diagonal preconditioner. On a qc::GridDefinition, setUseMultigrid
+ *  switches to a GeometricMultigrid V cycle, which keeps the number of iterations independent
+ *  of the grid level.
  *  \author Schwen
  */
 template <typename ConfiguratorType>
@@ -149,9 +181,10 @@ protected:
   const typename ConfiguratorType::InitType &_grid;
   const aol::StiffOp<ConfiguratorType> _stiffOp;
   typename ConfiguratorType::MatrixType _massMat, _systemMat;
-  aol::DiagonalPreconditioner< aol::Vector<RealType> >* _prec;
+  aol::Op< aol::Vector<RealType> >* _prec;
   RealType _tau, _solverAccuracy;
   int _solverSteps;
+  bool _useMultigrid;
 
 public:
   // this version must be used with adaptive grids
@@ -163,7 +196,8 @@ public:
       _prec ( NULL ),
       _tau ( 0 ),
       _solverAccuracy ( 1.0e-16 ),
-      _solverSteps ( 500 ) {
+      _solverSteps ( 500 ),
+      _useMultigrid ( false ) {
     const aol::LumpedMassOp<ConfiguratorType> massOp ( Config, aol::DO_NOT_INVERT );
     massOp.assembleAddMatrix ( _massMat );
     setSigma ( Sigma ); // also assembles matrices
@@ -177,7 +211,8 @@ public:
       _prec ( NULL ),
       _tau ( 0 ),
       _solverAccuracy ( 1.0e-16 ),
-      _solverSteps ( 500 ) {
+      _solverSteps ( 500 ),
+      _useMultigrid ( false ) {
     const aol::LumpedMassOp<ConfiguratorType> massOp ( _grid, aol::DO_NOT_INVERT );
     massOp.assembleAddMatrix ( _massMat );
     setSigma ( Sigma ); // also assembles matrices
@@ -191,7 +226,8 @@ public:
       _prec ( NULL ),
       _tau ( aol::NumberTrait<RealType>::NaN ),
       _solverAccuracy ( 1.0e-16 ),
-      _solverSteps ( 500 ) {
+      _solverSteps ( 500 ),
+      _useMultigrid ( false ) {
     const aol::LumpedMassOp<ConfiguratorType> massOp ( _grid, aol::DO_NOT_INVERT );
     massOp.assembleAddMatrix ( _massMat );
   }
@@ -215,6 +251,13 @@ public:
     _solverSteps = Steps;
   }
 
+  //! Use a multigrid preconditioner if the grid is a qc::GridDefinition, the diagonal preconditioner otherwise.
+  void setUseMultigrid ( const bool UseMultigrid ) {
+    _useMultigrid = UseMultigrid;
+    if ( _prec != NULL )
+      updatePreconditioner();
+  }
+
   void applyAdd ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
     aol::Vector<RealType> tmp ( Dest, aol::DEEP_COPY );
     apply ( Arg, tmp );
@@ -244,8 +287,14 @@ protected:
   void assembleSystemMatrix () {
     _systemMat = _massMat;
     _stiffOp.assembleAddMatrix( _systemMat, _tau );
+    updatePreconditioner();
+  }
+
+  void updatePreconditioner () {
     if ( _prec != NULL ) delete ( _prec );
-    _prec = new aol::DiagonalPreconditioner< aol::Vector<RealType> > ( _systemMat );
+    _prec = _useMultigrid ? qc::newMultigridPreconditionerIfSupported<RealType> ( _grid, _systemMat ) : NULL;
+    if ( _prec == NULL )
+      _prec = new aol::DiagonalPreconditioner< aol::Vector<RealType> > ( _systemMat );
   }
 
 private:
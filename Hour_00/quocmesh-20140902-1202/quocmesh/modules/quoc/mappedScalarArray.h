@@ -0,0 +1,201 @@
+#ifndef __MAPPEDSCALARARRAY_H
+#define __MAPPEDSCALARARRAY_H
+
+#include <scalarArray.h>
+
+namespace qc {
+
+/**
+ * \brief Read-only std::streambuf on a block of memory, used to parse the header of a memory mapped array.
+ */
+class MemoryStreambuf : public std::streambuf {
+public:
+  MemoryStreambuf ( char *Data, const size_t Size ) {
+    setg ( Data, Data, Data + Size );
+  }
+
+protected:
+  virtual pos_type seekoff ( off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Which = std::ios_base::in ) {
+    aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Which );
+    char *pos = ( Dir == std::ios_base::beg ) ? eback() : ( ( Dir == std::ios_base::end ) ? egptr() : gptr() );
+    pos += Offset;
+    if ( ( pos < eback() ) || ( pos > egptr() ) )
+      return pos_type ( off_type ( -1 ) );
+    setg ( eback(), pos, egptr() );
+    return pos_type ( pos - eback() );
+  }
+
+  virtual pos_type seekpos ( pos_type Pos, std::ios_base::openmode Which = std::ios_base::in ) {
+    return seekoff ( off_type ( Pos ), std::ios_base::beg, Which );
+  }
+};
+
+/**
+ * \brief Memory maps an uncompressed array file in 2d pgm style format and parses its header.
+ *
+ * Files that can't be mapped (compressed files, other image formats) are not opened, isMapped()
+ * returns false in this case. Used by MappedScalarArray.
+ */
+template <typename DataType>
+class MappedArrayFile2D {
+  aol::MemoryMappedFile *_file;
+  int _type, _numX, _numY;
+  char *_data;
+
+public:
+  explicit MappedArrayFile2D ( const std::string &FileName )
+    : _file ( NULL ),
+      _type ( 0 ),
+      _numX ( 0 ),
+      _numY ( 0 ),
+      _data ( NULL ) {
+    if ( !isMappable ( FileName ) )
+      return;
+
+    _file = new aol::MemoryMappedFile ( FileName );
+    if ( ( _file->getSize() == 0 ) || ( _file->getData()[0] != 'P' ) ) {
+      // Let ScalarArray::load generate the appropriate error message.
+      delete _file;
+      _file = NULL;
+      return;
+    }
+
+    try {
+      MemoryStreambuf streambuf ( _file->getData(), _file->getSize() );
+      std::istream in ( &streambuf );
+      ScalarArray<DataType, qc::QC_2D>::readHeader ( in, _type, _numX, _numY );
+      const size_t dataOffset = static_cast<size_t> ( in.tellg() );
+      const bool isBinary = ( _type != qc::PGM_UNSIGNED_CHAR_ASCII ) && ( _type != qc::PGM_FLOAT_ASCII );
+      const size_t dataSize = isBinary ? static_cast<size_t> ( _numX ) * _numY * qc::getSizeOfSaveType ( static_cast<qc::SaveType> ( _type ) ) : 0;
+      if ( in.fail() || ( dataOffset + dataSize > _file->getSize() ) )
+        throw aol::IOException ( aol::strprintf ( "qc::MappedArrayFile2D: \"%s\" is too small for a %dx%d array", FileName.c_str(), _numX, _numY ).c_str(), __FILE__, __LINE__ );
+      _data = _file->getData() + dataOffset;
+    } catch ( ... ) {
+      delete _file;
+      throw;
+    }
+  }
+
+  ~MappedArrayFile2D () {
+    delete _file;
+  }
+
+  bool isMapped () const {
+    return ( _file != NULL );
+  }
+
+  int getType () const {
+    return _type;
+  }
+
+  int getNumX () const {
+    return _numX;
+  }
+
+  int getNumY () const {
+    return _numY;
+  }
+
+  char* getData () const {
+    return _data;
+  }
+
+  size_t getDataSize () const {
+    return isMapped() ? static_cast<size_t> ( _file->getData() + _file->getSize() - _data ) : 0;
+  }
+
+  //! Returns a pointer to the mapped data if it can be used directly as array of DataType, NULL otherwise.
+  DataType* getDataInPlace () const {
+    if ( !isMapped() || ( _type != aol::FileFormatMagicNumber<DataType>::FFType ) )
+      return NULL;
+#ifdef USE_SSE
+    const uintptr_t alignment = 16;
+#else
+    const uintptr_t alignment = sizeof ( DataType );
+#endif
+    if ( ( reinterpret_cast<uintptr_t> ( _data ) % alignment ) != 0 )
+      return NULL;
+    return reinterpret_cast<DataType*> ( _data );
+  }
+
+  //! Files handled by ScalarArray<QC_2D>::load without Bzipifstream can't be mapped, neither can compressed files.
+  static bool isMappable ( const std::string &FileName ) {
+    const char *fileName = FileName.c_str();
+    return !( aol::hasBzipSuffx ( fileName ) || aol::fileNameEndsWith ( fileName, ".png" ) || aol::fileNameEndsWith ( fileName, ".dm3" )
+              || aol::fileNameEndsWith ( fileName, ".dm4" ) || aol::fileNameEndsWith ( fileName, ".tif" ) );
+  }
+
+private:
+  MappedArrayFile2D ( const MappedArrayFile2D& ); // do not implement
+  MappedArrayFile2D& operator= ( const MappedArrayFile2D& ); // do not implement
+};
+
+/**
+ * \brief ScalarArray that is loaded from a file, like ScalarArray ( const string &filename ).
+ *
+ * In general, the file is just loaded. The specialization for QC_2D memory maps uncompressed
+ * files in 2d pgm style format instead. If the data type stored in the file is DataType, the
+ * array directly uses the mapped file contents without any copies and the file is only read
+ * when the data is accessed. The mapping is copy-on-write, i.e. the array may be modified
+ * without changing the file. Other data types are converted directly from the mapped file.
+ *
+ * Since the array doesn't own its data in the first case, it may not be reallocated.
+ */
+template <typename _DataType, qc::Dimension Dim>
+class MappedScalarArray : public ScalarArray<_DataType, Dim> {
+public:
+  explicit MappedScalarArray ( const std::string &FileName )
+    : ScalarArray<_DataType, Dim> ( FileName ) { }
+
+  bool isMapped () const {
+    return false;
+  }
+
+private:
+  MappedScalarArray ( const MappedScalarArray& ); // do not implement
+  MappedScalarArray& operator= ( const MappedScalarArray& ); // do not implement
+};
+
+//! Holds the mapped file of MappedScalarArray<DataType, QC_2D>, needs to be a base class to be constructed before the array.
+template <typename DataType>
+class MappedArrayFile2DHolder {
+protected:
+  const MappedArrayFile2D<DataType> _mappedFile;
+
+  explicit MappedArrayFile2DHolder ( const std::string &FileName )
+    : _mappedFile ( FileName ) { }
+};
+
+template <typename _DataType>
+class MappedScalarArray<_DataType, qc::QC_2D> : private MappedArrayFile2DHolder<_DataType>, public ScalarArray<_DataType, qc::QC_2D> {
+public:
+  explicit MappedScalarArray ( const std::string &FileName )
+    : MappedArrayFile2DHolder<_DataType> ( FileName ),
+      ScalarArray<_DataType, qc::QC_2D> ( this->_mappedFile.getDataInPlace() ? this->_mappedFile.getNumX() : 0,
+                                          this->_mappedFile.getDataInPlace() ? this->_mappedFile.getNumY() : 0,
+                                          this->_mappedFile.getDataInPlace(), aol::FLAT_COPY ) {
+    if ( this->_mappedFile.getDataInPlace() )
+      return;
+
+    if ( this->_mappedFile.isMapped() ) {
+      MemoryStreambuf streambuf ( this->_mappedFile.getData(), this->_mappedFile.getDataSize() );
+      std::istream in ( &streambuf );
+      this->loadRaw ( in, this->_mappedFile.getType(), this->_mappedFile.getNumX(), this->_mappedFile.getNumY() );
+    }
+    else
+      this->load ( FileName.c_str() );
+  }
+
+  //! Returns whether the array directly uses the mapped file contents.
+  bool isMapped () const {
+    return ( this->_mappedFile.getDataInPlace() != NULL );
+  }
+
+private:
+  MappedScalarArray ( const MappedScalarArray& ); // do not implement
+  MappedScalarArray& operator= ( const MappedScalarArray& ); // do not implement
+};
+
+}
+
+#endif // __MAPPEDSCALARARRAY_H
@@ -0,0 +1,340 @@
+#ifndef __MULTIGRID_H
+#define __MULTIGRID_H
+
+#include <quoc.h>
+#include <gridBase.h>
+#include <prolongation.h>
+#include <multilevelArray.h>
+#include <sparseMatrices.h>
+#include <solver.h>
+
+namespace qc {
+
+//! Recursion pattern of a multigrid cycle.
+enum MultigridCycleMode {
+  MULTIGRID_V_CYCLE, //!< one coarse grid correction per level
+  MULTIGRID_W_CYCLE, //!< two coarse grid corrections per level
+  MULTIGRID_F_CYCLE  //!< an F cycle on the next coarser level followed by a V cycle
+};
+
+/**
+ * \brief Geometric multigrid for linear systems assembled on a qc::GridDefinition (e.g. with
+ *        QuocConfiguratorTraitMultiLin in 2D or 3D).
+ *
+ * The hierarchy of coarse grids is the one of qc::MultilevelArray. The prolongation P is the one of qc::ProlongOp,
+ * the restriction is its transpose (i.e. qc::STD_MG_RESTRICT) and the coarse grid operators are the Galerkin
+ * products \f$ P^T A P \f$, hence no reassembly on the coarse grids is needed and any scalar matrix that supports
+ * makeRowEntries (e.g. FastUniformGridMatrix or SparseMatrix, possibly with Dirichlet rows and columns) can be used.
+ * All operators are stored as aol::CSRMatrix. Smoothing is done by Gauss-Seidel, forward before and backward after
+ * the coarse grid correction, the coarsest level is solved approximately by symmetric Gauss-Seidel sweeps.
+ *
+ * apply does one cycle with zero initial guess. For V and W cycles this is a symmetric positive definite operator
+ * if the system matrix is, so the object can be passed as preconditioner to aol::PCGInverse, which then needs a
+ * number of iterations that does not depend on the grid level. MultigridInverse uses the cycles as stand alone
+ * solver.
+ *
+ * \note The object is not reentrant since the cycles use vectors stored in the object.
+ *
+ * \author Berkels
+ * \ingroup multigrid
+ */
+template <typename RealType>
+class GeometricMultigrid : public aol::Op<aol::Vector<RealType> > {
+protected:
+  typedef aol::CSRMatrix<RealType> CSRMatrixType;
+  typedef qc::MultilevelArray<RealType, aol::Vector<RealType> > MultilevelArrayType;
+
+  const int _fineLevel, _coarsestLevel;
+  //! Indexed by level, only entries from _coarsestLevel on are used. _prolongations[l] maps level l - 1 to level l.
+  std::vector<CSRMatrixType*> _operators, _prolongations, _restrictions;
+  std::vector<aol::Vector<RealType>*> _invDiagonals;
+  MultigridCycleMode _cycleMode;
+  int _numPreSmooth, _numPostSmooth, _numCoarseSweeps;
+  mutable MultilevelArrayType _solutions, _rhs, _residuals;
+
+public:
+  template <typename MatrixType>
+  GeometricMultigrid ( const qc::GridDefinition &Grid,
+                       const MatrixType &SystemMatrix,
+                       const MultigridCycleMode CycleMode = MULTIGRID_V_CYCLE,
+                       const int NumPreSmooth = 2,
+                       const int NumPostSmooth = 2,
+                       const int CoarsestLevel = 1 )
+    : _fineLevel ( Grid.getGridDepth() ),
+      _coarsestLevel ( aol::Clamp ( CoarsestLevel, 0, Grid.getGridDepth() ) ),
+      _operators ( Grid.getGridDepth() + 1, static_cast<CSRMatrixType*> ( NULL ) ),
+      _prolongations ( Grid.getGridDepth() + 1, static_cast<CSRMatrixType*> ( NULL ) ),
+      _restrictions ( Grid.getGridDepth() + 1, static_cast<CSRMatrixType*> ( NULL ) ),
+      _invDiagonals ( Grid.getGridDepth() + 1, static_cast<aol::Vector<RealType>*> ( NULL ) ),
+      _cycleMode ( CycleMode ),
+      _numPreSmooth ( NumPreSmooth ),
+      _numPostSmooth ( NumPostSmooth ),
+      _numCoarseSweeps ( 50 ),
+      _solutions ( Grid ),
+      _rhs ( Grid ),
+      _residuals ( Grid ) {
+    if ( ( SystemMatrix.getNumRows() != Grid.getNumberOfNodes() ) || ( SystemMatrix.getNumCols() != Grid.getNumberOfNodes() ) )
+      throw aol::Exception ( "qc::GeometricMultigrid: System matrix does not match the grid", __FILE__, __LINE__ );
+
+    aol::SparseMatrix<RealType> fineMat ( SystemMatrix.getNumRows(), SystemMatrix.getNumCols() );
+    std::vector<typename aol::Row<RealType>::RowEntry> vec;
+    for ( int i = 0; i < SystemMatrix.getNumRows(); ++i ) {
+      SystemMatrix.makeRowEntries ( vec, i );
+      for ( typename std::vector<typename aol::Row<RealType>::RowEntry>::const_iterator it = vec.begin(); it != vec.end(); ++it )
+        if ( ( it->value != aol::ZOTrait<RealType>::zero ) || ( it->col == i ) )
+          fineMat.add ( i, it->col, it->value );
+    }
+    _operators[_fineLevel] = new CSRMatrixType ( fineMat );
+    buildHierarchy ( Grid.getDimOfWorld() );
+  }
+
+  virtual ~GeometricMultigrid() {
+    for ( int level = 0; level <= _fineLevel; ++level ) {
+      delete _operators[level];
+      delete _prolongations[level];
+      delete _restrictions[level];
+      delete _invDiagonals[level];
+    }
+  }
+
+  void setCycleMode ( const MultigridCycleMode CycleMode ) {
+    _cycleMode = CycleMode;
+  }
+
+  void setNumSmoothingSteps ( const int NumPreSmooth, const int NumPostSmooth ) {
+    _numPreSmooth = NumPreSmooth;
+    _numPostSmooth = NumPostSmooth;
+  }
+
+  //! Number of symmetric Gauss-Seidel sweeps used to solve on the coarsest level.
+  void setNumCoarseSweeps ( const int NumCoarseSweeps ) {
+    _numCoarseSweeps = NumCoarseSweeps;
+  }
+
+  int getFineLevel() const {
+    return _fineLevel;
+  }
+
+  int getCoarsestLevel() const {
+    return _coarsestLevel;
+  }
+
+  //! Galerkin operator on the given level, on the fine level this is a copy of the system matrix.
+  const CSRMatrixType& getOperator ( const int Level ) const {
+    return *_operators[Level];
+  }
+
+  //! Improves the approximate solution X of A X = Rhs by one cycle.
+  void cycle ( const aol::Vector<RealType> &Rhs, aol::Vector<RealType> &X ) const {
+    if ( ( Rhs.size() != _operators[_fineLevel]->getNumRows() ) || ( X.size() != Rhs.size() ) )
+      throw aol::Exception ( "qc::GeometricMultigrid::cycle: Vector sizes do not match the system matrix", __FILE__, __LINE__ );
+    cycle ( _fineLevel, Rhs, X, _cycleMode );
+  }
+
+  //! Applies one cycle with zero initial guess to Arg.
+  void apply ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    Dest.setZero();
+    cycle ( Arg, Dest );
+  }
+
+  void applyAdd ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    aol::Vector<RealType> tmp ( Dest, aol::STRUCT_COPY );
+    apply ( Arg, tmp );
+    Dest += tmp;
+  }
+
+protected:
+  void buildHierarchy ( const qc::Dimension Dim ) {
+    for ( int level = _fineLevel; level > _coarsestLevel; --level ) {
+      const qc::GridDefinition coarseGrid ( level - 1, Dim ), fineGrid ( level, Dim );
+      aol::SparseMatrix<RealType> prolongation ( fineGrid.getNumberOfNodes(), coarseGrid.getNumberOfNodes() );
+      qc::ProlongOp<RealType> ( coarseGrid, fineGrid ).assembleAddMatrix ( prolongation );
+      aol::SparseMatrix<RealType> restriction ( coarseGrid.getNumberOfNodes(), fineGrid.getNumberOfNodes() );
+      prolongation.transposeTo ( restriction );
+      _prolongations[level] = new CSRMatrixType ( prolongation );
+      _restrictions[level] = new CSRMatrixType ( restriction );
+      _operators[level - 1] = newGalerkinProduct ( *_restrictions[level], *_operators[level], *_prolongations[level] );
+    }
+
+    for ( int level = _coarsestLevel; level <= _fineLevel; ++level ) {
+      const CSRMatrixType &mat = *_operators[level];
+      _invDiagonals[level] = new aol::Vector<RealType> ( mat.getNumRows() );
+      for ( int i = 0; i < mat.getNumRows(); ++i ) {
+        const RealType diag = mat.get ( i, i );
+        // Rows without diagonal entry are left untouched by the smoother.
+        ( *_invDiagonals[level] ) [i] = ( diag != aol::ZOTrait<RealType>::zero ) ? aol::ZOTrait<RealType>::one / diag : aol::ZOTrait<RealType>::zero;
+      }
+    }
+  }
+
+  //! Computes R A P row by row, accumulating each row of the product in a dense vector.
+  static CSRMatrixType* newGalerkinProduct ( const CSRMatrixType &R, const CSRMatrixType &A, const CSRMatrixType &P ) {
+    const aol::Vector<int> &rRow = R.getRowPointerReference(), &rCol = R.getColumnIndexReference();
+    const aol::Vector<int> &aRow = A.getRowPointerReference(), &aCol = A.getColumnIndexReference();
+    const aol::Vector<int> &pRow = P.getRowPointerReference(), &pCol = P.getColumnIndexReference();
+    const aol::Vector<RealType> &rVal = R.getValueReference(), &aVal = A.getValueReference(), &pVal = P.getValueReference();
+
+    const int numCoarse = R.getNumRows();
+    aol::SparseMatrix<RealType> product ( numCoarse, numCoarse );
+    std::vector<RealType> rowValues ( numCoarse, aol::ZOTrait<RealType>::zero );
+    std::vector<bool> isUsed ( numCoarse, false );
+    std::vector<int> usedCols;
+    for ( int I = 0; I < numCoarse; ++I ) {
+      usedCols.clear();
+      for ( int k = rRow[I]; k < rRow[I + 1]; ++k ) {
+        const int i = rCol[k];
+        for ( int l = aRow[i]; l < aRow[i + 1]; ++l ) {
+          const int j = aCol[l];
+          const RealType ra = rVal[k] * aVal[l];
+          for ( int m = pRow[j]; m < pRow[j + 1]; ++m ) {
+            const int J = pCol[m];
+            if ( !isUsed[J] ) {
+              isUsed[J] = true;
+              usedCols.push_back ( J );
+            }
+            rowValues[J] += ra * pVal[m];
+          }
+        }
+      }
+      // SparseMatrix::add appends cheaply if the columns come in ascending order.
+      std::sort ( usedCols.begin(), usedCols.end() );
+      for ( std::vector<int>::const_iterator it = usedCols.begin(); it != usedCols.end(); ++it ) {
+        if ( ( rowValues[*it] != aol::ZOTrait<RealType>::zero ) || ( *it == I ) )
+          product.add ( I, *it, rowValues[*it] );
+        rowValues[*it] = aol::ZOTrait<RealType>::zero;
+        isUsed[*it] = false;
+      }
+    }
+    return new CSRMatrixType ( product );
+  }
+
+  void cycle ( const int Level, const aol::Vector<RealType> &Rhs, aol::Vector<RealType> &X, const MultigridCycleMode CycleMode ) const {
+    if ( Level == _coarsestLevel ) {
+      for ( int i = 0; i < _numCoarseSweeps; ++i ) {
+        smooth ( Level, Rhs, X, aol::GAUSS_SEIDEL_FORWARD );
+        smooth ( Level, Rhs, X, aol::GAUSS_SEIDEL_BACKWARD );
+      }
+      return;
+    }
+
+    for ( int i = 0; i < _numPreSmooth; ++i )
+      smooth ( Level, Rhs, X, aol::GAUSS_SEIDEL_FORWARD );
+
+    aol::Vector<RealType> &residual = _residuals[Level];
+    _operators[Level]->apply ( X, residual );
+    residual.scaleAndAdd ( -aol::ZOTrait<RealType>::one, Rhs );
+
+    aol::Vector<RealType> &coarseRhs = _rhs[Level - 1], &coarseX = _solutions[Level - 1];
+    _restrictions[Level]->apply ( residual, coarseRhs );
+    coarseX.setZero();
+    switch ( CycleMode ) {
+      case MULTIGRID_V_CYCLE:
+        cycle ( Level - 1, coarseRhs, coarseX, MULTIGRID_V_CYCLE );
+        break;
+      case MULTIGRID_W_CYCLE:
+        cycle ( Level - 1, coarseRhs, coarseX, MULTIGRID_W_CYCLE );
+        cycle ( Level - 1, coarseRhs, coarseX, MULTIGRID_W_CYCLE );
+        break;
+      case MULTIGRID_F_CYCLE:
+        cycle ( Level - 1, coarseRhs, coarseX, MULTIGRID_F_CYCLE );
+        cycle ( Level - 1, coarseRhs, coarseX, MULTIGRID_V_CYCLE );
+        break;
+      default:
+        throw aol::UnimplementedCodeException ( "qc::GeometricMultigrid::cycle: Unknown cycle mode", __FILE__, __LINE__ );
+    }
+    _prolongations[Level]->applyAdd ( coarseX, X );
+
+    for ( int i = 0; i < _numPostSmooth; ++i )
+      smooth ( Level, Rhs, X, aol::GAUSS_SEIDEL_BACKWARD );
+  }
+
+  //! One Gauss-Seidel sweep on the CSR arrays of the operator on the given level.
+  void smooth ( const int Level, const aol::Vector<RealType> &Rhs, aol::Vector<RealType> &X, const aol::GaussSeidelSweepingMode Direction ) const {
+    const CSRMatrixType &mat = *_operators[Level];
+    const int * const rowPointer = mat.getRowPointerReference().getData();
+    const int * const columnIndex = mat.getColumnIndexReference().getData();
+    const RealType * const value = mat.getValueReference().getData();
+    const RealType * const invDiag = _invDiagonals[Level]->getData();
+    const RealType * const rhs = Rhs.getData();
+    RealType * const x = X.getData();
+
+    const int numRows = mat.getNumRows();
+    const bool forward = ( Direction == aol::GAUSS_SEIDEL_FORWARD );
+    for ( int n = 0; n < numRows; ++n ) {
+      const int i = forward ? n : numRows - 1 - n;
+      RealType r = rhs[i];
+      for ( int k = rowPointer[i]; k < rowPointer[i + 1]; ++k )
+        r -= value[k] * x[columnIndex[k]];
+      x[i] += invDiag[i] * r;
+    }
+  }
+
+private:
+  GeometricMultigrid ( const GeometricMultigrid<RealType> &other );
+  GeometricMultigrid<RealType>& operator= ( const GeometricMultigrid<RealType> &other );
+};
+
+
+/**
+ * \brief Solves the system of a GeometricMultigrid by repeated cycles.
+ *
+ * The residual is computed with the fine level operator of the multigrid object, the stopping criterion is
+ * controlled by the aol::SolverInfo as for the other iterative solvers.
+ *
+ * \author Berkels
+ * \ingroup solver
+ */
+template <typename RealType>
+class MultigridInverse : public aol::IterativeInverseOp<aol::Vector<RealType>, aol::CSRMatrix<RealType> > {
+protected:
+  const GeometricMultigrid<RealType> &_multigrid;
+
+public:
+  MultigridInverse ( const GeometricMultigrid<RealType> &Multigrid,
+                     const RealType Epsilon = 1e-16,
+                     const int MaxIter = 100,
+                     const aol::StoppingMode Stop = aol::STOPPING_UNSET,
+                     ostream &Out = cerr )
+    : aol::IterativeInverseOp<aol::Vector<RealType>, aol::CSRMatrix<RealType> > ( Multigrid.getOperator ( Multigrid.getFineLevel() ), Epsilon, MaxIter, Stop, false, Out ),
+      _multigrid ( Multigrid ) {}
+
+  MultigridInverse ( const GeometricMultigrid<RealType> &Multigrid,
+                     aol::SolverInfo<RealType> &Info )
+    : aol::IterativeInverseOp<aol::Vector<RealType>, aol::CSRMatrix<RealType> > ( Multigrid.getOperator ( Multigrid.getFineLevel() ), Info ),
+      _multigrid ( Multigrid ) {}
+
+  virtual void apply ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    aol::Vector<RealType> residual ( Dest, aol::STRUCT_COPY );
+
+    this->_op.apply ( Dest, residual );
+    residual -= Arg;
+    this->_infoPtr->startIterations ( Arg.normSqr(), residual.normSqr(), "Multigrid", "l_2 norm ^2" );
+
+    while ( !this->_infoPtr->stoppingCriterionIsFulfilled() && ! ( this->_infoPtr->maxIterIsReached() ) && ! ( this->_infoPtr->currentResidualIsNaN() ) ) {
+      this->_infoPtr->startStep();
+      _multigrid.cycle ( Arg, Dest );
+      this->_op.apply ( Dest, residual );
+      residual -= Arg;
+      this->_infoPtr->finishStep ( residual.normSqr() );
+    }
+    this->_infoPtr->finishIterations();
+  }
+};
+
+/**
+ * Returns a new multigrid preconditioner for Mat if Grid is a qc::GridDefinition and NULL otherwise.
+ * Allows to use the multigrid preconditioner in classes templated on the configurator if the grid supports it.
+ */
+template <typename RealType, typename GridType, typename MatrixType>
+aol::Op<aol::Vector<RealType> >* newMultigridPreconditionerIfSupported ( const GridType &/*Grid*/, const MatrixType &/*Mat*/ ) {
+  return NULL;
+}
+
+template <typename RealType, typename MatrixType>
+aol::Op<aol::Vector<RealType> >* newMultigridPreconditionerIfSupported ( const qc::GridDefinition &Grid, const MatrixType &Mat ) {
+  return new GeometricMultigrid<RealType> ( Grid, Mat );
+}
+
+} // end namespace qc
+
+#endif
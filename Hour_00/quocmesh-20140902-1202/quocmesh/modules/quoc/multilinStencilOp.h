@@ -0,0 +1,182 @@
+#ifndef __MULTILINSTENCILOP_H
+#define __MULTILINSTENCILOP_H
+
+#include <quoc.h>
+#include <FEOpInterface.h>
+
+namespace qc {
+
+/**
+ * \brief Matrix free application of a multilinear FE operator on a uniform rectangular grid whose local matrix is
+ *        the same on all elements, e.g. the mass or the stiffness matrix.
+ *
+ * Such an operator is given by a 9-point (2D) or 27-point (3D) stencil. Since a node only "sees" the elements that
+ * exist around it, there is one stencil for each combination of "first node", "inner node" and "last node" in each
+ * coordinate direction. The operator is applied row by row, the inner nodes of a row are handled by simple loops
+ * over the contiguous rows of the argument that can be vectorized by the compiler. The rows are distributed over
+ * the OpenMP threads, each thread only writes to its own rows.
+ *
+ * Compared to the assembled matrices, this saves the memory for the matrix and the memory bandwidth needed to read
+ * it in each application. The stencil entries are summed up in the same order as the assembled matrices, but the
+ * products in the application are summed in a different order, so the results are equal up to rounding.
+ *
+ * Works with all configurators on uniform rectangular grids with lexicographically ordered nodes and the local dof
+ * numbering of qc::Element, i.e. QuocConfiguratorTraitMultiLin and RectangularGridConfigurator in 2D and 3D.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+class MultilinStencilOp : public aol::Op<aol::Vector<typename ConfiguratorType::RealType> > {
+public:
+  typedef typename ConfiguratorType::RealType RealType;
+  typedef aol::Mat<ConfiguratorType::maxNumLocalDofs, ConfiguratorType::maxNumLocalDofs, RealType> LocalMatrixType;
+
+  static const int NumStencilEntries = ( ConfiguratorType::Dim == qc::QC_3D ) ? 27 : 9;
+
+protected:
+  const aol::Vec3<int> _size;
+  const int _numNodes;
+  //! _stencils[NodeClass][Entry], see getNodeClass and getEntryIndex.
+  RealType _stencils[NumStencilEntries][NumStencilEntries];
+
+  //! 0 for the first node in a direction, 2 for the last one and 1 for the inner nodes.
+  static int getNodeClass ( const int I, const int Num ) {
+    return ( I == 0 ) ? 0 : ( ( I == Num - 1 ) ? 2 : 1 );
+  }
+
+  //! The stencil entry of the neighbor at offset (OX, OY, OZ), the offsets are in {-1,0,1}.
+  static int getEntryIndex ( const int OX, const int OY, const int OZ ) {
+    return ( OX + 1 ) + 3 * ( OY + 1 ) + ( ( ConfiguratorType::Dim == qc::QC_3D ) ? 9 * ( OZ + 1 ) : 0 );
+  }
+
+public:
+  explicit MultilinStencilOp ( const typename ConfiguratorType::InitType &Grid )
+    : _size ( Grid.getSize() ),
+      _numNodes ( Grid.getNumberOfNodes() ) {
+    if ( ( ConfiguratorType::Dim != qc::QC_2D ) && ( ConfiguratorType::Dim != qc::QC_3D ) )
+      throw aol::Exception ( "qc::MultilinStencilOp: Only implemented in 2D and 3D", __FILE__, __LINE__ );
+    for ( int d = 0; d < ConfiguratorType::Dim; ++d ) {
+      if ( _size[d] < 2 )
+        throw aol::Exception ( aol::strprintf ( "qc::MultilinStencilOp: The grid needs at least two nodes in each direction, but has %d in direction %d", _size[d], d ).c_str(), __FILE__, __LINE__ );
+    }
+    for ( int c = 0; c < NumStencilEntries; ++c )
+      for ( int k = 0; k < NumStencilEntries; ++k )
+        _stencils[c][k] = aol::ZOTrait<RealType>::zero;
+  }
+
+  //! Sets up the stencils from the local matrix of the operator, the local dofs are numbered like in qc::Element.
+  void setLocalMatrix ( const LocalMatrixType &LocalMatrix ) {
+    const int numLocalDofs = ConfiguratorType::maxNumLocalDofs;
+    for ( int c = 0; c < NumStencilEntries; ++c ) {
+      const int nodeClass[3] = { c % 3, ( c / 3 ) % 3, c / 9 };
+      for ( int k = 0; k < NumStencilEntries; ++k )
+        _stencils[c][k] = aol::ZOTrait<RealType>::zero;
+
+      // Traverse the elements containing the node in the order of the element iterators (the local index A of the
+      // node is decreasing in this order), i.e. in the order in which the assembled matrices sum up the local matrices.
+      for ( int a = numLocalDofs - 1; a >= 0; --a ) {
+        bool elementExists = true;
+        for ( int d = 0; d < ConfiguratorType::Dim; ++d ) {
+          const int bit = ( a >> d ) & 1;
+          if ( ( ( bit == 1 ) && ( nodeClass[d] == 0 ) ) || ( ( bit == 0 ) && ( nodeClass[d] == 2 ) ) )
+            elementExists = false;
+        }
+        if ( !elementExists )
+          continue;
+
+        for ( int b = 0; b < numLocalDofs; ++b )
+          _stencils[c][getEntryIndex ( ( b & 1 ) - ( a & 1 ), ( ( b >> 1 ) & 1 ) - ( ( a >> 1 ) & 1 ), ( ( b >> 2 ) & 1 ) - ( ( a >> 2 ) & 1 ) )] += LocalMatrix[a][b];
+      }
+    }
+  }
+
+  //! Sets up the stencils from the local matrix of FEOp on the first element, FEOp needs to have the same local matrix on all elements.
+  template <typename FELinOpType>
+  void setLocalMatrixFrom ( const FELinOpType &FEOp ) {
+    LocalMatrixType localMatrix;
+    FEOp.prepareLocalMatrix ( *FEOp.getConfigurator().begin(), localMatrix );
+    setLocalMatrix ( localMatrix );
+  }
+
+  //! Returns the stencil entry of the node (X,Y,Z) for its neighbor at offset (OX,OY,OZ), i.e. the matrix entry of the corresponding row and column.
+  RealType getStencilEntry ( const int X, const int Y, const int Z, const int OX, const int OY, const int OZ ) const {
+    const int nodeClass = getNodeClass ( X, _size[0] ) + 3 * getNodeClass ( Y, _size[1] ) + ( ( ConfiguratorType::Dim == qc::QC_3D ) ? 9 * getNodeClass ( Z, _size[2] ) : 0 );
+    return _stencils[nodeClass][getEntryIndex ( OX, OY, OZ )];
+  }
+
+  void applyAdd ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    if ( ( Arg.size() != _numNodes ) || ( Dest.size() != _numNodes ) )
+      throw aol::Exception ( "qc::MultilinStencilOp::applyAdd: Size of Arg or Dest incompatible to the grid size", __FILE__, __LINE__ );
+
+    const int numX = _size[0];
+    const int numY = _size[1];
+    const int numZ = ( ConfiguratorType::Dim == qc::QC_3D ) ? _size[2] : 1;
+    const int maxOZ = ( ConfiguratorType::Dim == qc::QC_3D ) ? 1 : 0;
+    const int numRows = numY * numZ;
+    const RealType * const arg = Arg.getData();
+    RealType * const dest = Dest.getData();
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for ( int row = 0; row < numRows; ++row ) {
+      const int y = row % numY;
+      const int z = row / numY;
+      const int rowClass = 3 * getNodeClass ( y, numY ) + ( ( ConfiguratorType::Dim == qc::QC_3D ) ? 9 * getNodeClass ( z, numZ ) : 0 );
+      const RealType * const firstStencil = _stencils[rowClass];
+      const RealType * const innerStencil = _stencils[rowClass + 1];
+      const RealType * const lastStencil = _stencils[rowClass + 2];
+      RealType * const destRow = dest + row * numX;
+
+      for ( int oz = -maxOZ; oz <= maxOZ; ++oz ) {
+        if ( ( z + oz < 0 ) || ( z + oz >= numZ ) )
+          continue;
+        for ( int oy = -1; oy <= 1; ++oy ) {
+          if ( ( y + oy < 0 ) || ( y + oy >= numY ) )
+            continue;
+
+          const RealType * const argRow = arg + ( row + oy + oz * numY ) * numX;
+          const int k = getEntryIndex ( 0, oy, oz );
+          const RealType cm = innerStencil[k - 1], c0 = innerStencil[k], cp = innerStencil[k + 1];
+          for ( int x = 1; x < numX - 1; ++x )
+            destRow[x] += cm * argRow[x - 1] + c0 * argRow[x] + cp * argRow[x + 1];
+
+          destRow[0] += firstStencil[k] * argRow[0] + firstStencil[k + 1] * argRow[1];
+          destRow[numX - 1] += lastStencil[k - 1] * argRow[numX - 2] + lastStencil[k] * argRow[numX - 1];
+        }
+      }
+    }
+  }
+};
+
+/**
+ * \brief Matrix free mass matrix on a uniform rectangular grid, can be used instead of aol::MassOp with aol::ASSEMBLED.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+class MultilinStencilMassOp : public MultilinStencilOp<ConfiguratorType> {
+public:
+  explicit MultilinStencilMassOp ( const typename ConfiguratorType::InitType &Grid )
+    : MultilinStencilOp<ConfiguratorType> ( Grid ) {
+    this->setLocalMatrixFrom ( aol::MassOp<ConfiguratorType> ( Grid ) );
+  }
+};
+
+/**
+ * \brief Matrix free stiffness matrix on a uniform rectangular grid, can be used instead of aol::StiffOp with aol::ASSEMBLED.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+class MultilinStencilStiffOp : public MultilinStencilOp<ConfiguratorType> {
+public:
+  explicit MultilinStencilStiffOp ( const typename ConfiguratorType::InitType &Grid )
+    : MultilinStencilOp<ConfiguratorType> ( Grid ) {
+    this->setLocalMatrixFrom ( aol::StiffOp<ConfiguratorType> ( Grid ) );
+  }
+};
+
+}
+
+#endif // __MULTILINSTENCILOP_H
@@ -818,6 +818,13 @@ public:
     ParametricDeformationType::setIdentityDeformationParameters ( _deformParameters );
   }
 
+  //! Sets the parameters to the identity, except for the translation (in world coordinates), which all parametric deformations store in their first component.
+  void setTransformationToTranslation ( const aol::Vec<ConfiguratorType::Dim, RealType> &Translation ) {
+    ParametricDeformationType::setIdentityDeformationParameters ( _deformParameters );
+    for ( int i = 0; i < ConfiguratorType::Dim; ++i )
+      _deformParameters[0][i] = Translation[i];
+  }
+
   void setTransformationToComposition ( const aol::MultiVector<RealType> &/*DeformParameters1*/, const aol::MultiVector<RealType> &/*DeformParameters2*/ ) {
     throw aol::UnimplementedCodeException ( "not implemented", __FILE__, __LINE__ );
   }
@@ -914,6 +921,76 @@ public:
     qc::OTFILexMapper<Dim> mapper ( grid );
     return mapper.splitGlobalIndex ( phaseCorrelation.getMaxIndexAndValue().first );
   }
+
+  /**
+   * Estimates the translation (in pixels) with Template(x) = Reference(x-Translation) with sub-pixel accuracy.
+   * Since phase correlation assumes periodic images, the mean of both images is removed and they are multiplied
+   * by a Hann window before correlating them. Whitening the spectrum amplifies the noise in the high frequencies,
+   * so the correlation is smoothed with a Gaussian of width SmoothingSigma (in pixels) before looking for its peak.
+   * The sub-pixel position of the peak is found by fitting a parabola to the peak and its two neighbors in each
+   * direction. Shifts larger than half the image size are interpreted as negative shifts (the correlation is periodic).
+   */
+  static aol::Vec<Dim, RealType> estimateTranslation ( const ArrayType &Reference, const ArrayType &Template, const RealType SmoothingSigma = 1 ) {
+    typedef typename ConfiguratorType::InitType InitType;
+    const InitType grid ( Reference.getSize() );
+    const aol::Vec3<int> size = Reference.getSize();
+    qc::OTFILexMapper<Dim> mapper ( grid );
+
+    ArrayType windowedReference ( grid ), windowedTemplate ( grid );
+    const RealType meanReference = Reference.getMeanValue();
+    const RealType meanTemplate = Template.getMeanValue();
+    qc::CoordType coord;
+    for ( int i = 0; i < Reference.size(); ++i ) {
+      mapper.splitGlobalIndex ( i, coord );
+      RealType window = 1;
+      for ( int d = 0; d < Dim; ++d )
+        window *= 0.5 * ( 1 - cos ( 2 * aol::NumberTrait<RealType>::pi * coord[d] / aol::Max ( size[d] - 1, 1 ) ) );
+      windowedReference[i] = window * ( Reference[i] - meanReference );
+      windowedTemplate[i] = window * ( Template[i] - meanTemplate );
+    }
+
+    ArrayType phaseCorrelation ( grid );
+    qc::Convolution<Dim, RealType> conv ( qc::GridSize<Dim> ( grid ).getSizeAsVecDim() );
+    conv.phaseCorrelation ( windowedReference, windowedTemplate, phaseCorrelation );
+
+    // Move the zero shift to the center, so that the smoothing doesn't have to deal with the periodicity.
+    ArrayType centeredCorrelation ( grid );
+    qc::CoordType shiftedCoord;
+    for ( int i = 0; i < phaseCorrelation.size(); ++i ) {
+      mapper.splitGlobalIndex ( i, coord );
+      for ( int d = 0; d < Dim; ++d )
+        shiftedCoord[d] = ( coord[d] + size[d] - size[d] / 2 ) % size[d];
+      centeredCorrelation[i] = phaseCorrelation[mapper.getGlobalIndex ( shiftedCoord )];
+    }
+    if ( SmoothingSigma > 0 ) {
+      qc::LinearSmoothOp<RealType, typename qc::MultilevelArrayTrait<RealType, InitType>::GridTraitType> linSmooth;
+      linSmooth.setCurrentGrid ( grid );
+      linSmooth.setSigma ( SmoothingSigma * grid.H() );
+      linSmooth.applySingle ( centeredCorrelation );
+    }
+
+    const int peakIndex = centeredCorrelation.getMaxIndexAndValue().first;
+    const RealType peakValue = centeredCorrelation[peakIndex];
+    qc::CoordType peak;
+    mapper.splitGlobalIndex ( peakIndex, peak );
+    aol::Vec<Dim, RealType> translation;
+    for ( int d = 0; d < Dim; ++d ) {
+      RealType offset = 0;
+      if ( ( peak[d] > 0 ) && ( peak[d] < size[d] - 1 ) ) {
+        qc::CoordType neighbor ( peak );
+        --neighbor[d];
+        const RealType valueMinus = centeredCorrelation[mapper.getGlobalIndex ( neighbor )];
+        neighbor[d] += 2;
+        const RealType valuePlus = centeredCorrelation[mapper.getGlobalIndex ( neighbor )];
+        const RealType curvature = valueMinus - 2 * peakValue + valuePlus;
+        if ( curvature < 0 )
+          offset = aol::Clamp<RealType> ( 0.5 * ( valueMinus - valuePlus ) / curvature, -0.5, 0.5 );
+      }
+      // The peak of the phase correlation is at -Translation.
+      translation[d] = size[d] / 2 - peak[d] - offset;
+    }
+    return translation;
+  }
 };
 
 } // end namespace qc
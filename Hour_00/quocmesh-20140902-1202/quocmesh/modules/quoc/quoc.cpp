@@ -10,12 +10,14 @@ int getSizeOfSaveType ( const qc::SaveType Type ) {
     break;
   case PGM_UNSIGNED_SHORT_BINARY:
   case PGM_SHORT_BINARY:
+  case TILED_UNSIGNED_SHORT_BINARY:
     return 2;
     break;
   case PGM_FLOAT_ASCII:
   case PGM_FLOAT_BINARY:
   case PGM_UNSIGNED_INT_BINARY:
   case PGM_SIGNED_INT_BINARY:
+  case TILED_FLOAT_BINARY:
     return 4;
     break;
   case PGM_DOUBLE_BINARY:
@@ -45,6 +47,10 @@ const char *getDefaulSuffixOfSaveType ( const qc::SaveType Type ) {
     case PNG_2D:
       return ".png";
       break;
+    case TILED_FLOAT_BINARY:
+    case TILED_UNSIGNED_SHORT_BINARY:
+      return ".qtz";
+      break;
     default:
       throw aol::Exception ( "qc::getDefaulSuffixOfSaveType: Unsupported SaveType", __FILE__, __LINE__ );
       break;
@@ -25,12 +25,18 @@ struct ArrayHeader {
  *  <tr><td>type 33</td><td>RAW signed int data PGM </td></tr>
  *  <tr><td>type 34</td><td>RAW unsigned int data PGM </td></tr>
  *  <tr><td>type 211</td><td>PNG </td></tr>
+ *  <tr><td>type 212</td><td>zlib compressed tiles of float data </td></tr>
+ *  <tr><td>type 213</td><td>zlib compressed tiles of unsigned short data </td></tr>
  *  </table>
  *  Note that there is an enum available that should be used instead of those integers.
  *  Types 2, 5 and 211 can be directly viewed using e.g. xv or gimp for 2D data (i.e. on Array2D).
  *  Type 211 cannot be used in 3D and does not allow for comments.
- *  The floating point types (7, 8, 9) don't use the overflow handling. Instead the values are
- *  saved directly, just casted to the selected floating point type.
+ *  The floating point types (7, 8, 9) and the signed short and the int types (11, 33, 34) don't use the
+ *  overflow handling. Instead the values are saved directly, just casted to the selected type. Type 10
+ *  saves unsigned short data directly, data of other types is scaled to [0,65535].
+ *  The tiled types (212, 213) are written to their own file format (see qc::TiledArrayFile) that allows
+ *  to load a sub-region of the array without decompressing the whole file. They don't use the overflow
+ *  handling either and can only be saved to and loaded from files with the suffix ".qtz".
  */
 enum SaveType {
   PGM_UNSIGNED_CHAR_ASCII    =  2,                     //!< can be opened in image processing programs (xv, gimp, ...)
@@ -42,7 +48,9 @@ enum SaveType {
   PGM_SHORT_BINARY           = aol::FF_SIGNED_SHORT,
   PGM_UNSIGNED_INT_BINARY    = aol::FF_UNSIGNED_INT,
   PGM_SIGNED_INT_BINARY      = aol::FF_SIGNED_INT,
-  PNG_2D                     = 211
+  PNG_2D                     = 211,
+  TILED_FLOAT_BINARY         = 212,                    //!< zlib compressed tiles that can be loaded separately, see qc::TiledArrayFile
+  TILED_UNSIGNED_SHORT_BINARY = 213                    //!< like TILED_FLOAT_BINARY, values are rounded and clipped to [0,65535]
 };
 
 /**
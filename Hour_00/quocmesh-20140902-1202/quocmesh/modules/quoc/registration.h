@@ -6,12 +6,14 @@
 #include <hyperelastic.h>
 #include <deformations.h>
 #include <imageTools.h>
+#include <mappedScalarArray.h>
 #include <gradientDescent.h>
 #include <gradientflow.h>
 #include <quocDescent.h>
 #include <quocTimestepSaver.h>
 #include <cellCenteredGrid.h>
 #include <anisoStiffOps.h>
+#include <multilinStencilOp.h>
 
 namespace qc {
 
@@ -215,6 +217,65 @@ enum REGISTRATION_INPUT_TYPE {
   TEMPLATE
 };
 
+/**
+ * \brief Mass and stiffness operators on the grids of a multilevel descent, indexed by the grid level.
+ *
+ * Each operator is created on the first request for its level. The operators are matrix free, see
+ * qc::MultilinStencilOp, and replace the assembled aol::MassOp and aol::StiffOp used before.
+ * Since the grids of a multilevel descent don't change, the operators can be reused by all descents on
+ * the same level, e.g. by all pairings registered by the same object in a series registration.
+ *
+ * \author Berkels
+ */
+template <typename ConfiguratorType>
+class MultilevelOpCache {
+  typedef typename ConfiguratorType::InitType InitType;
+  const vector<const InitType*> &_grids;
+  mutable vector<qc::MultilinStencilMassOp<ConfiguratorType>*> _massOps;
+  mutable vector<qc::MultilinStencilStiffOp<ConfiguratorType>*> _stiffOps;
+
+  template <typename OpType>
+  const OpType &getOp ( vector<OpType*> &Ops, const int Level ) const {
+    QUOC_ASSERT ( ( Level >= 0 ) && ( Level < static_cast<int> ( Ops.size() ) ) );
+    if ( Ops[Level] == NULL )
+      Ops[Level] = new OpType ( *_grids[Level] );
+    return *Ops[Level];
+  }
+
+  // The cached operators are not supposed to be shared, so prevent copying.
+  MultilevelOpCache ( const MultilevelOpCache<ConfiguratorType> &Other );
+  MultilevelOpCache<ConfiguratorType>& operator= ( const MultilevelOpCache<ConfiguratorType> &Other );
+public:
+  explicit MultilevelOpCache ( const vector<const InitType*> &Grids )
+    : _grids ( Grids ),
+      _massOps ( Grids.size(), NULL ),
+      _stiffOps ( Grids.size(), NULL ) {}
+
+  ~MultilevelOpCache ( ) {
+    for ( unsigned int level = 0; level < _grids.size(); ++level ) {
+      delete _massOps[level];
+      delete _stiffOps[level];
+    }
+  }
+
+  //! Returns the level of the grid with the same size as Grid, -1 if there is none.
+  int getLevelOfGrid ( const InitType &Grid ) const {
+    for ( unsigned int level = 0; level < _grids.size(); ++level ) {
+      if ( _grids[level]->getSize() == Grid.getSize() )
+        return level;
+    }
+    return -1;
+  }
+
+  const qc::MultilinStencilMassOp<ConfiguratorType> &getMassOp ( const int Level ) const {
+    return getOp ( _massOps, Level );
+  }
+
+  const qc::MultilinStencilStiffOp<ConfiguratorType> &getStiffOp ( const int Level ) const {
+    return getOp ( _stiffOps, Level );
+  }
+};
+
 /**
  * \author Berkels
  */
@@ -231,17 +292,24 @@ protected:
   // original image data
   MultilevelArrayType _org_template, _org_reference;
   string _saveDirectory;
+  const MultilevelOpCache<ConfiguratorType> _opCache;
 
 public:
   const aol::ParameterParser& getParserReference ( ) const {
     return *_pParser;
   }
 
+  //! Matrix free mass and stiffness operators on the grids of the different levels, shared by all descents done by this object.
+  const MultilevelOpCache<ConfiguratorType>& getOpCache ( ) const {
+    return _opCache;
+  }
+
   RegistrationMultilevelDescentInterfaceBase ( const aol::ParameterParser &Parser )
     : qc::MultilevelDescentInterface<ConfiguratorType> ( Parser.getInt ( "precisionLevel" ) ),
       _pParser ( &Parser, false ),
       _org_template ( this->_grid ),
-      _org_reference ( this->_grid ) {
+      _org_reference ( this->_grid ),
+      _opCache ( this->_grids ) {
     loadImageData( );
 
     // This creates the save directory and dumps the paramters to a file in that dir.
@@ -254,7 +322,8 @@ public:
     : qc::MultilevelDescentInterface<ConfiguratorType> ( MaxDepth ),
       _pParser ( new aol::ParameterParser, true ),
       _org_template ( this->_grid ),
-      _org_reference ( this->_grid ) {
+      _org_reference ( this->_grid ),
+      _opCache ( this->_grids ) {
   }
 
   void setLevel ( const int Level ) {
@@ -378,7 +447,9 @@ public:
   }
 
   void loadAndPrepareImage ( const char* Filename, MultilevelArrayType &Dest, const bool NoScaling = false, const bool NoResizeOrCrop = false, const bool NoSmoothing = false ) const {
-    ImageDOFType inputData ( Filename );
+    // Uncompressed 2D input is memory mapped instead of being read, the image is only needed to initialize Dest.
+    const qc::MappedScalarArray<RealType, ConfiguratorType::Dim> mappedInputData ( Filename );
+    const ImageDOFType inputData ( mappedInputData, aol::FLAT_COPY );
     initMultilevelArrayFromImage ( inputData, Dest, NoScaling, NoResizeOrCrop, NoSmoothing );
   }
 
@@ -519,6 +590,13 @@ public:
     _transformation.levRestrict ( 0, this->_maxDepth );
   }
 
+  //! Sets the transformation to the constant displacement Translation (in world coordinates).
+  void setTransformationToTranslation ( const aol::Vec<ConfiguratorType::Dim, RealType> &Translation ) {
+    for ( int comp = 0; comp < ConfiguratorType::Dim; ++comp )
+      _transformation.getArray( comp, this->_maxDepth ).setAll ( Translation[comp] );
+    _transformation.levRestrict ( 0, this->_maxDepth );
+  }
+
   void setTransformationToComposition ( const qc::MultiArray<RealType, ConfiguratorType::Dim> &Transformation1,  const qc::MultiArray<RealType, ConfiguratorType::Dim> &Transformation2 ) {
     _transformation.setCurLevel ( _transformation.getDepth() );
     qc::MultiArray<RealType, ConfiguratorType::Dim> phi ( _transformation, aol::FLAT_COPY );
@@ -586,7 +664,8 @@ template <typename ConfiguratorType>
 class DirichletRegularizationConfigurator {
   typedef typename ConfiguratorType::RealType RealType;
   const typename ConfiguratorType::InitType &_grid;
-  const aol::StiffOp<ConfiguratorType> _stiff;
+  // Either owned or taken from the operator cache of the multilevel descent.
+  const aol::DeleteFlagPointer<const aol::Op<aol::Vector<RealType> > > _pStiff;
   const qc::DisplacementLengthEnergy<ConfiguratorType> _regE;
   const aol::DiagonalBlockOp<RealType> _regDE;
 public:
@@ -597,16 +676,16 @@ public:
                                         // Dummy argument, don't give it a name!
                                         const aol::Vector<RealType> & = *static_cast<aol::Vector<RealType>*> ( NULL ) )
    : _grid ( Grid ),
-     _stiff ( _grid,  aol::ASSEMBLED ),
-     _regE ( _stiff ),
-     _regDE ( _stiff ) {}
+     _pStiff ( new aol::StiffOp<ConfiguratorType> ( _grid,  aol::ASSEMBLED ), true ),
+     _regE ( *_pStiff ),
+     _regDE ( *_pStiff ) {}
 
   template <typename RegistrationMultilevelDescentType>
   DirichletRegularizationConfigurator ( const RegistrationMultilevelDescentType &RegisMLD )
    : _grid ( RegisMLD.getCurrentGrid() ),
-     _stiff ( _grid,  aol::ASSEMBLED ),
-     _regE ( _stiff ),
-     _regDE ( _stiff ) {}
+     _pStiff ( &RegisMLD.getOpCache().getStiffOp ( RegisMLD.getLevel() ), false ),
+     _regE ( *_pStiff ),
+     _regDE ( *_pStiff ) {}
 
   const aol::Op<aol::MultiVector<RealType>, aol::Scalar<RealType> > &getRegERef ( ) const {
     return _regE;
@@ -788,6 +867,7 @@ protected:
   RealType _stopEpsilon;
   int _maxGDIterations;
   bool _validateDerivative;
+  bool _useFFTSmoothing;
 public:
   StandardRegistration ( const ImageDOFType &Reference0,
                          const ImageDOFType &Template0,
@@ -799,7 +879,8 @@ public:
       _regulConfig ( RegulConfig ),
       _stopEpsilon ( aol::ZOTrait<RealType>::zero ),
       _maxGDIterations ( 1000 ),
-      _validateDerivative ( false ) {}
+      _validateDerivative ( false ),
+      _useFFTSmoothing ( false ) {}
 
   StandardRegistration ( const qc::GridSize<ConfiguratorType::Dim> &Size,
                          const RegistrationConfiguratorType &RegisConfig,
@@ -810,7 +891,8 @@ public:
       _regulConfig ( RegulConfig ),
       _stopEpsilon ( aol::ZOTrait<RealType>::zero ),
       _maxGDIterations ( 1000 ),
-      _validateDerivative ( false ) {}
+      _validateDerivative ( false ),
+      _useFFTSmoothing ( false ) {}
 
   RealType findTransformation ( aol::MultiVector<RealType> &Phi, const bool NoConsoleOutput = false, const char *EnergyPlotFile = NULL ) {
     // Check if the input data fulfills the requirements imposed by the chosen registration approach.
@@ -840,6 +922,7 @@ public:
     typedef aol::GradientDescentWithAutomaticFilterWidth<ConfiguratorType, aol::MultiVector<RealType>, GradientDescentType> GDType;
     GDType gradientDescent_solver ( this->_grid, E, DE, _maxGDIterations, this->_tau, _stopEpsilon );
     gradientDescent_solver.setConfigurationFlags ( GDType::USE_NONLINEAR_CG | ( NoConsoleOutput ? GDType::DO_NOT_WRITE_CONSOLE_OUTPUT : 0 ) );
+    qc::setUseFFTIfSupported ( gradientDescent_solver.getSmoothOpReference(), _useFFTSmoothing );
 
     std::ofstream out;
     if ( EnergyPlotFile ) {
@@ -866,6 +949,11 @@ public:
   void setMaxGDIterations ( const int MaxGDIterations ) {
     _maxGDIterations = MaxGDIterations;
   }
+
+  //! Smooth the descent directions with the FFT based solver of qc::LinearSmoothOp, see qc::LinearSmoothOp::setUseFFT.
+  void setUseFFTSmoothing ( const bool UseFFTSmoothing ) {
+    _useFFTSmoothing = UseFFTSmoothing;
+  }
 };
 
 /**
@@ -932,6 +1020,7 @@ public:
       stdRegistration.setStopEpsilon( this->getParserReference().getDouble ( "stopEpsilon" ) );
     if ( this->getParserReference().hasVariable ( "maxGDIterations" ) )
       stdRegistration.setMaxGDIterations( this->getParserReference().getInt ( "maxGDIterations" ) );
+    stdRegistration.setUseFFTSmoothing ( this->getParserReference().checkAndGetBool ( "useFFTSmoothing" ) );
     _energyOfLastSolution = stdRegistration.findTransformation ( phi, false, _disableSaving ? NULL : aol::strprintf ( "%senergy_%02d.txt", this->getSaveDirectory(), this->_curLevel ).c_str() );
 
     if ( _disableSaving == false )
@@ -1151,13 +1240,23 @@ public:
   typedef typename ConfiguratorType::RealType RealType;
   typedef typename ConfiguratorType::ArrayType ImageDOFType;
 
-  NCCRegistrationConfigurator ( ) : BaseRegistrationConfigurator<ConfiguratorType> ( ) {}
+protected:
+  const MultilevelOpCache<ConfiguratorType> *_pOpCache;
+public:
+  NCCRegistrationConfigurator ( ) : BaseRegistrationConfigurator<ConfiguratorType> ( ), _pOpCache ( NULL ) {}
 
-  explicit NCCRegistrationConfigurator ( const aol::ParameterParser &Parser ) : BaseRegistrationConfigurator<ConfiguratorType> ( Parser ) {}
+  explicit NCCRegistrationConfigurator ( const aol::ParameterParser &Parser ) : BaseRegistrationConfigurator<ConfiguratorType> ( Parser ), _pOpCache ( NULL ) {}
 
   template <typename RegistrationMultilevelDescentType>
   explicit NCCRegistrationConfigurator ( const RegistrationMultilevelDescentType &RegisMLD )
-    : BaseRegistrationConfigurator<ConfiguratorType> ( RegisMLD.getParserReference() ) {}
+    : BaseRegistrationConfigurator<ConfiguratorType> ( RegisMLD.getParserReference() ),
+      _pOpCache ( &RegisMLD.getOpCache() ) {}
+
+  //! Returns the mass operator on Grid from the cache of the multilevel descent if possible, NULL otherwise.
+  const aol::Op<aol::Vector<typename ConfiguratorType::RealType> >* getCachedMassOpPointer ( const typename ConfiguratorType::InitType &Grid ) const {
+    const int level = ( _pOpCache != NULL ) ? _pOpCache->getLevelOfGrid ( Grid ) : -1;
+    return ( level >= 0 ) ? &_pOpCache->getMassOp ( level ) : NULL;
+  }
 
   typedef NormalizedCrossCorrelationEnergy<ConfiguratorType> Energy;
   typedef VariationOfNormalizedCrossCorrelationEnergy<ConfiguratorType> EnergyVariation;
@@ -1209,29 +1308,44 @@ public:
   typedef typename ConfiguratorType::RealType RealType;
 protected:
   const typename ConfiguratorType::InitType &_grid;
-  const aol::MassOp<ConfiguratorType> _massOp;
+  // Either owned or taken from the operator cache of the multilevel descent, see NCCRegistrationConfigurator.
+  aol::DeleteFlagPointer<const aol::Op<aol::Vector<RealType> > > _pMassOp;
   typename ConfiguratorType::ArrayType _normalizedR;
   const typename ConfiguratorType::ArrayType _t;
   mutable RealType _varOfLastDeformedT;
   mutable typename ConfiguratorType::ArrayType _lastNormalizedDeformedT;
 public:
+  NormalizedCrossCorrelationEnergy ( const typename ConfiguratorType::InitType &Grid,
+                                     const aol::Vector<RealType> &ImR,
+                                     const aol::Vector<RealType> &ImT )
+    : _grid ( Grid ),
+      _pMassOp ( new aol::MassOp<ConfiguratorType> ( Grid, aol::ASSEMBLED ), true ),
+      _normalizedR( Grid ),
+      _t( ImT, Grid, aol::FLAT_COPY ),
+      _varOfLastDeformedT ( 0 ),
+      _lastNormalizedDeformedT ( Grid ) {
+    normalizeImageForNCC ( *_pMassOp, ImR, _normalizedR );
+  }
+
   NormalizedCrossCorrelationEnergy ( const typename ConfiguratorType::InitType &Grid,
                                      const aol::Vector<RealType> &ImR,
                                      const aol::Vector<RealType> &ImT,
-                                     // Dummy argument so that this class can be used in qc::StandardRegistration.
-                                     // It's potentially filled with an invalid reference, so don't give it a name!
-                                     const NCCRegistrationConfigurator<ConfiguratorType> & = *static_cast<NCCRegistrationConfigurator<ConfiguratorType>*> ( NULL ) )
+                                     const NCCRegistrationConfigurator<ConfiguratorType> &RegisConfig )
     : _grid ( Grid ),
-      _massOp ( Grid, aol::ASSEMBLED ),
       _normalizedR( Grid ),
       _t( ImT, Grid, aol::FLAT_COPY ),
       _varOfLastDeformedT ( 0 ),
       _lastNormalizedDeformedT ( Grid ) {
-    normalizeImageForNCC ( _massOp, ImR, _normalizedR );
+    const aol::Op<aol::Vector<RealType> > *cachedMassOp = RegisConfig.getCachedMassOpPointer ( Grid );
+    if ( cachedMassOp != NULL )
+      _pMassOp.reset ( cachedMassOp, false );
+    else
+      _pMassOp.reset ( new aol::MassOp<ConfiguratorType> ( Grid, aol::ASSEMBLED ), true );
+    normalizeImageForNCC ( *_pMassOp, ImR, _normalizedR );
   }
 
   //! Subtracts mean and then devides by variance. Furthermore, returns the variance.
-  static RealType normalizeImageForNCC ( const aol::MassOp<ConfiguratorType> &MassOp, const aol::Vector<RealType> &Image, aol::Vector<RealType> &NormalizedImage ) {
+  static RealType normalizeImageForNCC ( const aol::Op<aol::Vector<RealType> > &MassOp, const aol::Vector<RealType> &Image, aol::Vector<RealType> &NormalizedImage ) {
     typedef typename ConfiguratorType::RealType RealType;
     aol::Vector<RealType> temp ( Image, aol::STRUCT_COPY );
     MassOp.apply ( Image, temp );
@@ -1251,9 +1365,9 @@ public:
     // the variance more complicated. Probably even R would need to be renormalized based on the
     // altered domain mask.
     qc::DeformImage<ConfiguratorType> ( _t, _grid, deformedT, MArg, false );
-    _varOfLastDeformedT = normalizeImageForNCC ( _massOp, deformedT, _lastNormalizedDeformedT );
+    _varOfLastDeformedT = normalizeImageForNCC ( *_pMassOp, deformedT, _lastNormalizedDeformedT );
     // deformedImage is not needed anymore, we can use it as temp vector.
-    _massOp.apply ( _lastNormalizedDeformedT, deformedT );
+    _pMassOp->apply ( _lastNormalizedDeformedT, deformedT );
     this->_lastEnergy = - ( deformedT * _normalizedR );
     Dest += this->_lastEnergy;
   }
@@ -1282,12 +1396,15 @@ private:
 public:
   VariationOfNormalizedCrossCorrelationEnergy ( const typename ConfiguratorType::InitType &Grid,
                                                 const aol::Vector<RealType> &ImR,
-                                                const aol::Vector<RealType> &ImT,
-                                                // Dummy argument so that this class can be used in qc::StandardRegistration.
-                                                // It's potentially filled with an invalid reference, so don't give it a name!
-                                                const NCCRegistrationConfigurator<ConfiguratorType> & = *static_cast<NCCRegistrationConfigurator<ConfiguratorType>*> ( NULL ) )
+                                                const aol::Vector<RealType> &ImT )
     : _E ( Grid, ImR, ImT ), _DE ( _E ) {}
 
+  VariationOfNormalizedCrossCorrelationEnergy ( const typename ConfiguratorType::InitType &Grid,
+                                                const aol::Vector<RealType> &ImR,
+                                                const aol::Vector<RealType> &ImT,
+                                                const NCCRegistrationConfigurator<ConfiguratorType> &RegisConfig )
+    : _E ( Grid, ImR, ImT, RegisConfig ), _DE ( _E ) {}
+
   void applyAdd ( const aol::MultiVector<RealType> &MArg, aol::MultiVector<RealType> &MDest ) const {
     _DE.applyAdd ( MArg, MDest );
   }
@@ -11,6 +11,7 @@
 #include <indexMapper.h>
 #include <imageTools.h>
 #include <dm3Import.h>
+#include <tiledArrayFile.h>
 
 #ifdef USE_LIB_TIFF
 #include <tiffio.h>
@@ -20,15 +21,80 @@
 #include <cimgIncludes.h>
 #endif
 
-char FILE_TYPE[][14] = { "", "",
-                         "ASCII",
-                         "", "",
-                         "BINARY",
-                         "",
-                         "ASCII FLOAT",
-                         "RAW FLOAT",
-                         "RAW DOUBLE"
-                       };
+namespace {
+
+//! Name of the SaveType written to the default comment of the pgm style formats.
+const char* getFileTypeName ( const qc::SaveType Type ) {
+  switch ( Type ) {
+    case qc::PGM_UNSIGNED_CHAR_ASCII:
+      return "ASCII";
+    case qc::PGM_UNSIGNED_CHAR_BINARY:
+      return "BINARY";
+    case qc::PGM_FLOAT_ASCII:
+      return "ASCII FLOAT";
+    case qc::PGM_FLOAT_BINARY:
+      return "RAW FLOAT";
+    case qc::PGM_DOUBLE_BINARY:
+      return "RAW DOUBLE";
+    case qc::PGM_UNSIGNED_SHORT_BINARY:
+      return "RAW UNSIGNED SHORT";
+    case qc::PGM_SHORT_BINARY:
+      return "RAW SHORT";
+    case qc::PGM_UNSIGNED_INT_BINARY:
+      return "RAW UNSIGNED INT";
+    case qc::PGM_SIGNED_INT_BINARY:
+      return "RAW INT";
+    default:
+      return "";
+  }
+}
+
+//! Magic number following the P or Q of the pgm style formats. The short types use a single
+//! character, such that the first two characters of the header determine the type.
+string getMagicNumberString ( const qc::SaveType Type ) {
+  if ( Type == qc::PGM_UNSIGNED_SHORT_BINARY )
+    return "a";
+  else if ( Type == qc::PGM_SHORT_BINARY )
+    return "b";
+  else
+    return aol::strprintf ( "%d", Type );
+}
+
+//! Converts the type string read from the first line of a pgm style header (without the leading P or Q) to a SaveType, returns -1 if the type is unknown.
+int getSaveTypeFromMagicNumber ( const char *MagicNumber ) {
+  switch ( MagicNumber[0] ) {
+    case '2':
+      return qc::PGM_UNSIGNED_CHAR_ASCII;
+    case '5':
+      return qc::PGM_UNSIGNED_CHAR_BINARY;
+    case '7':
+      return qc::PGM_FLOAT_ASCII;
+    case '8':
+      return qc::PGM_FLOAT_BINARY;
+    case '9':
+      return qc::PGM_DOUBLE_BINARY;
+    case 'a':
+      return qc::PGM_UNSIGNED_SHORT_BINARY;
+    case 'b':
+      return qc::PGM_SHORT_BINARY;
+    case '3':
+      if ( MagicNumber[1] == '3' )
+        return qc::PGM_SIGNED_INT_BINARY;
+      else if ( MagicNumber[1] == '4' )
+        return qc::PGM_UNSIGNED_INT_BINARY;
+      return -1;
+    default:
+      return -1;
+  }
+}
+
+//! Whether the raw data of this SaveType is padded to start at a multiple of 16 bytes, see qc::MappedScalarArray.
+bool isAlignedBinaryType ( const qc::SaveType Type ) {
+  return ( Type == qc::PGM_FLOAT_BINARY ) || ( Type == qc::PGM_DOUBLE_BINARY ) || ( Type == qc::PGM_UNSIGNED_SHORT_BINARY )
+         || ( Type == qc::PGM_SHORT_BINARY ) || ( Type == qc::PGM_UNSIGNED_INT_BINARY ) || ( Type == qc::PGM_SIGNED_INT_BINARY );
+}
+
+}
 
 template < typename DataType > const aol::Format & qc::ScalarArray < DataType, qc::QC_2D > ::format = aol::mixedFormat;
 template < typename DataType > bool qc::ScalarArray < DataType, qc::QC_2D > ::prettyFormat = true;
@@ -140,7 +206,7 @@ void qc::ScalarArray<_DataType, qc::QC_1D>::save ( ostream &out, qc::SaveType ty
   char      info[4096];
 
   if ( !comment ) {
-    sprintf ( info, "# This is a QuOcMesh file of type %d (=%s) written %s", type, FILE_TYPE[type],
+    sprintf ( info, "# This is a QuOcMesh file of type %d (=%s) written %s", type, getFileTypeName ( type ),
               aol::generateCurrentTimeAndDateString().c_str() );
     comment = info;
   }
@@ -276,7 +342,7 @@ void qc::ScalarArray<_DataType, qc::QC_2D>::save ( ostream &out, qc::SaveType ty
   char      info[4096];
 
   if ( !comment ) {
-    sprintf ( info, "# This is a QuOcMesh file of type %d (=%s) written %s", type, FILE_TYPE[type],
+    sprintf ( info, "# This is a QuOcMesh file of type %d (=%s) written %s", type, getFileTypeName ( type ),
               aol::generateCurrentTimeAndDateString().c_str() );
     comment = info;
   }
@@ -289,21 +355,37 @@ void qc::ScalarArray<_DataType, qc::QC_2D>::save ( ostream &out, qc::SaveType ty
     comment = info;
   }
 
-  out << "P" << type << endl <<  comment << endl << this->numX << " " << this->numY << endl;
+  std::ostringstream header;
+  header << endl << this->numX << " " << this->numY << endl;
   switch ( type ) {
     case PGM_UNSIGNED_CHAR_ASCII:
     case PGM_UNSIGNED_CHAR_BINARY:
-      out << "255\n";
+      header << "255\n";
       break;
     case PGM_FLOAT_ASCII:
     case PGM_FLOAT_BINARY:
     case PGM_DOUBLE_BINARY:
-      out << static_cast<int> ( maximum ) << "\n";
+    case PGM_UNSIGNED_SHORT_BINARY:
+    case PGM_SHORT_BINARY:
+    case PGM_UNSIGNED_INT_BINARY:
+    case PGM_SIGNED_INT_BINARY:
+      header << static_cast<int> ( maximum ) << "\n";
       break;
     default:
       throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::save: illegal type", __FILE__, __LINE__ );
   }
 
+  std::ostringstream magic;
+  magic << "P" << getMagicNumberString ( type ) << endl << comment;
+
+  // Pad the comment such that binary data (except for unsigned char) starts at a multiple of 16 bytes.
+  // This way, MappedScalarArray can directly use the data of uncompressed files without copying it.
+  if ( isAlignedBinaryType ( type ) ) {
+    const size_t headerSize = magic.str().size() + header.str().size();
+    magic << string ( ( 16 - headerSize % 16 ) % 16, ' ' );
+  }
+
+  out << magic.str() << header.str();
   this->saveRaw ( out, type, minimum, maximum );
 }
 
@@ -317,12 +399,18 @@ void qc::ScalarArray<_DataType, qc::QC_2D>::save ( const char *fileName,
       throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::save( const char*, qc::SaveType, const char* ) with type PNG allows no comment", __FILE__, __LINE__ );
     else
       savePNG ( fileName );
-  else {
-    if ( type != 2 && type != 5 && ! ( type >= 7 && type <= 9 ) )
+  else if ( TiledArrayFile::isTiledType ( type ) ) {
+    if ( !TiledArrayFile::hasTiledSuffix ( fileName ) )
+      throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::save: Tiled array files need the suffix .qtz", __FILE__, __LINE__ );
+    TiledArrayFile::write ( fileName, this->getData(), 2, aol::Vec3<int> ( this->numX, this->numY, 1 ), type, comment );
+    if ( !this->quietMode ) cerr << "done.\n";
+  } else {
+    if ( type != 2 && type != 5 && ! ( type >= 7 && type <= 9 ) && !isAlignedBinaryType ( type ) )
       throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::save: Unknown magic number",
                                  __FILE__, __LINE__ );
 
-    aol::Bzipofstream *out = new aol::Bzipofstream ( fileName );
+    // 2D and 3D arrays are usually large enough for parallel compression to pay off.
+    aol::Bzipofstream *out = new aol::Bzipofstream ( fileName, aol::Bzipofstream::DefaultCompressionLevel, 0 );
 
     if ( !out->good() ) {
       delete out;
@@ -411,67 +499,56 @@ void qc::ScalarArray<_DataType, qc::QC_2D>::pasteAddFrom ( const qc::ScalarArray
 
 template <typename _DataType>
 void qc::ScalarArray<_DataType, qc::QC_2D>::load ( istream &in ) {
-  char          tmp[256];
-  int           type, inWidth, inHeight, inMaxColor;
+  int type, inWidth, inHeight;
 
   if ( ! ( this->quietMode ) ) {
     cerr << "qc::ScalarArray<DataType, qc::QC_2D>::load( istream &in )\n";
   }
 
+  readHeader ( in, type, inWidth, inHeight );
+  this->loadRaw ( in, type, inWidth, inHeight );
+}
+
+template <typename _DataType>
+void qc::ScalarArray<_DataType, qc::QC_2D>::readHeader ( istream &in, int &Type, int &Width, int &Height ) {
+  int inMaxColor;
+  readHeader ( in, Type, Width, Height, inMaxColor );
+}
+
+template <typename _DataType>
+void qc::ScalarArray<_DataType, qc::QC_2D>::readHeader ( istream &in, int &Type, int &Width, int &Height, int &MaxColor ) {
+  char          tmp[256];
+
   in.get ( tmp, 255, '\n' );
   if ( tmp[0] != 'P' )
     throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::load: wrong file format",
                                __FILE__, __LINE__ );
 
-  switch ( tmp[1] ) {
-    case '2':
-      type = PGM_UNSIGNED_CHAR_ASCII;
-      break;
-    case '5':
-      type = PGM_UNSIGNED_CHAR_BINARY;
-      break;
-    case '7':
-      type = PGM_FLOAT_ASCII;
-      break;
-    case '8':
-      type = PGM_FLOAT_BINARY;
-      break;
-    case '9':
-      type = PGM_DOUBLE_BINARY;
-      break;
-    case 'a':
-      type = PGM_UNSIGNED_SHORT_BINARY;
-      break;
-    case 'b':
-      type = PGM_SHORT_BINARY;
-      break;
-    default:
-      throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::load: wrong magic number",
-                                 __FILE__, __LINE__ );
-  }
+  Type = getSaveTypeFromMagicNumber ( tmp + 1 );
+  if ( Type < 0 )
+    throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::load: wrong magic number",
+                               __FILE__, __LINE__ );
 
   aol::READ_COMMENTS ( in );
-  in >> inWidth;
+  in >> Width;
   if ( in.fail() )
     throw aol::FileFormatException ( "qc::ScalarArray<DataType, qc::QC_2D>::load: error reading width", __FILE__, __LINE__ );
 
   aol::READ_COMMENTS ( in );
-  in >> inHeight;
+  in >> Height;
   if ( in.fail() )
     throw aol::FileFormatException ( "qc::ScalarArray<DataType, qc::QC_2D>::load: error reading height", __FILE__, __LINE__ );
 
   aol::READ_COMMENTS ( in );
-  in >> inMaxColor;
+  in >> MaxColor;
   if ( in.fail() )
     throw aol::FileFormatException ( "qc::ScalarArray<DataType, qc::QC_2D>::load: error reading max color", __FILE__, __LINE__ );
 
   in.ignore();
 
 #ifdef VERBOSE
-  cerr << "Read from header: " << inWidth << " " << inHeight << " " << inMaxColor << endl;
+  cerr << "Read from header: " << Width << " " << Height << " " << MaxColor << endl;
 #endif
-
-  this->loadRaw ( in, type, inWidth, inHeight );
 }
 
 template < typename _DataType >
@@ -500,15 +577,33 @@ void qc::ScalarArray<_DataType, qc::QC_2D>::load ( const char *fileName ) {
     loadDM3 ( fileName );
   } else if ( aol::fileNameEndsWith ( fileName, ".tif" ) ) {
     loadTIFF ( fileName );
+  } else if ( TiledArrayFile::hasTiledSuffix ( fileName ) ) {
+    const TiledArrayFile file ( fileName );
+    loadRegion ( fileName, aol::Vec2<int> ( 0, 0 ), aol::Vec2<int> ( file.getSize()[0], file.getSize()[1] ) );
   } else {
 
-    // Decompression is done by aol::Bzipifstream based on filename extension
-    aol::Bzipifstream in ( fileName );
+    // Decompression is done by aol::Bzipifstream based on filename extension, in parallel if the file consists of several bzip2 streams
+    aol::Bzipifstream in ( fileName, 0 );
     load ( in );
   }
   if ( !this->quietMode ) cerr << "done." << endl;
 }
 
+template <typename _DataType>
+void qc::ScalarArray<_DataType, qc::QC_2D>::loadRegion ( const char *fileName, const aol::Vec2<int> &Begin, const aol::Vec2<int> &Size ) {
+  if ( TiledArrayFile::hasTiledSuffix ( fileName ) ) {
+    const TiledArrayFile file ( fileName );
+    if ( file.getSize()[2] != 1 )
+      throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_2D>::loadRegion: The file contains a 3D array", __FILE__, __LINE__ );
+    if ( ( Size[0] != this->numX ) || ( Size[1] != this->numY ) )
+      reallocate ( Size[0], Size[1] );
+    file.read ( this->getData(), aol::Vec3<int> ( Begin[0], Begin[1], 0 ), aol::Vec3<int> ( Size[0], Size[1], 1 ) );
+  } else {
+    load ( fileName );
+    crop ( Begin, Size );
+  }
+}
+
 // code for loadPNG and savePNG based on libpng.txt from libpng-1.2.12
 template <typename _DataType>
 void qc::ScalarArray<_DataType, qc::QC_2D>::loadPNG ( const char *fileName ) {
@@ -580,6 +675,72 @@ void qc::ScalarArray<_DataType, qc::QC_2D>::savePNG ( const char *fileName ) con
 #endif //USE_LIB_PNG
 }
 
+namespace {
+
+void writeTIFFIFDEntry ( ostream &Out, const uint16_t Tag, const uint16_t Type, const uint32_t Count, const uint32_t Value ) {
+  aol::writebinary<uint16_t> ( Out, Tag );
+  aol::writebinary<uint16_t> ( Out, Type );
+  aol::writebinary<uint32_t> ( Out, Count );
+  // Values of type SHORT are left-justified in the four byte value field.
+  if ( Type == 3 ) {
+    aol::writebinary<uint16_t> ( Out, static_cast<uint16_t> ( Value ) );
+    aol::writebinary<uint16_t> ( Out, 0 );
+  }
+  else
+    aol::writebinary<uint32_t> ( Out, Value );
+}
+
+} // end of nameless namespace
+
+template <typename _DataType>
+void qc::ScalarArray<_DataType, qc::QC_2D>::saveTIFF ( const char *fileName ) const {
+  std::ofstream out ( fileName, ios::binary );
+  if ( out.good() == false )
+    throw aol::FileException ( aol::strprintf ( "qc::ScalarArray<DataType, qc::QC_2D>::saveTIFF: Cannot open \"%s\" for writing", fileName ).c_str(), __FILE__, __LINE__ );
+
+  const uint32_t numX = this->getNumX();
+  const uint32_t numY = this->getNumY();
+  const uint32_t stripByteCount = numX * numY * sizeof ( float );
+  const uint16_t numEntries = 13;
+  // Header (8 bytes), followed by the IFD, the resolution rationals and finally the pixel data.
+  const uint32_t ifdOffset = 8;
+  const uint32_t resolutionOffset = ifdOffset + 2 + 12 * numEntries + 4;
+  const uint32_t dataOffset = resolutionOffset + 8;
+
+  // The data is written in native byte order, the header tells readers which one that is.
+  const uint16_t endianTest = 1;
+  const bool littleEndian = ( *reinterpret_cast<const unsigned char*> ( &endianTest ) == 1 );
+  out.write ( littleEndian ? "II" : "MM", 2 );
+  aol::writebinary<uint16_t> ( out, 42 );
+  aol::writebinary<uint32_t> ( out, ifdOffset );
+
+  // The entries have to be sorted by tag.
+  aol::writebinary<uint16_t> ( out, numEntries );
+  writeTIFFIFDEntry ( out, 256, 4, 1, numX );              // ImageWidth
+  writeTIFFIFDEntry ( out, 257, 4, 1, numY );              // ImageLength
+  writeTIFFIFDEntry ( out, 258, 3, 1, 32 );                // BitsPerSample
+  writeTIFFIFDEntry ( out, 259, 3, 1, 1 );                 // Compression: none
+  writeTIFFIFDEntry ( out, 262, 3, 1, 1 );                 // PhotometricInterpretation: BlackIsZero
+  writeTIFFIFDEntry ( out, 273, 4, 1, dataOffset );        // StripOffsets
+  writeTIFFIFDEntry ( out, 277, 3, 1, 1 );                 // SamplesPerPixel
+  writeTIFFIFDEntry ( out, 278, 4, 1, numY );              // RowsPerStrip
+  writeTIFFIFDEntry ( out, 279, 4, 1, stripByteCount );    // StripByteCounts
+  writeTIFFIFDEntry ( out, 282, 5, 1, resolutionOffset );  // XResolution
+  writeTIFFIFDEntry ( out, 283, 5, 1, resolutionOffset );  // YResolution
+  writeTIFFIFDEntry ( out, 296, 3, 1, 1 );                 // ResolutionUnit: none
+  writeTIFFIFDEntry ( out, 339, 3, 1, 3 );                 // SampleFormat: IEEE floating point
+  aol::writebinary<uint32_t> ( out, 0 );                   // no further IFD
+
+  // Resolution 1/1, shared by XResolution and YResolution.
+  aol::writebinary<uint32_t> ( out, 1 );
+  aol::writebinary<uint32_t> ( out, 1 );
+
+  aol::writeBinaryData<DataType, float> ( this->getData(), this->size(), out );
+
+  if ( out.good() == false )
+    throw aol::IOException ( aol::strprintf ( "qc::ScalarArray<DataType, qc::QC_2D>::saveTIFF: Error writing to \"%s\"", fileName ).c_str(), __FILE__, __LINE__ );
+}
+
 template <typename _DataType>
 void qc::ScalarArray<_DataType, qc::QC_2D>::loadDM3 ( const char *FileName ) {
   qc::DM3Reader dmreader( FileName );
@@ -994,7 +1155,7 @@ void qc::ScalarArray < _DataType, qc::QC_3D >::save ( ostream &out, qc::SaveType
     throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_3D>::save: impossible with type PNG_2D", __FILE__, __LINE__ );
 
   if ( !comment ) {
-    sprintf ( info, "# This is a QuOcMesh file of type %d (=%s) written %s", type, FILE_TYPE[type], aol::generateCurrentTimeAndDateString().c_str() );
+    sprintf ( info, "# This is a QuOcMesh file of type %d (=%s) written %s", type, getFileTypeName ( type ), aol::generateCurrentTimeAndDateString().c_str() );
     comment = info;
   }
 
@@ -1004,11 +1165,7 @@ void qc::ScalarArray < _DataType, qc::QC_3D >::save ( ostream &out, qc::SaveType
     info[strlen ( comment ) ] = 0;
   }
 
-  out << "Q";
-  if ( type == 10 )
-    out << "a";
-  else
-    out << type;
+  out << "Q" << getMagicNumberString ( type );
   out << "\n"
       <<  comment << "\n" << this->numX << " " << this->numY << " " << this->numZ;
 
@@ -1023,6 +1180,9 @@ void qc::ScalarArray < _DataType, qc::QC_3D >::save ( ostream &out, qc::SaveType
     case PGM_FLOAT_BINARY:
     case PGM_DOUBLE_BINARY:
     case PGM_UNSIGNED_SHORT_BINARY:
+    case PGM_SHORT_BINARY:
+    case PGM_UNSIGNED_INT_BINARY:
+    case PGM_SIGNED_INT_BINARY:
       out << std::endl << static_cast<int> ( maximum ) << std::endl;
       break;
     default:
@@ -1197,16 +1357,27 @@ void qc::ScalarArray<_DataType, qc::QC_3D>::save ( const char *fileName,
   if ( type == PNG_2D )
     throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_3D>::save: impossible with type PNG_2D", __FILE__, __LINE__ );
 
+  if ( TiledArrayFile::isTiledType ( type ) ) {
+    if ( !TiledArrayFile::hasTiledSuffix ( fileName ) )
+      throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_3D>::save: Tiled array files need the suffix .qtz", __FILE__, __LINE__ );
+    TiledArrayFile::write ( fileName, this->getData(), 3, aol::Vec3<int> ( this->numX, this->numY, this->numZ ), type, comment );
+    if ( !this->quietMode ) cerr << "done.\n";
+    return;
+  }
+
   if ( type != PGM_UNSIGNED_CHAR_ASCII &&
        type != PGM_UNSIGNED_CHAR_BINARY &&
        type != PGM_FLOAT_ASCII &&
        type != PGM_FLOAT_BINARY &&
        type != PGM_DOUBLE_BINARY &&
-       type != PGM_UNSIGNED_SHORT_BINARY  )
+       type != PGM_UNSIGNED_SHORT_BINARY &&
+       type != PGM_SHORT_BINARY &&
+       type != PGM_UNSIGNED_INT_BINARY &&
+       type != PGM_SIGNED_INT_BINARY )
     throw aol::Exception ( "qc::ScalarArray<DataType, qc::QC_3D>::save: Unknown SaveType",
                            __FILE__, __LINE__ );
 
-  aol::Bzipofstream *out = new aol::Bzipofstream ( fileName );
+  aol::Bzipofstream *out = new aol::Bzipofstream ( fileName, aol::Bzipofstream::DefaultCompressionLevel, 0 );
 
   if ( !out->good() ) {
     delete out;
@@ -1223,63 +1394,47 @@ void qc::ScalarArray<_DataType, qc::QC_3D>::save ( const char *fileName,
 //-----------------------------------------------------------------------------------------------------
 template < typename _DataType >
 void qc::ScalarArray<_DataType, qc::QC_3D>::load ( istream &in ) {
-  char tmp[256];
   int  type, inWidth, inHeight, inDepth, inMaxColor;
 
   if ( !in ) {
     throw aol::Exception ( "qc::ScalarArray<DataType, qc::QC_3D>::load: instream not open. ", __FILE__, __LINE__ );
   };
 
+  readHeader ( in, type, inWidth, inHeight, inDepth, inMaxColor );
+
+  if ( !this->quietMode ) cerr << "\twidth = " << inWidth << endl
+                                 << "\theight = " << inHeight << endl
+                                 << "\tdepth = " << inDepth << endl
+                                 << "\tmaxColor = " << inMaxColor << endl;
+
+  if ( !this->quietMode ) cerr << this->getNumX() << " " << this->getNumY() << " " << this->getNumZ() << endl;
+
+  this->loadRaw ( in, type, inWidth, inHeight, inDepth );
+}
+
+template < typename _DataType >
+void qc::ScalarArray<_DataType, qc::QC_3D>::readHeader ( istream &in, int &Type, int &Width, int &Height, int &Depth, int &MaxColor ) {
+  char tmp[256];
+
   in.get ( tmp, 255, '\n' );
   if ( tmp[0] != 'Q' ) {
     cerr << "first two bytes: " << tmp[0] << tmp[1] << endl;
     throw aol::Exception ( "qc::ScalarArray<DataType, qc::QC_3D>::load: wrong file format", __FILE__, __LINE__ );
   }
 
-  switch ( tmp[1] ) {
-    case '2':
-      type = PGM_UNSIGNED_CHAR_ASCII;
-      break;
-    case '5':
-      type = PGM_UNSIGNED_CHAR_BINARY;
-      break;
-    case '7':
-      type = PGM_FLOAT_ASCII;
-      break;
-    case '8':
-      type = PGM_FLOAT_BINARY;
-      break;
-    case '9':
-      type = PGM_DOUBLE_BINARY;
-      break;
-    case 'a':
-      type = PGM_UNSIGNED_SHORT_BINARY;
-      break;
-    case 'b':
-      type = PGM_SHORT_BINARY;
-      break;
-    default:
-      throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_3D>::load: wrong magic number", __FILE__, __LINE__ );
-  }
+  Type = getSaveTypeFromMagicNumber ( tmp + 1 );
+  if ( Type < 0 )
+    throw aol::TypeException ( "qc::ScalarArray<DataType, qc::QC_3D>::load: wrong magic number", __FILE__, __LINE__ );
 
   aol::READ_COMMENTS ( in );
-  in >> inWidth;
+  in >> Width;
   aol::READ_COMMENTS ( in );
-  in >> inHeight;
+  in >> Height;
   aol::READ_COMMENTS ( in );
-  in >> inDepth;
+  in >> Depth;
   aol::READ_COMMENTS ( in );
-  in >> inMaxColor;
+  in >> MaxColor;
   in.ignore();
-
-  if ( !this->quietMode ) cerr << "\twidth = " << inWidth << endl
-                                 << "\theight = " << inHeight << endl
-                                 << "\tdepth = " << inDepth << endl
-                                 << "\tmaxColor = " << inMaxColor << endl;
-
-  if ( !this->quietMode ) cerr << this->getNumX() << " " << this->getNumY() << " " << this->getNumZ() << endl;
-
-  this->loadRaw ( in, type, inWidth, inHeight, inDepth );
 }
 
 template < typename _DataType >
@@ -1304,12 +1459,32 @@ void qc::ScalarArray<_DataType, qc::QC_3D>::load ( const char *fileName ) {
 #endif
   if ( aol::fileNameEndsWith ( fileName, ".mrc" ) ) {
     loadMRC ( fileName );
+  } else if ( TiledArrayFile::hasTiledSuffix ( fileName ) ) {
+    const TiledArrayFile file ( fileName );
+    loadRegion ( fileName, aol::Vec3<int> ( 0, 0, 0 ), file.getSize() );
   } else {
-    aol::Bzipifstream in ( fileName );
+    // Decompression is done by aol::Bzipifstream based on filename extension, in parallel if the file consists of several bzip2 streams
+    aol::Bzipifstream in ( fileName, 0 );
     load ( in );
   }
 }
 
+template <typename _DataType>
+void qc::ScalarArray<_DataType, qc::QC_3D>::loadRegion ( const char *fileName, const aol::Vec3<int> &Begin, const aol::Vec3<int> &Size ) {
+  if ( TiledArrayFile::hasTiledSuffix ( fileName ) ) {
+    const TiledArrayFile file ( fileName );
+    if ( ( Size[0] != this->numX ) || ( Size[1] != this->numY ) || ( Size[2] != this->numZ ) )
+      reallocate ( Size[0], Size[1], Size[2] );
+    file.read ( this->getData(), Begin, Size );
+  } else {
+    ScalarArray<DataType, qc::QC_3D> copy;
+    copy.setQuietMode ( this->quietMode );
+    copy.load ( fileName );
+    reallocate ( Size[0], Size[1], Size[2] );
+    copy.copyBlockTo ( Begin, *this );
+  }
+}
+
 
 template < typename _DataType >
 typename qc::ScalarArray<_DataType, qc::QC_3D>::RealType
@@ -738,6 +738,15 @@ public:
    */
   void load ( istream &in );
 
+  /** Reads the header of an array in 2d pgm style format from in, i.e. everything in front of the
+   *  actual data, and returns the qc::SaveType of the data and the dimensions of the array.
+   *  @throws qcTypeException if the magic number is unknown
+   */
+  static void readHeader ( istream &in, int &Type, int &Width, int &Height );
+
+  //! Like readHeader above, additionally returns the max value stored in the header.
+  static void readHeader ( istream &in, int &Type, int &Width, int &Height, int &MaxColor );
+
   /** Load array in 2d pgm style format from the file named fileName. If the file contains
    *  compressed data in the bz2, gz or Z format, it will automatically be decompressed
    *  by a pipe stream that is passed to load(istream &in).
@@ -746,6 +755,12 @@ public:
    */
   void load ( const char *fileName );
 
+  /** Loads the rectangle of size Size starting at Begin of the array stored in the file named fileName.
+   *  For tiled array files (see qc::TiledArrayFile) only the tiles intersecting the rectangle are read and
+   *  decompressed, other files are loaded completely and cropped afterwards.
+   */
+  void loadRegion ( const char *fileName, const aol::Vec2<int> &Begin, const aol::Vec2<int> &Size );
+
   void loadRaw ( istream &in, const int Type, const int InWidth, const int InHeight );
 
   void loadPNG ( const char *fileName );
@@ -754,6 +769,10 @@ public:
 
   void savePNG ( const char *fileName ) const;
 
+  //! Save array as uncompressed, single strip TIFF with 32 bit floating point samples.
+  //! Does not need libtiff or cimg.
+  void saveTIFF ( const char *fileName ) const;
+
   //! Load array in the Digital Micrograph 3 file format.
   //! \author Berkels
   void loadDM3 ( const char *FileName );
@@ -1078,6 +1097,39 @@ public:
     copy.copyBlockTo ( CropStart, *this );
   }
 
+  /**
+   * Crops the rectangle of size CropSize starting at CropStart from Image and averages
+   * each BinSize x BinSize block of the cropped rectangle into one pixel of this array
+   * in a single pass. Rows and columns of the rectangle that do not fill a complete
+   * block are discarded. This array is reallocated to CropSize / BinSize.
+   */
+  void cropAndBinFrom ( const ScalarArray<DataType, qc::QC_2D> &Image, const aol::Vec<2, int> &CropStart, const aol::Vec<2, int> &CropSize, const int BinSize ) {
+    if ( BinSize < 1 )
+      throw aol::Exception ( "ScalarArray<QC_2D>::cropAndBinFrom(): BinSize has to be positive!\n", __FILE__, __LINE__ );
+    if ( ( CropStart[0] < 0 ) || ( CropStart[1] < 0 ) || ( CropSize[0] < 0 ) || ( CropSize[1] < 0 )
+         || ( CropStart[0] + CropSize[0] > Image.getNumX() ) || ( CropStart[1] + CropSize[1] > Image.getNumY() ) )
+      throw aol::Exception ( "ScalarArray<QC_2D>::cropAndBinFrom(): Crop rectangle does not fit into the image!\n", __FILE__, __LINE__ );
+
+    const int numX = CropSize[0] / BinSize;
+    const int numY = CropSize[1] / BinSize;
+    this->reallocate ( numX, numY );
+
+    // Sum up whole input rows at once so that the input is traversed in memory order.
+    aol::Vector<RealType> rowSums ( numX );
+    const RealType scale = aol::ZOTrait<RealType>::one / aol::Sqr ( static_cast<RealType> ( BinSize ) );
+    for ( int y = 0; y < numY; ++y ) {
+      rowSums.setZero();
+      for ( int j = 0; j < BinSize; ++j ) {
+        const DataType *inputRow = Image.getRowDataPointer ( CropStart[1] + y * BinSize + j ) + CropStart[0];
+        for ( int x = 0; x < numX; ++x )
+          for ( int i = 0; i < BinSize; ++i )
+            rowSums[x] += static_cast<RealType> ( inputRow[x * BinSize + i] );
+      }
+      for ( int x = 0; x < numX; ++x )
+        this->set ( x, y, static_cast<DataType> ( scale * rowSums[x] ) );
+    }
+  }
+
   /**
    * \author Berkels
    */
@@ -2182,6 +2234,13 @@ public:
      */
   void load ( istream &in );
 
+  /** Reads the header of an array in 3d pgm style format from in, i.e. everything in front of the
+   *  actual data, and returns the qc::SaveType of the data, the dimensions of the array and the
+   *  max value stored in the header.
+   *  @throws qcTypeException if the magic number is unknown
+   */
+  static void readHeader ( istream &in, int &Type, int &Width, int &Height, int &Depth, int &MaxColor );
+
   void loadRaw ( istream &in, const int Type, const int InWidth, const int InHeight, const int InDepth );
 
   /** Load array in the standard 2d pgm style format from the file named fileName. If the file contains
@@ -2192,6 +2251,11 @@ public:
    */
   void load ( const char *fileName );
 
+  /** Loads the box of size Size starting at Begin of the array stored in the file named fileName.
+   *  For tiled array files (see qc::TiledArrayFile) only the tiles intersecting the box are read and
+   *  decompressed, other files are loaded completely and cropped afterwards.
+   */
+  void loadRegion ( const char *fileName, const aol::Vec3<int> &Begin, const aol::Vec3<int> &Size );
 
   /** Load array in 2d pgm style format from the files indicated by fileNameMask
    *  by calling the ScalarArray<QC_2D>::load function for each slice. The slices will be
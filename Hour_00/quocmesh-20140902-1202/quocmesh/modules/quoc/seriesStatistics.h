@@ -0,0 +1,192 @@
+#ifndef __SERIESSTATISTICS_H
+#define __SERIESSTATISTICS_H
+
+#include <aol.h>
+#include <vec.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace qc {
+
+/**
+ * \brief Pixelwise mean, variance and median of a series of images that are added one frame at a time.
+ *
+ * Only the running sums needed for mean and variance are kept in memory. The samples needed for the median are
+ * written to a scratch file, ordered by tiles of TileSize consecutive pixels: The block of a tile holds the values
+ * of its pixels in all frames, frame by frame. Thus, the median of a tile only needs to read one contiguous block
+ * and the memory needed to compute the median is limited by MaxBlockBytes per thread, independently of the size
+ * of the series. The tiles are processed in parallel (if compiled with OpenMP) and the median of each pixel is
+ * found with std::nth_element instead of sorting.
+ *
+ * Samples equal to aol::NumberTrait<RealType>::Inf are treated as missing (e.g. pixels deformed out of the domain),
+ * pixels without samples get the value FillValue in the getters. The statistics can be queried after adding any
+ * number of frames, e.g. to save intermediate results.
+ *
+ * \author Berkels
+ */
+template <typename RealType>
+class SeriesStatistics {
+  const int _numPixels;
+  const int _maxNumFrames;
+  int _tileSize;
+  int _numFrames;
+  aol::Vector<RealType> _sum;
+  aol::Vector<RealType> _sumOfSquaredDeviations;
+  aol::Vector<int> _numSamples;
+  const string _scratchFileName;
+  std::fstream _scratchFile;
+
+  SeriesStatistics ( const SeriesStatistics<RealType> &other );
+  SeriesStatistics<RealType>& operator= ( const SeriesStatistics<RealType> &other );
+
+public:
+  /**
+   * NumPixels is the size of the frames, MaxNumFrames the maximal number of frames that will be added. The samples
+   * are stored in ScratchFileName, which is deleted again by the destructor, or by the constructor if it fails.
+   *
+   * \attention The scratch file grows to NumPixels * MaxNumFrames * sizeof(RealType) bytes, e.g. about 53 GB for
+   *            400 frames with 4096^2 pixels in double precision.
+   */
+  SeriesStatistics ( const int NumPixels, const int MaxNumFrames, const string &ScratchFileName, const int64_t MaxBlockBytes = ( 32 << 20 ) )
+  try
+    : _numPixels ( NumPixels ),
+      _maxNumFrames ( MaxNumFrames ),
+      _tileSize ( aol::Clamp<int64_t> ( MaxBlockBytes / ( static_cast<int64_t> ( aol::Max ( MaxNumFrames, 1 ) ) * sizeof ( RealType ) ), 1, aol::Max ( NumPixels, 1 ) ) ),
+      _numFrames ( 0 ),
+      _sum ( NumPixels ),
+      _sumOfSquaredDeviations ( NumPixels ),
+      _numSamples ( NumPixels ),
+      _scratchFileName ( ScratchFileName ),
+      _scratchFile ( ScratchFileName.c_str(), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary ) {
+    if ( _scratchFile.good() == false )
+      throw aol::FileException ( aol::strprintf ( "qc::SeriesStatistics: Cannot open scratch file \"%s\"", ScratchFileName.c_str() ).c_str(), __FILE__, __LINE__ );
+  }
+  catch ( ... ) {
+    // The destructor is not called if the constructor fails, so the scratch file has to be removed here.
+    remove ( ScratchFileName.c_str() );
+    throw;
+  }
+
+  ~SeriesStatistics () {
+    _scratchFile.close();
+    remove ( _scratchFileName.c_str() );
+  }
+
+  int getNumFrames () const {
+    return _numFrames;
+  }
+
+  int getTileSize () const {
+    return _tileSize;
+  }
+
+  //! Adds the next frame of the series.
+  void addFrame ( const aol::Vector<RealType> &Frame ) {
+    if ( Frame.size() != _numPixels )
+      throw aol::Exception ( "qc::SeriesStatistics::addFrame: Frame has the wrong size", __FILE__, __LINE__ );
+    if ( _numFrames >= _maxNumFrames )
+      throw aol::Exception ( aol::strprintf ( "qc::SeriesStatistics::addFrame: Only space for %d frames", _maxNumFrames ).c_str(), __FILE__, __LINE__ );
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for ( int j = 0; j < _numPixels; ++j ) {
+      const RealType value = Frame[j];
+      if ( value != aol::NumberTrait<RealType>::Inf ) {
+        // Welford's update, using the mean before and after adding value.
+        const RealType oldMean = ( _numSamples[j] > 0 ) ? ( _sum[j] / _numSamples[j] ) : value;
+        _sum[j] += value;
+        ++_numSamples[j];
+        _sumOfSquaredDeviations[j] += ( value - oldMean ) * ( value - _sum[j] / _numSamples[j] );
+      }
+    }
+
+    for ( int tileStart = 0; tileStart < _numPixels; tileStart += _tileSize ) {
+      const int tileSize = aol::Min ( _tileSize, _numPixels - tileStart );
+      _scratchFile.seekp ( getBlockOffset ( tileStart ) + static_cast<int64_t> ( _numFrames ) * tileSize * sizeof ( RealType ) );
+      _scratchFile.write ( reinterpret_cast<const char*> ( Frame.getData() + tileStart ), tileSize * sizeof ( RealType ) );
+    }
+    _scratchFile.flush();
+    if ( _scratchFile.fail() )
+      throw aol::IOException ( aol::strprintf ( "qc::SeriesStatistics::addFrame: Writing to \"%s\" failed", _scratchFileName.c_str() ).c_str(), __FILE__, __LINE__ );
+    ++_numFrames;
+  }
+
+  void getNumSamples ( aol::Vector<RealType> &NumSamples ) const {
+    for ( int j = 0; j < _numPixels; ++j )
+      NumSamples[j] = _numSamples[j];
+  }
+
+  void getMean ( aol::Vector<RealType> &Mean, const RealType FillValue = 0 ) const {
+    for ( int j = 0; j < _numPixels; ++j )
+      Mean[j] = ( _numSamples[j] > 0 ) ? ( _sum[j] / _numSamples[j] ) : FillValue;
+  }
+
+  //! Sample variance (normalized by the number of samples minus one) of each pixel.
+  void getVariance ( aol::Vector<RealType> &Variance, const RealType FillValue = 0 ) const {
+    for ( int j = 0; j < _numPixels; ++j )
+      Variance[j] = ( _numSamples[j] > 1 ) ? ( _sumOfSquaredDeviations[j] / ( _numSamples[j] - 1 ) ) : ( ( _numSamples[j] == 1 ) ? 0 : FillValue );
+  }
+
+  //! Median of the samples of each pixel, the mean of the two middle samples if their number is even.
+  void getMedian ( aol::Vector<RealType> &Median, const RealType FillValue = 0 ) const {
+    if ( _numFrames == 0 ) {
+      Median.setAll ( FillValue );
+      return;
+    }
+
+    int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel reduction ( + : numFailed )
+#endif
+    {
+      std::ifstream in ( _scratchFileName.c_str(), std::ios::binary );
+      std::vector<RealType> block ( static_cast<size_t> ( _tileSize ) * _numFrames );
+      std::vector<RealType> samples ( _numFrames );
+#ifdef _OPENMP
+#pragma omp for schedule ( dynamic )
+#endif
+      for ( int tileStart = 0; tileStart < _numPixels; tileStart += _tileSize ) {
+        const int tileSize = aol::Min ( _tileSize, _numPixels - tileStart );
+        in.seekg ( getBlockOffset ( tileStart ) );
+        in.read ( reinterpret_cast<char*> ( &block[0] ), static_cast<std::streamsize> ( tileSize ) * _numFrames * sizeof ( RealType ) );
+        if ( in.fail() ) {
+          ++numFailed;
+          continue;
+        }
+        for ( int j = 0; j < tileSize; ++j ) {
+          int numSamples = 0;
+          for ( int i = 0; i < _numFrames; ++i ) {
+            const RealType value = block[i * tileSize + j];
+            if ( value != aol::NumberTrait<RealType>::Inf )
+              samples[numSamples++] = value;
+          }
+          Median[tileStart + j] = ( numSamples > 0 ) ? getMedianOfSamples ( samples, numSamples ) : FillValue;
+        }
+      }
+    }
+    if ( numFailed > 0 )
+      throw aol::IOException ( aol::strprintf ( "qc::SeriesStatistics::getMedian: Reading %d tiles from \"%s\" failed", numFailed, _scratchFileName.c_str() ).c_str(), __FILE__, __LINE__ );
+  }
+
+private:
+  int64_t getBlockOffset ( const int TileStart ) const {
+    return static_cast<int64_t> ( TileStart ) * _maxNumFrames * sizeof ( RealType );
+  }
+
+  //! Same result as aol::Vector::getMedianValue on the first NumSamples entries of Samples (which are reordered).
+  static RealType getMedianOfSamples ( std::vector<RealType> &Samples, const int NumSamples ) {
+    const typename std::vector<RealType>::iterator middle = Samples.begin() + NumSamples / 2;
+    std::nth_element ( Samples.begin(), middle, Samples.begin() + NumSamples );
+    if ( NumSamples % 2 == 1 )
+      return *middle;
+    // nth_element leaves the smaller values in front of middle, the largest of them is the other middle value.
+    return ( *std::max_element ( Samples.begin(), middle ) + *middle ) / 2;
+  }
+};
+
+} // end namespace qc
+
+#endif // __SERIESSTATISTICS_H
@@ -0,0 +1,302 @@
+#include <tiledArrayFile.h>
+#include <mappedScalarArray.h>
+
+#ifdef USE_LIB_Z
+#include <zlib.h>
+#endif
+
+namespace qc {
+
+namespace {
+
+#ifdef USE_LIB_Z
+//! Start and size of tile number TileIndex, clipped to the array.
+void getTileBox ( const int TileIndex, const aol::Vec3<int> &Size, const aol::Vec3<int> &TileSize, const aol::Vec3<int> &NumTiles,
+                  aol::Vec3<int> &TileBegin, aol::Vec3<int> &TileExtent ) {
+  TileBegin[0] = ( TileIndex % NumTiles[0] ) * TileSize[0];
+  TileBegin[1] = ( ( TileIndex / NumTiles[0] ) % NumTiles[1] ) * TileSize[1];
+  TileBegin[2] = ( TileIndex / ( NumTiles[0] * NumTiles[1] ) ) * TileSize[2];
+  for ( int i = 0; i < 3; ++i )
+    TileExtent[i] = aol::Min ( TileSize[i], Size[i] - TileBegin[i] );
+}
+
+inline void convertToStoredType ( const double Value, float &Stored ) {
+  Stored = static_cast<float> ( Value );
+}
+
+inline void convertToStoredType ( const double Value, unsigned short &Stored ) {
+  Stored = static_cast<unsigned short> ( aol::Clamp ( floor ( Value + 0.5 ), 0., 65535. ) );
+}
+
+template <typename DataType, typename StoredType>
+bool compressTile ( const DataType *Data, const aol::Vec3<int> &Size, const aol::Vec3<int> &TileBegin, const aol::Vec3<int> &TileExtent,
+                    std::vector<char> &Compressed ) {
+  std::vector<StoredType> buffer ( static_cast<size_t> ( TileExtent[0] ) * TileExtent[1] * TileExtent[2] );
+  size_t index = 0;
+  for ( int z = TileBegin[2]; z < TileBegin[2] + TileExtent[2]; ++z ) {
+    for ( int y = TileBegin[1]; y < TileBegin[1] + TileExtent[1]; ++y ) {
+      const DataType *row = Data + ( static_cast<size_t> ( z ) * Size[1] + y ) * Size[0];
+      for ( int x = TileBegin[0]; x < TileBegin[0] + TileExtent[0]; ++x )
+        convertToStoredType ( static_cast<double> ( row[x] ), buffer[index++] );
+    }
+  }
+
+  const uLong bufferSize = static_cast<uLong> ( buffer.size() * sizeof ( StoredType ) );
+  uLongf compressedSize = compressBound ( bufferSize );
+  Compressed.resize ( compressedSize );
+  if ( compress2 ( reinterpret_cast<Bytef*> ( &Compressed[0] ), &compressedSize, reinterpret_cast<const Bytef*> ( &buffer[0] ), bufferSize, Z_BEST_SPEED ) != Z_OK )
+    return false;
+  Compressed.resize ( compressedSize );
+  return true;
+}
+
+template <typename DataType, typename StoredType>
+void writeTiles ( std::ostream &Out, const DataType *Data, const aol::Vec3<int> &Size, const aol::Vec3<int> &TileSize, const aol::Vec3<int> &NumTiles,
+                  std::vector<uint64_t> &Offsets, const int NumThreads ) {
+  const int numTiles = static_cast<int> ( Offsets.size() ) - 1;
+  // Only a few tiles per thread are kept in memory at once.
+  const int batchSize = 4 * NumThreads;
+  std::vector<std::vector<char> > compressedTiles ( batchSize );
+  Offsets[0] = 0;
+  for ( int batchBegin = 0; batchBegin < numTiles; batchBegin += batchSize ) {
+    const int batchEnd = aol::Min ( numTiles, batchBegin + batchSize );
+    int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( NumThreads ) reduction ( + : numFailed )
+#endif
+    for ( int t = batchBegin; t < batchEnd; ++t ) {
+      aol::Vec3<int> tileBegin, tileExtent;
+      getTileBox ( t, Size, TileSize, NumTiles, tileBegin, tileExtent );
+      if ( !compressTile<DataType, StoredType> ( Data, Size, tileBegin, tileExtent, compressedTiles[t - batchBegin] ) )
+        ++numFailed;
+    }
+    if ( numFailed > 0 )
+      throw aol::Exception ( "qc::TiledArrayFile::write: zlib compression failed", __FILE__, __LINE__ );
+
+    for ( int t = batchBegin; t < batchEnd; ++t ) {
+      const std::vector<char> &compressed = compressedTiles[t - batchBegin];
+      Out.write ( &compressed[0], compressed.size() );
+      Offsets[t + 1] = Offsets[t] + compressed.size();
+    }
+  }
+}
+
+template <typename DataType, typename StoredType>
+void readTiles ( DataType *Dest, const aol::Vec3<int> &Begin, const aol::Vec3<int> &ROISize, const char *TileData, const std::vector<uint64_t> &Offsets,
+                 const aol::Vec3<int> &Size, const aol::Vec3<int> &TileSize, const aol::Vec3<int> &NumTiles, const int NumThreads ) {
+#ifndef _OPENMP
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+#endif
+  // Collect the tiles intersecting the box.
+  aol::Vec3<int> firstTile, lastTile;
+  for ( int i = 0; i < 3; ++i ) {
+    firstTile[i] = Begin[i] / TileSize[i];
+    lastTile[i] = ( Begin[i] + ROISize[i] - 1 ) / TileSize[i];
+  }
+  std::vector<int> tiles;
+  for ( int z = firstTile[2]; z <= lastTile[2]; ++z )
+    for ( int y = firstTile[1]; y <= lastTile[1]; ++y )
+      for ( int x = firstTile[0]; x <= lastTile[0]; ++x )
+        tiles.push_back ( ( z * NumTiles[1] + y ) * NumTiles[0] + x );
+
+  const int numTiles = static_cast<int> ( tiles.size() );
+  int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( NumThreads ) reduction ( + : numFailed )
+#endif
+  for ( int i = 0; i < numTiles; ++i ) {
+    const int t = tiles[i];
+    aol::Vec3<int> tileBegin, tileExtent;
+    getTileBox ( t, Size, TileSize, NumTiles, tileBegin, tileExtent );
+
+    std::vector<StoredType> buffer ( static_cast<size_t> ( tileExtent[0] ) * tileExtent[1] * tileExtent[2] );
+    uLongf bufferSize = static_cast<uLongf> ( buffer.size() * sizeof ( StoredType ) );
+    const uLongf expectedSize = bufferSize;
+    if ( ( uncompress ( reinterpret_cast<Bytef*> ( &buffer[0] ), &bufferSize, reinterpret_cast<const Bytef*> ( TileData + Offsets[t] ),
+                        static_cast<uLong> ( Offsets[t + 1] - Offsets[t] ) ) != Z_OK ) || ( bufferSize != expectedSize ) ) {
+      ++numFailed;
+      continue;
+    }
+
+    // Copy the intersection of tile and box.
+    aol::Vec3<int> copyBegin, copyEnd;
+    for ( int j = 0; j < 3; ++j ) {
+      copyBegin[j] = aol::Max ( tileBegin[j], Begin[j] );
+      copyEnd[j] = aol::Min ( tileBegin[j] + tileExtent[j], Begin[j] + ROISize[j] );
+    }
+    for ( int z = copyBegin[2]; z < copyEnd[2]; ++z ) {
+      for ( int y = copyBegin[1]; y < copyEnd[1]; ++y ) {
+        const StoredType *source = &buffer[0] + ( static_cast<size_t> ( z - tileBegin[2] ) * tileExtent[1] + ( y - tileBegin[1] ) ) * tileExtent[0] + ( copyBegin[0] - tileBegin[0] );
+        DataType *dest = Dest + ( static_cast<size_t> ( z - Begin[2] ) * ROISize[1] + ( y - Begin[1] ) ) * ROISize[0] + ( copyBegin[0] - Begin[0] );
+        for ( int x = 0; x < copyEnd[0] - copyBegin[0]; ++x )
+          dest[x] = static_cast<DataType> ( source[x] );
+      }
+    }
+  }
+  if ( numFailed > 0 )
+    throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile::read: %d tiles are corrupt", numFailed ).c_str(), __FILE__, __LINE__ );
+}
+#endif
+
+}
+
+TiledArrayFile::TiledArrayFile ( const char *FileName )
+  : _file ( NULL ),
+    _dim ( 0 ),
+    _type ( qc::TILED_FLOAT_BINARY ),
+    _tileData ( NULL ) {
+  _file = new aol::MemoryMappedFile ( FileName );
+  try {
+    MemoryStreambuf streambuf ( _file->getData(), _file->getSize() );
+    std::istream in ( &streambuf );
+
+    char magic[3] = { 0, 0, 0 };
+    in.read ( magic, 3 );
+    if ( in.fail() || ( magic[0] != 'Q' ) || ( magic[1] != 'T' ) || ( ( magic[2] != '2' ) && ( magic[2] != '3' ) ) )
+      throw aol::TypeException ( aol::strprintf ( "qc::TiledArrayFile: \"%s\" is not a tiled array file", FileName ).c_str(), __FILE__, __LINE__ );
+    _dim = magic[2] - '0';
+
+    int type = 0;
+    aol::READ_COMMENTS ( in );
+    in >> _size[0] >> _size[1] >> _size[2];
+    aol::READ_COMMENTS ( in );
+    in >> _tileSize[0] >> _tileSize[1] >> _tileSize[2];
+    aol::READ_COMMENTS ( in );
+    in >> type;
+    in.ignore();
+    if ( in.fail() )
+      throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile: Could not read the header of \"%s\"", FileName ).c_str(), __FILE__, __LINE__ );
+    _type = static_cast<qc::SaveType> ( type );
+    if ( !isTiledType ( _type ) )
+      throw aol::TypeException ( aol::strprintf ( "qc::TiledArrayFile: \"%s\" has an unknown type", FileName ).c_str(), __FILE__, __LINE__ );
+
+    for ( int i = 0; i < 3; ++i ) {
+      if ( ( _size[i] < 0 ) || ( _tileSize[i] <= 0 ) )
+        throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile: \"%s\" has an invalid header", FileName ).c_str(), __FILE__, __LINE__ );
+      _numTiles[i] = ( _size[i] + _tileSize[i] - 1 ) / _tileSize[i];
+    }
+
+    const size_t offsetsBegin = static_cast<size_t> ( in.tellg() );
+    const size_t numTiles = static_cast<size_t> ( _numTiles[0] ) * _numTiles[1] * _numTiles[2];
+    const size_t tileDataBegin = offsetsBegin + ( numTiles + 1 ) * sizeof ( uint64_t );
+    if ( tileDataBegin > _file->getSize() )
+      throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile: \"%s\" is truncated", FileName ).c_str(), __FILE__, __LINE__ );
+    _offsets.resize ( numTiles + 1 );
+    memcpy ( &_offsets[0], _file->getData() + offsetsBegin, _offsets.size() * sizeof ( uint64_t ) );
+    _tileData = _file->getData() + tileDataBegin;
+
+    for ( size_t i = 0; i < numTiles; ++i )
+      if ( _offsets[i] > _offsets[i + 1] )
+        throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile: \"%s\" has an invalid tile index", FileName ).c_str(), __FILE__, __LINE__ );
+    if ( tileDataBegin + _offsets[numTiles] > _file->getSize() )
+      throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile: \"%s\" is truncated", FileName ).c_str(), __FILE__, __LINE__ );
+  } catch ( ... ) {
+    delete _file;
+    throw;
+  }
+}
+
+TiledArrayFile::~TiledArrayFile () {
+  delete _file;
+}
+
+template <typename DataType>
+void TiledArrayFile::read ( DataType *Dest, const aol::Vec3<int> &Begin, const aol::Vec3<int> &Size, const int NumThreads ) const {
+  for ( int i = 0; i < 3; ++i )
+    if ( ( Begin[i] < 0 ) || ( Size[i] < 0 ) || ( Begin[i] + Size[i] > _size[i] ) )
+      throw aol::Exception ( "qc::TiledArrayFile::read: The box does not fit into the array", __FILE__, __LINE__ );
+  if ( ( Size[0] == 0 ) || ( Size[1] == 0 ) || ( Size[2] == 0 ) )
+    return;
+
+#ifdef USE_LIB_Z
+  if ( _type == qc::TILED_FLOAT_BINARY )
+    readTiles<DataType, float> ( Dest, Begin, Size, _tileData, _offsets, _size, _tileSize, _numTiles, aol::getNumThreadsToUse ( NumThreads ) );
+  else
+    readTiles<DataType, unsigned short> ( Dest, Begin, Size, _tileData, _offsets, _size, _tileSize, _numTiles, aol::getNumThreadsToUse ( NumThreads ) );
+#else
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Dest );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+  throw aol::Exception ( "qc::TiledArrayFile::read: Compiled without zlib support!", __FILE__, __LINE__ );
+#endif
+}
+
+template <typename DataType>
+void TiledArrayFile::write ( const char *FileName, const DataType *Data, const int Dim, const aol::Vec3<int> &Size, const qc::SaveType Type,
+                             const char *Comment, const aol::Vec3<int> &TileSize, const int NumThreads ) {
+#ifdef USE_LIB_Z
+  if ( !isTiledType ( Type ) )
+    throw aol::TypeException ( "qc::TiledArrayFile::write: Unsupported SaveType", __FILE__, __LINE__ );
+  if ( ( Dim != 2 ) && ( Dim != 3 ) )
+    throw aol::Exception ( "qc::TiledArrayFile::write: Only 2D and 3D arrays are supported", __FILE__, __LINE__ );
+
+  aol::Vec3<int> tileSize, numTiles;
+  for ( int i = 0; i < 3; ++i ) {
+    if ( i >= Dim )
+      tileSize[i] = 1;
+    else if ( TileSize[i] > 0 )
+      tileSize[i] = TileSize[i];
+    else
+      tileSize[i] = ( Dim == 2 ) ? DefaultTileSize2D : DefaultTileSize3D;
+    numTiles[i] = ( Size[i] + tileSize[i] - 1 ) / tileSize[i];
+  }
+
+  std::ofstream out ( FileName, std::ios::out | std::ios::binary );
+  if ( !out.good() )
+    throw aol::FileException ( aol::strprintf ( "qc::TiledArrayFile::write: Cannot open \"%s\" for writing", FileName ).c_str(), __FILE__, __LINE__ );
+
+  out << "QT" << Dim << endl;
+  if ( Comment == NULL )
+    out << "# This is a QuOcMesh tiled array file of type " << Type << " written " << aol::generateCurrentTimeAndDateString();
+  else if ( Comment[0] != '#' )
+    out << "#" << Comment;
+  else
+    out << Comment;
+  out << endl << Size[0] << " " << Size[1] << " " << Size[2] << endl
+      << tileSize[0] << " " << tileSize[1] << " " << tileSize[2] << endl
+      << static_cast<int> ( Type ) << endl;
+
+  // The offsets are only known after compressing the tiles, reserve space for them now and fill it in later.
+  std::vector<uint64_t> offsets ( static_cast<size_t> ( numTiles[0] ) * numTiles[1] * numTiles[2] + 1, 0 );
+  const std::streampos offsetsPos = out.tellp();
+  out.write ( reinterpret_cast<const char*> ( &offsets[0] ), offsets.size() * sizeof ( uint64_t ) );
+
+  if ( Type == qc::TILED_FLOAT_BINARY )
+    writeTiles<DataType, float> ( out, Data, Size, tileSize, numTiles, offsets, aol::getNumThreadsToUse ( NumThreads ) );
+  else
+    writeTiles<DataType, unsigned short> ( out, Data, Size, tileSize, numTiles, offsets, aol::getNumThreadsToUse ( NumThreads ) );
+
+  out.seekp ( offsetsPos );
+  out.write ( reinterpret_cast<const char*> ( &offsets[0] ), offsets.size() * sizeof ( uint64_t ) );
+  out.close();
+  if ( out.fail() )
+    throw aol::IOException ( aol::strprintf ( "qc::TiledArrayFile::write: Error writing \"%s\". Is there enough free disk space?", FileName ).c_str(), __FILE__, __LINE__ );
+#else
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( FileName );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Data );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Dim );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Size );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Type );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( Comment );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( TileSize );
+  aol::doNothingWithArgumentToPreventUnusedParameterWarning ( NumThreads );
+  throw aol::Exception ( "qc::TiledArrayFile::write: Compiled without zlib support!", __FILE__, __LINE__ );
+#endif
+}
+
+#define INSTANTIATE_TILEDARRAYFILE( DataType ) \
+  template void TiledArrayFile::read<DataType> ( DataType*, const aol::Vec3<int>&, const aol::Vec3<int>&, const int ) const; \
+  template void TiledArrayFile::write<DataType> ( const char*, const DataType*, const int, const aol::Vec3<int>&, const qc::SaveType, const char*, const aol::Vec3<int>&, const int );
+
+INSTANTIATE_TILEDARRAYFILE ( signed char )
+INSTANTIATE_TILEDARRAYFILE ( unsigned char )
+INSTANTIATE_TILEDARRAYFILE ( short )
+INSTANTIATE_TILEDARRAYFILE ( unsigned short )
+INSTANTIATE_TILEDARRAYFILE ( int )
+INSTANTIATE_TILEDARRAYFILE ( unsigned int )
+INSTANTIATE_TILEDARRAYFILE ( float )
+INSTANTIATE_TILEDARRAYFILE ( double )
+INSTANTIATE_TILEDARRAYFILE ( long double )
+
+#undef INSTANTIATE_TILEDARRAYFILE
+
+}
@@ -0,0 +1,98 @@
+#ifndef __TILEDARRAYFILE_H
+#define __TILEDARRAYFILE_H
+
+#include <quoc.h>
+#include <smallVec.h>
+#include <platformDependent.h>
+
+namespace qc {
+
+/**
+ * \brief File format for 2D and 3D arrays that splits the array into fixed-size tiles and compresses
+ *        each tile independently with zlib.
+ *
+ * Since the tiles are independent, they are compressed and decompressed in parallel (if compiled with
+ * OpenMP) and a box of the array can be read by only decompressing the tiles intersecting it.
+ *
+ * The file starts with a text header similar to the pgm style formats
+ * \verbatim
+   QT<dim>
+   # comment
+   <numX> <numY> <numZ>
+   <tileX> <tileY> <tileZ>
+   <type>
+   \endverbatim
+ * where type is qc::TILED_FLOAT_BINARY or qc::TILED_UNSIGNED_SHORT_BINARY (for 2D arrays numZ and tileZ
+ * are 1). The header is followed by numTiles + 1 offsets (64 bit unsigned ints) of the compressed tiles
+ * relative to the end of the offset table and the compressed tiles themselves. The tiles are ordered with
+ * x running fastest, both inside the array and inside each tile. Tiles at the upper boundaries are clipped
+ * to the array.
+ *
+ * The file is memory mapped for reading, so it doesn't need to fit into memory.
+ *
+ * \author Berkels
+ */
+class TiledArrayFile {
+  aol::MemoryMappedFile *_file;
+  int _dim;
+  qc::SaveType _type;
+  aol::Vec3<int> _size, _tileSize, _numTiles;
+  std::vector<uint64_t> _offsets;
+  const char *_tileData;
+
+public:
+  static const int DefaultTileSize2D = 256;
+  static const int DefaultTileSize3D = 64;
+
+  //! Opens FileName and reads its header and tile offsets.
+  explicit TiledArrayFile ( const char *FileName );
+  ~TiledArrayFile ();
+
+  int getDim () const {
+    return _dim;
+  }
+
+  qc::SaveType getType () const {
+    return _type;
+  }
+
+  const aol::Vec3<int>& getSize () const {
+    return _size;
+  }
+
+  const aol::Vec3<int>& getTileSize () const {
+    return _tileSize;
+  }
+
+  /**
+   * Reads the box of size Size starting at Begin to Dest (x running fastest), decompressing only
+   * the tiles intersecting the box. NumThreads <= 0 uses as many threads as OpenMP provides (one thread inside a parallel region, see aol::getNumThreadsToUse).
+   */
+  template <typename DataType>
+  void read ( DataType *Dest, const aol::Vec3<int> &Begin, const aol::Vec3<int> &Size, const int NumThreads = 0 ) const;
+
+  /**
+   * Writes the Dim dimensional array of size Size stored in Data (x running fastest) to FileName.
+   * Type has to be qc::TILED_FLOAT_BINARY or qc::TILED_UNSIGNED_SHORT_BINARY. A TileSize component
+   * <= 0 selects the default tile size. NumThreads <= 0 uses as many threads as OpenMP provides (one thread inside a parallel region, see aol::getNumThreadsToUse).
+   */
+  template <typename DataType>
+  static void write ( const char *FileName, const DataType *Data, const int Dim, const aol::Vec3<int> &Size, const qc::SaveType Type,
+                      const char *Comment = NULL, const aol::Vec3<int> &TileSize = aol::Vec3<int> ( 0, 0, 0 ), const int NumThreads = 0 );
+
+  static bool isTiledType ( const qc::SaveType Type ) {
+    return ( Type == qc::TILED_FLOAT_BINARY ) || ( Type == qc::TILED_UNSIGNED_SHORT_BINARY );
+  }
+
+  static bool hasTiledSuffix ( const char *FileName ) {
+    return aol::fileNameEndsWith ( FileName, ".qtz" );
+  }
+
+private:
+  TiledArrayFile ( const TiledArrayFile& ); // do not implement
+  TiledArrayFile& operator= ( const TiledArrayFile& ); // do not implement
+};
+
+}
+
+#endif // __TILEDARRAYFILE_H
@@ -113,16 +113,33 @@ public:
   }
 };
 
+/**
+ * Usage: matchSeries [ParameterFile [Action [ShardIndex]]], where Action is a SeriesMatching::ACTION.
+ *
+ * To distribute the registrations over several nodes, run SeriesMatching::MATCH_SHARD_OF_SERIES for each
+ * ShardIndex from 0 to "numShards"-1 (all using the same save directory) and afterwards
+ * SeriesMatching::MERGE_SHARDS_AND_AVERAGE_SERIES once. The extra stages are only done by the latter.
+ */
 template <typename ConfiguratorType, typename RegistrationType>
 void matchSeries ( aol::ParameterParser &Parser, int argc, char **argv ) {
   typedef typename ConfiguratorType::RealType RealType;
+  typedef SeriesMatching<RegistrationType> SeriesMatchingType;
   const int numExtraStages = Parser.getInt ( "numExtraStages" );
   const RealType extraStageslambdaFactor = Parser.getDouble ( "extraStagesLambdaFactor" );
+  const typename SeriesMatchingType::ACTION actionType = ( argc > 2 ) ? static_cast<typename SeriesMatchingType::ACTION> ( atoi ( argv[2] ) ) : SeriesMatchingType::MATCH_AND_AVERAGE_SERIES;
+  if ( argc > 3 ) {
+    if ( Parser.hasVariable ( "shardIndex" ) )
+      Parser.changeVariableValue ( "shardIndex", argv[3] );
+    else
+      Parser.addVariable ( "shardIndex", argv[3] );
+  }
+  const bool matchShard = ( actionType == SeriesMatchingType::MATCH_SHARD_OF_SERIES );
 
   // This creates the save directory and dumps the paramters to a file in that dir.
   qc::DefaultArraySaver<RealType, ConfiguratorType::Dim> saver;
   saver.initFromParser ( Parser, true );
-  aol::AdditionalOutputToFile addOut ( saver.createSaveName ( "", ".txt", -1, "log" ).c_str() );
+  // Shards may run at the same time, so each one needs its own log.
+  aol::AdditionalOutputToFile addOut ( saver.createSaveName ( "", ".txt", -1, matchShard ? aol::strprintf ( "log_shard_%03d", Parser.getInt ( "shardIndex" ) ).c_str() : "log" ).c_str() );
 
   if ( Parser.hasVariable ( "templateNamePattern" ) ) {
     if ( Parser.hasVariable ( "reference" ) )
@@ -144,10 +161,12 @@ void matchSeries ( aol::ParameterParser &Parser, int argc, char **argv ) {
   aol::ParameterParser parserStage1 ( Parser );
   parserStage1.changeVariableValue ( "saveDirectory", ( string ( saver.getSaveDirectory() ) + "stage1/" ).c_str() );
 
-  SeriesMatching<RegistrationType> mldS1 ( parserStage1 );
-  const typename SeriesMatching<RegistrationType>::ACTION actionType = ( argc > 2 ) ? static_cast<typename SeriesMatching<RegistrationType>::ACTION> ( atoi ( argv[2] ) ) : SeriesMatching<RegistrationType>::MATCH_AND_AVERAGE_SERIES;
+  SeriesMatchingType mldS1 ( parserStage1 );
   if ( Parser.checkAndGetBool ( "skipStage1" ) == false )
     mldS1.doAction( actionType );
+  // The extra stages need the average of all shards.
+  if ( matchShard )
+    return;
   const string averageName = string ( Parser.checkAndGetBool ( "useMedianAsNewTarget" ) ? "median" : "average" ) + qc::getDefaultArraySuffix ( ConfiguratorType::Dim );
   string lastAverageFileName = string ( mldS1.getSaveDirectory() ) + averageName;
 
@@ -165,8 +184,9 @@ void matchSeries ( aol::ParameterParser &Parser, int argc, char **argv ) {
       parserStageN.changeVariableValue ( "reference", lastAverageFileName.c_str() );
       parserStageN.addVariable ( "stage", i+2 );
 
-      SeriesMatching<RegistrationType> mldSN ( parserStageN, Parser.checkAndGetBool ( "reuseStage1Results" ) );
-      mldSN.doAction( actionType );
+      SeriesMatchingType mldSN ( parserStageN, Parser.checkAndGetBool ( "reuseStage1Results" ) );
+      // The shards only cover stage one, the extra stages are done as usual.
+      mldSN.doAction( ( actionType == SeriesMatchingType::MERGE_SHARDS_AND_AVERAGE_SERIES ) ? SeriesMatchingType::MATCH_AND_AVERAGE_SERIES : actionType );
       lastAverageFileName = string ( mldSN.getSaveDirectory() ) + averageName;
     }
   }
@@ -236,6 +256,10 @@ int main( int argc, char **argv ) {
   catch ( aol::Exception &el ) {
     el.dump();
   }
+  // Also catch the standard exceptions, so that the stack is unwound and scratch files are removed.
+  catch ( std::exception &ex ) {
+    cerr << "std::exception: " << ex.what() << endl;
+  }
   aol::callSystemPauseIfNecessaryOnPlatform();
   return 0;
 }
@@ -2,8 +2,14 @@
 #define __MATCHSERIES_H
 
 #include <registration.h>
+#include <paramReg.h>
+#include <seriesStatistics.h>
 #include <dm3Import.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /**
  * \author Berkels
  */
@@ -22,12 +28,16 @@ class SeriesMatching {
   const bool _reduceDeformations;
   const bool _useAltStartLevel;
   const int _stage;
+  const bool _prealignWithPhaseCorrelation;
+  std::vector<aol::Vec<Dim, RealType> > _prealignTranslations;
 public:
   enum ACTION {
     MATCH_AND_AVERAGE_SERIES,
     ONLY_AVERAGE_SERIES,
     ANALYZE_DEFORMATTIONS,
-    APPLY_DEFORMATTION
+    APPLY_DEFORMATTION,
+    MATCH_SHARD_OF_SERIES,
+    MERGE_SHARDS_AND_AVERAGE_SERIES
   };
 
   SeriesMatching ( const aol::ParameterParser &Parser, const bool LoadStageOneResults = false )
@@ -36,7 +46,8 @@ public:
       _loadStageOneResults ( LoadStageOneResults ),
       _reduceDeformations ( _parser.checkAndGetBool ( "reduceDeformations" ) ),
       _useAltStartLevel ( _parser.hasVariable ( "altStartLevel" ) && ( _parser.getInt ( "altStartLevel" ) != _parser.getInt ( "startLevel" ) ) ),
-      _stage ( _parser.hasVariable ( "stage" ) ? _parser.getInt ( "stage" ) : 1 ) { }
+      _stage ( _parser.hasVariable ( "stage" ) ? _parser.getInt ( "stage" ) : 1 ),
+      _prealignWithPhaseCorrelation ( _parser.checkAndGetBool ( "prealignWithPhaseCorrelation" ) ) { }
 
   void createTemplateFileNameList ( std::vector<std::string> &FileNames ) const {
     std::set<int> skipNumsSet;
@@ -93,7 +104,341 @@ public:
     return ( createDeformationBaseFileName ( InputDirectory, DeformationNumber ) + _registrationAlgo.getDeformationFileNameSuffix() );
   }
 
-  void matchSeries ( ) {
+  //! Number of threads used to register the neighboring templates, parameter "numPairwiseThreads" (default 1,
+  //! values <= 0 use as many threads as OpenMP provides). Without OpenMP, this is always 1.
+  int getNumPairwiseThreads ( ) const {
+#ifdef _OPENMP
+    const int numThreads = _parser.getIntOrDefault ( "numPairwiseThreads", 1 );
+    return ( numThreads > 0 ) ? numThreads : omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  //! Initializes the transformation of Algo used as starting point when registering template I to its predecessor.
+  void initTransformationForPairing ( RegistrationType &Algo, const int I, const bool ReverseRoles ) const {
+    // In case we try to reduce the deformations, we have to adjust the initial deformation used
+    // for the first pairing.
+    if ( _reduceDeformations && ( ReverseRoles == false ) && ( I == 0 ) && ( _stage > 1 ) ) {
+      Algo.loadTransformation ( aol::strprintf ( "%s../stage%d/reduceDef_%%d.dat.bz2", _parser.getString ( "saveDirectory" ).c_str(), _stage - 1 ).c_str() );
+      // In Stage 3+, this needs to be combined with the deformation calculated in the previous stage.
+      if ( _stage > 2 ) {
+        TransformationDOFType reducedTransformation ( Algo.getTransformationDOFInitializer() );
+        Algo.getTransformation ( reducedTransformation );
+
+        Algo.loadTransformation ( aol::strprintf ( "%s../stage%d/0/deformation_%02d%s", _parser.getString ( "saveDirectory" ).c_str(), _stage-1, Algo.getMaxGridDepth(), Algo.getDeformationFileNameSuffix().c_str() ).c_str() );
+        TransformationDOFType transformationToLastAverage ( Algo.getTransformationDOFInitializer() );
+        Algo.getTransformation ( transformationToLastAverage );
+
+        Algo.setTransformationToComposition ( transformationToLastAverage, reducedTransformation );
+      }
+
+    }
+    else if ( _prealignWithPhaseCorrelation ) // Start with the translation found by prealignWithPhaseCorrelation.
+      Algo.setTransformationToTranslation ( _prealignTranslations[I] );
+    else // Start with a clean displacement (this pairing is new).
+      Algo.setTransformationToZero();
+  }
+
+  /**
+   * Estimates the translation from each template I, Begin <= I < End, to its predecessor (the predecessor of the
+   * first template is the reference) by phase correlation, see qc::PhaseCorrelationRegistration::estimateTranslation
+   * (its SmoothingSigma is given by "prealignSmoothingSigma", default 1).
+   * Since the frames of a series are mostly related by drift, initTransformationForPairing uses these translations
+   * as starting point for the registrations to the predecessors. The templates are processed in parallel, the
+   * translations (in pixels) are written to TranslationsFileName.
+   */
+  void prealignWithPhaseCorrelation ( const std::vector<std::string> &TemplateFileNames, const int Begin, const int End, const string &TranslationsFileName ) {
+    const bool reverseRoles = _parser.checkAndGetBool ( "reverseRolesInSeriesMatching" );
+    const bool noScaling = _parser.checkAndGetBool ( "dontNormalizeInputImages" );
+    const bool noResizeOrCrop = reverseRoles && _parser.checkAndGetBool ( "dontResizeOrCropReference" );
+    const ArrayType &firstPredecessor = reverseRoles ? _registrationAlgo.getTemplImageReference() : _registrationAlgo.getRefImageReference();
+    const RealType h = _registrationAlgo.getInitializerRef().H();
+    const RealType smoothingSigma = _parser.getRealOrDefault<RealType> ( "prealignSmoothingSigma", 1 );
+
+    cerr << "Estimating the translations of templates " << Begin << " to " << End - 1 << " by phase correlation\n";
+    _prealignTranslations.resize ( TemplateFileNames.size() );
+    int numFailed = 0;
+    string firstError;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) reduction ( + : numFailed )
+#endif
+    for ( int i = Begin; i < End; ++i ) {
+      string error;
+      try {
+        // Load the templates like matchToPredecessorsInParallel does, i.e. both in the role of the templates.
+        ArrayType curTemplate ( _registrationAlgo.getInitializerRef() );
+        ArrayType predecessor ( _registrationAlgo.getInitializerRef() );
+        _registrationAlgo.loadAndPrepareImage ( TemplateFileNames[i].c_str(), curTemplate, noScaling, noResizeOrCrop );
+        if ( i > 0 )
+          _registrationAlgo.loadAndPrepareImage ( TemplateFileNames[i-1].c_str(), predecessor, noScaling, noResizeOrCrop );
+        else
+          predecessor = firstPredecessor;
+
+        _prealignTranslations[i] = reverseRoles ? qc::PhaseCorrelationRegistration<ConfiguratorType>::estimateTranslation ( curTemplate, predecessor, smoothingSigma )
+                                                : qc::PhaseCorrelationRegistration<ConfiguratorType>::estimateTranslation ( predecessor, curTemplate, smoothingSigma );
+        _prealignTranslations[i] *= h;
+      }
+      // No exception may leave the parallel region, the first error is thrown after it.
+      catch ( aol::Exception &el ) {
+        el.consume();
+        error = el.getMessage() + " : " + el.getWhere();
+      }
+      catch ( std::exception &ex ) {
+        error = ex.what();
+      }
+      catch ( ... ) {
+        error = "unknown exception";
+      }
+      if ( error.size() > 0 ) {
+        ++numFailed;
+#ifdef _OPENMP
+#pragma omp critical ( SeriesMatching_prealignWithPhaseCorrelation )
+#endif
+        {
+          cerr << "Failed to prealign template " << i << ": " << error << endl;
+          if ( firstError.size() == 0 )
+            firstError = aol::strprintf ( "template %d: ", i ) + error;
+        }
+      }
+    }
+    if ( numFailed > 0 )
+      throw aol::Exception ( aol::strprintf ( "SeriesMatching::prealignWithPhaseCorrelation: Failed to prealign %d templates, first error at %s", numFailed, firstError.c_str() ).c_str(), __FILE__, __LINE__ );
+
+    std::ofstream translationsFile ( TranslationsFileName.c_str() );
+    translationsFile << setprecision ( 17 );
+    for ( int i = Begin; i < End; ++i ) {
+      translationsFile << i;
+      for ( int d = 0; d < Dim; ++d )
+        translationsFile << " " << _prealignTranslations[i][d] / h;
+      translationsFile << " # " << TemplateFileNames[i] << endl;
+    }
+  }
+
+  //! With "prealignWithPhaseCorrelation", the registrations to the predecessors start on "prealignStartLevel" (default
+  //! "startLevel"): The coarse levels are mostly needed to find the drift, which the prealignment already estimated.
+  int getPairingStartLevel ( ) const {
+    return _prealignWithPhaseCorrelation ? _parser.getIntOrDefault ( "prealignStartLevel", _parser.getInt ( "startLevel" ) ) : -1;
+  }
+
+  /**
+   * Registers template I (already loaded in Algo) to its predecessor, starting with the current
+   * transformation of Algo, and saves the result to the subdirectory I of the save directory.
+   * Returns the norm of the transformation found with "startLevel" (see getPairingStartLevel). If "altStartLevel" is used,
+   * the better of the two results is saved as deformation-<I> in the save directory.
+   */
+  RealType matchToPredecessor ( RegistrationType &Algo, const int I ) const {
+    Algo.makeAndSetSaveDirectory ( aol::strprintf ( "%s%d/", _parser.getString ( "saveDirectory" ).c_str(), I ).c_str() );
+    Algo.solveAndProlongToMaxDepth ( getPairingStartLevel() );
+    const RealType transformationNorm = Algo.getTransformationNorm ();
+
+    if ( _useAltStartLevel ) {
+      const RealType firstTryEnergy = Algo.getEnergyOfLastSolution();
+
+      TransformationDOFType savedTransformation ( Algo.getTransformationDOFInitializer() );
+      Algo.getTransformation ( savedTransformation );
+
+      ArrayType temp ( Algo.getInitializerRef() );
+      Algo.applyCurrentTransformation ( Algo.getTemplImageReference(), temp );
+      const int numOutOfDomainFirstTry = temp.numOccurence ( aol::NumberTrait<RealType>::Inf );
+
+      Algo.setTransformationToZero();
+      Algo.makeAndSetSaveDirectory ( aol::strprintf ( "%s%d-alt/", _parser.getString ( "saveDirectory" ).c_str(), I ).c_str() );
+      Algo.solveAndProlongToMaxDepth(  _parser.getInt ( "altStartLevel" ) );
+
+      Algo.applyCurrentTransformation ( Algo.getTemplImageReference(), temp );
+      const int numOutOfDomainSecondTry = temp.numOccurence ( aol::NumberTrait<RealType>::Inf );
+
+      const bool firstTryBetterWRTDomain = ( numOutOfDomainFirstTry < numOutOfDomainSecondTry );
+      const bool firstTryBetterWRTEnergy = ( firstTryEnergy < Algo.getEnergyOfLastSolution() );
+      const bool energyAsAltCriterion = _parser.checkAndGetBool( "energyAsAltCriterion" );
+
+      cerr << "Using ";
+      if ( ( energyAsAltCriterion && firstTryBetterWRTEnergy ) || ( !energyAsAltCriterion && firstTryBetterWRTDomain ) ) {
+        cerr << "\"startLevel\"";
+        Algo.setTransformation ( savedTransformation );
+      }
+      else
+        cerr << "\"altStartLevel\"";
+      cerr << " result\n";
+      cerr << ( firstTryBetterWRTDomain ? "\"startLevel\"" : "\"altStartLevel\"" ) << " has higher overlap\n";
+      cerr << ( firstTryBetterWRTEnergy ? "\"startLevel\"" : "\"altStartLevel\"" ) << " has lower energy\n";
+
+      Algo.setLevel ( Algo.getMaxGridDepth() );
+      Algo.saveTransformation ( aol::strprintf ( "%s/deformation-%03d%s", _parser.getString ( "saveDirectory" ).c_str(), I, Algo.getDeformationFileNameSuffix().c_str() ).c_str() );
+    }
+    return transformationNorm;
+  }
+
+  /**
+   * Registers the templates Begin, ..., End-1 to their predecessors (the first template to the reference) like
+   * matchSeries does, but NumThreads pairings at a time. Since these registrations don't depend on each other,
+   * each thread uses its own instance of RegistrationType. The results are saved and loaded in matchSeries afterwards,
+   * TransformationNorms and Energies (resized to the number of templates) return getTransformationNorm and
+   * getEnergyOfLastSolution of each pairing in the range.
+   */
+  void matchToPredecessorsInParallel ( const std::vector<std::string> &TemplateFileNames, const int Begin, const int End, const int NumThreads,
+                                       aol::Vector<RealType> &TransformationNorms, aol::Vector<RealType> &Energies ) {
+    const bool reverseRoles = _parser.checkAndGetBool ( "reverseRolesInSeriesMatching" );
+    const bool noScaling = _parser.checkAndGetBool ( "dontNormalizeInputImages" );
+    const qc::REGISTRATION_INPUT_TYPE templateRole = reverseRoles ? qc::REFERENCE : qc::TEMPLATE;
+    // The predecessor of the first template, already loaded by matchSeries.
+    const ArrayType firstPredecessor ( reverseRoles ? _registrationAlgo.getTemplImageReference() : _registrationAlgo.getRefImageReference(), aol::DEEP_COPY );
+
+    aol::RandomAccessContainer<RegistrationType> algos;
+    for ( int i = 0; i < NumThreads; ++i )
+      algos.constructDatumAndPushBack ( _parser );
+
+    TransformationNorms.reallocate ( TemplateFileNames.size() );
+    Energies.reallocate ( TemplateFileNames.size() );
+    int numFailed = 0;
+    string firstError;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( NumThreads ) reduction ( + : numFailed )
+#endif
+    for ( int i = Begin; i < End; ++i ) {
+#ifdef _OPENMP
+      RegistrationType &algo = algos[omp_get_thread_num()];
+#else
+      RegistrationType &algo = algos[0];
+#endif
+      string error;
+      try {
+        // Load the predecessor like matchSeries does, i.e. in the role of the templates, and then move it to the other role.
+        if ( i > 0 )
+          algo.loadRefOrTemplate ( TemplateFileNames[i-1].c_str(), templateRole, noScaling );
+        if ( reverseRoles )
+          algo.setTemplate ( ( i > 0 ) ? algo.getRefImageReference() : firstPredecessor );
+        else
+          algo.setReference ( ( i > 0 ) ? algo.getTemplImageReference() : firstPredecessor );
+
+        initTransformationForPairing ( algo, i, reverseRoles );
+        algo.loadRefOrTemplate ( TemplateFileNames[i].c_str(), templateRole, noScaling );
+        TransformationNorms[i] = matchToPredecessor ( algo, i );
+        Energies[i] = algo.getEnergyOfLastSolution ();
+      }
+      // No exception may leave the parallel region, the first error is thrown after it.
+      catch ( aol::Exception &el ) {
+        el.consume();
+        error = el.getMessage() + " : " + el.getWhere();
+      }
+      catch ( std::exception &ex ) {
+        error = ex.what();
+      }
+      catch ( ... ) {
+        error = "unknown exception";
+      }
+      if ( error.size() > 0 ) {
+        ++numFailed;
+#ifdef _OPENMP
+#pragma omp critical ( SeriesMatching_matchToPredecessorsInParallel )
+#endif
+        {
+          cerr << "Failed to match template " << i << ": " << error << endl;
+          if ( firstError.size() == 0 )
+            firstError = aol::strprintf ( "template %d: ", i ) + error;
+        }
+      }
+    }
+    if ( numFailed > 0 )
+      throw aol::Exception ( aol::strprintf ( "SeriesMatching::matchToPredecessorsInParallel: Failed to match %d templates, first error at %s", numFailed, firstError.c_str() ).c_str(), __FILE__, __LINE__ );
+  }
+
+  //! Number of shards the pairwise registrations are split into, parameter "numShards" (default 1).
+  int getNumShards ( ) const {
+    const int numShards = _parser.getIntOrDefault ( "numShards", 1 );
+    if ( numShards < 1 )
+      throw aol::Exception ( "SeriesMatching::getNumShards: \"numShards\" needs to be positive", __FILE__, __LINE__ );
+    return numShards;
+  }
+
+  //! Range [Begin, End) of the templates whose registrations to their predecessors belong to shard ShardIndex.
+  void getShardRange ( const int ShardIndex, const int NumTemplates, int &Begin, int &End ) const {
+    const int numShards = getNumShards();
+    if ( ( ShardIndex < 0 ) || ( ShardIndex >= numShards ) )
+      throw aol::OutOfBoundsException ( aol::strprintf ( "SeriesMatching::getShardRange: Shard %d doesn't exist, \"numShards\" is %d", ShardIndex, numShards ).c_str(), __FILE__, __LINE__ );
+    Begin = ( ShardIndex * NumTemplates ) / numShards;
+    End = ( ( ShardIndex + 1 ) * NumTemplates ) / numShards;
+  }
+
+  string createShardDirectoryName ( const int ShardIndex ) const {
+    return aol::strprintf ( "%sshard_%03d/", _parser.getString ( "saveDirectory" ).c_str(), ShardIndex );
+  }
+
+  /**
+   * Registers the templates of shard "shardIndex" (see getShardRange) to their predecessors. The deformations are
+   * saved where matchSeries saves them, the transformation norms and energies to defNorms.txt and pairwiseEnergies.txt
+   * in the directory of the shard (see createShardDirectoryName). Different shards can be processed by different
+   * processes or nodes sharing the save directory; mergeShardsAndAverageSeries combines their results.
+   */
+  void matchShardOfSeries ( ) {
+    std::vector<std::string> templateFileNames;
+    createTemplateFileNameList ( templateFileNames );
+    const int shardIndex = _parser.getInt ( "shardIndex" );
+    int begin, end;
+    getShardRange ( shardIndex, templateFileNames.size(), begin, end );
+    cerr << "Matching shard " << shardIndex << " (templates " << begin << " to " << end - 1 << ")\n";
+
+    if ( _parser.checkAndGetBool ( "reverseRolesInSeriesMatching" ) )
+      _registrationAlgo.loadRefOrTemplate ( _parser.getString ( "reference" ).c_str(), qc::TEMPLATE, _parser.checkAndGetBool ( "dontNormalizeInputImages" ) );
+
+    const string shardDir = createShardDirectoryName ( shardIndex );
+    aol::makeDirectory ( shardDir.c_str() );
+    if ( _prealignWithPhaseCorrelation )
+      prealignWithPhaseCorrelation ( templateFileNames, begin, end, shardDir + "prealignTranslations.txt" );
+
+    const string origSaveDir = _registrationAlgo.getSaveDirectory();
+    aol::Vector<RealType> transformationNorms, energies;
+    matchToPredecessorsInParallel ( templateFileNames, begin, end, getNumPairwiseThreads(), transformationNorms, energies );
+    _registrationAlgo.setSaveDirectory ( origSaveDir.c_str() );
+
+    std::ofstream defNormsFile ( ( shardDir + "defNorms.txt" ).c_str() );
+    std::ofstream energiesFile ( ( shardDir + "pairwiseEnergies.txt" ).c_str() );
+    defNormsFile << setprecision ( 17 );
+    energiesFile << setprecision ( 17 );
+    for ( int i = begin; i < end; ++i ) {
+      defNormsFile << i << " " << transformationNorms[i] << " # " << templateFileNames[i] << endl;
+      energiesFile << i << " " << energies[i] << endl;
+    }
+  }
+
+  //! Reads the values written by matchShardOfSeries for all shards.
+  void loadShardResults ( const int NumTemplates, aol::Vector<RealType> &TransformationNorms, aol::Vector<RealType> &Energies ) const {
+    TransformationNorms.reallocate ( NumTemplates );
+    Energies.reallocate ( NumTemplates );
+    const int numShards = getNumShards();
+    for ( int shard = 0; shard < numShards; ++shard ) {
+      int begin, end;
+      getShardRange ( shard, NumTemplates, begin, end );
+      const string shardDir = createShardDirectoryName ( shard );
+      loadShardValues ( ( shardDir + "defNorms.txt" ).c_str(), begin, end, TransformationNorms );
+      loadShardValues ( ( shardDir + "pairwiseEnergies.txt" ).c_str(), begin, end, Energies );
+    }
+  }
+
+  static void loadShardValues ( const char *FileName, const int Begin, const int End, aol::Vector<RealType> &Values ) {
+    std::ifstream in ( FileName );
+    if ( in.good() == false )
+      throw aol::FileException ( aol::strprintf ( "SeriesMatching::loadShardValues: Cannot open \"%s\" for reading, was the shard matched?", FileName ).c_str(), __FILE__, __LINE__ );
+    for ( int i = Begin; i < End; ++i ) {
+      int index = -1;
+      in >> index >> Values[i];
+      in.ignore ( std::numeric_limits<std::streamsize>::max(), '\n' );
+      if ( in.fail() || ( index != i ) )
+        throw aol::IOException ( aol::strprintf ( "SeriesMatching::loadShardValues: \"%s\" has no value for template %d", FileName, i ).c_str(), __FILE__, __LINE__ );
+    }
+  }
+
+  /**
+   * Registers each template to its predecessor and, unless "dontAccumulateDeformation" is set, refines
+   * the accumulated transformation by registering the template to the reference.
+   *
+   * If "numPairwiseThreads" is larger than one (see getNumPairwiseThreads), the registrations to the
+   * predecessors are done in parallel first (see matchToPredecessorsInParallel) and the sequential
+   * accumulation/refinement pass only loads their results. With MergeShards, the registrations to the
+   * predecessors are not done at all, but the results of matchShardOfSeries are loaded for all shards.
+   */
+  void matchSeries ( const bool MergeShards = false ) {
     // We will temporarily change the save directory, so store the original value.
     const string origSaveDir = _registrationAlgo.getSaveDirectory();
 
@@ -113,6 +458,20 @@ public:
     if ( reverseRoles )
       _registrationAlgo.loadRefOrTemplate ( _parser.getString ( "reference" ).c_str(), qc::TEMPLATE, _parser.checkAndGetBool ( "dontNormalizeInputImages" ) );
 
+    // With stage one results, only the first template is registered to its predecessor.
+    if ( _prealignWithPhaseCorrelation && ( MergeShards == false ) )
+      prealignWithPhaseCorrelation ( templateFileNames, 0, _loadStageOneResults ? aol::Min ( 1, numTemplateImages ) : numTemplateImages, origSaveDir + "/prealignTranslations.txt" );
+
+    // With stage one results, there is nothing to do in parallel.
+    const int numPairwiseThreads = getNumPairwiseThreads();
+    const bool matchPairsInParallel = ( numPairwiseThreads > 1 ) && ( _loadStageOneResults == false ) && ( MergeShards == false );
+    aol::Vector<RealType> pairwiseTransformationNorms, pairwiseEnergies;
+    if ( matchPairsInParallel )
+      matchToPredecessorsInParallel ( templateFileNames, 0, numTemplateImages, numPairwiseThreads, pairwiseTransformationNorms, pairwiseEnergies );
+    else if ( MergeShards )
+      loadShardResults ( numTemplateImages, pairwiseTransformationNorms, pairwiseEnergies );
+    const bool usePairwiseResults = matchPairsInParallel || MergeShards;
+
     // Start with a clean deformation.
     _registrationAlgo.setTransformationToZero ( );
     TransformationDOFType accumulatedTransformation ( _registrationAlgo.getTransformationDOFInitializer() );
@@ -122,71 +481,27 @@ public:
 
     for ( int i = 0; i < numTemplateImages; ++i ) {
       // First match the current template with the last template (assuming that the first template is the reference image).
-
-      // In case we try to reduce the deformations, we have to adjust the initial deformation used
-      // for the first pairing.
-      if ( _reduceDeformations && ( reverseRoles == false ) && ( i == 0 ) && ( _stage > 1 ) ) {
-        _registrationAlgo.loadTransformation ( aol::strprintf ( "%s../stage%d/reduceDef_%%d.dat.bz2", _parser.getString ( "saveDirectory" ).c_str(), _stage - 1 ).c_str() );
-        // In Stage 3+, this needs to be combined with the deformation calculated in the previous stage.
-        if ( _stage > 2 ) {
-          TransformationDOFType reducedTransformation ( _registrationAlgo.getTransformationDOFInitializer() );
-          _registrationAlgo.getTransformation ( reducedTransformation );
-
-          _registrationAlgo.loadTransformation ( aol::strprintf ( "%s../stage%d/0/deformation_%02d%s", _parser.getString ( "saveDirectory" ).c_str(), _stage-1, _registrationAlgo.getMaxGridDepth(), _registrationAlgo.getDeformationFileNameSuffix().c_str() ).c_str() );
-          TransformationDOFType transformationToLastAverage ( _registrationAlgo.getTransformationDOFInitializer() );
-          _registrationAlgo.getTransformation ( transformationToLastAverage );
-
-          _registrationAlgo.setTransformationToComposition ( transformationToLastAverage, reducedTransformation );
-        }
-
-      }
-      else // Start with a clean displacement (this pairing is new).
-        _registrationAlgo.setTransformationToZero();
+      if ( usePairwiseResults == false )
+        initTransformationForPairing ( _registrationAlgo, i, reverseRoles );
 
       _registrationAlgo.loadRefOrTemplate ( templateFileNames[i].c_str(), reverseRoles ? qc::REFERENCE : qc::TEMPLATE, _parser.checkAndGetBool ( "dontNormalizeInputImages" ) );
-      if ( ( _loadStageOneResults == false ) || ( i == 0 ) ) {
-        _registrationAlgo.makeAndSetSaveDirectory ( aol::strprintf ( "%s%d/", _parser.getString ( "saveDirectory" ).c_str(), i ).c_str() );
-        _registrationAlgo.solveAndProlongToMaxDepth();
+      if ( usePairwiseResults ) {
+        if ( _useAltStartLevel )
+          _registrationAlgo.loadTransformation ( aol::strprintf ( "%s/deformation-%03d%s", _parser.getString ( "saveDirectory" ).c_str(), i, _registrationAlgo.getDeformationFileNameSuffix().c_str() ).c_str() );
+        else
+          _registrationAlgo.loadTransformation ( aol::strprintf ( "%s%d/deformation_%02d%s", _parser.getString ( "saveDirectory" ).c_str(), i, _registrationAlgo.getMaxGridDepth(), _registrationAlgo.getDeformationFileNameSuffix().c_str() ).c_str() );
+        defNormsFile << i << " " << pairwiseTransformationNorms[i] << " # " << templateFileNames[i] << endl;
+        // The first deformation will not be refined, so save its energy directly.
+        if ( ( _useAltStartLevel == false ) && ( i == 0 ) )
+          energiesFile << i << " " << pairwiseEnergies[i] << endl;
+      }
+      else if ( ( _loadStageOneResults == false ) || ( i == 0 ) ) {
+        const RealType transformationNorm = matchToPredecessor ( _registrationAlgo, i );
         if ( _loadStageOneResults == false )
-          defNormsFile << i << " " << _registrationAlgo.getTransformationNorm () << " # " << templateFileNames[i] << endl;
+          defNormsFile << i << " " << transformationNorm << " # " << templateFileNames[i] << endl;
 
-        if ( _useAltStartLevel ) {
-          const RealType firstTryEnergy = _registrationAlgo.getEnergyOfLastSolution();
-
-          TransformationDOFType savedTransformation ( _registrationAlgo.getTransformationDOFInitializer() );
-          _registrationAlgo.getTransformation ( savedTransformation );
-
-          ArrayType temp ( _registrationAlgo.getInitializerRef() );
-          _registrationAlgo.applyCurrentTransformation ( _registrationAlgo.getTemplImageReference(), temp );
-          const int numOutOfDomainFirstTry = temp.numOccurence ( aol::NumberTrait<RealType>::Inf );
-
-          _registrationAlgo.setTransformationToZero();
-          _registrationAlgo.makeAndSetSaveDirectory ( aol::strprintf ( "%s%d-alt/", _parser.getString ( "saveDirectory" ).c_str(), i ).c_str() );
-          _registrationAlgo.solveAndProlongToMaxDepth(  _parser.getInt ( "altStartLevel" ) );
-
-          _registrationAlgo.applyCurrentTransformation ( _registrationAlgo.getTemplImageReference(), temp );
-          const int numOutOfDomainSecondTry = temp.numOccurence ( aol::NumberTrait<RealType>::Inf );
-
-          const bool firstTryBetterWRTDomain = ( numOutOfDomainFirstTry < numOutOfDomainSecondTry );
-          const bool firstTryBetterWRTEnergy = ( firstTryEnergy < _registrationAlgo.getEnergyOfLastSolution() );
-          const bool energyAsAltCriterion = _parser.checkAndGetBool( "energyAsAltCriterion" );
-
-          cerr << "Using ";
-          if ( ( energyAsAltCriterion && firstTryBetterWRTEnergy ) || ( !energyAsAltCriterion && firstTryBetterWRTDomain ) ) {
-            cerr << "\"startLevel\"";
-            _registrationAlgo.setTransformation ( savedTransformation );
-          }
-          else
-            cerr << "\"altStartLevel\"";
-          cerr << " result\n";
-          cerr << ( firstTryBetterWRTDomain ? "\"startLevel\"" : "\"altStartLevel\"" ) << " has higher overlap\n";
-          cerr << ( firstTryBetterWRTEnergy ? "\"startLevel\"" : "\"altStartLevel\"" ) << " has lower energy\n";
-
-          _registrationAlgo.setLevel ( _registrationAlgo.getMaxGridDepth() );
-          _registrationAlgo.saveTransformation ( aol::strprintf ( "%s/deformation-%03d%s", _parser.getString ( "saveDirectory" ).c_str(), i, _registrationAlgo.getDeformationFileNameSuffix().c_str() ).c_str() );
-        }
         // The first deformation will not be refined, so save its energy directly.
-        else if ( i == 0 )
+        if ( ( _useAltStartLevel == false ) && ( i == 0 ) )
           energiesFile << i << " " << _registrationAlgo.getEnergyOfLastSolution () << endl;
       }
       else {
@@ -243,12 +558,37 @@ public:
     _registrationAlgo.setSaveDirectory ( origSaveDir.c_str() );
   }
 
-  void saveAverageMedianAndNumSamples ( const ArrayType &Average, const ArrayType &Median, const ArrayType &NumSamples, const int Iter = -1 ) const {
+  void saveAverageMedianAndNumSamples ( const ArrayType &Average, const ArrayType &Median, const ArrayType &NumSamples, const int Iter = -1, const ArrayType *Variance = NULL ) const {
     qc::DefaultArraySaver<RealType, Dim> saver ( true );
     saver.setSaveDirectory ( _parser.getString ( "saveDirectory" ).c_str() );
     saver.saveStep ( Average, Iter, "average" );
     saver.saveStep ( Median, Iter, "median" );
     saver.saveStep ( NumSamples, Iter, "numSamples" );
+    if ( Variance )
+      saver.saveStep ( *Variance, Iter, "variance" );
+  }
+
+  /**
+   * Creates a new, uniquely named scratch file in which qc::SeriesStatistics stores the samples needed for the median
+   * and returns its name. The file is placed in the directory given by the optional parameter scratchDirectory, by
+   * default in the save directory, so several runs or shards can share a scratch directory. The returned file is owned
+   * by the qc::SeriesStatistics object it is passed to, which deletes it again.
+   *
+   * \attention The file needs numPixels * numFrames * sizeof(RealType) bytes, i.e. about 53 GB for a series of
+   *            400 frames with 4096^2 pixels in double precision, so scratchDirectory should be on a disk with
+   *            enough free space.
+   */
+  string createSeriesStatisticsScratchFile ( ) const {
+    string scratchDirectory = _parser.hasVariable ( "scratchDirectory" ) ? _parser.getString ( "scratchDirectory" ) : _parser.getString ( "saveDirectory" );
+    if ( ( scratchDirectory.size() > 0 ) && ( scratchDirectory[scratchDirectory.size() - 1] != '/' ) )
+      scratchDirectory += '/';
+    const string fileNameMask = scratchDirectory + "medianSamples_XXXXXX";
+    std::vector<char> fileName ( fileNameMask.begin(), fileNameMask.end() );
+    fileName.resize ( aol::Max<size_t> ( fileName.size() + 1, 1024 ), 0 );
+    ofstream scratchFile;
+    aol::generateTemporaryFile ( &fileName[0], scratchFile );
+    scratchFile.close();
+    return &fileName[0];
   }
 
   void saveNamedDeformedTemplate ( const char *TemplateFileName, const ArrayType &DefTemplateArray ) const {
@@ -283,8 +623,10 @@ public:
         saveNamedDeformedTemplate ( _parser.getString ( "reference" ).c_str(), curTemplate );
       }
 
-      aol::MultiVector<RealType> deformedTemplates ( numTemplateImages, _registrationAlgo.getInitializerRef().getNumberOfNodes() );
-      aol::MultiVector<RealType> calculatedDeformedTemplates;
+      // The deformed templates are not kept in memory, only their statistics.
+      qc::SeriesStatistics<RealType> statistics ( average.size(), numTemplateImages, createSeriesStatisticsScratchFile() );
+      ArrayType deformedTemplate ( _registrationAlgo.getInitializerRef() );
+      ArrayType variance ( _registrationAlgo.getInitializerRef() );
 
       const int averageSaveIncrement = _parser.hasVariable ( "averageSaveIncrement" ) ? _parser.getInt ( "averageSaveIncrement" ) : numTemplateImages;
 
@@ -292,46 +634,32 @@ public:
       if ( _reduceDeformations )
         reducedPhi.load ( aol::strprintf ( "%sreduceDef_%%d.dat.bz2", getSaveDirectory() ).c_str() );
 
-      // First generate all deformed template images.
+      // Deform the templates one at a time and add them to the statistics.
       for ( int i = 0; i < numTemplateImages; ++i ) {
         _registrationAlgo.loadAndPrepareImage ( templateFileNames[i].c_str(), curTemplate, true, false, true );
         const string defFileNameBase = createDeformationBaseFileName ( InputDirectory, i );
         if ( _reduceDeformations ) {
           _registrationAlgo.applyTransformation ( reducedPhi, curTemplate, average );
-          _registrationAlgo.applySavedTransformation ( defFileNameBase.c_str(), average, deformedTemplates[i] );
+          _registrationAlgo.applySavedTransformation ( defFileNameBase.c_str(), average, deformedTemplate );
         }
         else
-          _registrationAlgo.applySavedTransformation ( defFileNameBase.c_str(), curTemplate, deformedTemplates[i] );
-        calculatedDeformedTemplates.appendReference ( deformedTemplates[i] );
+          _registrationAlgo.applySavedTransformation ( defFileNameBase.c_str(), curTemplate, deformedTemplate );
+        statistics.addFrame ( deformedTemplate );
         if ( _parser.checkAndGetBool ( "saveNamedDeformedTemplates" ) ) {
           ArrayType defTemplateArray ( _registrationAlgo.getInitializerRef() );
           _registrationAlgo.applySavedTransformation ( defFileNameBase.c_str(), curTemplate, defTemplateArray, _parser.checkAndGetBool ( "saveNamedDeformedTemplatesExtendedWithMean" ) ? curTemplate.getMeanValue() : 0, _parser.checkAndGetBool ( "saveNamedDeformedTemplatesUsingNearestNeighborInterpolation" ) );
           saveNamedDeformedTemplate ( templateFileNames[i].c_str(), defTemplateArray );
         }
 
-        if ( ( calculatedDeformedTemplates.numComponents() == numTemplateImages ) || ( ( calculatedDeformedTemplates.numComponents() % averageSaveIncrement ) == 0 ) ) {
+        if ( ( statistics.getNumFrames() == numTemplateImages ) || ( ( statistics.getNumFrames() % averageSaveIncrement ) == 0 ) ) {
           const RealType lastTemplateMean = curTemplate.getMeanValue ();
 
-          // Now calculate the average and median.
-          for ( int j = 0; j < average.size(); ++j ) {
-            average[j] = 0;
-            int numSamplesInDomain = 0;
-            for ( int i = 0; i < calculatedDeformedTemplates.numComponents(); ++i ) {
-              if ( calculatedDeformedTemplates[i][j] != aol::NumberTrait<RealType>::Inf ) {
-                average[j] += calculatedDeformedTemplates[i][j];
-                ++numSamplesInDomain;
-              }
-            }
-            if ( numSamplesInDomain > 0 )
-              average[j] /= numSamplesInDomain;
-            else
-              average[j] = lastTemplateMean;
-
-            numSamples[j] = numSamplesInDomain;
-          }
-
-          calculatedDeformedTemplates.getMedianVecOverComponents ( median, lastTemplateMean );
-          saveAverageMedianAndNumSamples ( average, median, numSamples, ( calculatedDeformedTemplates.numComponents() != numTemplateImages ) ? calculatedDeformedTemplates.numComponents() : -1 );
+          // Now calculate the average and median of the frames added so far.
+          statistics.getMean ( average, lastTemplateMean );
+          statistics.getNumSamples ( numSamples );
+          statistics.getVariance ( variance );
+          statistics.getMedian ( median, lastTemplateMean );
+          saveAverageMedianAndNumSamples ( average, median, numSamples, ( statistics.getNumFrames() != numTemplateImages ) ? statistics.getNumFrames() : -1, &variance );
         }
       }
     }
@@ -455,6 +783,14 @@ public:
     averageSeries ( _registrationAlgo.getSaveDirectory() );
   }
 
+  //! Like matchAndAverageSeries, but uses the pairwise registrations of all shards, see matchShardOfSeries.
+  void mergeShardsAndAverageSeries ( ) {
+    matchSeries ( true );
+    if ( _reduceDeformations )
+      reduceDeformations ( _registrationAlgo.getSaveDirectory() );
+    averageSeries ( _registrationAlgo.getSaveDirectory() );
+  }
+
   void analyzeDeformations ( const char *InputDirectory ) {
     std::vector<std::string> templateFileNames;
     createTemplateFileNameList ( templateFileNames );
@@ -576,6 +912,7 @@ public:
     typedef aol::H1GradientDescent<ConfiguratorType, aol::MultiVector<RealType>, qc::LinearSmoothOp<RealType, typename qc::MultilevelArrayTrait<RealType, typename ConfiguratorType::InitType>::GridTraitType > > GDType;
     GDType solver ( _registrationAlgo.getInitializerRef(), E, DE, 1000, 1, 5e-7 );
     solver.setConfigurationFlags ( GDType::USE_NONLINEAR_CG|GDType::LOG_GRADIENT_NORM_AT_OLD_POSITION|GDType::USE_GRADIENT_BASED_STOPPING );
+    solver.getSmoothOpReference().setUseFFT ( _parser.checkAndGetBool ( "useFFTSmoothing" ) );
 
     qc::MultiArray<RealType, Dim> phi ( _registrationAlgo.getInitializerRef() );
     solver.applySingle ( phi );
@@ -642,15 +979,15 @@ public:
     const int numTemplateImages = templateFileNames.size();
 
     ArrayType median ( _registrationAlgo.getInitializerRef() );
+    ArrayType templateArray ( _registrationAlgo.getInitializerRef() );
 
-    aol::MultiVector<RealType> templates ( numTemplateImages, _registrationAlgo.getInitializerRef().getNumberOfNodes() );
-
+    qc::SeriesStatistics<RealType> statistics ( median.size(), numTemplateImages, createSeriesStatisticsScratchFile() );
     for ( int i = 0; i < numTemplateImages; ++i ) {
-      ArrayType templateArray ( templates[i], _registrationAlgo.getInitializerRef(), aol::FLAT_COPY );
       _registrationAlgo.loadAndPrepareImage ( templateFileNames[i].c_str(), templateArray, true );
+      statistics.addFrame ( templateArray );
     }
 
-    templates.getMedianVecOverComponents ( median );
+    statistics.getMedian ( median );
     median.save ( aol::strprintf ( "%smedianOfTemplates.dat.bz2", getSaveDirectory() ).c_str(), qc::PGM_DOUBLE_BINARY );
   }
 
@@ -672,6 +1009,12 @@ public:
       case APPLY_DEFORMATTION:
         applyDeformation( );
         break;
+      case MATCH_SHARD_OF_SERIES:
+        matchShardOfSeries( );
+        break;
+      case MERGE_SHARDS_AND_AVERAGE_SERIES:
+        mergeShardsAndAverageSeries( );
+        break;
       default:
         throw aol::Exception ( "SeriesMatching::doAction: Invalid ActionType", __FILE__, __LINE__ );
     } 
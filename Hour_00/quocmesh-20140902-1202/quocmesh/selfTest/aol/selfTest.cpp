@@ -1148,6 +1148,164 @@ int main( int, char** ) {
 
     }
 
+#ifndef DO_NOT_USE_MEMORYMANAGER
+    {
+      cerr << "--- Testing aol::MemoryManager ... ";
+      bool mmFailed = false;
+
+      aol::MemoryManager::deleteUnlocked();
+      aol::MemoryManager::resetStatistics();
+
+      const double *oldData = NULL;
+      {
+        aol::Vector<double> vec ( 1000 );
+        oldData = vec.getData();
+        mmFailed |= ( ( reinterpret_cast<uintptr_t> ( oldData ) % aol::MemoryManager::CacheLineSize ) != 0 );
+      }
+      {
+        // 1000 doubles are less than twice as much as 900 doubles, so the block is recycled, for 400 doubles it is too large.
+        aol::Vector<double> vec ( 900 );
+        aol::Vector<double> vec2 ( 400 );
+        mmFailed |= ( vec.getData() != oldData ) || ( vec.size() != 900 ) || ( vec2.getData() == oldData );
+      }
+      {
+        // Huge blocks that are allocated one after another do not start at the same offset from a huge page boundary.
+        aol::Vector<double> vec ( aol::MemoryManager::HugePageSize / sizeof ( double ) );
+        void *block = aol::MemoryManager::allocateBlock ( aol::MemoryManager::HugePageSize );
+        mmFailed |= ( ( reinterpret_cast<uintptr_t> ( vec.getData() ) % aol::MemoryManager::CacheLineSize ) != 0 );
+        mmFailed |= ( ( reinterpret_cast<uintptr_t> ( block ) % aol::MemoryManager::CacheLineSize ) != 0 );
+        mmFailed |= ( ( reinterpret_cast<uintptr_t> ( vec.getData() ) % aol::MemoryManager::HugePageSize ) == ( reinterpret_cast<uintptr_t> ( block ) % aol::MemoryManager::HugePageSize ) );
+        aol::MemoryManager::freeBlock ( block, aol::MemoryManager::HugePageSize );
+
+        // Freeing a huge block with a wrong size is detected by its header.
+        block = aol::MemoryManager::allocateBlock ( 2 * aol::MemoryManager::HugePageSize );
+        bool wrongSizeDetected = false;
+        try {
+          aol::MemoryManager::freeBlock ( block, aol::MemoryManager::HugePageSize );
+        } catch ( aol::Exception &el ) {
+          el.consume();
+          wrongSizeDetected = true;
+        }
+        mmFailed |= !wrongSizeDetected;
+        aol::MemoryManager::freeBlock ( block, 2 * aol::MemoryManager::HugePageSize );
+      }
+
+      aol::MemoryManager::Statistics stats;
+      aol::MemoryManager::getStatistics ( stats );
+      mmFailed |= ( stats.numThreadCacheHits + stats.numSharedHits != 1 ) || ( stats.numMisses != 3 ) || ( stats.numDeallocations != 4 );
+      mmFailed |= ( stats.bytesRetained != ( 1000 + 400 ) * sizeof ( double ) + aol::MemoryManager::HugePageSize ) || ( stats.numBlocksRetained != 3 );
+      mmFailed |= ( aol::MemoryManager::memoryManagerMemoryUsage() != stats.bytesRetained );
+
+      {
+        // The copy of a GenBandMatrix gets its own data from the MemoryManager, which its destructor returns.
+        aol::Vector<int> offsets ( 3 );
+        offsets[0] = -1; offsets[1] = 0; offsets[2] = 1;
+        aol::GenBandMatrix<double> mat ( 5, 5, offsets );
+        for ( int i = 0; i < 5; ++i )
+          mat.set ( i, i, i + 1 );
+        aol::GenBandMatrix<double> copy ( mat );
+        mat.set ( 0, 0, 7 );
+        mmFailed |= ( copy.get ( 0, 0 ) != 1 ) || ( copy.get ( 4, 4 ) != 5 ) || ( copy.get ( 0, 1 ) != 0 );
+      }
+
+      int numWrong = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction ( + : numWrong )
+#endif
+      for ( int i = 0; i < 1000; ++i ) {
+        aol::Vector<int> vec ( 100 + i % 7 );
+        vec.setAll ( i );
+        if ( vec.sum() != i * vec.size() )
+          ++numWrong;
+      }
+      mmFailed |= ( numWrong != 0 );
+
+      // The limits hold for the thread caches and the shared store together, independently of the number of threads.
+      aol::MemoryManager::deleteUnlocked();
+      aol::MemoryManager::setMaxRetain ( 40 );
+      aol::MemoryManager::setMemusageLimit ( 1 << 20 );
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for ( int i = 0; i < 1000; ++i ) {
+        // Blocks freed before are too small to be recycled, so each vector needs a new block.
+        aol::Vector<double> vec ( 100 + 10 * i );
+      }
+      aol::MemoryManager::getStatistics ( stats );
+      mmFailed |= ( stats.bytesRetained > ( 1 << 20 ) ) || ( stats.numBlocksRetained > 40 ) || ( stats.numReleased == 0 );
+      aol::MemoryManager::setMaxRetain ( 256 );
+      aol::MemoryManager::setMemusageLimit ( 512 * ( 1 << 20 ) );
+
+      aol::MemoryManager::deleteUnlocked();
+      mmFailed |= ( aol::MemoryManager::memoryManagerMemoryUsage() != 0 );
+
+      failed |= mmFailed;
+      if( !mmFailed )
+        cerr << "OK." << endl;
+      else
+        cerr << "FAILED!" << endl;
+    }
+#endif
+
+    {
+      cerr << "--- Testing fused aol::Vector and aol::MultiVector operations ... ";
+      bool fusedFailed = false;
+
+      // The fused operations have to give exactly the same results as the unfused ones, also for vectors whose
+      // length is not a multiple of the SIMD width and for vectors long enough to be processed in parallel.
+      const int sizes[3] = { 1001, 3, 100003 };
+      aol::MultiVector<double> x, y, z, w;
+      for ( int j = 0; j < 3; ++j ) {
+        x.appendReference ( *( new aol::Vector<double> ( sizes[j] ) ), true );
+        y.appendReference ( *( new aol::Vector<double> ( sizes[j] ) ), true );
+        z.appendReference ( *( new aol::Vector<double> ( sizes[j] ) ), true );
+        w.appendReference ( *( new aol::Vector<double> ( sizes[j] ) ), true );
+        for ( int i = 0; i < sizes[j]; ++i ) {
+          x[j][i] = sin ( 0.01 * i + j );
+          y[j][i] = cos ( 0.02 * i );
+          z[j][i] = sin ( 0.7 * i );
+          w[j][i] = cos ( 0.3 * i - j );
+        }
+      }
+
+      aol::MultiVector<double> xFused ( x ), zFused ( z );
+      x.addMultiple ( y, 0.3 );
+      z.addMultiple ( w, -0.7 );
+      fusedFailed |= ( zFused.addMultipleAndNormSqr ( w, -0.7, xFused, y, 0.3 ) != z.normSqr() );
+      fusedFailed |= !( xFused == x ) || !( zFused == z );
+      fusedFailed |= ( xFused[2].addMultipleAndNormSqr ( y[2], 1.1 ) != x[2].addMultiple ( y[2], 1.1 ).normSqr() );
+      fusedFailed |= ( xFused[2] != x[2] );
+
+      aol::Vector<float> a ( 1001 ), b ( 1001 ), aFused ( 1001 );
+      for ( int i = 0; i < a.size(); ++i ) {
+        a[i] = aFused[i] = static_cast<float> ( sin ( 0.01 * i ) );
+        b[i] = static_cast<float> ( cos ( 0.02 * i ) );
+      }
+      fusedFailed |= ( aFused.addMultipleAndNormSqr ( b, 0.3f ) != a.addMultiple ( b, 0.3f ).normSqr() );
+      fusedFailed |= ( aFused != a );
+
+      // setSum, which aol::CGInverse uses for the initial residual, has to reject vectors of different size like addMultiple.
+      aol::Vector<float> difference ( a );
+      difference -= b;
+      aFused.setSum ( a, b, -1.f );
+      fusedFailed |= ( aFused != difference );
+      bool setSumThrew = false;
+      try {
+        aFused.setSum ( a, aol::Vector<float> ( 1000 ), 1.f );
+      }
+      catch ( aol::Exception &ex ) {
+        ex.consume();
+        setSumThrew = true;
+      }
+      fusedFailed |= !setSumThrew;
+
+      failed |= fusedFailed;
+      if( !fusedFailed )
+        cerr << "OK." << endl;
+      else
+        cerr << "FAILED!" << endl;
+    }
+
     {
       cerr << "--- Testing aol::BitVector ... ";
       aol::BitVector bf(20);
@@ -1178,6 +1336,56 @@ int main( int, char** ) {
         cerr << "FAILED!" << endl;
     }
 
+    {
+      cerr << "--- Testing aol::Bzipofstream/aol::Bzipifstream with small buffers and multiple threads ... ";
+      // The buffer is much smaller than the data, so the streams have to work chunk by chunk.
+      // With three threads and compression level 1, the data is written as several bzip2 streams.
+      const int bufferSize = 1000;
+      aol::Vector<int> data ( 100000 );
+      for ( int i = 0; i < data.size(); ++i )
+        data[i] = ( i * 7919 ) % 1013;
+
+      const char *fileNames[3] = { "test.bin.bz2", "test.bin", "test.bin.bz2" };
+      const int numThreads[3] = { 1, 1, 3 };
+      for ( int j = 0; j < 3; ++j ) {
+        {
+          aol::Bzipofstream out ( fileNames[j], 1, numThreads[j], bufferSize );
+          out << "header " << data.size() << endl;
+          for ( int i = 0; i < 100; ++i )
+            out.put ( static_cast<char> ( data[i] ) );
+          out.write ( reinterpret_cast<const char*> ( data.getData() ), data.size() * sizeof ( int ) );
+          out.close();
+          failed = failed || !out.good();
+        }
+
+        for ( int k = 1; k <= 3; k += 2 ) {
+          aol::Bzipifstream in ( fileNames[j], k, bufferSize );
+          string header;
+          int size = 0;
+          in >> header >> size;
+          in.get();
+          failed = failed || ( header != "header" ) || ( size != data.size() );
+          for ( int i = 0; i < 100; ++i )
+            failed = failed || ( in.get() != static_cast<unsigned char> ( data[i] ) );
+          in.unget();
+          failed = failed || ( in.get() != static_cast<unsigned char> ( data[99] ) );
+          aol::Vector<int> dataL ( data.size() );
+          in.read ( reinterpret_cast<char*> ( dataL.getData() ), dataL.size() * sizeof ( int ) );
+          failed = failed || !in.good() || ( dataL != data );
+          in.unget();
+          failed = failed || ( in.get() != static_cast<unsigned char> ( reinterpret_cast<const char*> ( data.getData() )[data.size() * sizeof ( int ) - 1] ) );
+          in.get();
+          failed = failed || !in.eof();
+        }
+        remove ( fileNames[j] );
+      }
+
+      if( !failed )
+        cerr << "OK." << endl;
+      else
+        cerr << "FAILED!" << endl;
+    }
+
     {
       cerr << "--- Testing aol::Vector<float> operator * ... ";
       if( !VectorOperatorStarTest<float>() )
@@ -1206,6 +1414,148 @@ int main( int, char** ) {
       cerr << "OK." << endl;
     }
 
+    {
+      cerr << "--- Testing aol::CSRMatrix<double> made from aol::SparseMatrix<double> ... ";
+      // Large enough for the parallel multiplication, every 7th row stays empty.
+      const int n = 20000;
+      aol::SparseMatrix<double> smat ( n, n );
+      for ( int i = 0; i < n; i += ( i % 7 == 5 ) ? 2 : 1 )
+        for ( int j = aol::Max ( 0, i - 3 ); j < aol::Min ( n, i + 4 ); ++j )
+          smat.set ( i, j, sin ( 0.1 * i + j ) );
+      const aol::CSRMatrix<double> csrMat ( smat );
+
+      aol::Vector<double> arg ( n ), dest ( n ), csrDest ( n );
+      for ( int i = 0; i < n; ++i )
+        arg[i] = cos ( 0.3 * i );
+      smat.apply ( arg, dest );
+      csrMat.apply ( arg, csrDest );
+      bool csrFailed = !( dest == csrDest );
+      smat.applyAdd ( arg, dest );
+      csrMat.applyAdd ( arg, csrDest );
+      csrFailed |= !( dest == csrDest );
+
+      aol::CSRMatrix<double> zeroMat ( smat );
+      zeroMat.setZero();
+      zeroMat.apply ( arg, csrDest );
+      csrFailed |= ( csrDest.norm() != 0 );
+
+      if ( !csrFailed )
+        cerr << "OK." << endl;
+      else {
+        cerr << "FAILED!" << endl;
+        failed = true;
+      }
+    }
+
+    {
+      cerr << "--- Testing aol::ParallelSSORPreconditioner and aol::ParallelILU0Preconditioner ... ";
+      bool parallelFailed = false;
+      typedef qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double,qc::QC_2D,3> > ConfigType;
+      const qc::GridDefinition grid ( 7, qc::QC_2D );
+      ConfigType::MatrixType mat ( grid );
+      aol::MassOp<ConfigType> ( grid, aol::ONTHEFLY ).assembleAddMatrix ( mat );
+      aol::StiffOp<ConfigType> ( grid, aol::ONTHEFLY ).assembleAddMatrix ( mat, grid.H() );
+      aol::Vector<double> rhs ( grid ), seqDest ( grid ), parDest ( grid );
+      for ( int i = 0; i < rhs.size(); ++i )
+        rhs[i] = sin ( 0.37 * i );
+
+      // With level scheduling, the operators have to coincide with the sequential ones.
+      const aol::SSORPreconditioner<aol::Vector<double>, ConfigType::MatrixType> seqSSOR ( mat );
+      const aol::ParallelSSORPreconditioner<double> parSSOR ( mat );
+      seqSSOR.apply ( rhs, seqDest );
+      parSSOR.apply ( rhs, parDest );
+      parDest -= seqDest;
+      parallelFailed |= ( parDest.getMaxAbsValue() > 1e-12 * seqDest.getMaxAbsValue() );
+
+      aol::SparseMatrix<double> smat ( grid );
+      aol::MassOp<ConfigType> ( grid, aol::ONTHEFLY ).assembleAddMatrix ( smat );
+      aol::StiffOp<ConfigType> ( grid, aol::ONTHEFLY ).assembleAddMatrix ( smat, grid.H() );
+      const aol::ILU0Preconditioner<double, aol::SparseMatrix<double> > seqILU0 ( smat );
+      const aol::ParallelILU0Preconditioner<double> parILU0 ( mat );
+      seqILU0.apply ( rhs, seqDest );
+      parILU0.apply ( rhs, parDest );
+      parDest -= seqDest;
+      parallelFailed |= ( parDest.getMaxAbsValue() > 1e-12 * seqDest.getMaxAbsValue() );
+
+      // The greedy coloring of a 2D quoc grid uses 4 colors, of a 3D quoc grid 8 colors.
+      parallelFailed |= ( aol::ParallelSweepMatrix<double> ( mat, aol::MULTICOLOR_ORDERING ).getNumLowerLevels() != 4 );
+      const qc::GridDefinition grid3D ( 3, qc::QC_3D );
+      typedef qc::QuocConfiguratorTraitMultiLin<double, qc::QC_3D, aol::GaussQuadrature<double,qc::QC_3D,3> > ConfigType3D;
+      ConfigType3D::MatrixType mat3D ( grid3D );
+      aol::StiffOp<ConfigType3D> ( grid3D, aol::ONTHEFLY ).assembleAddMatrix ( mat3D );
+      parallelFailed |= ( aol::ParallelSweepMatrix<double> ( mat3D, aol::MULTICOLOR_ORDERING ).getNumLowerLevels() != 8 );
+
+      // Multicolor ordering gives different preconditioners that still have to converge comparably fast.
+      const aol::ParallelSSORPreconditioner<double> colorSSOR ( mat, 1.2, aol::MULTICOLOR_ORDERING );
+      const aol::ParallelILU0Preconditioner<double> colorILU0 ( mat, aol::MULTICOLOR_ORDERING );
+      const aol::Op<aol::Vector<double> > *precs[5] = { &seqSSOR, &parSSOR, &colorSSOR, &parILU0, &colorILU0 };
+      int numIterations[5];
+      for ( int i = 0; i < 5; ++i ) {
+        aol::PCGInverse<aol::Vector<double> > pcg ( mat, *precs[i], 1e-20, 500, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE );
+        pcg.setQuietMode ( true );
+        parDest.setZero();
+        pcg.apply ( rhs, parDest );
+        numIterations[i] = pcg.getCount();
+      }
+      parallelFailed |= ( numIterations[1] != numIterations[0] ) || ( numIterations[2] > 2 * numIterations[0] ) || ( numIterations[4] > 2 * numIterations[3] );
+
+      // Non-symmetric matrix whose 20 levels are large enough to be processed in parallel.
+      const int n = 20000, offset = 1000;
+      aol::SparseMatrix<double> nonSymMat ( n, n );
+      for ( int i = 0; i < n; ++i ) {
+        nonSymMat.set ( i, i, 4 );
+        if ( i >= offset )
+          nonSymMat.set ( i, i - offset, -1 - 0.5 * sin ( 0.1 * i ) );
+        if ( i + offset < n )
+          nonSymMat.set ( i, i + offset, -0.5 );
+        if ( i > offset )
+          nonSymMat.set ( i, i - offset - 1, -1 );
+      }
+      aol::Vector<double> nonSymRhs ( n ), nonSymSeqDest ( n ), nonSymParDest ( n );
+      for ( int i = 0; i < n; ++i )
+        nonSymRhs[i] = cos ( 0.3 * i );
+      aol::SSORPreconditioner<aol::Vector<double>, aol::SparseMatrix<double> > ( nonSymMat ).apply ( nonSymRhs, nonSymSeqDest );
+      aol::ParallelSSORPreconditioner<double> ( nonSymMat ).apply ( nonSymRhs, nonSymParDest );
+      nonSymParDest -= nonSymSeqDest;
+      parallelFailed |= ( nonSymParDest.getMaxAbsValue() > 1e-12 * nonSymSeqDest.getMaxAbsValue() );
+      aol::ILU0Preconditioner<double, aol::SparseMatrix<double> > ( nonSymMat ).apply ( nonSymRhs, nonSymSeqDest );
+      const aol::ParallelILU0Preconditioner<double> nonSymILU0 ( nonSymMat );
+      nonSymILU0.apply ( nonSymRhs, nonSymParDest );
+      nonSymParDest -= nonSymSeqDest;
+      parallelFailed |= ( nonSymParDest.getMaxAbsValue() > 1e-12 * nonSymSeqDest.getMaxAbsValue() );
+
+      aol::PBiCGStabInverse<aol::Vector<double> > bicgstab ( nonSymMat, nonSymILU0, 1e-20, 500, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE );
+      bicgstab.setQuietMode ( true );
+      nonSymParDest.setZero();
+      bicgstab.apply ( nonSymRhs, nonSymParDest );
+      nonSymMat.apply ( nonSymParDest, nonSymSeqDest );
+      nonSymSeqDest -= nonSymRhs;
+      parallelFailed |= ( nonSymSeqDest.norm() > 1e-8 * nonSymRhs.norm() );
+
+      // Diagonal entries close to zero are treated as one, like in SSORPreconditioner with CHECK_ZERO_DIAG.
+      aol::SparseMatrix<double> diagMat ( 3, 3 );
+      diagMat.set ( 0, 0, 2 );
+      diagMat.set ( 1, 1, 1e-30 );
+      diagMat.set ( 2, 2, 4 );
+      aol::Vector<double> diagArg ( 3 ), diagDest ( 3 );
+      diagArg.setAll ( 1 );
+      aol::ParallelSSORPreconditioner<double> ( diagMat ).apply ( diagArg, diagDest );
+      parallelFailed |= ( diagDest[0] != 0.5 ) || ( diagDest[1] != 1 ) || ( diagDest[2] != 0.25 );
+
+      // Empty matrices have empty preconditioners.
+      const aol::SparseMatrix<double> emptyMat ( 0, 0 );
+      aol::Vector<double> emptyArg ( 0 ), emptyDest ( 0 );
+      aol::ParallelSSORPreconditioner<double> ( emptyMat ).apply ( emptyArg, emptyDest );
+      aol::ParallelILU0Preconditioner<double> ( emptyMat ).apply ( emptyArg, emptyDest );
+
+      if ( !parallelFailed )
+        cerr << "OK." << endl;
+      else {
+        cerr << "FAILED!" << endl;
+        failed = true;
+      }
+    }
+
     {
       cerr << "--- Testing aol::Matrix<double>::operator+=/operator-= ... ";
       aol::FullMatrix<double> M0 ( 5, 5 );
@@ -4,6 +4,7 @@
 #include <anisotropies.h>
 #include <anisotropyVisualization.h>
 #include <arrayExtensions.h>
+#include <arrayFileProbe.h>
 #include <array.h>
 #include <auxiliary.h>
 #include <bitArray.h>
@@ -41,10 +42,13 @@
 #include <levelSetDrawer.h>
 #include <levelSet.h>
 #include <linearSmoothOp.h>
+#include <mappedScalarArray.h>
 #include <mcm.h>
 #include <morphology.h>
+#include <multigrid.h>
 #include <multiDObject.h>
 #include <multilevelArray.h>
+#include <multilinStencilOp.h>
 #include <mutualInformation.h>
 #include <ocTree.h>
 #include <paramReg.h>
@@ -63,6 +67,7 @@
 #include <registration.h>
 #include <restriction.h>
 #include <scalarArray.h>
+#include <seriesStatistics.h>
 #include <shapeLevelsetGenerator.h>
 #include <simplexBaseFuncSetTFE.h>
 #include <simplexBaseFunctionSet.h>
@@ -70,11 +75,272 @@
 #include <simplexGrid.h>
 #include <simplexLookup.h>
 #include <sweeping.h>
+#include <tiledArrayFile.h>
 #include <tiledSpace.h>
 #include <UGBMatrix.h>
 #include <multiArray.h>
 #include <Willmore.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Solves the Poisson problem -Laplace u = 1 with zero Dirichlet boundary values on a grid of the given level with
+ * PCG preconditioned by a multigrid V cycle and with W cycles. Returns the number of PCG iterations and cycles needed
+ * and whether the solutions agree with the one of PCG with diagonal preconditioner.
+ */
+template <typename ConfType>
+bool solvePoissonWithMultigrid ( const int Level, int &NumPCGIterations, int &NumCycles ) {
+  typedef typename ConfType::RealType RealType;
+  const typename ConfType::InitType grid ( Level, ConfType::Dim );
+  typename ConfType::MatrixType mat ( grid );
+  aol::StiffOp<ConfType> ( grid, aol::ONTHEFLY ).assembleAddMatrix ( mat );
+  aol::Vector<RealType> one ( grid ), rhs ( grid );
+  one.setAll ( 1 );
+  aol::MassOp<ConfType> ( grid, aol::ONTHEFLY ).apply ( one, rhs );
+  qc::GridDefinition::OldFullBoundaryNodeIterator bit;
+  for ( bit = grid.begin(); bit != grid.end(); ++bit ) {
+    const int i = bit->x() + grid.getWidth() * bit->y() + grid.getWidth() * grid.getWidth() * bit->z();
+    mat.setRowColToZero ( i );
+    mat.setDiag ( i, 1 );
+    rhs[i] = 0;
+  }
+
+  aol::Vector<RealType> uDiag ( grid ), uPCG ( grid ), uCycles ( grid );
+  aol::DiagonalPreconditioner<aol::Vector<RealType> > diagPrec ( mat );
+  aol::PCGInverse<aol::Vector<RealType> > diagPCG ( mat, diagPrec, 1e-24, 1000, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE );
+  diagPCG.setQuietMode ( true );
+  diagPCG.apply ( rhs, uDiag );
+
+  const qc::GeometricMultigrid<RealType> multigrid ( grid, mat );
+  aol::PCGInverse<aol::Vector<RealType> > mgPCG ( mat, multigrid, 1e-24, 100, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE );
+  mgPCG.setQuietMode ( true );
+  mgPCG.apply ( rhs, uPCG );
+  NumPCGIterations = mgPCG.getCount();
+
+  qc::GeometricMultigrid<RealType> wCycle ( grid, mat, qc::MULTIGRID_W_CYCLE );
+  qc::MultigridInverse<RealType> cycles ( wCycle, 1e-24, 100, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE );
+  cycles.setQuietMode ( true );
+  cycles.apply ( rhs, uCycles );
+  NumCycles = cycles.getCount();
+
+  const RealType maxValue = uDiag.getMaxAbsValue();
+  uPCG -= uDiag;
+  uCycles -= uDiag;
+  return ( uPCG.getMaxAbsValue() < 1e-8 * maxValue ) && ( uCycles.getMaxAbsValue() < 1e-8 * maxValue );
+}
+
+//! Nonlinear FE operator with the integrand u^3 + 1, it can also traverse the elements serially like before aol::FEElementSlabs.
+template <typename ConfiguratorType>
+class CubicNonlinearityOp : public aol::FENonlinOpInterface<ConfiguratorType, CubicNonlinearityOp<ConfiguratorType> > {
+public:
+  typedef typename ConfiguratorType::RealType RealType;
+
+  explicit CubicNonlinearityOp ( const typename ConfiguratorType::InitType &Grid )
+    : aol::FENonlinOpInterface<ConfiguratorType, CubicNonlinearityOp<ConfiguratorType> > ( Grid ) {}
+
+  void getNonlinearity ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFunc,
+                         const typename ConfiguratorType::ElementType &El,
+                         int QuadPoint, const typename ConfiguratorType::DomVecType &/*RefCoord*/,
+                         RealType &NL ) const {
+    NL = aol::Cub ( DiscFunc.evaluateAtQuadPoint ( El, QuadPoint ) ) + 1;
+  }
+
+  void applyAddSerially ( const aol::Vector<RealType> &Arg, aol::Vector<RealType> &Dest ) const {
+    const aol::DiscreteFunctionDefault<ConfiguratorType> discrFunc ( this->getConfigurator(), Arg );
+    this->applyAddOnSlab ( discrFunc, this->getConfigurator().begin(), this->getConfigurator().end(), Dest );
+  }
+};
+
+//! The integral of u^4, it can also traverse the elements serially like before aol::FEElementSlabs.
+template <typename ConfiguratorType>
+class QuarticEnergy : public aol::FENonlinIntegrationScalarInterface<ConfiguratorType, QuarticEnergy<ConfiguratorType> > {
+public:
+  typedef typename ConfiguratorType::RealType RealType;
+
+  explicit QuarticEnergy ( const typename ConfiguratorType::InitType &Grid )
+    : aol::FENonlinIntegrationScalarInterface<ConfiguratorType, QuarticEnergy<ConfiguratorType> > ( Grid ) {}
+
+  RealType evaluateIntegrand ( const aol::DiscreteFunctionDefault<ConfiguratorType> &DiscFunc,
+                               const typename ConfiguratorType::ElementType &El,
+                               int QuadPoint, const typename ConfiguratorType::DomVecType &/*RefCoord*/ ) const {
+    return aol::Sqr ( aol::Sqr ( DiscFunc.evaluateAtQuadPoint ( El, QuadPoint ) ) );
+  }
+
+  RealType integrateSerially ( const aol::Vector<RealType> &Arg ) const {
+    const aol::DiscreteFunctionDefault<ConfiguratorType> discrFunc ( this->getConfigurator(), Arg );
+    return this->integrateOnSlab ( discrFunc, this->getConfigurator().begin(), this->getConfigurator().end() );
+  }
+};
+
+/**
+ * Checks that the nonlinear FE operators traversing the elements in parallel slabs give the same results as the
+ * serial traversal (up to the summation order) and, with OpenMP, exactly the same results for any number of threads.
+ */
+template <typename ConfiguratorType>
+bool compareSlabTraversalWithSerialTraversal ( const int Level ) {
+  typedef typename ConfiguratorType::RealType RealType;
+  const typename ConfiguratorType::InitType grid ( Level, ConfiguratorType::Dim );
+  aol::Vector<RealType> arg ( grid ), dest ( grid ), serialDest ( grid );
+  for ( int i = 0; i < arg.size(); ++i )
+    arg[i] = sin ( 0.1 * i ) + 0.5;
+
+  const CubicNonlinearityOp<ConfiguratorType> op ( grid );
+  const QuarticEnergy<ConfiguratorType> energy ( grid );
+  op.apply ( arg, dest );
+  op.applyAddSerially ( arg, serialDest );
+  aol::Scalar<RealType> integral;
+  energy.apply ( arg, integral );
+  const RealType serialIntegral = energy.integrateSerially ( arg );
+
+  bool success = ( aol::Abs ( integral[0] - serialIntegral ) < 1e-13 * serialIntegral );
+  serialDest -= dest;
+  success &= ( serialDest.getMaxAbsValue() < 1e-13 * dest.getMaxAbsValue() );
+
+#ifdef _OPENMP
+  const int maxNumThreads = omp_get_max_threads();
+  for ( int numThreads = 1; numThreads <= 4; ++numThreads ) {
+    omp_set_num_threads ( numThreads );
+    aol::Vector<RealType> threadDest ( grid );
+    op.apply ( arg, threadDest );
+    aol::Scalar<RealType> threadIntegral;
+    energy.apply ( arg, threadIntegral );
+    success &= ( threadDest == dest ) && ( threadIntegral[0] == integral[0] );
+  }
+  omp_set_num_threads ( maxNumThreads );
+#endif
+  return success;
+}
+
+/**
+ * Compares qc::DeformImage with qc::deformImageWithNodeIterator for a deformation that moves part of the domain outside of
+ * it and contains a NaN, using all combinations of extension and interpolation. The results have to be identical.
+ */
+template <typename ConfiguratorType>
+bool compareDeformImageWithNodeIterator ( const int Level ) {
+  typedef typename ConfiguratorType::RealType RealType;
+  const typename ConfiguratorType::InitType grid ( Level, ConfiguratorType::Dim );
+  aol::Vector<RealType> image ( grid ), extendImage ( grid ), deformed ( grid ), reference ( grid );
+  aol::MultiVector<RealType> phi ( ConfiguratorType::Dim, grid.getNumberOfNodes() );
+  for ( int j = 0; j < image.size(); ++j ) {
+    const RealType s = static_cast<RealType> ( j ) / image.size();
+    image[j] = sin ( 20 * s ) + s;
+    extendImage[j] = -s;
+    for ( int i = 0; i < ConfiguratorType::Dim; ++i )
+      phi[i][j] = static_cast<RealType> ( 0.2 * sin ( ( 7 + i ) * s + i ) );
+  }
+  phi[ConfiguratorType::Dim - 1][image.size() / 3] = aol::NumberTrait<RealType>::NaN;
+
+  bool success = true;
+  for ( int extend = 0; extend <= 1; ++extend ) {
+    for ( int nearest = 0; nearest <= 1; ++nearest ) {
+      qc::DeformImage<ConfiguratorType> ( image, grid, deformed, phi, extend != 0, static_cast<RealType> ( 2 ), nearest != 0 );
+      qc::deformImageWithNodeIterator<ConfiguratorType> ( image, grid, reference, phi, extend != 0, static_cast<RealType> ( 2 ), nearest != 0 );
+      // Without extension, the NaN position is clamped and interpolated, so the NaN is compared separately.
+      success &= ( aol::isNaN ( deformed[image.size() / 3] ) == aol::isNaN ( reference[image.size() / 3] ) );
+      deformed[image.size() / 3] = reference[image.size() / 3] = 0;
+      success &= ( deformed == reference );
+    }
+  }
+  success &= ( reference.numOccurence ( 2 ) > 0 );
+
+  qc::DeformImage<ConfiguratorType> ( image, grid, deformed, phi, extendImage );
+  qc::deformImageWithNodeIterator<ConfiguratorType> ( image, grid, reference, phi, true, 0, false, &extendImage );
+  success &= ( deformed == reference );
+  return success;
+}
+
+/**
+ * Writes a minimal Gatan Digital Micrograph file of version 3 or 4 for testing qc::DM3Reader. Tag directories and
+ * tags have to be added in file order, the number of entries of each directory has to be given when starting it.
+ */
+class DMTestFileWriter {
+  const int _version;
+  string _data;
+  int64_t _lastValueOffset;
+
+  void appendBigEndian ( const int64_t Value, const int NumBytes ) {
+    for ( int i = NumBytes - 1; i >= 0; --i )
+      _data += static_cast<char> ( ( Value >> ( 8 * i ) ) & 0xFF );
+  }
+
+  //! Integers of the tag structure have 4 bytes in version 3 and 8 bytes in version 4.
+  void appendInteger ( const int64_t Value ) {
+    appendBigEndian ( Value, ( _version == 3 ) ? 4 : 8 );
+  }
+
+  void appendEntryHeader ( const int TagIdentifier, const string &Name ) {
+    _data += static_cast<char> ( TagIdentifier );
+    appendBigEndian ( Name.size(), 2 );
+    _data += Name;
+    if ( _version == 4 )
+      appendBigEndian ( 0, 8 );
+  }
+
+  //! Values are stored little endian, like on the machines this test runs on.
+  template <typename DataType>
+  void appendValues ( const DataType *Values, const int NumValues ) {
+    _lastValueOffset = _data.size();
+    _data.append ( reinterpret_cast<const char*> ( Values ), NumValues * sizeof ( DataType ) );
+  }
+
+public:
+  DMTestFileWriter ( const int Version, const int NumRootEntries ) : _version ( Version ), _lastValueOffset ( -1 ) {
+    appendBigEndian ( Version, 4 );
+    appendInteger ( 0 );
+    appendBigEndian ( 1, 4 );
+    _data.append ( "\1\0", 2 );
+    appendInteger ( NumRootEntries );
+  }
+
+  //! An empty Name creates an unnamed directory, qc::DM3Reader names it by its index in the parent directory.
+  void beginDirectory ( const string &Name, const int NumEntries ) {
+    appendEntryHeader ( 20, Name );
+    _data.append ( "\1\0", 2 );
+    appendInteger ( NumEntries );
+  }
+
+  template <typename DataType>
+  void addValue ( const string &Name, const int Type, const DataType Value ) {
+    appendEntryHeader ( 21, Name );
+    _data += "%%%%";
+    appendInteger ( 1 );
+    appendInteger ( Type );
+    appendValues ( &Value, 1 );
+  }
+
+  template <typename DataType>
+  void addArray ( const string &Name, const int ElementType, const std::vector<DataType> &Values ) {
+    appendEntryHeader ( 21, Name );
+    _data += "%%%%";
+    appendInteger ( 3 );
+    appendInteger ( 20 );
+    appendInteger ( ElementType );
+    appendInteger ( Values.size() );
+    appendValues ( &Values[0], Values.size() );
+  }
+
+  //! A tag identifier 0 without any data, qc::DM3Reader skips it.
+  void addNullTag ( ) {
+    _data += '\0';
+  }
+
+  void addString ( const string &Name, const string &Value ) {
+    addArray ( Name, 4, std::vector<uint16_t> ( Value.begin(), Value.end() ) );
+  }
+
+  //! Position of the values of the last tag added in the file.
+  int64_t getLastValueOffset ( ) const {
+    return _lastValueOffset;
+  }
+
+  void save ( const char *FileName ) const {
+    std::ofstream out ( FileName, ios::binary );
+    out.write ( _data.data(), _data.size() );
+  }
+};
+
 int main( int, char** ) {
 
   try {
@@ -279,9 +545,8 @@ int main( int, char** ) {
       cerr << success;
 
 
-// does not work yet
-/*      qc::ScalarArray<unsigned short, qc::QC_3D> array3dShort ( "../../examples/testdata/volume_9.dat.bz2" );
-      for ( int i = 0; i < array3dShort.size(); ++i ) array3dShort[i] = 42023 * testArray[i];
+      qc::ScalarArray<unsigned short, qc::QC_3D> array3dShort ( "../../examples/testdata/volume_9.dat.bz2" );
+      for ( int i = 0; i < array3dShort.size(); ++i ) array3dShort[i] = static_cast<unsigned short> ( 42023 * aol::Abs ( testArray[i] ) );
 
       array3dShort.save( "savetest.bz2", qc::PGM_UNSIGNED_SHORT_BINARY );
       qc::ScalarArray<unsigned short, qc::QC_3D> array6("savetest.bz2");
@@ -290,7 +555,18 @@ int main( int, char** ) {
       success = success && ( array3dShort == array6 );
 
       cerr << success;
-*/
+
+      qc::ScalarArray<int, qc::QC_3D> array3dInt ( array3dShort.getNumX(), array3dShort.getNumY(), array3dShort.getNumZ() );
+      for ( int i = 0; i < array3dInt.size(); ++i ) array3dInt[i] = static_cast<int> ( 42023 * testArray[i] );
+
+      array3dInt.save( "savetest.bz2", qc::PGM_SIGNED_INT_BINARY );
+      qc::ScalarArray<int, qc::QC_3D> array7("savetest.bz2");
+      remove( "savetest.bz2" );
+
+      success = success && ( array3dInt == array7 );
+
+      cerr << success;
+
       if(success)
         cerr << "..... OK\n";
     }
@@ -466,6 +742,515 @@ int main( int, char** ) {
         cerr << " OK" << endl;
     }
 
+    {
+      cerr << "--- Testing qc::ScalarArray<double, qc::QC_2D>::cropAndBinFrom ... " ;
+      qc::ScalarArray<double, qc::QC_2D> array ( 11, 9 ), binned;
+      for ( int j = 0; j < array.getNumY(); ++j )
+        for ( int i = 0; i < array.getNumX(); ++i )
+          array.set ( i, j, 10 * j + i );
+
+      // Crop [1,10) x [2,9) and bin 3x3, the last row of the crop is discarded.
+      binned.cropAndBinFrom ( array, aol::Vec2<int> ( 1, 2 ), aol::Vec2<int> ( 9, 7 ), 3 );
+      success &= ( binned.getNumX() == 3 ) && ( binned.getNumY() == 2 );
+      for ( int j = 0; j < binned.getNumY(); ++j )
+        for ( int i = 0; i < binned.getNumX(); ++i )
+          success &= aol::appeqAbsolute ( binned.get ( i, j ), 10. * ( 3 * j + 3 ) + ( 3 * i + 2 ) );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::MappedScalarArray<double, qc::QC_2D> ... " ;
+      qc::ScalarArray<double, qc::QC_2D> array ( 13, 7 );
+      for ( int i = 0; i < array.size(); ++i )
+        array[i] = 0.5 * i - 3;
+      array.save ( "mapped.dat", qc::PGM_DOUBLE_BINARY );
+      array.save ( "mapped.dat.bz2", qc::PGM_DOUBLE_BINARY );
+      array.save ( "mappedFloat.dat", qc::PGM_FLOAT_BINARY );
+
+      // The data of the uncompressed double file is used in place, the other files are loaded.
+      qc::MappedScalarArray<double, qc::QC_2D> mapped ( "mapped.dat" ), compressed ( "mapped.dat.bz2" ), converted ( "mappedFloat.dat" );
+      success &= mapped.isMapped() && !compressed.isMapped() && !converted.isMapped();
+      success &= ( mapped.getNumX() == 13 ) && ( mapped.getNumY() == 7 ) && ( mapped == array ) && ( compressed == array ) && ( converted == array );
+
+      // Modifying the mapped array may not change the file.
+      mapped[0] = 42;
+      qc::ScalarArray<double, qc::QC_2D> reloaded ( "mapped.dat" );
+      success &= ( reloaded == array );
+
+      remove ( "mapped.dat" );
+      remove ( "mapped.dat.bz2" );
+      remove ( "mappedFloat.dat" );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+#ifdef USE_LIB_Z
+    {
+      cerr << "--- Testing qc::TiledArrayFile ... " ;
+      qc::ScalarArray<double, qc::QC_2D> array ( 13, 7 );
+      for ( int i = 0; i < array.size(); ++i )
+        array[i] = 0.25 * i - 3;
+      // Small tiles such that the tiles at the boundary are clipped.
+      qc::TiledArrayFile::write ( "tiled.qtz", array.getData(), 2, aol::Vec3<int> ( 13, 7, 1 ), qc::TILED_FLOAT_BINARY, NULL, aol::Vec3<int> ( 5, 3, 0 ) );
+      qc::ScalarArray<double, qc::QC_2D> loaded ( "tiled.qtz" ), region;
+      success &= ( loaded == array );
+      region.loadRegion ( "tiled.qtz", aol::Vec2<int> ( 4, 2 ), aol::Vec2<int> ( 7, 4 ) );
+      qc::ScalarArray<double, qc::QC_2D> expected ( array );
+      expected.crop ( aol::Vec2<int> ( 4, 2 ), aol::Vec2<int> ( 7, 4 ) );
+      success &= ( region == expected );
+
+      // Unsigned short values are rounded and clipped.
+      array.save ( "tiled.qtz", qc::TILED_UNSIGNED_SHORT_BINARY );
+      qc::ScalarArray<unsigned short, qc::QC_2D> loadedShort ( "tiled.qtz" );
+      for ( int i = 0; i < array.size(); ++i )
+        success &= ( loadedShort[i] == static_cast<unsigned short> ( aol::Max ( 0., floor ( array[i] + 0.5 ) ) ) );
+
+      qc::ScalarArray<float, qc::QC_3D> array3D ( 70, 5, 66 );
+      for ( int i = 0; i < array3D.size(); ++i )
+        array3D[i] = static_cast<float> ( i % 97 ) - 0.5f;
+      array3D.save ( "tiled.qtz", qc::TILED_FLOAT_BINARY );
+      qc::ScalarArray<float, qc::QC_3D> loaded3D ( "tiled.qtz" ), region3D;
+      region3D.loadRegion ( "tiled.qtz", aol::Vec3<int> ( 60, 1, 62 ), aol::Vec3<int> ( 8, 3, 4 ) );
+      success &= ( loaded3D == array3D ) && ( region3D.get ( 7, 2, 3 ) == array3D.get ( 67, 3, 65 ) ) && ( region3D.get ( 0, 0, 0 ) == array3D.get ( 60, 1, 62 ) );
+
+      remove ( "tiled.qtz" );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+#endif
+
+    {
+      cerr << "--- Testing qc::probeArrayFile ... " ;
+      const qc::ArrayFileInfo info = qc::probeArrayFile ( "../../examples/testdata/image_129.pgm.bz2" );
+      success &= ( info.dim == 2 ) && ( info.size == aol::Vec3<int> ( 129, 129, 1 ) ) && info.compressed;
+
+      const qc::ArrayFileInfo info3D = qc::probeArrayFile ( "../../examples/testdata/volume_9.dat.bz2" );
+      success &= ( info3D.dim == 3 ) && ( info3D.size == aol::Vec3<int> ( 9, 9, 9 ) );
+
+      qc::ScalarArray<unsigned short, qc::QC_2D> array ( 31, 17 );
+      for ( int i = 0; i < array.size(); ++i )
+        array[i] = static_cast<unsigned short> ( 3 * i );
+      array.save ( "probe.q2bz", qc::PGM_UNSIGNED_SHORT_BINARY );
+      const qc::ArrayFileInfo infoShort = qc::probeArrayFile ( "probe.q2bz" );
+      success &= ( infoShort.type == qc::PGM_UNSIGNED_SHORT_BINARY ) && ( infoShort.size == aol::Vec3<int> ( 31, 17, 1 ) )
+                 && ( infoShort.maxHint == 3 * ( array.size() - 1 ) ) && ( infoShort.payloadOffset % 16 == 0 );
+      remove ( "probe.q2bz" );
+
+      array.saveTIFF ( "probe.tif" );
+      const qc::ArrayFileInfo infoTIFF = qc::probeArrayFile ( "probe.tif" );
+      std::ifstream tiff ( "probe.tif", ios::binary );
+      tiff.seekg ( infoTIFF.payloadOffset + 5 * sizeof ( float ) );
+      success &= ( infoTIFF.type == qc::PGM_FLOAT_BINARY ) && ( infoTIFF.size == aol::Vec3<int> ( 31, 17, 1 ) ) && !infoTIFF.compressed
+                 && ( aol::readBinaryData<float, float> ( tiff ) == 15 );
+      tiff.close();
+      remove ( "probe.tif" );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::DM3Reader with synthetic DM3 and DM4 files ... " ;
+      const int numX = 5, numY = 3;
+      std::vector<uint16_t> data ( numX * numY );
+      for ( int i = 0; i < numX * numY; ++i )
+        data[i] = static_cast<uint16_t> ( 1000 * i + 7 );
+
+      for ( int version = 3; version <= 4; ++version ) {
+        DMTestFileWriter writer ( version, 1 );
+        writer.beginDirectory ( "ImageList", 1 );
+        writer.beginDirectory ( "", 2 );
+        writer.beginDirectory ( "ImageData", 4 );
+        writer.beginDirectory ( "Calibrations", 1 );
+        writer.beginDirectory ( "Dimension", 1 );
+        writer.beginDirectory ( "", 2 );
+        writer.addValue ( "Scale", 6, 0.5f );
+        writer.addString ( "Units", "nm" );
+        writer.addArray ( "Data", 4, data );
+        const int64_t dataOffset = writer.getLastValueOffset();
+        writer.addValue<uint32_t> ( "DataType", 5, 10 );
+        writer.beginDirectory ( "Dimensions", 2 );
+        writer.addValue<uint32_t> ( "", 5, numX );
+        writer.addValue<uint32_t> ( "", 5, numY );
+        writer.beginDirectory ( "ImageTags", 1 );
+        writer.beginDirectory ( "DataBar", 4 );
+        writer.addValue ( "Exposure Time (s)", 7, 0.125 );
+        writer.addString ( "Acquisition Date", "2/9/2014" );
+        writer.addNullTag ( );
+        writer.addValue<int16_t> ( "Offset", 2, -7 );
+        const string fileName = ( version == 3 ) ? "test.dm3" : "test.dm4";
+        writer.save ( fileName.c_str() );
+
+        qc::DM3Reader reader ( fileName );
+        success &= reader.hasTag ( "ImageList.0.ImageTags.DataBar.Offset" ) && !reader.hasTag ( "ImageList.0.ImageTags.Offset" )
+                   && ( reader.getTag ( "ImageList.0.ImageTags.DataBar" ).type == 0 ) && ( reader.getTag ( "ImageList.0.ImageTags.DataBar" ).length == 4 );
+        success &= ( reader.getPixelSize() == 0.5 ) && ( reader.getPixelSizeUnit() == "nm" ) && ( reader.getExposureTime() == 0.125 )
+                   && ( reader.getAcquisitionDate() == "2/9/2014" ) && ( reader.getTagValue<int> ( "ImageList.0.ImageTags.DataBar.Offset" ) == -7 )
+                   && ( reader.getTagValue<int> ( "ImageList.0.ImageData.Dimensions.1" ) == numY )
+                   && ( reader.getTagValue<int> ( "ImageList.0.ImageData.Data", 4 ) == data[4] );
+        success &= ( reader.getDataEntry().offset == dataOffset ) && ( reader.getTag ( "ImageList.0.ImageData.Data" ).offset == dataOffset )
+                   && ( reader.getDataEntry().numX == numX ) && ( reader.getDataEntry().numY == numY ) && ( reader.getDataEntry().declaredType == 10 );
+
+        qc::ScalarArray<unsigned short, qc::QC_2D> image;
+        reader.exportDataToScalarArray ( image );
+        for ( int i = 0; i < numX * numY; ++i )
+          success &= ( image[i] == data[i] );
+
+        // Replace the image data and read the result again.
+        qc::ScalarArray<double, qc::QC_2D> newImage ( numX, numY );
+        for ( int i = 0; i < newImage.size(); ++i )
+          newImage[i] = 3 * i;
+        reader.saveQuocDataInDM3Container ( newImage, "test_out" );
+        const string outFileName = ( version == 3 ) ? "test_out.dm3" : "test_out.dm4";
+        qc::DM3Reader newReader ( outFileName );
+        newReader.exportDataToScalarArray ( image );
+        for ( int i = 0; i < numX * numY; ++i )
+          success &= ( image[i] == newImage[i] );
+        success &= ( newReader.getDataEntry().offset == dataOffset ) && ( newReader.getAcquisitionDate() == "2/9/2014" )
+                   && ( newReader.getTagValue<int> ( "ImageList.0.ImageTags.DataBar.Offset" ) == -7 );
+
+        remove ( fileName.c_str() );
+        remove ( outFileName.c_str() );
+      }
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::DM3Reader::saveFramesAsScalarArrays ... " ;
+      const int numX = 5, numY = 3, numFrames = 7;
+      std::vector<uint16_t> data ( numX * numY * numFrames );
+      for ( unsigned int i = 0; i < data.size(); ++i )
+        data[i] = static_cast<uint16_t> ( 37 * i + 5 );
+
+      DMTestFileWriter writer ( 4, 1 );
+      writer.beginDirectory ( "ImageList", 1 );
+      writer.beginDirectory ( "", 1 );
+      writer.beginDirectory ( "ImageData", 3 );
+      writer.addArray ( "Data", 4, data );
+      writer.addValue<uint32_t> ( "DataType", 5, 10 );
+      writer.beginDirectory ( "Dimensions", 3 );
+      writer.addValue<uint32_t> ( "", 5, numX );
+      writer.addValue<uint32_t> ( "", 5, numY );
+      writer.addValue<uint32_t> ( "", 5, numFrames );
+      writer.save ( "test_stack.dm4" );
+
+      // With three threads, the last batch only contains one frame.
+      qc::DM3Reader reader ( "test_stack.dm4" );
+      for ( int numThreads = 1; numThreads <= 3; numThreads += 2 ) {
+        reader.saveFramesAsScalarArrays<unsigned short> ( "test_frame_%03d.q2bz", qc::PGM_UNSIGNED_SHORT_BINARY, numThreads );
+        for ( int frame = 0; frame < numFrames; ++frame ) {
+          const string frameFileName = aol::strprintf ( "test_frame_%03d.q2bz", frame );
+          qc::ScalarArray<unsigned short, qc::QC_2D> image ( frameFileName );
+          success &= ( image.getNumX() == numX ) && ( image.getNumY() == numY );
+          for ( int i = 0; i < image.size(); ++i )
+            success &= ( image[i] == data[frame * numX * numY + i] );
+          remove ( frameFileName.c_str() );
+        }
+      }
+
+      // Failures inside the parallel region are reported by an exception after it.
+      bool exceptionThrown = false;
+      try {
+        reader.saveFramesAsScalarArrays<unsigned short> ( "nonexistentDirectory/test_frame_%03d.q2bz", qc::PGM_UNSIGNED_SHORT_BINARY, 3 );
+      }
+      catch ( aol::Exception &ex ) {
+        ex.consume();
+        exceptionThrown = true;
+      }
+      success &= exceptionThrown;
+      remove ( "test_stack.dm4" );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::MultilinStencilMassOp and qc::MultilinStencilStiffOp ... " ;
+      typedef qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double, qc::QC_2D, 3> > ConfType2D;
+      typedef qc::RectangularGridConfigurator<double, qc::QC_3D, aol::GaussQuadrature<double, qc::QC_3D, 3> > ConfType3D;
+      const qc::GridDefinition grid2D ( 3, qc::QC_2D );
+      const qc::RectangularGrid<qc::QC_3D> grid3D ( aol::Vec3<int> ( 6, 4, 3 ) );
+
+      aol::Vector<double> arg2D ( grid2D ), dest2D ( grid2D ), ref2D ( grid2D );
+      for ( int i = 0; i < arg2D.size(); ++i )
+        arg2D[i] = sin ( 0.7 * i ) + 0.1 * i;
+      aol::Vector<double> arg3D ( grid3D ), dest3D ( grid3D ), ref3D ( grid3D );
+      for ( int i = 0; i < arg3D.size(); ++i )
+        arg3D[i] = cos ( 0.3 * i ) - 0.05 * i;
+
+      // Compare with the assembled matrices, applyAdd has to add to Dest.
+      dest2D.setAll ( 1 );
+      ref2D.setAll ( 1 );
+      qc::MultilinStencilMassOp<ConfType2D> ( grid2D ).applyAdd ( arg2D, dest2D );
+      aol::MassOp<ConfType2D> ( grid2D, aol::ASSEMBLED ).applyAdd ( arg2D, ref2D );
+      dest2D -= ref2D;
+      success &= ( dest2D.getMaxAbsValue() < 1e-14 );
+
+      qc::MultilinStencilStiffOp<ConfType2D> ( grid2D ).apply ( arg2D, dest2D );
+      aol::StiffOp<ConfType2D> ( grid2D, aol::ASSEMBLED ).apply ( arg2D, ref2D );
+      dest2D -= ref2D;
+      success &= ( dest2D.getMaxAbsValue() < 1e-12 );
+
+      qc::MultilinStencilMassOp<ConfType3D> ( grid3D ).apply ( arg3D, dest3D );
+      aol::MassOp<ConfType3D> ( grid3D, aol::ASSEMBLED ).apply ( arg3D, ref3D );
+      dest3D -= ref3D;
+      success &= ( dest3D.getMaxAbsValue() < 1e-14 );
+
+      qc::MultilinStencilStiffOp<ConfType3D> ( grid3D ).apply ( arg3D, dest3D );
+      aol::StiffOp<ConfType3D> ( grid3D, aol::ASSEMBLED ).apply ( arg3D, ref3D );
+      dest3D -= ref3D;
+      success &= ( dest3D.getMaxAbsValue() < 1e-12 );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing aol::FELinOpInterface with frozen matrices ... " ;
+      typedef qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double, qc::QC_2D, 3>, aol::SparseMatrix<double> > ConfType;
+      const qc::GridDefinition grid ( 4, qc::QC_2D );
+      aol::Vector<double> arg ( grid ), dest ( grid ), frozenDest ( grid );
+      for ( int i = 0; i < arg.size(); ++i )
+        arg[i] = sin ( 0.7 * i ) + 0.1 * i;
+
+      // ASSEMBLED operators freeze their matrix when assembling it. The CSRMatrix keeps the order of the entries of
+      // the SparseMatrix, so the results are identical to the ones of the assembled matrix.
+      aol::StiffOp<ConfType> stiffOp ( grid, aol::ASSEMBLED );
+      success &= !stiffOp.isFrozen();
+      stiffOp.apply ( arg, frozenDest );
+      success &= stiffOp.isFrozen() && ( stiffOp.getFrozenMatrix().getNumRows() == arg.size() );
+      stiffOp.getMatrix().apply ( arg, dest );
+      success &= ( dest == frozenDest );
+
+      // After changing the assembled matrix, freeze makes the operator use the changed matrix.
+      stiffOp.getMatrix() *= 2;
+      stiffOp.freeze();
+      stiffOp.apply ( arg, frozenDest );
+      dest *= 2;
+      success &= ( dest == frozenDest );
+
+      // Solvers use the frozen matrix without any further setup.
+      aol::MassOp<ConfType> massOp ( grid, aol::ASSEMBLED ), massOpOnTheFly ( grid, aol::ONTHEFLY );
+      aol::Vector<double> solution ( grid ), reference ( grid );
+      aol::CGInverse<aol::Vector<double> > cg ( massOp, 1e-20, 500, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE ), cgOnTheFly ( massOpOnTheFly, 1e-20, 500, aol::STOPPING_RELATIVE_TO_RIGHT_HAND_SIDE );
+      cg.setQuietMode ( true );
+      cgOnTheFly.setQuietMode ( true );
+      cg.apply ( arg, solution );
+      cgOnTheFly.apply ( arg, reference );
+      success &= massOp.isFrozen() && ( cg.getCount() == cgOnTheFly.getCount() );
+      massOpOnTheFly.apply ( solution, dest );
+      dest -= arg;
+      success &= ( dest.norm() < 1e-8 * arg.norm() );
+      reference -= solution;
+      success &= ( reference.norm() < 1e-8 * solution.norm() );
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing parallel element traversal of nonlinear FE operators ... " ;
+      success &= compareSlabTraversalWithSerialTraversal<qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double, qc::QC_2D, 3> > > ( 6 );
+      success &= compareSlabTraversalWithSerialTraversal<qc::QuocConfiguratorTraitMultiLin<double, qc::QC_3D, aol::GaussQuadrature<double, qc::QC_3D, 3> > > ( 4 );
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::GeometricMultigrid ... " ;
+      // The number of iterations must not grow with the grid level.
+      int numPCGIterations[3], numCycles[3];
+      for ( int i = 0; i < 3; ++i )
+        success &= solvePoissonWithMultigrid<qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double,qc::QC_2D,3> > > ( 5 + i, numPCGIterations[i], numCycles[i] );
+      success &= ( numPCGIterations[2] <= numPCGIterations[0] + 1 ) && ( numCycles[2] <= numCycles[0] + 1 ) && ( numPCGIterations[2] <= 15 );
+      for ( int i = 0; i < 2; ++i )
+        success &= solvePoissonWithMultigrid<qc::QuocConfiguratorTraitMultiLin<double, qc::QC_3D, aol::GaussQuadrature<double,qc::QC_3D,3> > > ( 3 + i, numPCGIterations[i], numCycles[i] );
+      success &= ( numPCGIterations[1] <= numPCGIterations[0] + 1 ) && ( numCycles[1] <= numCycles[0] + 1 ) && ( numPCGIterations[1] <= 15 );
+
+      // GeneralLinearSmoothOp with multigrid preconditioner
+      typedef qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double,qc::QC_2D,3> > ConfType;
+      const ConfType::InitType grid ( 6, qc::QC_2D );
+      qc::GeneralLinearSmoothOp<ConfType> smoothOp ( grid, 0.1 ), mgSmoothOp ( grid, 0.1 );
+      mgSmoothOp.setUseMultigrid ( true );
+      aol::Vector<double> arg ( grid ), dest ( grid ), mgDest ( grid );
+      for ( int i = 0; i < arg.size(); ++i )
+        arg[i] = ( ( i * 7 ) % 13 ) / 13.;
+      smoothOp.apply ( arg, dest );
+      mgSmoothOp.apply ( arg, mgDest );
+      mgDest -= dest;
+      success &= ( mgDest.getMaxAbsValue() < 1e-6 );
+
+      if ( success )
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::SeriesStatistics ... " ;
+      const int numPixels = 1000, numFrames = 9;
+      aol::MultiVector<double> frames ( numFrames, numPixels );
+      aol::RandomGenerator randomGenerator;
+      for ( int i = 0; i < numFrames; ++i ) {
+        for ( int j = 0; j < numPixels; ++j )
+          frames[i][j] = ( randomGenerator.rReal<double>() < 0.2 ) ? aol::NumberTrait<double>::Inf : randomGenerator.rReal<double>();
+      }
+      // The last pixel has no samples at all.
+      for ( int i = 0; i < numFrames; ++i )
+        frames[i][numPixels-1] = aol::NumberTrait<double>::Inf;
+
+      // Use small tiles to test the splitting into tiles, including a smaller last tile.
+      qc::SeriesStatistics<double> statistics ( numPixels, numFrames, "seriesStatistics.tmp", 7 * numFrames * sizeof ( double ) );
+      success &= ( statistics.getTileSize() == 7 );
+      aol::MultiVector<double> addedFrames;
+      aol::Vector<double> mean ( numPixels ), variance ( numPixels ), median ( numPixels ), numSamples ( numPixels ), reference ( numPixels );
+      for ( int i = 0; i < numFrames; ++i ) {
+        statistics.addFrame ( frames[i] );
+        addedFrames.appendReference ( frames[i] );
+        // Compare with the median of all frames in memory after an odd and an even number of frames.
+        if ( ( i == 4 ) || ( i == numFrames - 1 ) ) {
+          statistics.getMedian ( median, -1 );
+          addedFrames.getMedianVecOverComponents ( reference, -1 );
+          median -= reference;
+          success &= ( median.getMaxAbsValue() == 0 );
+        }
+      }
+
+      statistics.getMean ( mean, -1 );
+      statistics.getVariance ( variance, -1 );
+      statistics.getNumSamples ( numSamples );
+      for ( int j = 0; j < numPixels; ++j ) {
+        aol::Vector<double> samples;
+        for ( int i = 0; i < numFrames; ++i ) {
+          if ( frames[i][j] != aol::NumberTrait<double>::Inf )
+            samples.pushBack ( frames[i][j] );
+        }
+        success &= ( numSamples[j] == samples.size() );
+        if ( samples.size() > 0 )
+          success &= ( aol::Abs ( mean[j] - samples.getMeanValue() ) < 1e-14 ) && ( aol::Abs ( variance[j] - aol::Sqr ( samples.getStdDev() ) ) < 1e-14 );
+        else
+          success &= ( mean[j] == -1 ) && ( variance[j] == -1 );
+      }
+
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+#ifdef USE_LIB_FFTW
+    {
+      cerr << "--- Testing qc::LinearSmoothOp with FFT ... " ;
+      // The DCT-I basis functions are eigenvectors of the heat equation step, so the solution is known exactly.
+      const double tau = 0.002;
+      for ( int dim = qc::QC_2D; dim <= qc::QC_3D; ++dim ) {
+        const qc::GridDefinition grid ( 4, static_cast<qc::Dimension> ( dim ) );
+        const int width = grid.getWidth();
+        const int k[3] = { 3, 5, 2 };
+        aol::Vector<double> eigenvector ( grid ), dest ( grid );
+        double eigenvalue = 0;
+        for ( int d = 0; d < dim; ++d )
+          eigenvalue += 2 - 2 * cos ( aol::NumberTrait<double>::pi * k[d] / ( width - 1 ) );
+        eigenvalue = 1 + tau * aol::Sqr ( width - 1 ) * eigenvalue;
+        for ( qc::RectangularIterator<qc::QC_3D> it ( aol::Vec3<int> ( 0, 0, 0 ), aol::Vec3<int> ( width, width, ( dim == qc::QC_3D ) ? width : 1 ) ); it.notAtEnd(); ++it ) {
+          double value = 1;
+          for ( int d = 0; d < dim; ++d )
+            value *= cos ( aol::NumberTrait<double>::pi * k[d] * ( *it )[d] / ( width - 1 ) );
+          eigenvector[qc::ILexCombine3 ( ( *it )[0], ( *it )[1], ( *it )[2], width, width )] = value;
+        }
+
+        qc::LinearSmoothOp<double> linSmooth ( grid );
+        linSmooth.setTau ( tau );
+        linSmooth.setUseFFT ( true );
+        linSmooth.apply ( eigenvector, dest );
+        dest.addMultiple ( eigenvector, -1 / eigenvalue );
+        success &= ( dest.getMaxAbsValue() < 1e-12 );
+
+        // apply has to work in place.
+        dest = eigenvector;
+        linSmooth.apply ( dest, dest );
+        dest.addMultiple ( eigenvector, -1 / eigenvalue );
+        success &= ( dest.getMaxAbsValue() < 1e-12 );
+      }
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::FFTWPlanCache, FFTW wisdom and qc::computeFourierModulus ... " ;
+      // Plans are created once per size, type and number of threads.
+      const aol::Vec2<int> size ( 13, 8 );
+      qc::FFTWPlanCache<qc::QC_2D, double> &cache = qc::FFTWPlanCache<qc::QC_2D, double>::getInstance();
+      const qc::ConvolutionTrait<qc::QC_2D, double>::FFTWPlan plan = cache.getPlan ( size, qc::FFTW_PLAN_R2C );
+      success &= ( cache.getPlan ( size, qc::FFTW_PLAN_R2C ) == plan ) && ( cache.getPlan ( size, qc::FFTW_PLAN_C2R ) != plan )
+                 && ( cache.getPlan ( aol::Vec2<int> ( 8, 13 ), qc::FFTW_PLAN_R2C ) != plan );
+      qc::setFFTWNumThreads ( qc::getFFTWNumThreads() + 1 );
+      success &= ( cache.getPlan ( size, qc::FFTW_PLAN_R2C ) != plan );
+      qc::setFFTWNumThreads ( 0 );
+      success &= ( cache.getPlan ( size, qc::FFTW_PLAN_R2C ) == plan );
+
+      success &= !qc::importFFTWWisdom ( "nonexistent.wisdom" );
+      qc::exportFFTWWisdom ( "test.wisdom" );
+      success &= qc::importFFTWWisdom ( "test.wisdom" );
+      remove ( "test.wisdom" );
+
+      // The modulus computed with the r2c transform has to match the one of the complex transform, also for odd sizes.
+      for ( int n = 0; n < 2; ++n ) {
+        const int numX = size[n], numY = size[1 - n];
+        qc::ScalarArray<double, qc::QC_2D> function ( numX, numY ), modulus ( numX, numY ), functionCopy ( numX, numY );
+        qc::MultiArray<double, 2, 2> complexFunction ( numX, numY ), transform ( numX, numY );
+        for ( int j = 0; j < numY; ++j )
+          for ( int i = 0; i < numX; ++i )
+            function.set ( i, j, sin ( 0.7 * i + 0.3 * j * j ) + 0.1 * i );
+        complexFunction[0] = function;
+        qc::FourierTransform ( complexFunction, transform );
+        qc::computeFourierModulus ( function, modulus );
+        for ( int j = 0; j < numY; ++j )
+          for ( int i = 0; i < numX; ++i )
+            success &= ( aol::Abs ( modulus.get ( i, j ) - aol::Vec2<double> ( transform[0].get ( i, j ), transform[1].get ( i, j ) ).norm() ) < 1e-12 );
+
+        // Thresholding with zero only transforms back and forth.
+        functionCopy = function;
+        qc::fourierThreshold ( functionCopy, 0. );
+        functionCopy -= function;
+        success &= ( functionCopy.getMaxAbsValue() < 1e-12 );
+      }
+      if(success)
+        cerr << "OK" << endl;
+    }
+
+    {
+      cerr << "--- Testing qc::PhaseCorrelationRegistration::estimateTranslation ... " ;
+      typedef qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double, qc::QC_2D, 3> > ConfType;
+      const qc::GridDefinition grid ( 7, qc::QC_2D );
+      const int width = grid.getWidth();
+      const aol::Vec2<double> translation ( 3.3, -2.6 );
+      // A texture of random Gaussian bumps, sampled at the original and the translated positions.
+      aol::RandomGenerator randomGenerator;
+      aol::MultiVector<double> bumps ( 3, 600 );
+      for ( int k = 0; k < bumps[0].size(); ++k ) {
+        bumps[0][k] = randomGenerator.rReal<double> ( -5, width + 5 );
+        bumps[1][k] = randomGenerator.rReal<double> ( -5, width + 5 );
+        bumps[2][k] = randomGenerator.rReal<double>();
+      }
+      qc::ScalarArray<double, qc::QC_2D> reference ( grid ), templ ( grid );
+      for ( int j = 0; j < width; ++j ) {
+        for ( int i = 0; i < width; ++i ) {
+          for ( int k = 0; k < bumps[0].size(); ++k ) {
+            reference.add ( i, j, bumps[2][k] * exp ( - ( aol::Sqr ( i - bumps[0][k] ) + aol::Sqr ( j - bumps[1][k] ) ) / 4 ) );
+            templ.add ( i, j, bumps[2][k] * exp ( - ( aol::Sqr ( i - translation[0] - bumps[0][k] ) + aol::Sqr ( j - translation[1] - bumps[1][k] ) ) / 4 ) );
+          }
+        }
+      }
+      const aol::Vec<2, double> estimate = qc::PhaseCorrelationRegistration<ConfType>::estimateTranslation ( reference, templ );
+      success &= ( aol::Abs ( estimate[0] - translation[0] ) < 0.25 ) && ( aol::Abs ( estimate[1] - translation[1] ) < 0.25 );
+      if(success)
+        cerr << "OK" << endl;
+    }
+#endif
+
     { // int compatibility of arrays.
       cerr << "--- Testing qc::Array classes with size > 2^16 ... " ;
       cerr << "sizeof(short) = " << sizeof(short) << ", sizeof(int) = " << sizeof(int);
@@ -511,6 +1296,15 @@ int main( int, char** ) {
         cerr << "OK" << endl;
     }
 
+    {
+      cerr << "--- Testing qc::DeformImage against the node iterator based implementation ... " ;
+      success &= compareDeformImageWithNodeIterator<qc::QuocConfiguratorTraitMultiLin<double, qc::QC_2D, aol::GaussQuadrature<double, qc::QC_2D, 3> > > ( 5 );
+      success &= compareDeformImageWithNodeIterator<qc::QuocConfiguratorTraitMultiLin<float, qc::QC_2D, aol::GaussQuadrature<float, qc::QC_2D, 3> > > ( 5 );
+      success &= compareDeformImageWithNodeIterator<qc::QuocConfiguratorTraitMultiLin<double, qc::QC_3D, aol::GaussQuadrature<double, qc::QC_3D, 3> > > ( 3 );
+      if(success)
+        cerr << "OK" << endl;
+    }
+
     { // test some anisotropies and their visualization
       cerr << "--- Testing some anisotropies and their visualization ... " ;
 
@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \brief Measures the memory bandwidth attained by the BLAS-1 operations of aol::Vector on vectors that do not fit
+ *        into the cache, compares the fused operations used by the CG solvers with the corresponding sequence of
+ *        unfused operations and checks that both give the same result.
+ *
+ * The bandwidth of each operation is the number of bytes it has to read and write divided by its run time. The
+ * copy of a vector (operator=) serves as the reference for the attainable bandwidth.
+ *
+ * Usage: blas1 [bench file <ResultFile>]
+ *
+ * In benchmark mode, the number of entries per second (in millions) for which the residual and solution update of
+ * a CG step is done is logged as nupsi (unfused) and wupsi (fused).
+ *
+ * \author Berkels
+ */
+
+#include <vec.h>
+
+typedef double RType;
+
+class BLAS1Benchmark {
+  const int _size;
+  const int _numRepetitions;
+  aol::Vector<RType> _x, _y, _z, _w;
+  RType _copyBandwidth;
+
+public:
+  BLAS1Benchmark ( const int Size )
+    : _size ( Size ), _numRepetitions ( aol::Max ( 1, ( 1 << 26 ) / Size ) ), _x ( Size ), _y ( Size ), _z ( Size ), _w ( Size ), _copyBandwidth ( 0 ) {
+    for ( int i = 0; i < _size; ++i ) {
+      _x[i] = sin ( 0.001 * i );
+      _y[i] = cos ( 0.002 * i );
+      _z[i] = 0.01 * sin ( 0.7 * i );
+      _w[i] = 0.01 * cos ( 0.3 * i );
+    }
+  }
+
+  //! Returns the time per repetition in seconds and prints the bandwidth for NumStreams vectors read or written.
+  template <typename OpType>
+  RType run ( const char *Name, const int NumStreams, OpType Op ) {
+    aol::StopWatch watch;
+    watch.start();
+    for ( int i = 0; i < _numRepetitions; ++i )
+      Op ( _x, _y, _z, _w );
+    watch.stop();
+    const RType seconds = aol::Max ( watch.elapsedWallClockTime(), 1e-6 ) / _numRepetitions;
+    const RType bandwidth = static_cast<RType> ( NumStreams ) * _size * sizeof ( RType ) / seconds / ( 1 << 30 );
+    if ( _copyBandwidth == 0 )
+      _copyBandwidth = bandwidth;
+    cerr << aol::strprintf ( "%-40s %9.5fs %7.2f GiB/s %5.1f%% of copy\n", Name, seconds, bandwidth, 100 * bandwidth / _copyBandwidth );
+    return seconds;
+  }
+
+  int size () const {
+    return _size;
+  }
+};
+
+struct Copy {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &, aol::Vector<RType> & ) const {
+    Y = X;
+  }
+};
+
+struct Dot {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &Z, aol::Vector<RType> & ) const {
+    Z[0] += 1e-20 * ( X * Y );
+  }
+};
+
+struct AddMultiple {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &, aol::Vector<RType> & ) const {
+    X.addMultiple ( Y, 1e-10 );
+  }
+};
+
+struct AddMultipleThenNormSqr {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &Z, aol::Vector<RType> & ) const {
+    X.addMultiple ( Y, 1e-10 );
+    Z[0] += 1e-20 * X.normSqr();
+  }
+};
+
+struct AddMultipleAndNormSqr {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &Z, aol::Vector<RType> & ) const {
+    Z[0] += 1e-20 * X.addMultipleAndNormSqr ( Y, 1e-10 );
+  }
+};
+
+//! The update of solution (X) and residual (Z) in a CG step before the fused operations were used.
+struct CGUpdateUnfused {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &Z, aol::Vector<RType> &W ) const {
+    X.addMultiple ( Y, 1e-10 );
+    Z.addMultiple ( W, 1e-10 );
+    Y[0] += 1e-20 * ( Z * Z );
+  }
+};
+
+struct CGUpdateFused {
+  void operator() ( aol::Vector<RType> &X, aol::Vector<RType> &Y, aol::Vector<RType> &Z, aol::Vector<RType> &W ) const {
+    Y[0] += 1e-20 * Z.addMultipleAndNormSqr ( W, 1e-10, X, Y, 1e-10 );
+  }
+};
+
+//! Checks that the fused operations give exactly the same results as the unfused ones.
+void compareFusedWithUnfused ( const int Size ) {
+  aol::Vector<RType> x ( Size ), y ( Size ), z ( Size ), w ( Size );
+  for ( int i = 0; i < Size; ++i ) {
+    x[i] = sin ( 0.001 * i );
+    y[i] = cos ( 0.002 * i );
+    z[i] = 0.01 * sin ( 0.7 * i );
+    w[i] = 0.01 * cos ( 0.3 * i );
+  }
+  aol::Vector<RType> xFused ( x ), zFused ( z );
+
+  x.addMultiple ( y, 0.3 );
+  z.addMultiple ( w, -0.7 );
+  const RType normSqr = z * z;
+  const RType normSqrFused = zFused.addMultipleAndNormSqr ( w, -0.7, xFused, y, 0.3 );
+
+  x -= xFused;
+  z -= zFused;
+  if ( ( normSqr != normSqrFused ) || ( x.getMaxAbsValue() != 0 ) || ( z.getMaxAbsValue() != 0 ) )
+    throw aol::Exception ( "The fused and unfused operations give different results", __FILE__, __LINE__ );
+}
+
+int main ( int argc, char **argv ) {
+  try {
+    compareFusedWithUnfused ( 1 << 22 );
+    BLAS1Benchmark benchmark ( 1 << 22 );
+
+    cerr << benchmark.size() << " entries of type double\n";
+    benchmark.run ( "y = x", 2, Copy() );
+
+    string resultFilename;
+    if ( aol::checkForBenchmarkArguments ( argc, argv, resultFilename ) ) {
+      const RType unfusedSeconds = benchmark.run ( "CG update, unfused", 7, CGUpdateUnfused() );
+      const RType fusedSeconds = benchmark.run ( "CG update, fused", 6, CGUpdateFused() );
+      aol::logBenchmarkResult ( "blas1", benchmark.size() / unfusedSeconds / 1e6, benchmark.size() / fusedSeconds / 1e6, resultFilename );
+    }
+    else {
+      benchmark.run ( "x * y", 2, Dot() );
+      benchmark.run ( "x += a y", 3, AddMultiple() );
+      benchmark.run ( "x += a y; x * x", 4, AddMultipleThenNormSqr() );
+      benchmark.run ( "x += a y and x * x, fused", 3, AddMultipleAndNormSqr() );
+      benchmark.run ( "x += a y; z += b w; z * z", 7, CGUpdateUnfused() );
+      benchmark.run ( "x += a y, z += b w and z * z, fused", 6, CGUpdateFused() );
+    }
+  }
+  catch ( aol::Exception &el ) {
+    el.dump();
+    return EXIT_FAILURE;
+  }
+  aol::callSystemPauseIfNecessaryOnPlatform();
+  return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * \file
+ * \brief Compares the run time of qc::DeformImage with the node iterator based implementation it replaced
+ *        on 2D images with 1024^2, 2048^2 and 4096^2 pixels and checks that both give the same result.
+ *
+ * Usage: deformImage [bench file <ResultFile>]
+ *
+ * In benchmark mode, only the 1024^2 image is used and the number of deformed pixels per second (in
+ * millions) is logged as nupsi and wupsi.
+ *
+ * \author Berkels
+ */
+
+#include <deformations.h>
+#include <cellCenteredGrid.h>
+
+typedef double RType;
+const qc::Dimension DimensionChoice = qc::QC_2D;
+typedef qc::RectangularGridConfigurator<RType, DimensionChoice, aol::GaussQuadrature<RType,DimensionChoice,3>, qc::CellCenteredCubicGrid<DimensionChoice> > ConfType;
+
+//! Returns the number of deformed pixels per second (in millions) of qc::DeformImage.
+RType benchmarkDeformImage ( const int Depth, const bool CompareWithNodeIterator ) {
+  const ConfType::InitType grid ( Depth, DimensionChoice );
+  const int numX = grid.getNumX();
+  const int numRepetitions = aol::Max ( 1, ( 1 << 24 ) / grid.getNumberOfNodes() );
+
+  qc::ScalarArray<RType, qc::QC_2D> image ( grid );
+  qc::MultiArray<RType, qc::QC_2D> phi ( grid );
+  for ( int y = 0; y < numX; ++y ) {
+    for ( int x = 0; x < numX; ++x ) {
+      const RType s = static_cast<RType> ( x ) / numX, t = static_cast<RType> ( y ) / numX;
+      image.set ( x, y, sin ( 20 * s ) * cos ( 13 * t ) + s * t );
+      // Displacements of up to a few percent of the image width, pushing some positions out of the domain.
+      phi[0].set ( x, y, 0.05 * sin ( 6 * t + 1 ) * cos ( 5 * s ) );
+      phi[1].set ( x, y, 0.04 * cos ( 7 * s ) * sin ( 3 * t + 2 ) );
+    }
+  }
+  qc::ScalarArray<RType, qc::QC_2D> deformedImage ( grid );
+
+  aol::StopWatch watch;
+  watch.start();
+  for ( int i = 0; i < numRepetitions; ++i )
+    qc::DeformImage<ConfType> ( image, grid, deformedImage, phi );
+  watch.stop();
+  const RType pixelsPerSecond = numRepetitions * grid.getNumberOfNodes() / aol::Max ( watch.elapsedWallClockTime(), 1e-6 ) / 1e6;
+  cerr << numX << "^2 pixels, qc::DeformImage:                  " << aol::strprintf ( "%7.3f", watch.elapsedWallClockTime() / numRepetitions ) << "s per call\n";
+
+  if ( CompareWithNodeIterator ) {
+    qc::ScalarArray<RType, qc::QC_2D> referenceImage ( grid );
+    watch.start();
+    for ( int i = 0; i < numRepetitions; ++i )
+      qc::deformImageWithNodeIterator<ConfType> ( image, grid, referenceImage, phi, true, 0, false );
+    watch.stop();
+    cerr << numX << "^2 pixels, node iterator based DeformImage:  " << aol::strprintf ( "%7.3f", watch.elapsedWallClockTime() / numRepetitions ) << "s per call\n";
+
+    referenceImage -= deformedImage;
+    if ( referenceImage.getMaxAbsValue() != 0 )
+      throw aol::Exception ( aol::strprintf ( "The results differ by up to %e", referenceImage.getMaxAbsValue() ).c_str(), __FILE__, __LINE__ );
+  }
+  return pixelsPerSecond;
+}
+
+int main ( int argc, char **argv ) {
+  try {
+    string resultFilename;
+    if ( aol::checkForBenchmarkArguments ( argc, argv, resultFilename ) ) {
+      const RType megaPixelsPerSecond = benchmarkDeformImage ( 10, false );
+      aol::logBenchmarkResult ( "deformImage", megaPixelsPerSecond, megaPixelsPerSecond, resultFilename );
+    }
+    else {
+      for ( int depth = 10; depth <= 12; ++depth )
+        benchmarkDeformImage ( depth, true );
+    }
+  }
+  catch ( aol::Exception &el ) {
+    el.dump();
+    return EXIT_FAILURE;
+  }
+  aol::callSystemPauseIfNecessaryOnPlatform();
+  return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * \file
+ * \brief Compares the run time of the matrix free qc::MultilinStencilMassOp and qc::MultilinStencilStiffOp with the
+ *        assembled aol::MassOp and aol::StiffOp on a 2D grid with 1025^2 nodes and a 3D grid with 129^3 nodes and
+ *        checks that both give the same result up to rounding.
+ *
+ * Usage: stencilOp [bench file <ResultFile>]
+ *
+ * In benchmark mode, only the 2D grid is used and the number of nodes per second (in millions) to which the
+ * stencil mass and stiffness operators are applied is logged as nupsi and wupsi respectively.
+ *
+ * \author Berkels
+ */
+
+#include <multilinStencilOp.h>
+#include <configurators.h>
+
+typedef double RType;
+
+//! Returns the number of nodes per second (in millions) to which StencilOp is applied.
+template <typename ConfiguratorType, typename StencilOpType, typename AssembledOpType>
+RType benchmarkStencilOp ( const typename ConfiguratorType::InitType &Grid, const char *OpName, const bool CompareWithAssembled ) {
+  const int numRepetitions = aol::Max ( 1, ( 1 << 24 ) / Grid.getNumberOfNodes() );
+  aol::Vector<RType> arg ( Grid ), dest ( Grid );
+  for ( int i = 0; i < arg.size(); ++i )
+    arg[i] = sin ( 0.001 * i ) + 0.01 * cos ( 0.7 * i );
+
+  const StencilOpType stencilOp ( Grid );
+  aol::StopWatch watch;
+  watch.start();
+  for ( int i = 0; i < numRepetitions; ++i )
+    stencilOp.apply ( arg, dest );
+  watch.stop();
+  const RType nodesPerSecond = numRepetitions * Grid.getNumberOfNodes() / aol::Max ( watch.elapsedWallClockTime(), 1e-6 ) / 1e6;
+  cerr << Grid.getNumberOfNodes() << " nodes, " << OpName << ", stencil:   " << aol::strprintf ( "%8.5f", watch.elapsedWallClockTime() / numRepetitions ) << "s per apply\n";
+
+  if ( CompareWithAssembled ) {
+    const AssembledOpType assembledOp ( Grid, aol::ASSEMBLED );
+    aol::Vector<RType> reference ( Grid );
+    // Don't include the assembly in the timing.
+    assembledOp.apply ( arg, reference );
+    watch.start();
+    for ( int i = 0; i < numRepetitions; ++i )
+      assembledOp.apply ( arg, reference );
+    watch.stop();
+    cerr << Grid.getNumberOfNodes() << " nodes, " << OpName << ", assembled: " << aol::strprintf ( "%8.5f", watch.elapsedWallClockTime() / numRepetitions ) << "s per apply\n";
+
+    reference -= dest;
+    if ( reference.getMaxAbsValue() > 1e-10 * dest.getMaxAbsValue() )
+      throw aol::Exception ( aol::strprintf ( "The results differ by up to %e", reference.getMaxAbsValue() ).c_str(), __FILE__, __LINE__ );
+  }
+  return nodesPerSecond;
+}
+
+int main ( int argc, char **argv ) {
+  try {
+    typedef qc::QuocConfiguratorTraitMultiLin<RType, qc::QC_2D, aol::GaussQuadrature<RType, qc::QC_2D, 3> > ConfType2D;
+    typedef qc::QuocConfiguratorTraitMultiLin<RType, qc::QC_3D, aol::GaussQuadrature<RType, qc::QC_3D, 3> > ConfType3D;
+    const qc::GridDefinition grid2D ( 10, qc::QC_2D );
+
+    string resultFilename;
+    if ( aol::checkForBenchmarkArguments ( argc, argv, resultFilename ) ) {
+      const RType massNodesPerSecond = benchmarkStencilOp<ConfType2D, qc::MultilinStencilMassOp<ConfType2D>, aol::MassOp<ConfType2D> > ( grid2D, "mass ", false );
+      const RType stiffNodesPerSecond = benchmarkStencilOp<ConfType2D, qc::MultilinStencilStiffOp<ConfType2D>, aol::StiffOp<ConfType2D> > ( grid2D, "stiff", false );
+      aol::logBenchmarkResult ( "stencilOp", massNodesPerSecond, stiffNodesPerSecond, resultFilename );
+    }
+    else {
+      benchmarkStencilOp<ConfType2D, qc::MultilinStencilMassOp<ConfType2D>, aol::MassOp<ConfType2D> > ( grid2D, "mass ", true );
+      benchmarkStencilOp<ConfType2D, qc::MultilinStencilStiffOp<ConfType2D>, aol::StiffOp<ConfType2D> > ( grid2D, "stiff", true );
+      const qc::GridDefinition grid3D ( 7, qc::QC_3D );
+      benchmarkStencilOp<ConfType3D, qc::MultilinStencilMassOp<ConfType3D>, aol::MassOp<ConfType3D> > ( grid3D, "mass ", true );
+      benchmarkStencilOp<ConfType3D, qc::MultilinStencilStiffOp<ConfType3D>, aol::StiffOp<ConfType3D> > ( grid3D, "stiff", true );
+    }
+  }
+  catch ( aol::Exception &el ) {
+    el.dump();
+    return EXIT_FAILURE;
+  }
+  aol::callSystemPauseIfNecessaryOnPlatform();
+  return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * \file
+ * \brief Converts all DM3/DM4 files in a directory tree (or in a list of files) to TIFFs with
+ *        32 bit floating point precision, cropping the rectangle [x1,x2) x [y1,y2) and averaging
+ *        bin x bin blocks of it, like convertDM3ToTIFF does for a single file.
+ *
+ * The files are converted by numThreads workers within a single process (by default one per core).
+ * This needs quocmesh to be compiled with OpenMP, otherwise the files are converted one after
+ * another. Each worker only holds the frame it is currently converting, so at most numThreads
+ * frames are in memory at the same time.
+ *
+ * The output of InputDir/.../name.dm4 is OutputDir/name.tiff. Files whose output already exists
+ * are skipped, so the conversion can be interrupted and resumed. The output is written to a
+ * temporary file first and only renamed when complete, i.e. an interrupted run does not leave
+ * partially written TIFFs behind. Input files with the same name in different directories would
+ * be written to the same output file, all of them are reported and skipped.
+ *
+ * The exit code is EXIT_FAILURE if a conversion failed or files were skipped because of their name.
+ *
+ * Usage: batchConvertDM3ToTIFF InputDirOrFileList OutputDir x1 y1 x2 y2 bin [numThreads]
+ */
+
+#include <dm3Import.h>
+
+#include <map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int main ( int argc, char **argv ) {
+
+  try {
+    if ( ( argc != 8 ) && ( argc != 9 ) ) {
+      cerr << "USAGE: " << argv[0] << "  <InputDirOrFileList> <OutputDir> <x1> <y1> <x2> <y2> <bin> [<numThreads>]" << endl;
+      return EXIT_FAILURE;
+    }
+
+    const string input = argv[1];
+    const string outputDir = argv[2];
+    const aol::Vec2<int> cropStart ( atoi ( argv[3] ), atoi ( argv[4] ) );
+    const aol::Vec2<int> cropSize ( atoi ( argv[5] ) - cropStart[0], atoi ( argv[6] ) - cropStart[1] );
+    const int binSize = atoi ( argv[7] );
+#ifdef _OPENMP
+    const int numThreads = ( argc == 9 ) ? atoi ( argv[8] ) : omp_get_max_threads();
+#else
+    const int numThreads = 1;
+    if ( ( argc == 9 ) && ( atoi ( argv[8] ) > 1 ) )
+      cerr << "Warning: compiled without OpenMP, the files are converted one after another" << endl;
+#endif
+
+    if ( numThreads < 1 )
+      throw aol::Exception ( "numThreads has to be positive", __FILE__, __LINE__ );
+
+    std::vector<std::string> candidates;
+    if ( aol::directoryExists ( input ) )
+      aol::createRecursiveFileListing ( input, candidates );
+    else {
+      std::ifstream fileList ( input.c_str() );
+      if ( fileList.good() == false )
+        throw aol::FileException ( aol::strprintf ( "Cannot open file list %s for reading", input.c_str() ).c_str(), __FILE__, __LINE__ );
+      string line;
+      while ( std::getline ( fileList, line ) )
+        if ( line.size() > 0 )
+          candidates.push_back ( line );
+    }
+
+    // All outputs go into one directory, so input files with the same base name would overwrite each other (and write
+    // to the same temporary file in parallel). It is not clear which of them is meant, so all of them are skipped.
+    std::map<std::string, std::vector<std::string> > inFileNamesOfOutFile;
+    for ( unsigned int i = 0; i < candidates.size(); ++i ) {
+      if ( aol::fileNameEndsWith ( candidates[i].c_str(), ".dm4" ) || aol::fileNameEndsWith ( candidates[i].c_str(), ".dm3" ) )
+        inFileNamesOfOutFile[outputDir + "/" + aol::getBaseFileName ( candidates[i] ) + ".tiff"].push_back ( candidates[i] );
+    }
+
+    // Collect the files that still need to be converted.
+    std::vector<std::string> inFileNames, outFileNames;
+    int numSkipped = 0;
+    for ( std::map<std::string, std::vector<std::string> >::const_iterator it = inFileNamesOfOutFile.begin(); it != inFileNamesOfOutFile.end(); ++it ) {
+      if ( it->second.size() > 1 ) {
+        cerr << "Skipping the following files, they would all be converted to " << it->first << ":" << endl;
+        for ( unsigned int j = 0; j < it->second.size(); ++j )
+          cerr << "  " << it->second[j] << endl;
+        numSkipped += it->second.size();
+        continue;
+      }
+
+      if ( aol::fileExists ( it->first ) )
+        continue;
+
+      inFileNames.push_back ( it->second[0] );
+      outFileNames.push_back ( it->first );
+    }
+
+    cerr << "Converting " << inFileNames.size() << " files using " << numThreads << " thread(s)" << endl;
+    aol::makeDirectory ( outputDir.c_str() );
+
+    const int numFiles = static_cast<int> ( inFileNames.size() );
+    int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic ) num_threads ( numThreads ) reduction ( + : numFailed )
+#endif
+    for ( int i = 0; i < numFiles; ++i ) {
+      const string tempFileName = outFileNames[i] + ".part";
+      try {
+        qc::DM3Reader dmreader ( inFileNames[i] );
+        dmreader.saveCroppedAndBinnedDataAsTIFF ( tempFileName, cropStart, cropSize, binSize );
+        if ( std::rename ( tempFileName.c_str(), outFileNames[i].c_str() ) != 0 )
+          throw aol::FileException ( aol::strprintf ( "Cannot rename %s to %s", tempFileName.c_str(), outFileNames[i].c_str() ).c_str(), __FILE__, __LINE__ );
+#ifdef _OPENMP
+#pragma omp critical ( batchConvertDM3ToTIFF_output )
+#endif
+        cerr << "Converted " << inFileNames[i] << " to " << outFileNames[i] << endl;
+      }
+      // No exception may leave the parallel region.
+      catch ( aol::Exception &el ) {
+        std::remove ( tempFileName.c_str() );
+#ifdef _OPENMP
+#pragma omp critical ( batchConvertDM3ToTIFF_output )
+#endif
+        {
+          cerr << "Failed to convert " << inFileNames[i] << endl;
+          el.dump();
+        }
+        ++numFailed;
+      }
+      catch ( std::exception &ex ) {
+        std::remove ( tempFileName.c_str() );
+#ifdef _OPENMP
+#pragma omp critical ( batchConvertDM3ToTIFF_output )
+#endif
+        cerr << "Failed to convert " << inFileNames[i] << ": " << ex.what() << endl;
+        ++numFailed;
+      }
+      catch ( ... ) {
+        std::remove ( tempFileName.c_str() );
+#ifdef _OPENMP
+#pragma omp critical ( batchConvertDM3ToTIFF_output )
+#endif
+        cerr << "Failed to convert " << inFileNames[i] << ": unknown exception" << endl;
+        ++numFailed;
+      }
+    }
+
+    if ( numFailed > 0 )
+      cerr << numFailed << " of " << numFiles << " conversions failed" << endl;
+    if ( numSkipped > 0 )
+      cerr << numSkipped << " files were skipped because of duplicate names" << endl;
+    if ( ( numFailed > 0 ) || ( numSkipped > 0 ) )
+      return EXIT_FAILURE;
+  }//try
+  catch ( aol::Exception &el ) {
+    el.dump();
+    return EXIT_FAILURE;
+  }
+  aol::callSystemPauseIfNecessaryOnPlatform();
+  return 0;
+}
@@ -1,8 +1,11 @@
 /**
  * \file
- * \brief Converts a DM3 file to a ScalarArray with double precision. If the DM3 file contains multiple frames, the output are separate 2D arrays.
+ * \brief Converts a DM3 file to a ScalarArray keeping the data type stored in the DM3 file. If the DM3 file contains multiple frames, the output are separate 2D arrays.
  *
- * Usage: convertDM3ToQuoc InputFile
+ * The frames of a stack are read one after another, so stacks larger than the available memory can
+ * be converted. numThreads frames are compressed and written in parallel (needs OpenMP).
+ *
+ * Usage: convertDM3ToQuoc InputFile [numThreads]
  *
  * \author Berkels
  */
@@ -13,13 +16,14 @@ int main ( int argc, char **argv ) {
 
   try {
     if ( argc < 2 ) {
-      cerr << "USAGE: " << argv[0] << "  <InputFile>" << endl;
+      cerr << "USAGE: " << argv[0] << "  <InputFile> [<numThreads>]" << endl;
       return EXIT_FAILURE;
     }
 
     const string inFileName = argv[1];
+    const int numThreads = ( argc > 2 ) ? atoi ( argv[2] ) : 1;
     qc::DM3Reader dmreader( inFileName );
-    dmreader.saveDataAsScalarArray ( aol::getBaseFileName( inFileName ), true );
+    dmreader.saveDataAsScalarArray ( aol::getBaseFileName( inFileName ), true, numThreads );
 
   }//try
   catch ( aol::Exception &el ) {
@@ -0,0 +1,40 @@
+/**
+ * \file
+ * \brief Converts a 2D DM3/DM4 file directly to a TIFF with 32 bit floating point precision.
+ *        Optionally crops the rectangle [x1,x2) x [y1,y2) and averages bin x bin blocks of it,
+ *        without writing any intermediate quoc array.
+ *
+ * Usage: convertDM3ToTIFF InputFile OutputFile [x1 y1 x2 y2 [bin]]
+ */
+
+#include <dm3Import.h>
+
+int main ( int argc, char **argv ) {
+
+  try {
+    if ( ( argc != 3 ) && ( argc != 7 ) && ( argc != 8 ) ) {
+      cerr << "USAGE: " << argv[0] << "  <InputFile> <OutputFile> [<x1> <y1> <x2> <y2> [<bin>]]" << endl;
+      return EXIT_FAILURE;
+    }
+
+    const string inFileName = argv[1];
+    const string outFileName = argv[2];
+    qc::DM3Reader dmreader ( inFileName );
+
+    aol::Vec2<int> cropStart ( 0, 0 );
+    aol::Vec2<int> cropSize ( dmreader.getDataEntry().numX, dmreader.getDataEntry().numY );
+    if ( argc >= 7 ) {
+      cropStart.set ( atoi ( argv[3] ), atoi ( argv[4] ) );
+      cropSize.set ( atoi ( argv[5] ) - cropStart[0], atoi ( argv[6] ) - cropStart[1] );
+    }
+    const int binSize = ( argc == 8 ) ? atoi ( argv[7] ) : 1;
+
+    dmreader.saveCroppedAndBinnedDataAsTIFF ( outFileName, cropStart, cropSize, binSize );
+  }//try
+  catch ( aol::Exception &el ) {
+    el.dump();
+    return EXIT_FAILURE;
+  }
+  aol::callSystemPauseIfNecessaryOnPlatform();
+  return 0;
+}
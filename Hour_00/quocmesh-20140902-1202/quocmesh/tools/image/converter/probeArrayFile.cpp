@@ -0,0 +1,39 @@
+/**
+ * \file
+ * \brief Prints the dimensions, type and payload offset of the arrays stored in the given files without
+ *        reading the array data, one line per file. Supports the files handled by qc::probeArrayFile,
+ *        e.g. .q2bz, .dat.bz2, .pgm, TIFF and DM3/DM4 files.
+ *
+ * The columns are: file name, dimension, numX, numY, numZ, qc::SaveType, payload offset (-1 if unknown),
+ * compressed (0 or 1), min and max hint (nan if unknown).
+ *
+ * Usage: probeArrayFile InputFile [InputFile ...]
+ *
+ * \author Berkels
+ */
+
+#include <arrayFileProbe.h>
+
+int main ( int argc, char **argv ) {
+
+  if ( argc < 2 ) {
+    cerr << "USAGE: " << argv[0] << "  <InputFile> [<InputFile> ...]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  int numFailed = 0;
+  for ( int i = 1; i < argc; ++i ) {
+    try {
+      const qc::ArrayFileInfo info = qc::probeArrayFile ( argv[i] );
+      cout << argv[i] << "\t" << info.dim << "\t" << info.size[0] << "\t" << info.size[1] << "\t" << info.size[2]
+           << "\t" << info.type << "\t" << info.payloadOffset << "\t" << info.compressed
+           << "\t" << info.minHint << "\t" << info.maxHint << endl;
+    }//try
+    catch ( aol::Exception &el ) {
+      el.dump();
+      ++numFailed;
+    }
+  }
+  aol::callSystemPauseIfNecessaryOnPlatform();
+  return ( numFailed > 0 ) ? EXIT_FAILURE : 0;
+}
@@ -2,6 +2,26 @@ import fileinput, bz2
 #from PIL import Image
 import numpy as np
 
+#data types of the binary quoc formats, indexed by the magic number following the 'P' in the first line
+#of a .q2bz file (see qc::SaveType); convertDM3ToQuoc keeps the type of the .dm3/.dm4 file, usually uint16
+QUOC_DTYPES = {'5': np.uint8, '8': '<f4', '9': '<f8', 'a': '<u2', 'b': '<i2', '33': '<i4', '34': '<u4'}
+
+def readQuocHeader(f):
+    """ Reads the header of a 2D quoc array from the open file f and returns the numpy data type and the size. """
+    magic = f.readline().decode('ascii').strip()
+    if magic[1:] not in QUOC_DTYPES:
+        raise ValueError("Unsupported quoc file type {0}".format(magic))
+    #comment lines start with '#', binary types pad the last one with spaces
+    l = f.readline().decode('ascii')
+    while l.startswith('#'):
+        l = f.readline().decode('ascii')
+    #this line contains the size of the image, the next one the maximum value
+    words = l.split()
+    xsize = int(float(words[0]))
+    ysize = int(float(words[1]))
+    f.readline()
+    return np.dtype(QUOC_DTYPES[magic[1:]]), xsize, ysize
+
 #binCrop crops and image and bins it.
 #x1 and y1 are the coordinates of the top left corner to be cropped
 #x2 and y2 are the coordinates of the bottom right corner
@@ -14,20 +34,14 @@ def binCrop(image, x1, y1, x2, y2,bin):
     #first, the .q2bz file is read into 'f'
     f = bz2.BZ2File(image, 'r')
 
-    #the first 3 lines of the file are read off as they are text information
-    l=f.readline()
-    l=f.readline()
-    l=f.readline()
-    #the third line contains pixel information, so that is read into the program
-    words = l.split(" ")
-    xsize = int(float(words[0]))
-    ysize = int(float(words[1]))
-    l=f.readline() 
+    #the header tells the data type (the type stored in the .dm3/.dm4 file) and the size of the image
+    dtype, xsize, ysize = readQuocHeader(f)
 
     #the remaining info is read into a file, this is the image
     myF = f.read()
     #a numpy array is created, but is initially 1D
-    data = np.frombuffer(myF, dtype = float)
+    #the binning averages, so the data is converted to floating point
+    data = np.frombuffer(myF, dtype = dtype).astype(float)
     #based on the xsize that is given in the image header, the 2d image array is created
     print(data.shape)
     image = np.reshape(data, (-1,xsize))
@@ -40,8 +54,8 @@ def binCrop(image, x1, y1, x2, y2,bin):
     #I did not have time to add error messages if the numbers are off, I would 
     #imagine the program would just quit out
     M,N = cropped.shape
-    m = M/bin
-    n = N/bin
+    m = M//bin
+    n = N//bin
     sh = m,cropped.shape[0]//m,n,cropped.shape[1]//n
     image = cropped.reshape(sh).mean(-1).mean(1)
 
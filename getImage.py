@@ -1,7 +1,5 @@
 import sys, os, glob, shutil
 from subproc import run_subproc
-from binCrop import binCrop
-from PIL import Image
 
 def get_tiff_path(path):
     folders = []
@@ -32,28 +30,13 @@ def dm4_to_tiff(fullfilename,x1,y1,x2,y2,bin):
         shutil.move(f,f.replace(' ','_'))
         f = f.replace(' ','_')
         filebasename = filebasename.replace(' ','_')
-    basename = f[:-4]
-    # Convert from .dm4 to .q2bz
-    if(not os.path.isfile(basename+'.q2bz') and not os.path.isfile('{0}/tiff/{1}.tiff'.format(tiff_path, filebasename))):
-        print('Converting {0} to .q2bz...'.format(f))
-        run_subproc("./convertDM3ToQuoc " + f)
-        shutil.move(filebasename+'.q2bz',basename+'.q2bz')
+    tiff_file = '{0}/tiff/{1}.tiff'.format(tiff_path, filebasename)
+    # Convert from .dm4 directly to the cropped and binned .tiff
+    if(not os.path.isfile(tiff_file)):
+        print('Cropping, binning, and saving {0} as .tiff...'.format(f))
+        run_subproc('./convertDM3ToTIFF {0} {1} {2} {3} {4} {5} {6}'.format(f, tiff_file, x1, y1, x2, y2, bin))
     else:
-        print('{0}/tiff/{1}.q2bz or .tiff already exists!'.format(tiff_path, basename))
-    # Convert from .q2bz to .tiff
-    if(not os.path.isfile('tiff/{0}.tiff'.format(filebasename))):
-        print('Cropping, binning, and saving {0} as .tiff...'.format(f[:-4]+'.q2bz'))
-        editedImage = binCrop(f[:-4]+'.q2bz', x1, y1, x2, y2, bin)
-        # The next two lines save the resulting cropped and binned image as a .tiff file
-        im = Image.fromarray(editedImage)
-        im.save('{0}/tiff/{1}.tiff'.format(tiff_path, filebasename))
-    else:
-        print('{0}/tiff/{1}.tiff already exists!'.format(tiff_path, basename))
-    # Delete the .q2bz file to save hard drive space
-    try:
-        os.remove(basename+'.q2bz')
-    except:
-        pass
+        print('{0} already exists!'.format(tiff_file))
 
 def main():
     f   = sys.argv[1]
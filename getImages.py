@@ -1,6 +1,6 @@
-import sys, os, glob
+import sys, os, glob, shutil, subprocess, tempfile
 from subproc import run_subproc
-from getImage import dm4_to_tiff
+from getImage import get_tiff_path
 
 def remove_directory_spaces(path):
     """ Remove spaces in all directories. """
@@ -29,15 +29,34 @@ def main():
         y2 = int(f.readline().strip().split()[0])
         bin = int(f.readline().strip().split()[0])
     print('Using parameters:\nx1: {0}\nx2: {1}\ny1: {2}\ny2: {3}\nbin: {4}'.format(x1, x2, y1, y2, bin))
+    # Collect the .dm4 files per tiff directory, which is determined from the location of each file as in dm4_to_tiff.
+    file_lists = {}
     for dirpath, dirnames, filenames in os.walk(path):
         for f in filenames:
             if('.dm4' in f):
                 fullfilename = os.path.join(dirpath,f)
-                #submit_job(fullfilename, x1, y1, x2, y2, bin)
-                dm4_to_tiff(fullfilename, x1, y1, x2, y2, bin)
-                #run_subproc('python getImage.py {0} {1} {2} {3} {4} {5}'.format(fullfilename,x1,y1,x2,y2,bin),True)
-                #return 0
-        
+                if(' ' in f):
+                    shutil.move(fullfilename,os.path.join(dirpath,f.replace(' ','_')))
+                    fullfilename = os.path.join(dirpath,f.replace(' ','_'))
+                file_lists.setdefault(get_tiff_path(dirpath), []).append(fullfilename)
+    # Convert all .dm4 files of one tiff directory in a single process, the converter uses one worker per core.
+    failed = []
+    for tiff_path, filenames in file_lists.items():
+        if not os.path.exists(tiff_path + '/tiff'):
+            os.makedirs(tiff_path + '/tiff')
+            os.chmod(tiff_path + '/tiff', 0o755)
+        fd, file_list = tempfile.mkstemp(suffix='.txt', prefix='dm4_files_')
+        try:
+            with os.fdopen(fd, 'w') as f:
+                f.write('\n'.join(filenames) + '\n')
+            returncode = subprocess.call(['./batchConvertDM3ToTIFF', file_list, tiff_path + '/tiff', str(x1), str(y1), str(x2), str(y2), str(bin)])
+        finally:
+            os.remove(file_list)
+        if returncode != 0:
+            failed.append(tiff_path + '/tiff')
+    if failed:
+        print('Not all files could be converted for: {0}'.format(', '.join(failed)))
+        sys.exit(1)
 
 
 if __name__ == '__main__':